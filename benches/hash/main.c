@@ -0,0 +1,389 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "shared/common.h"
+#include "shared/types.h"
+#include "hash/add.h"
+#include "hash/bern.h"
+#include "hash/bern2.h"
+#include "hash/elf.h"
+#include "hash/fnv.h"
+#include "hash/jenkins.h"
+#include "hash/oat.h"
+#include "hash/rot.h"
+#include "hash/sax.h"
+#include "hash/xor.h"
+#include "hash/wy.h"
+#include "hash/hashcode.h"
+
+/* Measures throughput and bucket-collision quality of every hash in hash/ on a set of distinct keys. Keys are either
+ * read from a file (one key per line, or all string literals of a JSON file, i.e., the strings a string dictionary
+ * would receive), or generated synthetically. Produces one CSV line per key set and hash function.
+ *
+ * Quality is reported as the ratio between the number of colliding key pairs and the number expected for an ideal
+ * hash, for a power-of-two table addressed by the low bits (as in hash tables using a mask) and by the high bits (as
+ * the H1 part of the swiss table), as well as the number of full 32bit hash collisions. A ratio close to 1.0 is
+ * ideal; weak hashes show ratios far above 1.0 on structured keys. */
+
+#define DEFAULT_NUM_KEYS        1000000
+#define DEFAULT_MIN_BYTES       64 * 1024 * 1024
+
+struct key_set {
+        const char *name;
+        char *buffer;
+        const char **keys;
+        u32 *lens;
+        size_t num_keys;
+        size_t num_bytes;
+};
+
+struct hash_result {
+        double ns_per_key;
+        double gb_per_sec;
+        hash32_t *hashes;
+};
+
+static inline u64 now_ns()
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (u64) ts.tv_sec * 1000000000ULL + (u64) ts.tv_nsec;
+}
+
+static inline u64 next_random(u64 *state)
+{
+        u64 x = *state;
+        x ^= x >> 12;
+        x ^= x << 25;
+        x ^= x >> 27;
+        *state = x;
+        return x * 0x2545F4914F6CDD1DULL;
+}
+
+/** the NG5_HASH_* macros declare locals named 'i', 'k', 'a', 'b', 'c', 'g', 'hash' and 'key_size', hence the names */
+#define BENCH_HASH(fn_name, hash_expr)                                                                                 \
+static void fn_name(const struct key_set *set, hash32_t *out)                                                          \
+{                                                                                                                      \
+        for (size_t idx = 0; idx < set->num_keys; idx++) {                                                             \
+                const char *kptr = set->keys[idx];                                                                     \
+                size_t klen = set->lens[idx];                                                                          \
+                out[idx] = (hash_expr);                                                                                \
+        }                                                                                                              \
+}
+
+BENCH_HASH(bench_add, NG5_HASH_ADDITIVE(klen, kptr))
+BENCH_HASH(bench_bern, NG5_HASH_BERNSTEIN(klen, kptr))
+BENCH_HASH(bench_bern2, NG5_HASH_BERNSTEIN2(klen, kptr))
+BENCH_HASH(bench_elf, NG5_HASH_ELF(klen, kptr))
+BENCH_HASH(bench_fnv, NG5_HASH_FNV(klen, kptr))
+BENCH_HASH(bench_jenkins, NG5_HASH_JENKINS(klen, kptr))
+BENCH_HASH(bench_oat, NG5_HASH_OAT(klen, kptr))
+BENCH_HASH(bench_rot, NG5_HASH_ROT(klen, kptr))
+BENCH_HASH(bench_sax, NG5_HASH_SAX(klen, kptr))
+BENCH_HASH(bench_xor, NG5_HASH_XOR(klen, kptr))
+BENCH_HASH(bench_wy, NG5_HASH_WY(klen, kptr))
+
+static struct {
+        const char *name;
+        void (*run)(const struct key_set *set, hash32_t *out);
+} hash_functions[] = {
+        { "add",     bench_add },
+        { "bern",    bench_bern },
+        { "bern2",   bench_bern2 },
+        { "elf",     bench_elf },
+        { "fnv",     bench_fnv },
+        { "jenkins", bench_jenkins },
+        { "oat",     bench_oat },
+        { "rot",     bench_rot },
+        { "sax",     bench_sax },
+        { "xor",     bench_xor },
+        { "wy",      bench_wy }
+};
+
+#define NUM_HASH_FUNCTIONS      (sizeof(hash_functions) / sizeof(hash_functions[0]))
+
+static const struct key_set *sorted_set;
+
+static int compare_keys(const void *lhs, const void *rhs)
+{
+        const struct key_set *set = sorted_set;
+        u32 a = *(const u32 *) lhs, b = *(const u32 *) rhs;
+        if (set->lens[a] != set->lens[b]) {
+                return set->lens[a] < set->lens[b] ? -1 : 1;
+        }
+        return memcmp(set->keys[a], set->keys[b], set->lens[a]);
+}
+
+/** removes duplicates and empty keys (the classic hashes assert a non-empty key), keeping the first occurrence */
+static void key_set_make_distinct(struct key_set *set)
+{
+        u32 *order = malloc(set->num_keys * sizeof(u32));
+        bool *keep = calloc(set->num_keys, sizeof(bool));
+        for (size_t idx = 0; idx < set->num_keys; idx++) {
+                order[idx] = idx;
+        }
+        sorted_set = set;
+        qsort(order, set->num_keys, sizeof(u32), compare_keys);
+        for (size_t idx = 0; idx < set->num_keys; idx++) {
+                keep[order[idx]] = set->lens[order[idx]] > 0 &&
+                        (idx == 0 || compare_keys(&order[idx - 1], &order[idx]) != 0);
+        }
+        size_t num_kept = 0;
+        set->num_bytes = 0;
+        for (size_t idx = 0; idx < set->num_keys; idx++) {
+                if (keep[idx]) {
+                        set->keys[num_kept] = set->keys[idx];
+                        set->lens[num_kept] = set->lens[idx];
+                        set->num_bytes += set->lens[idx];
+                        num_kept++;
+                }
+        }
+        set->num_keys = num_kept;
+        free(order);
+        free(keep);
+}
+
+static void key_set_alloc(struct key_set *set, const char *name, size_t capacity, size_t buffer_size)
+{
+        set->name = name;
+        set->buffer = malloc(buffer_size);
+        set->keys = malloc(capacity * sizeof(char *));
+        set->lens = malloc(capacity * sizeof(u32));
+        set->num_keys = 0;
+        set->num_bytes = 0;
+}
+
+static void key_set_drop(struct key_set *set)
+{
+        free(set->buffer);
+        free(set->keys);
+        free(set->lens);
+}
+
+/** short, highly structured keys that differ only in a few trailing digits, e.g., "user409" */
+static void key_set_structured(struct key_set *set, size_t num_keys)
+{
+        key_set_alloc(set, "structured", num_keys, num_keys * 16);
+        char *pos = set->buffer;
+        for (size_t idx = 0; idx < num_keys; idx++) {
+                int len = sprintf(pos, "user%zu", idx);
+                set->keys[idx] = pos;
+                set->lens[idx] = len;
+                pos += len + 1;
+        }
+        set->num_keys = num_keys;
+        key_set_make_distinct(set);
+}
+
+/** random printable keys of 1 to 64 bytes */
+static void key_set_random(struct key_set *set, size_t num_keys)
+{
+        key_set_alloc(set, "random", num_keys, num_keys * 65);
+        u64 state = 0x9E3779B97F4A7C15ULL;
+        char *pos = set->buffer;
+        for (size_t idx = 0; idx < num_keys; idx++) {
+                u32 len = 1 + next_random(&state) % 64;
+                for (u32 j = 0; j < len; j++) {
+                        pos[j] = 'a' + next_random(&state) % 26;
+                }
+                set->keys[idx] = pos;
+                set->lens[idx] = len;
+                pos += len;
+        }
+        set->num_keys = num_keys;
+        key_set_make_distinct(set);
+}
+
+/** one key per line ('lines') or every string literal of a JSON document ('json'); escapes are kept as they are */
+static bool key_set_from_file(struct key_set *set, const char *path, bool json)
+{
+        FILE *file = fopen(path, "rb");
+        if (!file) {
+                fprintf(stderr, "** ERROR ** cannot open '%s'\n", path);
+                return false;
+        }
+        fseek(file, 0, SEEK_END);
+        size_t size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        key_set_alloc(set, path, size + 1, size + 1);
+        if (fread(set->buffer, 1, size, file) != size) {
+                fprintf(stderr, "** ERROR ** cannot read '%s'\n", path);
+                fclose(file);
+                key_set_drop(set);
+                return false;
+        }
+        fclose(file);
+        set->buffer[size] = '\0';
+
+        char *pos = set->buffer, *end = set->buffer + size;
+        while (pos < end) {
+                char *begin;
+                if (json) {
+                        while (pos < end && *pos != '"') {
+                                pos++;
+                        }
+                        begin = ++pos;
+                        while (pos < end && *pos != '"') {
+                                pos += (*pos == '\\' && pos + 1 < end) ? 2 : 1;
+                        }
+                } else {
+                        begin = pos;
+                        while (pos < end && *pos != '\n') {
+                                pos++;
+                        }
+                }
+                if (pos <= end && begin <= pos) {
+                        set->keys[set->num_keys] = begin;
+                        set->lens[set->num_keys] = pos - begin;
+                        set->num_keys++;
+                }
+                pos++;
+        }
+        key_set_make_distinct(set);
+        return true;
+}
+
+static double collision_ratio(const hash32_t *hashes, size_t num_keys, bool high_bits, u32 *max_load)
+{
+        u32 bits = 1;
+        while (((size_t) 1 << bits) < num_keys) {
+                bits++;
+        }
+        size_t num_buckets = (size_t) 1 << bits;
+        u32 *loads = calloc(num_buckets, sizeof(u32));
+        for (size_t idx = 0; idx < num_keys; idx++) {
+                size_t bucket = high_bits ? hashes[idx] >> (32 - bits) : hashes[idx] & (num_buckets - 1);
+                loads[bucket]++;
+        }
+        double pairs = 0;
+        for (size_t idx = 0; idx < num_buckets; idx++) {
+                pairs += loads[idx] * (double) (loads[idx] - (loads[idx] > 0 ? 1 : 0)) / 2;
+                *max_load = ng5_max(*max_load, loads[idx]);
+        }
+        free(loads);
+        double expected = num_keys * (double) (num_keys - 1) / (2.0 * num_buckets);
+        return expected > 0 ? pairs / expected : 0;
+}
+
+static int compare_hashes(const void *lhs, const void *rhs)
+{
+        hash32_t a = *(const hash32_t *) lhs, b = *(const hash32_t *) rhs;
+        return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+static size_t full_collisions(const hash32_t *hashes, size_t num_keys)
+{
+        hash32_t *sorted = malloc(num_keys * sizeof(hash32_t));
+        memcpy(sorted, hashes, num_keys * sizeof(hash32_t));
+        qsort(sorted, num_keys, sizeof(hash32_t), compare_hashes);
+        size_t num_collisions = 0;
+        for (size_t idx = 1; idx < num_keys; idx++) {
+                num_collisions += sorted[idx] == sorted[idx - 1] ? 1 : 0;
+        }
+        free(sorted);
+        return num_collisions;
+}
+
+static void run(const struct key_set *set, size_t min_bytes)
+{
+        if (set->num_keys < 2) {
+                fprintf(stderr, "** ERROR ** key set '%s' has less than 2 distinct keys\n", set->name);
+                return;
+        }
+
+        hash32_t *hashes = malloc(set->num_keys * sizeof(hash32_t));
+        size_t num_rounds = ng5_max((size_t) 1, min_bytes / (set->num_bytes + 1));
+        double expected_full = set->num_keys * (double) (set->num_keys - 1) / (2.0 * 4294967296.0);
+
+        for (size_t fn = 0; fn < NUM_HASH_FUNCTIONS; fn++) {
+                hash_functions[fn].run(set, hashes);        /* warm-up */
+                u64 begin = now_ns();
+                for (size_t round = 0; round < num_rounds; round++) {
+                        hash_functions[fn].run(set, hashes);
+                }
+                u64 elapsed = now_ns() - begin;
+
+                u32 max_load_low = 0, max_load_high = 0;
+                double ratio_low = collision_ratio(hashes, set->num_keys, false, &max_load_low);
+                double ratio_high = collision_ratio(hashes, set->num_keys, true, &max_load_high);
+
+                printf("%s, %s, %zu, %.2f, %.3f, %.3f, %zu, %.1f, %.3f, %u, %.3f, %u\n", set->name,
+                        hash_functions[fn].name, set->num_keys, set->num_bytes / (double) set->num_keys,
+                        elapsed / (double) (num_rounds * set->num_keys),
+                        (num_rounds * set->num_bytes) / (double) elapsed,
+                        full_collisions(hashes, set->num_keys), expected_full, ratio_low, max_load_low,
+                        ratio_high, max_load_high);
+                fflush(stdout);
+        }
+        free(hashes);
+}
+
+static void print_usage(const char *program)
+{
+        fprintf(stderr, "usage: %s [--keys <n>] [--lines <file>]* [--json <file>]*\n", program);
+        fprintf(stderr, "   --keys <n>          number of synthetic keys, default %d; 0 disables synthetic keys\n",
+                DEFAULT_NUM_KEYS);
+        fprintf(stderr, "   --lines <file>      adds a key set with one key per line of <file>\n");
+        fprintf(stderr, "   --json <file>       adds a key set with all string literals in the JSON file <file>\n");
+        fprintf(stderr, "default hash code (NG5_HASHCODE_OF) in this build: %s\n", NG5_HASHCODE_NAME);
+}
+
+int main(int argc, char *argv[])
+{
+        size_t num_keys = DEFAULT_NUM_KEYS;
+
+        for (int i = 1; i < argc; i++) {
+                if (strcmp(argv[i], "--keys") == 0 && i + 1 < argc) {
+                        num_keys = strtoull(argv[++i], NULL, 10);
+                } else if ((strcmp(argv[i], "--lines") == 0 || strcmp(argv[i], "--json") == 0) && i + 1 < argc) {
+                        i++;
+                } else {
+                        print_usage(argv[0]);
+                        return EXIT_FAILURE;
+                }
+        }
+
+        printf("key_set, hash, num_keys, avg_key_len, ns_per_key, gb_per_sec, full_collisions, expected_full, "
+               "low_bits_ratio, low_bits_max_load, high_bits_ratio, high_bits_max_load\n");
+
+        if (num_keys > 0) {
+                struct key_set set;
+                key_set_structured(&set, num_keys);
+                run(&set, DEFAULT_MIN_BYTES);
+                key_set_drop(&set);
+
+                key_set_random(&set, num_keys);
+                run(&set, DEFAULT_MIN_BYTES);
+                key_set_drop(&set);
+        }
+
+        for (int i = 1; i < argc; i++) {
+                bool json = strcmp(argv[i], "--json") == 0;
+                if (json || strcmp(argv[i], "--lines") == 0) {
+                        struct key_set set;
+                        if (key_set_from_file(&set, argv[++i], json)) {
+                                run(&set, DEFAULT_MIN_BYTES);
+                                key_set_drop(&set);
+                        }
+                }
+        }
+        return EXIT_SUCCESS;
+}
@@ -0,0 +1,526 @@
+/**
+ * Copyright 2019 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "shared/common.h"
+#include "shared/types.h"
+#include "core/mem/pool.h"
+
+/* Multi-threaded allocator benchmark over a configurable matrix of thread counts, size distributions, call mixes
+ * and object lifetimes. Each matrix cell runs in a forked child process (such that the peak resident set size is not
+ * shared among cells), and produces one CSV line with per-call latency percentiles, throughput and peak RSS.
+ *
+ * The CSV contains the columns 'impl_name', 'alpha' (share of realloc among realloc and free calls) and
+ * 'call_duration_ms' (mean latency per call) with the same meaning as in the output of `bench-mem-pools`, such that
+ * the R scripts in `benches/mem/pools/r-scripts` can be pointed to the results as well. */
+
+#define CLIB_ALLOCATOR_NAME     "clib/allocator"
+#define MAX_LIST_LEN            32
+#define HIST_SUB_BITS           4
+#define HIST_SUB_BUCKETS        (1 << HIST_SUB_BITS)
+#define HIST_NUM_BUCKETS        ((64 - HIST_SUB_BITS + 1) * HIST_SUB_BUCKETS)
+
+enum size_dist {
+        SIZE_UNIFORM,           /* uniform in [1, 2048] as in `bench-mem-pools` */
+        SIZE_POWERLAW,          /* Pareto distributed with shape 1.2 and minimum 8, capped at 1 MiB */
+        SIZE_BIMODAL            /* 90% in [16, 128], 10% in [4096, 65536] */
+};
+
+enum lifetime_dist {
+        LIFETIME_SHORT,         /* random victim among the last 32 live objects of a thread */
+        LIFETIME_LONG,          /* random victim among up to 8192 live objects of a thread */
+        LIFETIME_FIFO           /* oldest of up to 1024 live objects of a thread is freed first */
+};
+
+static const char *size_dist_names[] = { "uniform", "powerlaw", "bimodal" };
+static const char *lifetime_names[] = { "short", "long", "fifo" };
+static const u32 lifetime_windows[] = { 32, 8192, 1024 };
+
+struct mix {
+        u32 alloc_pct, realloc_pct, free_pct;
+};
+
+struct matrix_config {
+        u32 threads[MAX_LIST_LEN];
+        u32 num_threads;
+        enum size_dist sizes[MAX_LIST_LEN];
+        u32 num_sizes;
+        struct mix mixes[MAX_LIST_LEN];
+        u32 num_mixes;
+        enum lifetime_dist lifetimes[MAX_LIST_LEN];
+        u32 num_lifetimes;
+        const char *impls[MAX_LIST_LEN];
+        u32 num_impls;
+        u64 ops_per_thread;
+};
+
+struct cell {
+        const char *impl_name;
+        u32 threads;
+        enum size_dist size;
+        struct mix mix;
+        enum lifetime_dist lifetime;
+        u64 ops_per_thread;
+};
+
+struct cell_result {
+        u64 hist[HIST_NUM_BUCKETS];
+        u64 num_ops;
+        u64 sum_latency_ns;
+        u64 wallclock_ns;
+        u64 peak_rss_bytes;
+};
+
+struct bench_allocator {
+        struct pool pool;
+        bool is_pool;
+};
+
+struct worker {
+        pthread_t thread;
+        pthread_barrier_t *barrier;
+        const struct cell *cell;
+        struct bench_allocator *alloc;
+        u32 window;
+        u64 rand_state;
+        u64 hist[HIST_NUM_BUCKETS];
+        u64 num_ops;
+        u64 sum_latency_ns;
+};
+
+static inline u64 now_ns()
+{
+        struct timespec spec;
+        clock_gettime(CLOCK_MONOTONIC, &spec);
+        return (u64) spec.tv_sec * 1000000000ULL + spec.tv_nsec;
+}
+
+static inline u64 next_random(u64 *state)
+{
+        /* xorshift64*, thread-private to avoid the lock inside clibs `rand` */
+        u64 x = *state;
+        x ^= x >> 12;
+        x ^= x << 25;
+        x ^= x >> 27;
+        *state = x;
+        return x * 0x2545F4914F6CDD1DULL;
+}
+
+static inline double next_uniform(u64 *state)
+{
+        return ((next_random(state) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+static inline u64 next_size(u64 *state, enum size_dist dist)
+{
+        switch (dist) {
+        case SIZE_POWERLAW:
+                return ng5_min((u64) (8.0 / pow(next_uniform(state), 1.0 / 1.2)), 1 << 20);
+        case SIZE_BIMODAL:
+                return next_random(state) % 10 != 0 ? 16 + next_random(state) % 113 :
+                        4096 + next_random(state) % 61441;
+        case SIZE_UNIFORM:
+        default:
+                return 1 + next_random(state) % 2048;
+        }
+}
+
+static inline u32 hist_bucket(u64 value)
+{
+        if (value < HIST_SUB_BUCKETS) {
+                return value;
+        }
+        u32 exp = 63 - __builtin_clzll(value);
+        return (exp - HIST_SUB_BITS + 1) * HIST_SUB_BUCKETS + ((value >> (exp - HIST_SUB_BITS)) & (HIST_SUB_BUCKETS - 1));
+}
+
+static inline u64 hist_bucket_value(u32 bucket)
+{
+        if (bucket < HIST_SUB_BUCKETS) {
+                return bucket;
+        }
+        u32 exp = bucket / HIST_SUB_BUCKETS + HIST_SUB_BITS - 1;
+        u64 sub = bucket % HIST_SUB_BUCKETS;
+        return ((u64) HIST_SUB_BUCKETS + sub) << (exp - HIST_SUB_BITS);
+}
+
+static u64 hist_percentile(const u64 *hist, u64 total, double p)
+{
+        u64 rank = (u64) ceil(p * total);
+        u64 seen = 0;
+        for (u32 i = 0; i < HIST_NUM_BUCKETS; i++) {
+                seen += hist[i];
+                if (seen >= rank && hist[i] > 0) {
+                        return hist_bucket_value(i);
+                }
+        }
+        return 0;
+}
+
+static inline void *handle_get_pointer(struct bench_allocator *alloc, void *handle)
+{
+        return alloc->is_pool ? data_ptr_get_pointer(handle) : handle;
+}
+
+static inline void *bench_alloc(struct bench_allocator *alloc, u64 size)
+{
+        void *handle = alloc->is_pool ? pool_alloc(&alloc->pool, size) : malloc(size);
+        *(volatile char *) handle_get_pointer(alloc, handle) = 1;
+        return handle;
+}
+
+static inline void *bench_realloc(struct bench_allocator *alloc, void *handle, u64 size)
+{
+        handle = alloc->is_pool ? pool_realloc(&alloc->pool, handle, size) : realloc(handle, size);
+        *(volatile char *) handle_get_pointer(alloc, handle) = 1;
+        return handle;
+}
+
+static inline void bench_free(struct bench_allocator *alloc, void *handle)
+{
+        if (alloc->is_pool) {
+                pool_free(&alloc->pool, handle);
+        } else {
+                free(handle);
+        }
+}
+
+static void *worker_main(void *args)
+{
+        struct worker *worker = args;
+        const struct cell *cell = worker->cell;
+        void **live = malloc(worker->window * sizeof(void *));
+        u32 num_live = 0;
+
+        pthread_barrier_wait(worker->barrier);
+
+        for (u64 op = 0; op < cell->ops_per_thread; op++) {
+                u32 choice = next_random(&worker->rand_state) % 100;
+                bool do_alloc = num_live == 0 || (choice < cell->mix.alloc_pct && num_live < worker->window);
+                bool do_realloc = !do_alloc && choice < cell->mix.alloc_pct + cell->mix.realloc_pct &&
+                        choice >= cell->mix.alloc_pct;
+                /* the oldest object is at the front for fifo lifetimes */
+                u32 victim = cell->lifetime == LIFETIME_FIFO ? 0 :
+                        next_random(&worker->rand_state) % ng5_max(num_live, 1);
+                u64 size = next_size(&worker->rand_state, cell->size);
+                u64 begin, end;
+
+                if (do_alloc) {
+                        begin = now_ns();
+                        void *handle = bench_alloc(worker->alloc, size);
+                        end = now_ns();
+                        live[num_live++] = handle;
+                } else if (do_realloc) {
+                        begin = now_ns();
+                        live[victim] = bench_realloc(worker->alloc, live[victim], size);
+                        end = now_ns();
+                } else {
+                        begin = now_ns();
+                        bench_free(worker->alloc, live[victim]);
+                        end = now_ns();
+                        /* keep insertion order for fifo lifetimes, otherwise fill the hole with the last object */
+                        if (cell->lifetime == LIFETIME_FIFO) {
+                                memmove(live + victim, live + victim + 1, (num_live - victim - 1) * sizeof(void *));
+                        } else {
+                                live[victim] = live[num_live - 1];
+                        }
+                        num_live--;
+                }
+
+                worker->hist[hist_bucket(end - begin)]++;
+                worker->sum_latency_ns += end - begin;
+                worker->num_ops++;
+        }
+
+        while (num_live--) {
+                bench_free(worker->alloc, live[num_live]);
+        }
+        free(live);
+        return NULL;
+}
+
+static u64 peak_rss_bytes()
+{
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return (u64) usage.ru_maxrss * 1024;
+}
+
+static void run_cell(struct cell_result *result, const struct cell *cell)
+{
+        struct bench_allocator alloc;
+        struct worker workers[cell->threads];
+        pthread_barrier_t barrier;
+
+        alloc.is_pool = strcmp(cell->impl_name, CLIB_ALLOCATOR_NAME) != 0;
+        if (alloc.is_pool) {
+                pool_create_by_name(&alloc.pool, cell->impl_name);
+        }
+
+        /* all threads share one pool, whose number of managed pointers is limited; the window is clamped for all
+         * allocators such that results remain comparable */
+        u32 window = ng5_min(lifetime_windows[cell->lifetime], POOL_MAX_MANAGED_PTRS / cell->threads);
+
+        ng5_zero_memory(result, sizeof(struct cell_result));
+        pthread_barrier_init(&barrier, NULL, cell->threads + 1);
+        for (u32 i = 0; i < cell->threads; i++) {
+                ng5_zero_memory(&workers[i], sizeof(struct worker));
+                workers[i].barrier = &barrier;
+                workers[i].cell = cell;
+                workers[i].alloc = &alloc;
+                workers[i].window = window;
+                workers[i].rand_state = 0x9E3779B97F4A7C15ULL * (i + 1);
+                pthread_create(&workers[i].thread, NULL, worker_main, workers + i);
+        }
+
+        u64 begin = now_ns();
+        pthread_barrier_wait(&barrier);
+        for (u32 i = 0; i < cell->threads; i++) {
+                pthread_join(workers[i].thread, NULL);
+                for (u32 b = 0; b < HIST_NUM_BUCKETS; b++) {
+                        result->hist[b] += workers[i].hist[b];
+                }
+                result->num_ops += workers[i].num_ops;
+                result->sum_latency_ns += workers[i].sum_latency_ns;
+        }
+        result->wallclock_ns = now_ns() - begin;
+        result->peak_rss_bytes = peak_rss_bytes();
+
+        pthread_barrier_destroy(&barrier);
+        if (alloc.is_pool) {
+                pool_drop(&alloc.pool);
+        }
+}
+
+static void run_cell_isolated(const struct cell *cell)
+{
+        int pipe_fds[2];
+        struct cell_result result;
+
+        if (pipe(pipe_fds) != 0) {
+                perror("pipe");
+                return;
+        }
+
+        pid_t pid = fork();
+        if (pid == 0) {
+                close(pipe_fds[0]);
+                u64 baseline_rss = peak_rss_bytes();
+                run_cell(&result, cell);
+                result.peak_rss_bytes -= ng5_min(result.peak_rss_bytes, baseline_rss);
+                const char *data = (const char *) &result;
+                for (size_t written = 0; written < sizeof(struct cell_result); ) {
+                        ssize_t nwrite = write(pipe_fds[1], data + written, sizeof(struct cell_result) - written);
+                        if (nwrite <= 0) {
+                                break;
+                        }
+                        written += nwrite;
+                }
+                close(pipe_fds[1]);
+                _exit(EXIT_SUCCESS);
+        }
+
+        close(pipe_fds[1]);
+        size_t nread = 0;
+        char *data = (char *) &result;
+        while (nread < sizeof(struct cell_result)) {
+                ssize_t n = read(pipe_fds[0], data + nread, sizeof(struct cell_result) - nread);
+                if (n <= 0) {
+                        break;
+                }
+                nread += n;
+        }
+        close(pipe_fds[0]);
+        waitpid(pid, NULL, 0);
+
+        if (nread != sizeof(struct cell_result) || result.num_ops == 0) {
+                fprintf(stderr, "matrix cell for '%s' failed\n", cell->impl_name);
+                return;
+        }
+
+        u32 realloc_free_pct = cell->mix.realloc_pct + cell->mix.free_pct;
+        printf("%s, %" PRIu32 ", %s, %s, %" PRIu32 ", %" PRIu32 ", %" PRIu32 ", %0.2f, %" PRIu64 ", %0.8f, %0.0f, "
+                "%" PRIu64 ", %" PRIu64 ", %" PRIu64 ", %" PRIu64 ", %" PRIu64 "\n",
+                cell->impl_name, cell->threads, size_dist_names[cell->size], lifetime_names[cell->lifetime],
+                cell->mix.alloc_pct, cell->mix.realloc_pct, cell->mix.free_pct,
+                realloc_free_pct ? cell->mix.realloc_pct / (float) realloc_free_pct : 0.0f,
+                result.num_ops,
+                result.sum_latency_ns / (double) result.num_ops / 1.0e6,
+                result.num_ops / (result.wallclock_ns / 1.0e9),
+                hist_percentile(result.hist, result.num_ops, 0.50),
+                hist_percentile(result.hist, result.num_ops, 0.90),
+                hist_percentile(result.hist, result.num_ops, 0.99),
+                hist_percentile(result.hist, result.num_ops, 0.999),
+                result.peak_rss_bytes);
+        fflush(stdout);
+}
+
+static bool parse_list(char *list, void *dst, u32 *num, bool (*parse)(void *dst, u32 idx, const char *token))
+{
+        char *save = NULL;
+        *num = 0;
+        for (char *token = strtok_r(list, ",", &save); token; token = strtok_r(NULL, ",", &save)) {
+                if (*num == MAX_LIST_LEN || !parse(dst, *num, token)) {
+                        fprintf(stderr, "illegal list element '%s'\n", token);
+                        return false;
+                }
+                (*num)++;
+        }
+        return *num > 0;
+}
+
+static bool parse_thread(void *dst, u32 idx, const char *token)
+{
+        int value = atoi(token);
+        ((u32 *) dst)[idx] = value;
+        return value > 0;
+}
+
+static bool parse_size(void *dst, u32 idx, const char *token)
+{
+        for (u32 i = 0; i < NG5_ARRAY_LENGTH(size_dist_names); i++) {
+                if (strcmp(token, size_dist_names[i]) == 0) {
+                        ((enum size_dist *) dst)[idx] = i;
+                        return true;
+                }
+        }
+        return false;
+}
+
+static bool parse_lifetime(void *dst, u32 idx, const char *token)
+{
+        for (u32 i = 0; i < NG5_ARRAY_LENGTH(lifetime_names); i++) {
+                if (strcmp(token, lifetime_names[i]) == 0) {
+                        ((enum lifetime_dist *) dst)[idx] = i;
+                        return true;
+                }
+        }
+        return false;
+}
+
+static bool parse_mix(void *dst, u32 idx, const char *token)
+{
+        struct mix *mix = ((struct mix *) dst) + idx;
+        return sscanf(token, "%" SCNu32 ":%" SCNu32 ":%" SCNu32, &mix->alloc_pct, &mix->realloc_pct,
+                &mix->free_pct) == 3 && mix->alloc_pct + mix->realloc_pct + mix->free_pct == 100 &&
+                mix->alloc_pct > 0;
+}
+
+static bool parse_impl(void *dst, u32 idx, const char *token)
+{
+        ((const char **) dst)[idx] = token;
+        return true;
+}
+
+static void print_usage(const char *program)
+{
+        printf("usage: %s [--threads <list>] [--sizes <list>] [--mixes <list>] [--lifetimes <list>]\n"
+                "       [--impls <list>] [--ops <num>]\n\n"
+                "Runs each combination of the given lists, where lists are comma-separated:\n"
+                "  --threads     number of threads sharing one allocator (default: 1,2,4,8)\n"
+                "  --sizes       size distributions 'uniform', 'powerlaw', 'bimodal' (default: all)\n"
+                "  --mixes       call mixes as alloc:realloc:free percentages (default: 50:25:25)\n"
+                "  --lifetimes   object lifetimes 'short', 'long', 'fifo' (default: all)\n"
+                "  --impls       '%s' and/or memory pool names (default: all)\n"
+                "  --ops         calls per thread (default: 1000000)\n\n"
+                "The following memory pool names are registered:\n", program, CLIB_ALLOCATOR_NAME);
+        for (u32 i = 0; i < pool_get_num_registered_strategies(); i++) {
+                struct pool_register_entry *e = pool_register + i;
+                struct pool_strategy s;
+                e->_create(&s);
+                printf("\t'%s'\n", s.impl_name);
+                if (e->_drop) {
+                        e->_drop(&s);
+                }
+        }
+}
+
+int main(int argc, char *argv[])
+{
+        struct matrix_config config = {
+                .threads = { 1, 2, 4, 8 }, .num_threads = 4,
+                .sizes = { SIZE_UNIFORM, SIZE_POWERLAW, SIZE_BIMODAL }, .num_sizes = 3,
+                .mixes = { { 50, 25, 25 } }, .num_mixes = 1,
+                .lifetimes = { LIFETIME_SHORT, LIFETIME_LONG, LIFETIME_FIFO }, .num_lifetimes = 3,
+                .num_impls = 0,
+                .ops_per_thread = 1000000
+        };
+
+        for (int i = 1; i < argc; i++) {
+                const char *opt = argv[i];
+                char *value = i + 1 < argc ? argv[++i] : NULL;
+                bool ok = value != NULL;
+                if (ok && strcmp(opt, "--threads") == 0) {
+                        ok = parse_list(value, config.threads, &config.num_threads, parse_thread);
+                } else if (ok && strcmp(opt, "--sizes") == 0) {
+                        ok = parse_list(value, config.sizes, &config.num_sizes, parse_size);
+                } else if (ok && strcmp(opt, "--mixes") == 0) {
+                        ok = parse_list(value, config.mixes, &config.num_mixes, parse_mix);
+                } else if (ok && strcmp(opt, "--lifetimes") == 0) {
+                        ok = parse_list(value, config.lifetimes, &config.num_lifetimes, parse_lifetime);
+                } else if (ok && strcmp(opt, "--impls") == 0) {
+                        ok = parse_list(value, config.impls, &config.num_impls, parse_impl);
+                } else if (ok && strcmp(opt, "--ops") == 0) {
+                        ok = (config.ops_per_thread = strtoull(value, NULL, 10)) > 0;
+                } else {
+                        ok = false;
+                }
+                if (!ok) {
+                        print_usage(argv[0]);
+                        exit(EXIT_FAILURE);
+                }
+        }
+
+        if (config.num_impls == 0) {
+                config.impls[config.num_impls++] = CLIB_ALLOCATOR_NAME;
+                for (u32 i = 0; i < pool_get_num_registered_strategies() && config.num_impls < MAX_LIST_LEN; i++) {
+                        struct pool_strategy s;
+                        pool_register[i]._create(&s);
+                        config.impls[config.num_impls++] = s.impl_name;
+                        if (pool_register[i]._drop) {
+                                pool_register[i]._drop(&s);
+                        }
+                }
+        }
+
+        printf("impl_name, threads, size_dist, lifetime, alloc_pct, realloc_pct, free_pct, alpha, num_calls, "
+                "call_duration_ms, ops_per_sec, p50_ns, p90_ns, p99_ns, p999_ns, peak_rss_bytes\n");
+        fflush(stdout);
+
+        for (u32 impl = 0; impl < config.num_impls; impl++)
+        for (u32 threads = 0; threads < config.num_threads; threads++)
+        for (u32 size = 0; size < config.num_sizes; size++)
+        for (u32 mix = 0; mix < config.num_mixes; mix++)
+        for (u32 lifetime = 0; lifetime < config.num_lifetimes; lifetime++) {
+                struct cell cell = {
+                        .impl_name = config.impls[impl],
+                        .threads = config.threads[threads],
+                        .size = config.sizes[size],
+                        .mix = config.mixes[mix],
+                        .lifetime = config.lifetimes[lifetime],
+                        .ops_per_thread = config.ops_per_thread
+                };
+                run_cell_isolated(&cell);
+        }
+
+        return EXIT_SUCCESS;
+}
@@ -0,0 +1,287 @@
+/**
+ * Copyright 2019 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "shared/common.h"
+#include "shared/types.h"
+#include "utils/time.h"
+#include "core/alloc/trace.h"
+#include "core/mem/pool.h"
+
+#define CLIB_ALLOCATOR_NAME "clib/allocator"
+#define PAGE_SIZE           4096
+
+/* Replays an allocation trace (as recorded by `carbon-tool convert --trace-alloc <file>`) against every registered
+ * memory pool strategy and clibs allocator, and reports throughput, peak footprint and fragmentation. Each allocator
+ * runs in a forked child process such that the peak resident set size of one run does not leak into the next. */
+
+struct replay_trace {
+        struct trace_event *events;
+        u64 num_events;
+        u64 num_objects;
+        u64 peak_live_objects;
+        u64 peak_live_bytes;
+};
+
+struct replay_result {
+        u64 duration_us;
+        u64 peak_rss_bytes;
+        bool skipped;
+};
+
+static bool load_trace(struct replay_trace *trace, const char *path);
+static void replay_clib(struct replay_result *result, const struct replay_trace *trace);
+static void replay_pool(struct replay_result *result, const struct replay_trace *trace, const char *impl_name);
+static void run_isolated(const struct replay_trace *trace, const char *impl_name);
+
+int main(int argc, char *argv[])
+{
+        if (argc < 2) {
+                printf("usage: <trace-file> [<allocator>...]\n\n"
+                        "<trace-file> is an allocation trace, e.g., as recorded by\n"
+                        "`carbon-tool convert --trace-alloc <trace-file> out.carbon in.json`.\n"
+                        "<allocator> is the identifier of an allocator implementation to bench. If no\n"
+                        "allocator is given, '%s' and all registered memory pools are benched.\n\n",
+                        CLIB_ALLOCATOR_NAME);
+                exit(EXIT_FAILURE);
+        }
+
+        struct replay_trace trace;
+        if (!load_trace(&trace, argv[1])) {
+                fprintf(stderr, "unable to read allocation trace '%s'\n", argv[1]);
+                exit(EXIT_FAILURE);
+        }
+
+        printf("impl_name, num_events, num_objects, peak_live_objects, peak_live_bytes, duration_ms, "
+                "events_per_sec, peak_rss_bytes, fragmentation\n");
+        fflush(stdout);
+
+        if (argc > 2) {
+                for (int i = 2; i < argc; i++) {
+                        run_isolated(&trace, argv[i]);
+                }
+        } else {
+                run_isolated(&trace, CLIB_ALLOCATOR_NAME);
+                for (u32 i = 0; i < pool_get_num_registered_strategies(); i++) {
+                        struct pool_register_entry *e = pool_register + i;
+                        struct pool_strategy s;
+                        e->_create(&s);
+                        run_isolated(&trace, s.impl_name);
+                        if (e->_drop) {
+                                e->_drop(&s);
+                        }
+                }
+        }
+
+        free(trace.events);
+        return EXIT_SUCCESS;
+}
+
+static bool load_trace(struct replay_trace *trace, const char *path)
+{
+        struct trace_reader reader;
+        struct trace_event event;
+        u64 capacity = 1024;
+        u64 live_objects = 0, live_bytes = 0;
+        u64 *sizes = calloc(capacity, sizeof(u64));
+
+        if (!trace_reader_open(&reader, path)) {
+                free(sizes);
+                return false;
+        }
+
+        ng5_zero_memory(trace, sizeof(struct replay_trace));
+        trace->events = malloc(capacity * sizeof(struct trace_event));
+
+        /* load the entire trace upfront such that file I/O does not count into replay time, and determine the live
+         * set statistics of the trace to compute the fragmentation of an allocator later */
+        while (trace_reader_next(&event, &reader)) {
+                if (trace->num_events == capacity || event.object_id >= capacity) {
+                        u64 new_capacity = ng5_max(2 * capacity, event.object_id + 1);
+                        trace->events = realloc(trace->events, new_capacity * sizeof(struct trace_event));
+                        sizes = realloc(sizes, new_capacity * sizeof(u64));
+                        memset(sizes + capacity, 0, (new_capacity - capacity) * sizeof(u64));
+                        capacity = new_capacity;
+                }
+                trace->events[trace->num_events++] = event;
+                trace->num_objects = ng5_max(trace->num_objects, event.object_id + 1);
+                switch (event.type) {
+                case TRACE_EVENT_ALLOC:
+                        live_objects++;
+                        live_bytes += event.size;
+                        sizes[event.object_id] = event.size;
+                        break;
+                case TRACE_EVENT_REALLOC:
+                        live_bytes = live_bytes - sizes[event.object_id] + event.size;
+                        sizes[event.object_id] = event.size;
+                        break;
+                case TRACE_EVENT_FREE:
+                        live_objects--;
+                        live_bytes -= sizes[event.object_id];
+                        sizes[event.object_id] = 0;
+                        break;
+                }
+                trace->peak_live_objects = ng5_max(trace->peak_live_objects, live_objects);
+                trace->peak_live_bytes = ng5_max(trace->peak_live_bytes, live_bytes);
+        }
+
+        bool status = (reader.err.code == NG5_ERR_NOERR);
+        trace_reader_close(&reader);
+        free(sizes);
+        return status;
+}
+
+static inline void touch(void *ptr, u64 size)
+{
+        /* write one byte per page such that the block is backed by resident memory as in the recorded run */
+        for (u64 off = 0; off < size; off += PAGE_SIZE) {
+                ((volatile char *) ptr)[off] = 1;
+        }
+}
+
+static u64 peak_rss_bytes()
+{
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return (u64) usage.ru_maxrss * 1024;
+}
+
+static void replay_clib(struct replay_result *result, const struct replay_trace *trace)
+{
+        void **objects = calloc(trace->num_objects, sizeof(void *));
+
+        timestamp_t begin = time_now_wallclock();
+        for (u64 i = 0; i < trace->num_events; i++) {
+                const struct trace_event *event = trace->events + i;
+                void **object = objects + event->object_id;
+                switch (event->type) {
+                case TRACE_EVENT_ALLOC:
+                        *object = malloc(ng5_max(1, event->size));
+                        touch(*object, event->size);
+                        break;
+                case TRACE_EVENT_REALLOC:
+                        *object = realloc(*object, ng5_max(1, event->size));
+                        touch(*object, event->size);
+                        break;
+                case TRACE_EVENT_FREE:
+                        free(*object);
+                        *object = NULL;
+                        break;
+                }
+        }
+        timestamp_t end = time_now_wallclock();
+
+        result->duration_us = (end - begin) * 1000;
+        result->peak_rss_bytes = peak_rss_bytes();
+        result->skipped = false;
+
+        for (u64 i = 0; i < trace->num_objects; i++) {
+                free(objects[i]);
+        }
+        free(objects);
+}
+
+static void replay_pool(struct replay_result *result, const struct replay_trace *trace, const char *impl_name)
+{
+        if (trace->peak_live_objects > POOL_MAX_MANAGED_PTRS) {
+                result->skipped = true;
+                return;
+        }
+
+        struct pool pool;
+        data_ptr_t *objects = calloc(trace->num_objects, sizeof(data_ptr_t));
+        pool_create_by_name(&pool, impl_name);
+
+        timestamp_t begin = time_now_wallclock();
+        for (u64 i = 0; i < trace->num_events; i++) {
+                const struct trace_event *event = trace->events + i;
+                data_ptr_t *object = objects + event->object_id;
+                switch (event->type) {
+                case TRACE_EVENT_ALLOC:
+                        *object = pool_alloc(&pool, ng5_max(1, event->size));
+                        touch(data_ptr_get_pointer(*object), event->size);
+                        break;
+                case TRACE_EVENT_REALLOC:
+                        *object = pool_realloc(&pool, *object, ng5_max(1, event->size));
+                        touch(data_ptr_get_pointer(*object), event->size);
+                        break;
+                case TRACE_EVENT_FREE:
+                        pool_free(&pool, *object);
+                        *object = NULL;
+                        break;
+                }
+        }
+        timestamp_t end = time_now_wallclock();
+
+        result->duration_us = (end - begin) * 1000;
+        result->peak_rss_bytes = peak_rss_bytes();
+        result->skipped = false;
+
+        pool_free_all(&pool);
+        pool_drop(&pool);
+        free(objects);
+}
+
+static void run_isolated(const struct replay_trace *trace, const char *impl_name)
+{
+        int pipe_fds[2];
+        struct replay_result result = { .skipped = true };
+
+        if (pipe(pipe_fds) != 0) {
+                perror("pipe");
+                return;
+        }
+
+        pid_t pid = fork();
+        if (pid == 0) {
+                close(pipe_fds[0]);
+                u64 baseline_rss = peak_rss_bytes();
+                if (strcmp(impl_name, CLIB_ALLOCATOR_NAME) == 0) {
+                        replay_clib(&result, trace);
+                } else {
+                        replay_pool(&result, trace, impl_name);
+                }
+                result.peak_rss_bytes -= ng5_min(result.peak_rss_bytes, baseline_rss);
+                ssize_t nwrite = write(pipe_fds[1], &result, sizeof(struct replay_result));
+                ng5_unused(nwrite);
+                close(pipe_fds[1]);
+                _exit(EXIT_SUCCESS);
+        }
+
+        close(pipe_fds[1]);
+        ssize_t nread = read(pipe_fds[0], &result, sizeof(struct replay_result));
+        close(pipe_fds[0]);
+        waitpid(pid, NULL, 0);
+
+        if (nread != sizeof(struct replay_result) || result.skipped) {
+                printf("%s, %" PRIu64 ", %" PRIu64 ", %" PRIu64 ", %" PRIu64 ", NA, NA, NA, NA\n", impl_name,
+                        trace->num_events, trace->num_objects, trace->peak_live_objects, trace->peak_live_bytes);
+        } else {
+                double duration_ms = result.duration_us / 1000.0;
+                double events_per_sec = duration_ms > 0 ? trace->num_events / (duration_ms / 1000.0) : 0;
+                /* share of the peak footprint that is not explained by the peak of live bytes in the trace */
+                double fragmentation = result.peak_rss_bytes > trace->peak_live_bytes ?
+                        1.0 - trace->peak_live_bytes / (double) result.peak_rss_bytes : 0.0;
+                printf("%s, %" PRIu64 ", %" PRIu64 ", %" PRIu64 ", %" PRIu64 ", %0.3f, %0.0f, %" PRIu64 ", %0.4f\n",
+                        impl_name, trace->num_events, trace->num_objects, trace->peak_live_objects,
+                        trace->peak_live_bytes, duration_ms, events_per_sec, result.peak_rss_bytes, fragmentation);
+        }
+        fflush(stdout);
+}
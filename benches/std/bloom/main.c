@@ -0,0 +1,133 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "shared/common.h"
+#include "shared/types.h"
+#include "std/bloom.h"
+
+/* Measures false-positive rates and per-key latencies of the blocked Bloom filter for a range of bits per key.
+ * For each configuration, a fresh filter receives 'keys' random 64bit keys, and is then probed with the same number
+ * of keys that were not inserted. Produces one CSV line per configuration, with the false-positive rate expected by
+ * `bloom_fpr` next to the measured one. */
+
+#define MAX_LIST_LEN            32
+#define DEFAULT_NUM_KEYS        1000000
+
+static inline u64 now_ns()
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (u64) ts.tv_sec * 1000000000ULL + (u64) ts.tv_nsec;
+}
+
+static inline u64 next_random(u64 *state)
+{
+        u64 x = *state;
+        x ^= x >> 12;
+        x ^= x << 25;
+        x ^= x >> 27;
+        *state = x;
+        return x * 0x2545F4914F6CDD1DULL;
+}
+
+static void run(u32 bits_per_key, u64 num_keys)
+{
+        bloom_t filter;
+        bloom_create(&filter, bits_per_key * num_keys);
+
+        u64 *keys = malloc(num_keys * sizeof(u64));
+        u64 state = 0x9E3779B97F4A7C15ULL;
+        for (u64 i = 0; i < num_keys; i++) {
+                keys[i] = next_random(&state);
+        }
+
+        u64 begin = now_ns();
+        for (u64 i = 0; i < num_keys; i++) {
+                u64 key = keys[i];
+                NG5_BLOOM_SET(&filter, &key, sizeof(u64));
+        }
+        u64 set_ns = now_ns() - begin;
+
+        /** all inserted keys must be reported; the keys that follow in the random stream are not contained */
+        u64 num_false_negatives = 0;
+        for (u64 i = 0; i < num_keys; i++) {
+                u64 key = keys[i];
+                num_false_negatives += NG5_BLOOM_TEST(&filter, &key, sizeof(u64)) ? 0 : 1;
+        }
+        for (u64 i = 0; i < num_keys; i++) {
+                keys[i] = next_random(&state);
+        }
+
+        u64 num_false_positives = 0;
+        begin = now_ns();
+        for (u64 i = 0; i < num_keys; i++) {
+                u64 key = keys[i];
+                num_false_positives += NG5_BLOOM_TEST(&filter, &key, sizeof(u64)) ? 1 : 0;
+        }
+        u64 test_ns = now_ns() - begin;
+
+        if (num_false_negatives > 0) {
+                fprintf(stderr, "** ERROR ** %" PRIu64 " false negatives\n", num_false_negatives);
+        }
+
+        printf("%u, %" PRIu64 ", %zu, %f, %f, %f, %f\n", bits_per_key, num_keys, bloom_nbits(&filter),
+                bloom_fpr(bloom_nbits(&filter), num_keys), num_false_positives / (double) num_keys,
+                set_ns / (double) num_keys, test_ns / (double) num_keys);
+        fflush(stdout);
+
+        free(keys);
+        bloom_drop(&filter);
+}
+
+static void print_usage(const char *program)
+{
+        fprintf(stderr, "usage: %s [--keys <n>] [--bits-per-key <b1,b2,...>]\n", program);
+        fprintf(stderr, "   --keys <n>                  number of keys inserted (and probed), default %d\n",
+                DEFAULT_NUM_KEYS);
+        fprintf(stderr, "   --bits-per-key <list>       filter sizes in bits per key, default 4,6,8,10,12,16,20\n");
+}
+
+int main(int argc, char *argv[])
+{
+        u32 bits_per_key[MAX_LIST_LEN] = { 4, 6, 8, 10, 12, 16, 20 };
+        u32 num_bits_per_key = 7;
+        u64 num_keys = DEFAULT_NUM_KEYS;
+
+        for (int i = 1; i < argc; i++) {
+                if (strcmp(argv[i], "--keys") == 0 && i + 1 < argc) {
+                        num_keys = strtoull(argv[++i], NULL, 10);
+                } else if (strcmp(argv[i], "--bits-per-key") == 0 && i + 1 < argc) {
+                        num_bits_per_key = 0;
+                        for (char *token = strtok(argv[++i], ","); token && num_bits_per_key < MAX_LIST_LEN;
+                             token = strtok(NULL, ",")) {
+                                bits_per_key[num_bits_per_key++] = atoi(token);
+                        }
+                } else {
+                        print_usage(argv[0]);
+                        return EXIT_FAILURE;
+                }
+        }
+
+        printf("bits_per_key, num_keys, num_bits, expected_fpr, measured_fpr, set_ns, test_ns\n");
+        for (u32 i = 0; i < num_bits_per_key; i++) {
+                run(bits_per_key[i], num_keys);
+        }
+        return EXIT_SUCCESS;
+}
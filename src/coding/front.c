@@ -0,0 +1,202 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "coding/coding_front.h"
+
+static size_t write_varint(char *dst, u64 value)
+{
+        size_t len = 0;
+        do {
+                dst[len] = value & 0x7F;
+                value >>= 7;
+                dst[len++] |= value ? 0x80 : 0;
+        } while (value);
+        return len;
+}
+
+static size_t read_varint(u64 *value, const char *src, size_t nbytes)
+{
+        u64 result = 0;
+        for (size_t i = 0, shift = 0; i < nbytes && shift < 64; i++, shift += 7) {
+                unsigned char c = src[i];
+                result |= ((u64) (c & 0x7F)) << shift;
+                if (!(c & 0x80)) {
+                        *value = result;
+                        return i + 1;
+                }
+        }
+        return 0;
+}
+
+bool coding_front_create(struct coding_front *coder, u32 block_size)
+{
+        error_if_null(coder)
+
+        coder->block_size = ng5_max(block_size, (u32) 1);
+        coder->prev = NULL;
+        coder->prev_len = coder->prev_cap = 0;
+        coder->num_encoded = 0;
+        coder->block_begin = 0;
+        error_init(&coder->err);
+
+        return true;
+}
+
+bool coding_front_cpy(struct coding_front *dst, const struct coding_front *src)
+{
+        error_if_null(dst)
+        error_if_null(src)
+
+        *dst = *src;
+        if (src->prev) {
+                if (!(dst->prev = malloc(src->prev_cap))) {
+                        error(&dst->err, NG5_ERR_MALLOCERR)
+                        return false;
+                }
+                memcpy(dst->prev, src->prev, src->prev_len);
+        }
+        return true;
+}
+
+bool coding_front_drop(struct coding_front *coder)
+{
+        error_if_null(coder)
+
+        free(coder->prev);
+        coder->prev = NULL;
+        coder->prev_len = coder->prev_cap = 0;
+
+        return true;
+}
+
+bool coding_front_encode(struct memfile *file, struct coding_front *coder, const char *string)
+{
+        error_if_null(file)
+        error_if_null(coder)
+        error_if_null(string)
+
+        char header[NG5_FRONT_MAX_HEADER_SIZE];
+        size_t header_len = 0;
+        size_t len = strlen(string);
+        size_t shared = 0;
+
+        if (coder->num_encoded++ % coder->block_size == 0) {
+                coder->block_begin = memfile_tell(file);
+                header_len += write_varint(header + header_len, 0);
+        } else {
+                size_t max_shared = ng5_min(len, coder->prev_len);
+                while (shared < max_shared && coder->prev[shared] == string[shared]) {
+                        shared++;
+                }
+                u64 back = memfile_tell(file) - coder->block_begin;
+                header_len += write_varint(header + header_len, back);
+                header_len += write_varint(header + header_len, shared);
+        }
+        header_len += write_varint(header + header_len, len - shared);
+
+        if (!memfile_write(file, header, header_len) || !memfile_write(file, string + shared, len - shared)) {
+                error(&coder->err, NG5_ERR_IO)
+                return false;
+        }
+
+        if (len > coder->prev_cap) {
+                size_t cap = ng5_max(len, 2 * coder->prev_cap);
+                char *prev = realloc(coder->prev, cap);
+                if (!prev) {
+                        error(&coder->err, NG5_ERR_MALLOCERR)
+                        return false;
+                }
+                coder->prev = prev;
+                coder->prev_cap = cap;
+        }
+        memcpy(coder->prev, string, len);
+        coder->prev_len = len;
+
+        return true;
+}
+
+size_t coding_front_read_header(u64 *back, u64 *shared, u64 *suffix_len, const char *entry, size_t nbytes)
+{
+        size_t pos = 0, nread;
+
+        if (!back || !shared || !suffix_len || !entry || !(nread = read_varint(back, entry, nbytes))) {
+                return 0;
+        }
+        pos += nread;
+        *shared = 0;
+        if (*back > 0) {
+                if (!(nread = read_varint(shared, entry + pos, nbytes - pos))) {
+                        return 0;
+                }
+                pos += nread;
+        }
+        if (!(nread = read_varint(suffix_len, entry + pos, nbytes - pos))) {
+                return 0;
+        }
+        return pos + nread;
+}
+
+bool coding_front_decode(char *dst, size_t strlen, const char *block, size_t nbytes, size_t entry_off)
+{
+        error_if_null(dst)
+        error_if_null(block)
+
+        /** the strings of the block up to the requested one are restored in turn into a buffer, each overwriting
+         * the suffix of its predecessor */
+        char *current = NULL;
+        size_t current_len = 0, current_cap = 0;
+        size_t pos = 0;
+
+        while (pos <= entry_off && pos < nbytes) {
+                u64 back, shared, suffix_len;
+                size_t entry_begin = pos;
+                size_t header_len = coding_front_read_header(&back, &shared, &suffix_len, block + pos, nbytes - pos);
+
+                if (!header_len || back != entry_begin || shared > current_len ||
+                        suffix_len > nbytes - pos - header_len) {
+                        break;
+                }
+                pos += header_len;
+
+                if (entry_begin == entry_off) {
+                        bool status = shared + suffix_len == strlen;
+                        if (status) {
+                                if (shared > 0) {
+                                        memcpy(dst, current, shared);
+                                }
+                                memcpy(dst + shared, block + pos, suffix_len);
+                        }
+                        free(current);
+                        return status;
+                }
+
+                if (shared + suffix_len > current_cap) {
+                        current_cap = ng5_max(shared + suffix_len, 2 * current_cap);
+                        char *tmp = realloc(current, current_cap);
+                        if (!tmp) {
+                                break;
+                        }
+                        current = tmp;
+                }
+                memcpy(current + shared, block + pos, suffix_len);
+                current_len = shared + suffix_len;
+                pos += suffix_len;
+        }
+
+        free(current);
+        return false;
+}
@@ -0,0 +1,414 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <assert.h>
+
+#include "coding/coding_fsst.h"
+
+/** during training, each byte that is not covered by a symbol is counted under the pseudo code 256 + byte */
+#define NUM_PSEUDO_CODES        (2 * (UCHAR_MAX + 1))
+
+/** how many strings are taken from the input in one pass over it when the sample is drawn */
+#define SAMPLE_NUM_STRIDES      4096
+
+struct fsst_candidate {
+        u64 value;
+        u8 len;
+        u64 gain;
+};
+
+static const u64 symbol_masks[NG5_FSST_MAX_SYMBOL_LENGTH + 1] = {
+        0x0, 0xff, 0xffff, 0xffffff, 0xffffffff, 0xffffffffff, 0xffffffffffff, 0xffffffffffffff, 0xffffffffffffffff
+};
+
+static inline u64 load_word(const unsigned char *data, size_t remain)
+{
+        u64 word = 0;
+        if (likely(remain >= sizeof(u64))) {
+                memcpy(&word, data, sizeof(u64));
+        } else {
+                memcpy(&word, data, remain);
+        }
+        return word;
+}
+
+/** returns the code of the longest symbol that is a prefix of 'word', or -1 if the first byte must be escaped */
+static inline int find_code(const struct coding_fsst *dic, u64 word, size_t remain)
+{
+        unsigned char first = (unsigned char) word;
+        for (u16 code = dic->first_code[first]; code < dic->first_code[first + 1]; code++) {
+                u8 len = dic->lengths[code];
+                if (len <= remain && (word & symbol_masks[len]) == dic->symbols[code]) {
+                        return code;
+                }
+        }
+        return -1;
+}
+
+static size_t encode_bytes(unsigned char *dst, const struct coding_fsst *dic, const unsigned char *src, size_t len)
+{
+        unsigned char *begin = dst;
+        size_t pos = 0;
+        while (pos < len) {
+                size_t remain = len - pos;
+                int code = find_code(dic, load_word(src + pos, remain), remain);
+                if (likely(code >= 0)) {
+                        *dst++ = (unsigned char) code;
+                        pos += dic->lengths[code];
+                } else {
+                        *dst++ = NG5_FSST_ESCAPE;
+                        *dst++ = src[pos++];
+                }
+        }
+        return dst - begin;
+}
+
+/** rebuilds the per-byte code ranges; requires the codes to be ordered by first byte */
+static void index_symbols(struct coding_fsst *dic)
+{
+        ng5_zero_memory(dic->first_code, sizeof(dic->first_code));
+        for (u16 code = 0; code < dic->num_symbols; code++) {
+                dic->first_code[(unsigned char) dic->symbols[code] + 1]++;
+        }
+        for (unsigned c = 1; c <= UCHAR_MAX + 1; c++) {
+                dic->first_code[c] += dic->first_code[c - 1];
+        }
+}
+
+static int compare_candidates_by_symbol(const void *lhs, const void *rhs)
+{
+        const struct fsst_candidate *a = lhs, *b = rhs;
+        if (a->len != b->len) {
+                return a->len < b->len ? -1 : 1;
+        }
+        return a->value < b->value ? -1 : (a->value > b->value ? 1 : 0);
+}
+
+static int compare_candidates_by_gain(const void *lhs, const void *rhs)
+{
+        const struct fsst_candidate *a = lhs, *b = rhs;
+        if (a->gain != b->gain) {
+                return a->gain > b->gain ? -1 : 1;
+        }
+        return compare_candidates_by_symbol(lhs, rhs);
+}
+
+/** orders symbols by first byte and, for the same first byte, longest first, so that the first match is the longest */
+static int compare_candidates_by_code(const void *lhs, const void *rhs)
+{
+        const struct fsst_candidate *a = lhs, *b = rhs;
+        unsigned char a_first = (unsigned char) a->value, b_first = (unsigned char) b->value;
+        if (a_first != b_first) {
+                return a_first < b_first ? -1 : 1;
+        }
+        if (a->len != b->len) {
+                return a->len > b->len ? -1 : 1;
+        }
+        return a->value < b->value ? -1 : (a->value > b->value ? 1 : 0);
+}
+
+static inline u64 pseudo_code_value(const struct coding_fsst *dic, u16 pseudo_code)
+{
+        return pseudo_code <= UCHAR_MAX ? dic->symbols[pseudo_code] : (u64) (pseudo_code - (UCHAR_MAX + 1));
+}
+
+static inline u8 pseudo_code_len(const struct coding_fsst *dic, u16 pseudo_code)
+{
+        return pseudo_code <= UCHAR_MAX ? dic->lengths[pseudo_code] : 1;
+}
+
+/** draws up to NG5_FSST_SAMPLE_SIZE bytes from strings spread evenly over the input */
+static size_t draw_sample(unsigned char *sample, u32 *ends, size_t *num_sample_strings, const string_vector_t *strings)
+{
+        size_t num_strings = strings->num_elems;
+        size_t stride = ng5_max(num_strings / SAMPLE_NUM_STRIDES, (size_t) 1);
+        size_t sample_len = 0;
+        *num_sample_strings = 0;
+
+        for (size_t begin = 0; begin < stride; begin++) {
+                for (size_t i = begin; i < num_strings; i += stride) {
+                        const char *string = *vec_get(strings, i, const char *);
+                        size_t len = ng5_min(strlen(string), NG5_FSST_SAMPLE_SIZE - sample_len);
+                        memcpy(sample + sample_len, string, len);
+                        sample_len += len;
+                        ends[(*num_sample_strings)++] = sample_len;
+                        if (sample_len == NG5_FSST_SAMPLE_SIZE) {
+                                return sample_len;
+                        }
+                }
+        }
+        return sample_len;
+}
+
+bool coding_fsst_create(struct coding_fsst *dic)
+{
+        error_if_null(dic)
+
+        ng5_zero_memory(dic->symbols, sizeof(dic->symbols));
+        ng5_zero_memory(dic->lengths, sizeof(dic->lengths));
+        dic->num_symbols = 0;
+        index_symbols(dic);
+        error_init(&dic->err);
+
+        return true;
+}
+
+bool coding_fsst_cpy(struct coding_fsst *dst, const struct coding_fsst *src)
+{
+        error_if_null(dst)
+        error_if_null(src)
+
+        *dst = *src;
+        return true;
+}
+
+bool coding_fsst_drop(struct coding_fsst *dic)
+{
+        error_if_null(dic)
+        return true;
+}
+
+bool coding_fsst_build(struct coding_fsst *dic, const string_vector_t *strings)
+{
+        error_if_null(dic)
+        error_if_null(strings)
+
+        unsigned char *sample = malloc(NG5_FSST_SAMPLE_SIZE);
+        u32 *ends = malloc((NG5_FSST_SAMPLE_SIZE + 1) * sizeof(u32));
+        u32 *count1 = malloc(NUM_PSEUDO_CODES * sizeof(u32));
+        u32 *count2 = malloc(NUM_PSEUDO_CODES * NUM_PSEUDO_CODES * sizeof(u32));
+        struct fsst_candidate *candidates = malloc((NUM_PSEUDO_CODES + NG5_FSST_SAMPLE_SIZE) *
+                sizeof(struct fsst_candidate));
+
+        if (!sample || !ends || !count1 || !count2 || !candidates) {
+                free(sample);
+                free(ends);
+                free(count1);
+                free(count2);
+                free(candidates);
+                error(&dic->err, NG5_ERR_MALLOCERR)
+                return false;
+        }
+
+        size_t num_sample_strings;
+        draw_sample(sample, ends, &num_sample_strings, strings);
+
+        coding_fsst_create(dic);
+
+        for (unsigned generation = 0; generation < NG5_FSST_GENERATIONS; generation++) {
+
+                /** compress the sample with the current table, counting how often each code occurs and which code
+                 * follows it */
+                ng5_zero_memory(count1, NUM_PSEUDO_CODES * sizeof(u32));
+                ng5_zero_memory(count2, NUM_PSEUDO_CODES * NUM_PSEUDO_CODES * sizeof(u32));
+
+                for (size_t s = 0, pos = 0; s < num_sample_strings; s++) {
+                        int prev = -1;
+                        for (size_t end = ends[s]; pos < end; ) {
+                                size_t remain = end - pos;
+                                int code = find_code(dic, load_word(sample + pos, remain), remain);
+                                u16 pseudo_code = code >= 0 ? (u16) code : (u16) (UCHAR_MAX + 1 + sample[pos]);
+                                pos += pseudo_code_len(dic, pseudo_code);
+                                count1[pseudo_code]++;
+                                if (prev >= 0) {
+                                        count2[prev * NUM_PSEUDO_CODES + pseudo_code]++;
+                                }
+                                prev = pseudo_code;
+                        }
+                }
+
+                /** candidates are all symbols seen so far and all concatenations of two adjacent symbols, rated by
+                 * the number of input bytes they would cover */
+                size_t num_candidates = 0;
+                for (u16 first = 0; first < NUM_PSEUDO_CODES; first++) {
+                        if (count1[first] == 0) {
+                                continue;
+                        }
+                        u64 first_value = pseudo_code_value(dic, first);
+                        u8 first_len = pseudo_code_len(dic, first);
+                        candidates[num_candidates++] = (struct fsst_candidate) {
+                                .value = first_value, .len = first_len, .gain = (u64) count1[first] * first_len
+                        };
+                        if (first_len == NG5_FSST_MAX_SYMBOL_LENGTH) {
+                                continue;
+                        }
+                        for (u16 second = 0; second < NUM_PSEUDO_CODES; second++) {
+                                u32 count = count2[first * NUM_PSEUDO_CODES + second];
+                                if (count == 0) {
+                                        continue;
+                                }
+                                u8 len = ng5_min(first_len + pseudo_code_len(dic, second),
+                                        NG5_FSST_MAX_SYMBOL_LENGTH);
+                                u64 value = (first_value | (pseudo_code_value(dic, second) << (8 * first_len))) &
+                                        symbol_masks[len];
+                                candidates[num_candidates++] = (struct fsst_candidate) {
+                                        .value = value, .len = len, .gain = (u64) count * len
+                                };
+                        }
+                }
+
+                /** the same symbol may be produced by several pairs */
+                qsort(candidates, num_candidates, sizeof(struct fsst_candidate), compare_candidates_by_symbol);
+                size_t num_unique = 0;
+                for (size_t i = 0; i < num_candidates; i++) {
+                        if (num_unique > 0 && candidates[num_unique - 1].len == candidates[i].len &&
+                                candidates[num_unique - 1].value == candidates[i].value) {
+                                candidates[num_unique - 1].gain += candidates[i].gain;
+                        } else {
+                                candidates[num_unique++] = candidates[i];
+                        }
+                }
+
+                qsort(candidates, num_unique, sizeof(struct fsst_candidate), compare_candidates_by_gain);
+                size_t num_symbols = ng5_min(num_unique, (size_t) NG5_FSST_MAX_SYMBOLS);
+                qsort(candidates, num_symbols, sizeof(struct fsst_candidate), compare_candidates_by_code);
+
+                dic->num_symbols = num_symbols;
+                ng5_zero_memory(dic->symbols, sizeof(dic->symbols));
+                ng5_zero_memory(dic->lengths, sizeof(dic->lengths));
+                for (size_t code = 0; code < num_symbols; code++) {
+                        dic->symbols[code] = candidates[code].value;
+                        dic->lengths[code] = candidates[code].len;
+                }
+                index_symbols(dic);
+        }
+
+        free(sample);
+        free(ends);
+        free(count1);
+        free(count2);
+        free(candidates);
+
+        return true;
+}
+
+bool coding_fsst_serialize(struct memfile *file, const struct coding_fsst *dic)
+{
+        error_if_null(file)
+        error_if_null(dic)
+
+        u8 num_symbols = dic->num_symbols;
+        memfile_write(file, &num_symbols, sizeof(u8));
+        memfile_write(file, dic->lengths, num_symbols * sizeof(u8));
+        for (u16 code = 0; code < num_symbols; code++) {
+                memfile_write(file, dic->symbols + code, dic->lengths[code]);
+        }
+        return true;
+}
+
+bool coding_fsst_read(struct coding_fsst *dic, struct memfile *file)
+{
+        error_if_null(dic)
+        error_if_null(file)
+
+        coding_fsst_create(dic);
+        if (memfile_remain_size(file) < sizeof(u8)) {
+                error(&dic->err, NG5_ERR_CORRUPTED)
+                return false;
+        }
+        dic->num_symbols = *NG5_MEMFILE_READ_TYPE(file, u8);
+        if (memfile_remain_size(file) < dic->num_symbols) {
+                error(&dic->err, NG5_ERR_CORRUPTED)
+                return false;
+        }
+        memcpy(dic->lengths, NG5_MEMFILE_READ(file, dic->num_symbols), dic->num_symbols);
+        for (u16 code = 0; code < dic->num_symbols; code++) {
+                u8 len = dic->lengths[code];
+                if (len == 0 || len > NG5_FSST_MAX_SYMBOL_LENGTH || memfile_remain_size(file) < len) {
+                        error(&dic->err, NG5_ERR_CORRUPTED)
+                        return false;
+                }
+                memcpy(dic->symbols + code, NG5_MEMFILE_READ(file, len), len);
+        }
+        index_symbols(dic);
+        return true;
+}
+
+bool coding_fsst_encode(struct memfile *file, struct coding_fsst *dic, const char *string)
+{
+        error_if_null(file)
+        error_if_null(dic)
+        error_if_null(string)
+
+        /** the empty string has an empty encoding */
+        size_t len = strlen(string);
+        if (len == 0) {
+                return true;
+        }
+
+        /** in the worst case, each byte is escaped */
+        unsigned char buffer[512];
+        unsigned char *encoded = 2 * len <= sizeof(buffer) ? buffer : malloc(2 * len);
+        if (!encoded) {
+                error(&dic->err, NG5_ERR_MALLOCERR)
+                return false;
+        }
+
+        size_t nbytes = encode_bytes(encoded, dic, (const unsigned char *) string, len);
+        bool status = memfile_write(file, encoded, nbytes);
+
+        if (encoded != buffer) {
+                free(encoded);
+        }
+        return status;
+}
+
+bool coding_fsst_decode(char *dst, size_t strlen, size_t *nbytes_read, const struct coding_fsst *dic,
+        const char *encoded, size_t nbytes_encoded)
+{
+        error_if_null(dst)
+        error_if_null(dic)
+        error_if_null(encoded)
+
+        const unsigned char *in = (const unsigned char *) encoded, *in_end = in + nbytes_encoded;
+        char *out = dst, *out_end = dst + strlen;
+
+        /** while the output has room for a whole word, symbols are copied as such */
+        while (out_end - out >= (ptrdiff_t) sizeof(u64) && in < in_end) {
+                unsigned char code = *in++;
+                if (likely(code != NG5_FSST_ESCAPE)) {
+                        memcpy(out, dic->symbols + code, sizeof(u64));
+                        out += dic->lengths[code];
+                } else if (likely(in < in_end)) {
+                        *out++ = *in++;
+                } else {
+                        return false;
+                }
+        }
+
+        while (out < out_end && in < in_end) {
+                unsigned char code = *in++;
+                if (code != NG5_FSST_ESCAPE) {
+                        u8 len = dic->lengths[code];
+                        if (unlikely(len > out_end - out)) {
+                                return false;
+                        }
+                        memcpy(out, dic->symbols + code, len);
+                        out += len;
+                } else if (likely(in < in_end)) {
+                        *out++ = *in++;
+                } else {
+                        return false;
+                }
+        }
+
+        if (unlikely(out != out_end)) {
+                return false;
+        }
+        ng5_optional_set(nbytes_read, (size_t) (in - (const unsigned char *) encoded));
+        return true;
+}
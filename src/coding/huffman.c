@@ -20,22 +20,35 @@
 #include <inttypes.h>
 
 #include "coding/coding_huffman.h"
-#include "std/bitmap.h"
 
 struct huff_node {
-        struct huff_node *prev, *next, *left, *right;
         u64 freq;
+        u16 parent;
         unsigned char letter;
 };
 
-static void huff_tree_create(struct vector ofType(struct pack_huffman_entry) *table,
-        const struct vector ofType(u32) *frequencies);
+struct bit_writer {
+        struct memfile *file;
+        u64 word;
+        u8 nbits;
+        size_t nbytes_written;
+};
+
+static void huff_tree_create(struct vector ofType(struct pack_huffman_entry) *table, const u64 *frequencies);
+
+static void assign_canonical_codes(struct vector ofType(struct pack_huffman_entry) *table);
+
+static void codes_create(struct pack_huffman_code *codes, const struct vector ofType(struct pack_huffman_entry) *table);
+
+static bool decoder_create(struct pack_huffman_decoder *decoder, const struct coding_huffman *dic);
 
 bool coding_huffman_create(struct coding_huffman *dic)
 {
         error_if_null(dic);
 
         vec_create(&dic->table, NULL, sizeof(struct pack_huffman_entry), UCHAR_MAX / 4);
+        ng5_zero_memory(dic->codes, sizeof(dic->codes));
+        dic->decoder = NULL;
         error_init(&dic->err);
 
         return true;
@@ -49,6 +62,16 @@ NG5_EXPORT(bool) coding_huffman_cpy(struct coding_huffman *dst, struct coding_hu
                 error(&src->err, NG5_ERR_HARDCOPYFAILED);
                 return false;
         } else {
+                memcpy(dst->codes, src->codes, sizeof(src->codes));
+                dst->decoder = NULL;
+                if (src->decoder) {
+                        dst->decoder = malloc(sizeof(struct pack_huffman_decoder));
+                        if (!dst->decoder) {
+                                error(&src->err, NG5_ERR_MALLOCERR);
+                                return false;
+                        }
+                        *dst->decoder = *src->decoder;
+                }
                 return error_cpy(&dst->err, &src->err);
         }
 }
@@ -58,24 +81,20 @@ NG5_EXPORT(bool) coding_huffman_build(struct coding_huffman *encoder, const stri
         error_if_null(encoder);
         error_if_null(strings);
 
-        struct vector ofType(u32) frequencies;
-        vec_create(&frequencies, NULL, sizeof(u32), UCHAR_MAX);
-        vec_enlarge_size_to_capacity(&frequencies);
-
-        u32 *freq_data = vec_all(&frequencies, u32);
-        ng5_zero_memory(freq_data, UCHAR_MAX * sizeof(u32));
+        u64 frequencies[UCHAR_MAX + 1];
+        ng5_zero_memory(frequencies, sizeof(frequencies));
 
         for (size_t i = 0; i < strings->num_elems; i++) {
-                const char *string = *vec_get(strings, i, const char *);
-                size_t string_length = strlen(string);
-                for (size_t k = 0; k < string_length; k++) {
-                        size_t c = (unsigned char) string[k];
-                        freq_data[c]++;
+                const unsigned char *string = *vec_get(strings, i, const unsigned char *);
+                for (; *string != '\0'; string++) {
+                        frequencies[*string]++;
                 }
         }
 
-        huff_tree_create(&encoder->table, &frequencies);
-        vec_drop(&frequencies);
+        vec_clear(&encoder->table);
+        huff_tree_create(&encoder->table, frequencies);
+        assign_canonical_codes(&encoder->table);
+        codes_create(encoder->codes, &encoder->table);
 
         return true;
 }
@@ -92,12 +111,8 @@ bool coding_huffman_drop(struct coding_huffman *dic)
 {
         error_if_null(dic);
 
-        for (size_t i = 0; i < dic->table.num_elems; i++) {
-                struct pack_huffman_entry *entry = vec_get(&dic->table, i, struct pack_huffman_entry);
-                free(entry->blocks);
-        }
-
         vec_drop(&dic->table);
+        free(dic->decoder);
 
         free(dic);
 
@@ -113,84 +128,49 @@ bool coding_huffman_serialize(struct memfile *file, const struct coding_huffman
                 struct pack_huffman_entry *entry = vec_get(&dic->table, i, struct pack_huffman_entry);
                 memfile_write(file, &marker_symbol, sizeof(char));
                 memfile_write(file, &entry->letter, sizeof(unsigned char));
-
-                /** block one is the block that holds the significant part of the prefix code */
-                offset_t offset_meta, offset_continue;
-                memfile_get_offset(&offset_meta, file);
-                /** this will be the number of bytes used to encode the significant part of the prefix code */
-                memfile_skip(file, sizeof(u8));
-
-                memfile_begin_bit_mode(file);
-                bool first_bit_found = false;
-                for (int i = 31; entry->blocks && i >= 0; i--) {
-                        u32 mask = 1 << i;
-                        u32 k = entry->blocks[0] & mask;
-                        bool bit_state = k != 0;
-                        first_bit_found |= bit_state;
-
-                        if (first_bit_found) {
-                                memfile_write_bit(file, bit_state);
-                        }
-                }
-                size_t num_bytes_written;
-                memfile_end_bit_mode(&num_bytes_written, file);
-                memfile_get_offset(&offset_continue, file);
-                memfile_seek(file, offset_meta);
-                u8 num_bytes_written_uint8 = (u8) num_bytes_written;
-                memfile_write(file, &num_bytes_written_uint8, sizeof(u8));
-
-                memfile_seek(file, offset_continue);
+                memfile_write(file, &entry->nbits, sizeof(u8));
         }
 
         return true;
 }
 
-static struct pack_huffman_entry *find_dic_entry(struct coding_huffman *dic, unsigned char c)
+static inline void bit_writer_flush(struct bit_writer *writer, size_t nbytes)
 {
-        for (size_t i = 0; i < dic->table.num_elems; i++) {
-                struct pack_huffman_entry *entry = vec_get(&dic->table, i, struct pack_huffman_entry);
-                if (entry->letter == c) {
-                        return entry;
-                }
-        }
-        error(&dic->err, NG5_ERR_HUFFERR)
-        return NULL;
+        memfile_write(writer->file, &writer->word, nbytes);
+        writer->nbytes_written += nbytes;
 }
 
-static size_t encodeString(struct memfile *file, struct coding_huffman *dic, const char *string)
+/** appends 'nbits' bits in stream order; full 64-bit words are written at once */
+static inline void bit_writer_put(struct bit_writer *writer, u64 bits, u8 nbits)
 {
-        memfile_begin_bit_mode(file);
+        u8 nbits_free = 64 - writer->nbits;
+        writer->word |= bits << writer->nbits;
+        if (likely(nbits < nbits_free)) {
+                writer->nbits += nbits;
+        } else {
+                bit_writer_flush(writer, sizeof(u64));
+                writer->word = nbits_free < 64 ? bits >> nbits_free : 0;
+                writer->nbits = nbits - nbits_free;
+        }
+}
 
-        for (const char *c = string; *c != '\0'; c++) {
-                struct pack_huffman_entry *entry = find_dic_entry(dic, (unsigned char) *c);
-                if (!entry) {
-                        return 0;
-                }
+static bool encodeString(size_t *num_written_bytes, struct memfile *file, struct coding_huffman *dic,
+        const char *string)
+{
+        struct bit_writer writer = { .file = file, .word = 0, .nbits = 0, .nbytes_written = 0 };
 
-                if (!entry->blocks) {
-                        memfile_write_bit(file, false);
-                } else {
-                        for (size_t j = 0; j < entry->nblocks; j++) {
-                                u32 block = entry->blocks[j];
-
-                                bool first_bit_found = false;
-                                for (int i = 31; i >= 0; i--) {
-                                        u32 mask = 1 << i;
-                                        u32 k = block & mask;
-                                        bool bit_state = k != 0;
-                                        first_bit_found |= bit_state;
-
-                                        if (first_bit_found) {
-                                                memfile_write_bit(file, bit_state);
-                                        }
-                                }
-                        }
+        for (const unsigned char *c = (const unsigned char *) string; *c != '\0'; c++) {
+                const struct pack_huffman_code *code = dic->codes + *c;
+                if (unlikely(code->nbits == 0)) {
+                        error(&dic->err, NG5_ERR_HUFFERR)
+                        return false;
                 }
+                bit_writer_put(&writer, code->stream_bits, code->nbits);
         }
+        bit_writer_flush(&writer, (writer.nbits + 7) / 8);
 
-        size_t num_written_bytes;
-        memfile_end_bit_mode(&num_written_bytes, file);
-        return num_written_bytes;
+        *num_written_bytes = writer.nbytes_written;
+        return true;
 }
 
 NG5_EXPORT(bool) coding_huffman_encode(struct memfile *file, struct coding_huffman *dic, const char *string)
@@ -199,18 +179,19 @@ NG5_EXPORT(bool) coding_huffman_encode(struct memfile *file, struct coding_huffm
         error_if_null(dic)
         error_if_null(string)
 
-        u32 num_bytes_encoded = 0;
+        size_t num_bytes_encoded = 0;
 
         offset_t num_bytes_encoded_off = memfile_tell(file);
         memfile_skip(file, sizeof(u32));
 
-        if ((num_bytes_encoded = (u32) encodeString(file, dic, string)) == 0) {
+        if (!encodeString(&num_bytes_encoded, file, dic, string)) {
                 return false;
         }
 
         offset_t continue_off = memfile_tell(file);
         memfile_seek(file, num_bytes_encoded_off);
-        memfile_write(file, &num_bytes_encoded, sizeof(u32));
+        u32 num_bytes_encoded_u32 = (u32) num_bytes_encoded;
+        memfile_write(file, &num_bytes_encoded_u32, sizeof(u32));
         memfile_seek(file, continue_off);
 
         return true;
@@ -229,264 +210,325 @@ bool coding_huffman_read_entry(struct pack_huffman_info *info, struct memfile *f
         if (marker == marker_symbol) {
                 memfile_skip(file, sizeof(char));
                 info->letter = *NG5_MEMFILE_READ_TYPE(file, unsigned char);
-                info->nbytes_prefix = *NG5_MEMFILE_READ_TYPE(file, u8);
-                info->prefix_code = NG5_MEMFILE_PEEK(file, char);
-
-                memfile_skip(file, info->nbytes_prefix);
-
+                info->nbits = *NG5_MEMFILE_READ_TYPE(file, u8);
                 return true;
         } else {
                 return false;
         }
 }
 
-static const u32 *get_num_used_blocks(u16 *numUsedBlocks, struct pack_huffman_entry *entry, u16 num_blocks,
-        const u32 *blocks)
+bool coding_huffman_read_dictionary(struct coding_huffman *dic, struct memfile *file, char marker_symbol)
 {
-        for (entry->nblocks = 0; entry->nblocks < num_blocks; entry->nblocks++) {
-                const u32 *block = blocks + entry->nblocks;
-                if (*block != 0) {
-                        *numUsedBlocks = (num_blocks - entry->nblocks);
-                        return block;
+        error_if_null(dic)
+        error_if_null(file)
+
+        struct pack_huffman_info info;
+
+        vec_clear(&dic->table);
+        while (memfile_remain_size(file) >= 3 && coding_huffman_read_entry(&info, file, marker_symbol)) {
+                if (info.nbits == 0 || info.nbits > NG5_HUFFMAN_MAX_CODE_LENGTH) {
+                        error(&dic->err, NG5_ERR_CORRUPTED)
+                        return false;
                 }
+                struct pack_huffman_entry *entry = vec_new_and_get(&dic->table, struct pack_huffman_entry);
+                entry->letter = info.letter;
+                entry->nbits = info.nbits;
+                entry->code = 0;
         }
-        return NULL;
-}
-
-static void import_into_entry(struct pack_huffman_entry *entry, const struct huff_node *node, const struct bitmap *map)
-{
-        entry->letter = node->letter;
-        u32 *blocks, num_blocks;
-        const u32 *used_blocks;
-        bitmap_blocks(&blocks, &num_blocks, map);
-        used_blocks = get_num_used_blocks(&entry->nblocks, entry, num_blocks, blocks);
-        entry->blocks = malloc(entry->nblocks * sizeof(u32));
-        if (num_blocks > 0) {
-                memcpy(entry->blocks, used_blocks, entry->nblocks * sizeof(u32));
-        } else {
-                entry->blocks = NULL;
+        assign_canonical_codes(&dic->table);
+        codes_create(dic->codes, &dic->table);
+
+        if (!dic->decoder) {
+                dic->decoder = malloc(sizeof(struct pack_huffman_decoder));
+                if (!dic->decoder) {
+                        error(&dic->err, NG5_ERR_MALLOCERR)
+                        return false;
+                }
         }
-        free(blocks);
+        if (!decoder_create(dic->decoder, dic)) {
+                error(&dic->err, NG5_ERR_CORRUPTED)
+                return false;
+        }
+        return true;
 }
 
-static struct huff_node *seek_to_begin(struct huff_node *handle)
+static inline u64 peek_bits(const char *data, u64 bit_pos)
 {
-        for (; handle->prev != NULL; handle = handle->prev) { }
-        return handle;
+        u64 word;
+        memcpy(&word, data + (bit_pos >> 3), sizeof(u64));
+        return word >> (bit_pos & 7);
 }
 
-static struct huff_node *seek_to_end(struct huff_node *handle)
+/** decodes a code that is longer than the lookup table is wide, walking the canonical code one bit at a time */
+static bool decode_long_code(unsigned char *letter, u64 *bit_pos, const struct pack_huffman_decoder *decoder,
+        const char *data, u64 nbits_total)
 {
-        for (; handle->next != NULL; handle = handle->next) { }
-        return handle;
+        u64 code = 0;
+        u64 pos = *bit_pos;
+        for (u8 len = 1; len <= decoder->max_nbits && pos < nbits_total; len++, pos++) {
+                code = (code << 1) | ((((const unsigned char *) data)[pos >> 3] >> (pos & 7)) & 1);
+                u64 idx = code - decoder->first_code[len];
+                if (code >= decoder->first_code[len] && idx < decoder->num_codes[len]) {
+                        *letter = decoder->letters[decoder->first_letter[len] + idx];
+                        *bit_pos = pos + 1;
+                        return true;
+                }
+        }
+        return false;
 }
 
-ng5_func_unused
-static void __diag_print_insight(struct huff_node *n)
+bool coding_huffman_decode(char *dst, size_t strlen, const struct coding_huffman *dic, const char *encoded,
+        size_t nbytes_encoded)
 {
-        printf("(");
-        if (!n->left && !n->right) {
-                printf("%c", n->letter);
-        } else {
-                if (n->left) {
-                        __diag_print_insight(n->left);
+        error_if_null(dst)
+        error_if_null(dic)
+        error_if_null(encoded)
+
+        const struct pack_huffman_decoder *decoder = dic->decoder;
+        if (unlikely(!decoder)) {
+                return strlen == 0;
+        }
+
+        const u64 mask = (1 << NG5_HUFFMAN_TABLE_BITS) - 1;
+        const u64 nbits_total = (u64) nbytes_encoded * 8;
+        u64 pos = 0;
+        size_t n = 0;
+
+        /** fast path: one lookup resolves up to NG5_HUFFMAN_SYMBOLS_PER_LOOKUP letters; the output has room for all
+         * of them, so the letters are copied unconditionally */
+        while (strlen - n >= NG5_HUFFMAN_SYMBOLS_PER_LOOKUP) {
+                const struct pack_huffman_lookup *lookup = decoder->lookup + (peek_bits(encoded, pos) & mask);
+                if (likely(lookup->nletters > 0)) {
+                        memcpy(dst + n, lookup->letters, NG5_HUFFMAN_SYMBOLS_PER_LOOKUP);
+                        n += lookup->nletters;
+                        pos += lookup->nbits;
+                } else if (!decode_long_code((unsigned char *) dst + n++, &pos, decoder, encoded, nbits_total)) {
+                        return false;
                 }
-                printf(",");
-                if (n->right) {
-                        __diag_print_insight(n->right);
+                if (unlikely(pos > nbits_total)) {
+                        return false;
                 }
         }
-        printf(")");
-        printf(": %"PRIu64"", n->freq);
+
+        while (n < strlen) {
+                const struct pack_huffman_lookup *lookup = decoder->lookup + (peek_bits(encoded, pos) & mask);
+                if (likely(lookup->nletters > 0)) {
+                        dst[n++] = lookup->letters[0];
+                        pos += lookup->first_nbits;
+                } else if (!decode_long_code((unsigned char *) dst + n++, &pos, decoder, encoded, nbits_total)) {
+                        return false;
+                }
+                if (unlikely(pos > nbits_total)) {
+                        return false;
+                }
+        }
+
+        return true;
 }
 
-ng5_func_unused
-static void __diag_dump_remaining_candidates(struct huff_node *n)
+static int compare_entries_canonical(const void *lhs, const void *rhs)
 {
-        struct huff_node *it = seek_to_begin(n);
-        while (it->next != NULL) {
-                __diag_print_insight(it);
-                printf(" | ");
-                it = it->next;
+        const struct pack_huffman_entry *a = lhs, *b = rhs;
+        if (a->nbits != b->nbits) {
+                return a->nbits < b->nbits ? -1 : 1;
         }
+        return a->letter < b->letter ? -1 : (a->letter > b->letter ? 1 : 0);
 }
 
-static struct huff_node *find_smallest(struct huff_node *begin, u64 lowerBound, struct huff_node *skip)
+/** replaces the tree-shaped codes by canonical codes of the same lengths, ordered by (length, letter) */
+static void assign_canonical_codes(struct vector ofType(struct pack_huffman_entry) *table)
 {
-        u64 smallest = UINT64_MAX;
-        struct huff_node *result = NULL;
-        for (struct huff_node *it = begin; it != NULL; it = it->next) {
-                if (it != skip && it->freq >= lowerBound && it->freq <= smallest) {
-                        smallest = it->freq;
-                        result = it;
+        struct pack_huffman_entry *entries = vec_all(table, struct pack_huffman_entry);
+        qsort(entries, table->num_elems, sizeof(struct pack_huffman_entry), compare_entries_canonical);
+
+        u64 code = 0;
+        u8 prev_nbits = 0;
+        for (size_t i = 0; i < table->num_elems; i++) {
+                struct pack_huffman_entry *entry = entries + i;
+                if (i > 0) {
+                        code++;
                 }
+                code <<= (entry->nbits - prev_nbits);
+                entry->code = code;
+                prev_nbits = entry->nbits;
         }
-        return result;
 }
 
-static void assign_code(struct huff_node *node, const struct bitmap *path,
-        struct vector ofType(struct pack_huffman_entry) *table)
+static u64 reverse_bits(u64 code, u8 nbits)
 {
-        if (!node->left && !node->right) {
-                struct pack_huffman_entry *entry = vec_new_and_get(table, struct pack_huffman_entry);
-                import_into_entry(entry, node, path);
-        } else {
-                if (node->left) {
-                        struct bitmap left;
-                        bitmap_cpy(&left, path);
-                        bitmap_lshift(&left);
-                        bitmap_set(&left, 0, false);
-                        assign_code(node->left, &left, table);
-                        bitmap_drop(&left);
-                }
-                if (node->right) {
-                        struct bitmap right;
-                        bitmap_cpy(&right, path);
-                        bitmap_lshift(&right);
-                        bitmap_set(&right, 0, true);
-                        assign_code(node->right, &right, table);
-                        bitmap_drop(&right);
-                }
+        u64 result = 0;
+        for (u8 i = 0; i < nbits; i++, code >>= 1) {
+                result = (result << 1) | (code & 1);
         }
+        return result;
 }
 
-static struct huff_node *trim_and_begin(struct vector ofType(HuffNode) *candidates)
+static void codes_create(struct pack_huffman_code *codes, const struct vector ofType(struct pack_huffman_entry) *table)
 {
-        struct huff_node *begin = NULL;
-        for (struct huff_node *it = vec_get(candidates, 0, struct huff_node);; it++) {
-                if (it->freq == 0) {
-                        if (it->prev) {
-                                it->prev->next = it->next;
-                        }
-                        if (it->next) {
-                                it->next->prev = it->prev;
-                        }
-                } else {
-                        if (!begin) {
-                                begin = it;
-                        }
-                }
-                if (!it->next) {
-                        break;
-                }
+        ng5_zero_memory(codes, (UCHAR_MAX + 1) * sizeof(struct pack_huffman_code));
+        for (size_t i = 0; i < table->num_elems; i++) {
+                const struct pack_huffman_entry *entry = vec_get(table, i, struct pack_huffman_entry);
+                codes[entry->letter].stream_bits = reverse_bits(entry->code, entry->nbits);
+                codes[entry->letter].nbits = entry->nbits;
         }
-        return begin;
 }
 
-static void huff_tree_create(struct vector ofType(struct pack_huffman_entry) *table,
-        const struct vector ofType(u32) *frequencies)
+static bool decoder_create(struct pack_huffman_decoder *decoder, const struct coding_huffman *dic)
 {
-        assert(UCHAR_MAX == frequencies->num_elems);
+        const struct pack_huffman_entry *entries = vec_all(&dic->table, struct pack_huffman_entry);
+        const size_t num_entries = dic->table.num_elems;
+        const u32 table_size = 1 << NG5_HUFFMAN_TABLE_BITS;
 
-        struct vector ofType(HuffNode) candidates;
-        vec_create(&candidates, NULL, sizeof(struct huff_node), UCHAR_MAX * UCHAR_MAX);
-        size_t appender_idx = UCHAR_MAX;
+        ng5_zero_memory(decoder, sizeof(struct pack_huffman_decoder));
 
-        for (unsigned char i = 0; i < UCHAR_MAX; i++) {
-                struct huff_node *node = vec_new_and_get(&candidates, struct huff_node);
-                node->letter = i;
-                node->freq = *vec_get(frequencies, i, u32);
+        if (num_entries > UCHAR_MAX + 1) {
+                return false;
         }
 
-        for (unsigned char i = 0; i < UCHAR_MAX; i++) {
-                struct huff_node *node = vec_get(&candidates, i, struct huff_node);
-                struct huff_node *prev = i > 0 ? vec_get(&candidates, i - 1, struct huff_node) : NULL;
-                struct huff_node *next = i + 1 < UCHAR_MAX ? vec_get(&candidates, i + 1, struct huff_node) : NULL;
-                node->next = next;
-                node->prev = prev;
-                node->left = node->right = NULL;
+        /** canonical code book for codes that do not fit into the lookup table */
+        for (size_t i = 0; i < num_entries; i++) {
+                u8 nbits = entries[i].nbits;
+                if (decoder->num_codes[nbits]++ == 0) {
+                        decoder->first_letter[nbits] = i;
+                        decoder->first_code[nbits] = entries[i].code;
+                }
+                decoder->letters[i] = entries[i].letter;
+                decoder->max_nbits = ng5_max(decoder->max_nbits, nbits);
         }
 
-        struct huff_node *smallest, *small;
-        struct huff_node *handle = trim_and_begin(&candidates);
-        struct huff_node *new_node = NULL;
-
-        while (handle->next != NULL) {
-                smallest = find_smallest(handle, 0, NULL);
-                small = find_smallest(handle, smallest->freq, smallest);
-
-                appender_idx++;
-                new_node = vec_new_and_get(&candidates, struct huff_node);
-                new_node->freq = small->freq + smallest->freq;
-                new_node->letter = '\0';
-                new_node->left = small;
-                new_node->right = smallest;
-
-                if ((small->prev == NULL && smallest->next == NULL) && small->next == smallest) {
-                        break;
+        /** single-letter table: the bit stream holds codes most-significant bit first, but it is read least-significant
+         * bit first, hence the table is indexed by the reversed code; all combinations of the trailing bits map to the
+         * same letter */
+        struct {
+                unsigned char letter;
+                u8 nbits;
+        } single[1 << NG5_HUFFMAN_TABLE_BITS];
+        ng5_zero_memory(single, sizeof(single));
+
+        for (size_t i = 0; i < num_entries; i++) {
+                const struct pack_huffman_entry *entry = entries + i;
+                if (entry->nbits > NG5_HUFFMAN_TABLE_BITS) {
+                        continue;
                 }
-
-                if ((smallest->prev == NULL && small->next == NULL) && smallest->next == small) {
-                        break;
+                if (entry->code >= ((u64) 1 << entry->nbits)) {
+                        return false;
                 }
-                if (smallest->prev) {
-                        smallest->prev->next = smallest->next;
+                u32 reversed = reverse_bits(entry->code, entry->nbits);
+                for (u32 suffix = 0; suffix < (table_size >> entry->nbits); suffix++) {
+                        u32 idx = reversed | (suffix << entry->nbits);
+                        single[idx].letter = entry->letter;
+                        single[idx].nbits = entry->nbits;
                 }
-                if (smallest->next) {
-                        smallest->next->prev = smallest->prev;
+        }
+
+        /** multi-letter table: greedily decode as many complete codes as fit into the table width */
+        for (u32 idx = 0; idx < table_size; idx++) {
+                struct pack_huffman_lookup *lookup = decoder->lookup + idx;
+                u8 nbits = 0;
+                while (lookup->nletters < NG5_HUFFMAN_SYMBOLS_PER_LOOKUP) {
+                        u8 remaining = NG5_HUFFMAN_TABLE_BITS - nbits;
+                        u8 code_nbits = single[idx >> nbits].nbits;
+                        if (code_nbits == 0 || code_nbits > remaining) {
+                                break;
+                        }
+                        lookup->letters[lookup->nletters++] = single[idx >> nbits].letter;
+                        nbits += code_nbits;
                 }
-                if (small->prev) {
-                        small->prev->next = small->next;
+                lookup->nbits = nbits;
+                lookup->first_nbits = single[idx].nbits;
+        }
+
+        return true;
+}
+
+static inline bool huff_node_less(const struct huff_node *nodes, u16 lhs, u16 rhs)
+{
+        return nodes[lhs].freq < nodes[rhs].freq || (nodes[lhs].freq == nodes[rhs].freq && lhs < rhs);
+}
+
+static void heap_sift_down(u16 *heap, size_t num_elems, size_t pos, const struct huff_node *nodes)
+{
+        for (size_t child = 2 * pos + 1; child < num_elems; pos = child, child = 2 * pos + 1) {
+                if (child + 1 < num_elems && huff_node_less(nodes, heap[child + 1], heap[child])) {
+                        child++;
                 }
-                if (small->next) {
-                        small->next->prev = small->prev;
+                if (!huff_node_less(nodes, heap[child], heap[pos])) {
+                        break;
                 }
+                u16 tmp = heap[pos];
+                heap[pos] = heap[child];
+                heap[child] = tmp;
+        }
+}
 
-                if (small->prev) {
-                        handle = seek_to_begin(small->prev);
-                } else if (smallest->prev) {
-                        handle = seek_to_begin(smallest->prev);
-                } else if (small->next) {
-                        handle = seek_to_begin(small->next);
-                } else if (smallest->next) {
-                        handle = seek_to_begin(smallest->next);
-                } else {
-                        print_error_and_die(NG5_ERR_INTERNALERR);
-                }
+static u16 heap_pop(u16 *heap, size_t *num_elems, const struct huff_node *nodes)
+{
+        u16 top = heap[0];
+        heap[0] = heap[--(*num_elems)];
+        heap_sift_down(heap, *num_elems, 0, nodes);
+        return top;
+}
 
-                assert (!handle->prev);
-                struct huff_node *end = seek_to_end(handle);
-                assert(!end->next);
-                end->next = new_node;
-                new_node->prev = end;
-                new_node->next = NULL;
-
-#ifdef DIAG_HUFFMAN_ENABLE_DEBUG
-                printf("in-memory huff-tree: ");
-                __diag_print_insight(new_node);
-                printf("\n");
-                printf("remaining candidates: ");
-                __diag_dump_remaining_candidates(handle);
-                printf("\n");
-#endif
+static void heap_push(u16 *heap, size_t *num_elems, u16 node, const struct huff_node *nodes)
+{
+        size_t pos = (*num_elems)++;
+        heap[pos] = node;
+        while (pos > 0 && huff_node_less(nodes, heap[pos], heap[(pos - 1) / 2])) {
+                u16 tmp = heap[pos];
+                heap[pos] = heap[(pos - 1) / 2];
+                heap[(pos - 1) / 2] = tmp;
+                pos = (pos - 1) / 2;
         }
+}
 
-        seek_to_begin(handle);
-        if (handle->next) {
-                struct huff_node *finalNode = vec_new_and_get(&candidates, struct huff_node);
-                finalNode->freq = small->freq + smallest->freq;
-                finalNode->letter = '\0';
-                if (handle->freq > handle->next->freq) {
-                        finalNode->left = handle;
-                        finalNode->right = handle->next;
-                } else {
-                        finalNode->left = handle->next;
-                        finalNode->right = handle;
+/**
+ * Builds the Huffman tree over all letters with non-zero frequency by repeatedly merging the two least frequent
+ * nodes taken from a binary min-heap. Inner nodes are appended after the leaves, hence each parent has a larger index
+ * than its children, and the code length of each leaf is its depth below the root.
+ */
+static void huff_tree_create(struct vector ofType(struct pack_huffman_entry) *table, const u64 *frequencies)
+{
+        struct huff_node nodes[2 * (UCHAR_MAX + 1)];
+        u16 heap[UCHAR_MAX + 1];
+        u8 depth[2 * (UCHAR_MAX + 1)];
+        size_t num_nodes = 0, heap_size = 0;
+
+        for (unsigned letter = 0; letter <= UCHAR_MAX; letter++) {
+                if (frequencies[letter] > 0) {
+                        nodes[num_nodes].freq = frequencies[letter];
+                        nodes[num_nodes].letter = letter;
+                        heap[heap_size++] = num_nodes++;
                 }
-                new_node = finalNode;
         }
 
-#ifdef DIAG_HUFFMAN_ENABLE_DEBUG
-        printf("final in-memory huff-tree: ");
-        __diag_print_insight(new_node);
-        printf("\n");
-#endif
+        const size_t num_leaves = num_nodes;
+        if (num_leaves == 0) {
+                return;
+        }
 
-        struct bitmap root_path;
-        bitmap_create(&root_path, UCHAR_MAX);
-        bitmap_set(&root_path, 0, true);
-        assign_code(new_node, &root_path, table);
-        bitmap_drop(&root_path);
+        for (size_t pos = heap_size / 2; pos-- > 0; ) {
+                heap_sift_down(heap, heap_size, pos, nodes);
+        }
 
-        vec_drop(&candidates);
-}
\ No newline at end of file
+        while (heap_size > 1) {
+                u16 smallest = heap_pop(heap, &heap_size, nodes);
+                u16 small = heap_pop(heap, &heap_size, nodes);
+                nodes[num_nodes].freq = nodes[smallest].freq + nodes[small].freq;
+                nodes[smallest].parent = nodes[small].parent = num_nodes;
+                heap_push(heap, &heap_size, num_nodes++, nodes);
+        }
+
+        depth[num_nodes - 1] = 0;
+        for (size_t i = num_nodes - 1; i-- > 0; ) {
+                depth[i] = depth[nodes[i].parent] + 1;
+        }
+
+        for (size_t i = 0; i < num_leaves; i++) {
+                assert(depth[i] <= NG5_HUFFMAN_MAX_CODE_LENGTH);
+                struct pack_huffman_entry *entry = vec_new_and_get(table, struct pack_huffman_entry);
+                entry->letter = nodes[i].letter;
+                /** a single letter is the root itself but still needs a 1-bit code */
+                entry->nbits = ng5_max(depth[i], 1);
+                entry->code = 0;
+        }
+}
@@ -0,0 +1,321 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "coding/coding_intpack.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define INTPACK_HAS_AVX2
+#endif
+
+static inline u8 bit_width(u64 value)
+{
+        return value ? (u8) (64 - __builtin_clzll(value)) : 0;
+}
+
+static inline size_t packed_size(u64 num_values, u8 width)
+{
+        return (num_values * width + 7) / 8;
+}
+
+static inline u64 width_mask(u8 width)
+{
+        return width < 64 ? (1ULL << width) - 1 : ~0ULL;
+}
+
+static inline u64 zigzag(u64 delta)
+{
+        return (delta << 1) ^ (u64) (((i64) delta) >> 63);
+}
+
+static inline u64 unzigzag(u64 value)
+{
+        return (value >> 1) ^ (0 - (value & 1));
+}
+
+/** Stores <code>value</code> as bits <code>[pos, pos + width)</code> of the zero-initialized buffer <code>dst</code>,
+ * which has room for 9 bytes starting at byte <code>pos / 8</code>. */
+static inline void pack_value(unsigned char *dst, u64 pos, u8 width, u64 value)
+{
+        u64 word;
+        unsigned shift = pos & 7;
+        unsigned char *at = dst + (pos >> 3);
+        memcpy(&word, at, sizeof(u64));
+        word |= value << shift;
+        memcpy(at, &word, sizeof(u64));
+        if (shift + width > 64) {
+                at[sizeof(u64)] |= (unsigned char) (value >> (64 - shift));
+        }
+}
+
+/** Reads bits <code>[pos, pos + width)</code> of <code>src</code>, which has <code>nbytes</code> bytes. */
+static inline u64 unpack_value(const unsigned char *src, size_t nbytes, u64 pos, u8 width)
+{
+        unsigned char buffer[sizeof(u64) + 1] = {0};
+        size_t at = pos >> 3;
+        unsigned shift = pos & 7;
+        if (width == 0) {
+                return 0;
+        }
+        memcpy(buffer, src + at, ng5_min(sizeof(buffer), nbytes - at));
+        u64 word;
+        memcpy(&word, buffer, sizeof(u64));
+        word >>= shift;
+        if (shift + width > 64) {
+                word |= ((u64) buffer[sizeof(u64)]) << (64 - shift);
+        }
+        return word & width_mask(width);
+}
+
+bool coding_intpack_plan(struct coding_intpack_header *header, const u64 *values, u32 num_values)
+{
+        error_if_null(header)
+        error_if_null(values)
+
+        u64 min = num_values ? values[0] : 0, max = min;
+        u64 max_delta = 0, max_run = 0, run = 0;
+        u32 num_runs = 0;
+        for (u32 i = 0; i < num_values; i++) {
+                min = ng5_min(min, values[i]);
+                max = ng5_max(max, values[i]);
+                if (i > 0) {
+                        max_delta = ng5_max(max_delta, zigzag(values[i] - values[i - 1]));
+                }
+                if (i == 0 || values[i] != values[i - 1]) {
+                        max_run = ng5_max(max_run, run);
+                        num_runs++;
+                        run = 0;
+                }
+                run++;
+        }
+        max_run = ng5_max(max_run, run);
+
+        u8 for_width = bit_width(max - min);
+        u8 delta_width = bit_width(max_delta);
+        u8 run_width = bit_width(max_run ? max_run - 1 : 0);
+        size_t for_size = packed_size(num_values, for_width);
+        size_t delta_size = packed_size(num_values, delta_width);
+        size_t rle_size = packed_size(num_runs, for_width) + packed_size(num_runs, run_width);
+
+        ng5_zero_memory(header, sizeof(struct coding_intpack_header));
+        header->num_values = num_values;
+        if (for_size <= delta_size && for_size <= rle_size) {
+                header->scheme = INTPACK_FOR;
+                header->width = for_width;
+                header->reference = min;
+        } else if (delta_size <= rle_size) {
+                header->scheme = INTPACK_DELTA;
+                header->width = delta_width;
+                header->reference = values[0];
+        } else {
+                header->scheme = INTPACK_RLE;
+                header->width = for_width;
+                header->run_width = run_width;
+                header->num_runs = num_runs;
+                header->reference = min;
+        }
+        return true;
+}
+
+size_t coding_intpack_payload_size(const struct coding_intpack_header *header)
+{
+        switch (header->scheme) {
+        case INTPACK_FOR:
+        case INTPACK_DELTA:
+                return packed_size(header->num_values, header->width);
+        case INTPACK_RLE:
+                return packed_size(header->num_runs, header->width) + packed_size(header->num_runs,
+                        header->run_width);
+        default:
+                return 0;
+        }
+}
+
+bool coding_intpack_encode(void *dst, const struct coding_intpack_header *header, const u64 *values)
+{
+        error_if_null(dst)
+        error_if_null(header)
+        error_if_null(values)
+
+        size_t nbytes = coding_intpack_payload_size(header);
+        /* the packing loop writes 9 bytes at the position of each value; pack into a buffer with that much slack */
+        unsigned char *buffer = calloc(nbytes + sizeof(u64) + 1, 1);
+        if (!buffer) {
+                return false;
+        }
+
+        switch (header->scheme) {
+        case INTPACK_FOR:
+                for (u32 i = 0; i < header->num_values; i++) {
+                        pack_value(buffer, (u64) i * header->width, header->width, values[i] - header->reference);
+                }
+                break;
+        case INTPACK_DELTA: {
+                u64 last = header->reference;
+                for (u32 i = 0; i < header->num_values; i++) {
+                        pack_value(buffer, (u64) i * header->width, header->width, zigzag(values[i] - last));
+                        last = values[i];
+                }
+        }
+                break;
+        case INTPACK_RLE: {
+                size_t lengths_off = packed_size(header->num_runs, header->width);
+                u32 run = 0;
+                for (u32 i = 0; i < header->num_values; run++) {
+                        u32 end = i + 1;
+                        while (end < header->num_values && values[end] == values[i]) {
+                                end++;
+                        }
+                        pack_value(buffer, (u64) run * header->width, header->width, values[i] - header->reference);
+                        pack_value(buffer + lengths_off, (u64) run * header->run_width, header->run_width,
+                                end - i - 1);
+                        i = end;
+                }
+                assert(run == header->num_runs);
+        }
+                break;
+        default:
+                free(buffer);
+                return false;
+        }
+
+        memcpy(dst, buffer, nbytes);
+        free(buffer);
+        return true;
+}
+
+#ifdef INTPACK_HAS_AVX2
+
+/** Unpacks four values per step: one unaligned 64-bit gather per value at the byte holding its first bit, followed by
+ * per-lane variable shifts. Requires a width of at most 56 bits, such that each value lies within the gathered word,
+ * and 8 readable bytes at the byte of each value. */
+__attribute__((target("avx2")))
+static size_t unpack_avx2(u64 *dst, const unsigned char *src, u8 width, u64 first, size_t n, u64 reference)
+{
+        const __m256i mask = _mm256_set1_epi64x((long long) width_mask(width));
+        const __m256i ref = _mm256_set1_epi64x((long long) reference);
+        const __m256i seven = _mm256_set1_epi64x(7);
+        const __m256i step = _mm256_set1_epi64x((long long) (4 * (u64) width));
+        __m256i pos = _mm256_set_epi64x((long long) ((first + 3) * width), (long long) ((first + 2) * width),
+                (long long) ((first + 1) * width), (long long) (first * width));
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+                __m256i words = _mm256_i64gather_epi64((const long long *) src, _mm256_srli_epi64(pos, 3), 1);
+                __m256i values = _mm256_srlv_epi64(words, _mm256_and_si256(pos, seven));
+                values = _mm256_add_epi64(_mm256_and_si256(values, mask), ref);
+                _mm256_storeu_si256((__m256i *) (dst + i), values);
+                pos = _mm256_add_epi64(pos, step);
+        }
+        return i;
+}
+
+static bool has_avx2()
+{
+        return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+void coding_intpack_unpack(u64 *dst, const void *src, size_t nbytes, u8 width, u64 first, size_t n, u64 reference)
+{
+        const unsigned char *in = src;
+        size_t i = 0;
+
+        if (width == 0) {
+                for (; i < n; i++) {
+                        dst[i] = reference;
+                }
+                return;
+        }
+
+        if (width <= 56 && nbytes >= sizeof(u64)) {
+                /* values whose first byte is followed by 7 more readable bytes are read by a single unaligned load */
+                u64 last_safe = ((nbytes - sizeof(u64)) * 8 + 7) / width;
+                size_t num_fast = last_safe >= first ? ng5_min(n, (size_t) (last_safe - first + 1)) : 0;
+#ifdef INTPACK_HAS_AVX2
+                if (num_fast >= 4 && has_avx2()) {
+                        i = unpack_avx2(dst, in, width, first, num_fast, reference);
+                }
+#endif
+                const u64 mask = width_mask(width);
+                for (; i < num_fast; i++) {
+                        u64 pos = (first + i) * width, word;
+                        memcpy(&word, in + (pos >> 3), sizeof(u64));
+                        dst[i] = reference + ((word >> (pos & 7)) & mask);
+                }
+        }
+        for (; i < n; i++) {
+                dst[i] = reference + unpack_value(in, nbytes, (first + i) * width, width);
+        }
+}
+
+void coding_intpack_cursor_init(struct coding_intpack_cursor *cursor, const struct coding_intpack_header *header)
+{
+        ng5_zero_memory(cursor, sizeof(struct coding_intpack_cursor));
+        cursor->last = header->reference;
+}
+
+u32 coding_intpack_decode(u64 *dst, u32 n, struct coding_intpack_cursor *cursor,
+        const struct coding_intpack_header *header, const void *payload)
+{
+        size_t nbytes = coding_intpack_payload_size(header);
+        n = ng5_min(n, header->num_values - cursor->idx);
+
+        switch (header->scheme) {
+        case INTPACK_FOR:
+                coding_intpack_unpack(dst, payload, nbytes, header->width, cursor->idx, n, header->reference);
+                break;
+        case INTPACK_DELTA: {
+                u64 last = cursor->last;
+                coding_intpack_unpack(dst, payload, nbytes, header->width, cursor->idx, n, 0);
+                for (u32 i = 0; i < n; i++) {
+                        last += unzigzag(dst[i]);
+                        dst[i] = last;
+                }
+                cursor->last = last;
+        }
+                break;
+        case INTPACK_RLE: {
+                const unsigned char *lengths = (const unsigned char *) payload + packed_size(header->num_runs,
+                        header->width);
+                size_t values_size = packed_size(header->num_runs, header->width);
+                size_t lengths_size = nbytes - values_size;
+                for (u32 i = 0; i < n;) {
+                        if (cursor->run_left == 0) {
+                                assert(cursor->run < header->num_runs);
+                                cursor->run_value = header->reference + unpack_value(payload, values_size,
+                                        (u64) cursor->run * header->width, header->width);
+                                cursor->run_left = 1 + unpack_value(lengths, lengths_size,
+                                        (u64) cursor->run * header->run_width, header->run_width);
+                                cursor->run++;
+                        }
+                        u32 len = ng5_min(cursor->run_left, n - i);
+                        for (u32 k = 0; k < len; k++) {
+                                dst[i + k] = cursor->run_value;
+                        }
+                        cursor->run_left -= len;
+                        i += len;
+                }
+        }
+                break;
+        default:
+                return 0;
+        }
+
+        cursor->idx += n;
+        return n;
+}
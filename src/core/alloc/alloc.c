@@ -28,9 +28,25 @@ static void invoke_free(struct allocator *self, void *ptr);
 
 static void invoke_clone(struct allocator *dst, const struct allocator *self);
 
-NG5_EXPORT (bool) alloc_create_std(struct allocator *alloc)
+static struct allocator std_override;
+static bool std_override_set = false;
+
+NG5_EXPORT (bool) alloc_override_std(const struct allocator *alloc)
 {
         if (alloc) {
+                std_override = *alloc;
+        }
+        std_override_set = (alloc != NULL);
+        return true;
+}
+
+NG5_EXPORT (bool) alloc_create_std(struct allocator *alloc)
+{
+        if (alloc && unlikely(std_override_set)) {
+                *alloc = std_override;
+                error_init(&alloc->err);
+                return true;
+        } else if (alloc) {
                 alloc->extra = NULL;
                 alloc->malloc = invoke_malloc;
                 alloc->realloc = invoke_realloc;
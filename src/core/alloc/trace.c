@@ -16,6 +16,8 @@
  */
 
 #include <inttypes.h>
+#include <execinfo.h>
+#include <math.h>
 #include "std/vec.h"
 #include "core/alloc/trace.h"
 #include "std/sort.h"
@@ -328,3 +330,627 @@ static void invoke_clone(struct allocator *dst, const struct allocator *self)
 {
         *dst = *self;
 }
+
+/**
+ * Sampling allocation profiler
+ *
+ * In contrast to the allocator above, the sampling allocator does not take a lock on the common path. Each thread
+ * counts down the bytes until its next sample, where the distance between two samples is drawn from an exponential
+ * distribution with mean `sample_period` (i.e., allocated bytes are Poisson-sampled). Only a sampled allocation
+ * captures a backtrace and enters the global call-site table under a spinlock. Each sample is weighted by the
+ * inverse of its sampling probability such that the per-call-site aggregates are unbiased estimates of the real
+ * number of objects and bytes.
+ *
+ * Every block carries a 16-byte header that stores the user size and (for sampled blocks) the call-site index, such
+ * that free and realloc can retract sampled bytes from the live-heap aggregate without any further lookup.
+ */
+
+#define TRACE_SAMPLE_MAX_SITES          4096
+#define TRACE_SAMPLE_SKIP_FRAMES        2       /* sampler_record, invoke_sampling_{malloc,realloc} */
+
+struct trace_sample_header {
+        u32 site_idx;                           /* index in call-site table plus one, or 0 if block is not sampled */
+        u32 reserved;
+        size_t size;                            /* user size in bytes */
+};
+
+struct trace_sample_site {
+        u64 hash;
+        u32 depth;
+        void *frames[TRACE_SAMPLE_STACK_DEPTH];
+        double live_objs;
+        double live_bytes;
+        double total_objs;
+        double total_bytes;
+};
+
+static struct {
+        size_t sample_period;
+        struct spinlock spinlock;
+        struct trace_sample_site *sites;
+        u32 num_sites;
+        u32 num_dropped;
+} global_sampler = {.sample_period = 0, .sites = NULL, .num_sites = 0, .num_dropped = 0};
+
+static __thread struct {
+        bool init;
+        u64 rand_state;
+        i64 bytes_until_sample;
+} thread_sampler;
+
+static void *invoke_sampling_malloc(struct allocator *self, size_t size);
+static void *invoke_sampling_realloc(struct allocator *self, void *ptr, size_t size);
+static void invoke_sampling_free(struct allocator *self, void *ptr);
+
+static inline u64 sampler_next_random()
+{
+        /* xorshift64*, seeded per thread */
+        u64 x = thread_sampler.rand_state;
+        x ^= x >> 12;
+        x ^= x << 25;
+        x ^= x >> 27;
+        thread_sampler.rand_state = x;
+        return x * 0x2545F4914F6CDD1DULL;
+}
+
+static i64 sampler_next_interval()
+{
+        /* uniform in (0, 1], taken from the upper 53 bits */
+        double u = ((sampler_next_random() >> 11) + 1) * (1.0 / 9007199254740992.0);
+        return (i64) (-log(u) * global_sampler.sample_period) + 1;
+}
+
+static inline bool sampler_should_sample(size_t size)
+{
+        if (unlikely(!thread_sampler.init)) {
+                thread_sampler.rand_state = (u64) time_now_wallclock() ^ (u64) (uintptr_t) &thread_sampler;
+                thread_sampler.rand_state |= 1;
+                thread_sampler.bytes_until_sample = sampler_next_interval();
+                thread_sampler.init = true;
+        }
+        thread_sampler.bytes_until_sample -= size;
+        if (likely(thread_sampler.bytes_until_sample > 0)) {
+                return false;
+        }
+        do {
+                thread_sampler.bytes_until_sample += sampler_next_interval();
+        } while (thread_sampler.bytes_until_sample <= 0);
+        return true;
+}
+
+static inline double sampler_probability(size_t size)
+{
+        return 1.0 - exp(-((double) size) / global_sampler.sample_period);
+}
+
+static u64 sampler_hash_frames(void **frames, int depth)
+{
+        u64 hash = 14695981039346656037ULL;
+        for (int i = 0; i < depth; i++) {
+                hash ^= (u64) (uintptr_t) frames[i];
+                hash *= 1099511628211ULL;
+        }
+        return hash;
+}
+
+static u32 sampler_site_lookup_or_insert(void **frames, int depth)
+{
+        u64 hash = sampler_hash_frames(frames, depth);
+        u32 slot = hash % TRACE_SAMPLE_MAX_SITES;
+        for (u32 probe = 0; probe < TRACE_SAMPLE_MAX_SITES; probe++) {
+                struct trace_sample_site *site = global_sampler.sites + slot;
+                if (site->depth == 0) {
+                        site->hash = hash;
+                        site->depth = depth;
+                        memcpy(site->frames, frames, depth * sizeof(void *));
+                        global_sampler.num_sites++;
+                        return slot + 1;
+                } else if (site->hash == hash && site->depth == (u32) depth &&
+                        memcmp(site->frames, frames, depth * sizeof(void *)) == 0) {
+                        return slot + 1;
+                }
+                slot = (slot + 1) % TRACE_SAMPLE_MAX_SITES;
+        }
+        return 0;
+}
+
+__attribute__((noinline)) static void sampler_record(struct trace_sample_header *header, size_t size,
+        const void *caller)
+{
+        void *frames[TRACE_SAMPLE_STACK_DEPTH + TRACE_SAMPLE_SKIP_FRAMES];
+        int depth = backtrace(frames, NG5_ARRAY_LENGTH(frames));
+        int skip = ng5_min(depth, TRACE_SAMPLE_SKIP_FRAMES);
+        /* start at the return address of the allocator function, independent of what the compiler inlined */
+        for (int i = 0; i < depth; i++) {
+                if (frames[i] == caller) {
+                        skip = i;
+                        break;
+                }
+        }
+        double objs = 1.0 / sampler_probability(size);
+
+        spin_acquire(&global_sampler.spinlock);
+        u32 site_idx = sampler_site_lookup_or_insert(frames + skip, depth - skip);
+        if (likely(site_idx != 0)) {
+                struct trace_sample_site *site = global_sampler.sites + site_idx - 1;
+                site->live_objs += objs;
+                site->live_bytes += objs * size;
+                site->total_objs += objs;
+                site->total_bytes += objs * size;
+        } else {
+                global_sampler.num_dropped++;
+        }
+        spin_release(&global_sampler.spinlock);
+
+        header->site_idx = site_idx;
+}
+
+static void sampler_retract(const struct trace_sample_header *header)
+{
+        if (header->site_idx != 0) {
+                double objs = 1.0 / sampler_probability(header->size);
+                spin_acquire(&global_sampler.spinlock);
+                struct trace_sample_site *site = global_sampler.sites + header->site_idx - 1;
+                site->live_objs -= objs;
+                site->live_bytes -= objs * header->size;
+                spin_release(&global_sampler.spinlock);
+        }
+}
+
+int trace_alloc_create_sampling(struct allocator *alloc, size_t sample_period)
+{
+        error_if_null(alloc);
+        error_if_null(sample_period);
+
+        if (!global_sampler.sites) {
+                spin_init(&global_sampler.spinlock);
+                global_sampler.sites = calloc(TRACE_SAMPLE_MAX_SITES, sizeof(struct trace_sample_site));
+                error_print_and_die_if(!global_sampler.sites, NG5_ERR_MALLOCERR);
+        }
+        global_sampler.sample_period = sample_period;
+
+        alloc->extra = NULL;
+        alloc->malloc = invoke_sampling_malloc;
+        alloc->realloc = invoke_sampling_realloc;
+        alloc->free = invoke_sampling_free;
+        alloc->clone = invoke_clone;
+        error_init(&alloc->err);
+
+        return true;
+}
+
+static void *invoke_sampling_malloc(struct allocator *self, size_t size)
+{
+        ng5_unused(self);
+
+        struct trace_sample_header *header = malloc(sizeof(struct trace_sample_header) + size);
+        error_print_and_die_if(!header, NG5_ERR_MALLOCERR);
+        header->site_idx = 0;
+        header->size = size;
+        if (unlikely(sampler_should_sample(size))) {
+                sampler_record(header, size, __builtin_return_address(0));
+        }
+        return header + 1;
+}
+
+static void *invoke_sampling_realloc(struct allocator *self, void *ptr, size_t size)
+{
+        ng5_unused(self);
+
+        /* as for realloc, a null pointer requests a new block */
+        struct trace_sample_header *header = ptr ? ((struct trace_sample_header *) ptr) - 1 : NULL;
+        if (header) {
+                sampler_retract(header);
+        }
+
+        struct trace_sample_header *result = realloc(header, sizeof(struct trace_sample_header) + size);
+        if (unlikely(!result)) {
+                error_print(NG5_ERR_REALLOCERR);
+                if (header) {
+                        header->site_idx = 0;
+                }
+                return ptr;
+        }
+        result->site_idx = 0;
+        result->size = size;
+        if (unlikely(sampler_should_sample(size))) {
+                sampler_record(result, size, __builtin_return_address(0));
+        }
+        return result + 1;
+}
+
+static void invoke_sampling_free(struct allocator *self, void *ptr)
+{
+        ng5_unused(self);
+
+        if (!ptr) {
+                return;
+        }
+        struct trace_sample_header *header = ((struct trace_sample_header *) ptr) - 1;
+        sampler_retract(header);
+        free(header);
+}
+
+static void dump_pprof(FILE *file, enum trace_dump_view view)
+{
+        double sum_live_objs = 0, sum_live_bytes = 0, sum_total_objs = 0, sum_total_bytes = 0;
+        for (u32 i = 0; i < TRACE_SAMPLE_MAX_SITES; i++) {
+                const struct trace_sample_site *site = global_sampler.sites + i;
+                sum_live_objs += site->live_objs;
+                sum_live_bytes += site->live_bytes;
+                sum_total_objs += site->total_objs;
+                sum_total_bytes += site->total_bytes;
+        }
+
+        /* legacy text heap profile as understood by pprof; the view only decides which sites are listed */
+        fprintf(file, "heap profile: %" PRIu64 ": %" PRIu64 " [%" PRIu64 ": %" PRIu64 "] @ heapprofile\n",
+                (u64) sum_live_objs, (u64) sum_live_bytes, (u64) sum_total_objs, (u64) sum_total_bytes);
+        for (u32 i = 0; i < TRACE_SAMPLE_MAX_SITES; i++) {
+                const struct trace_sample_site *site = global_sampler.sites + i;
+                if (site->depth == 0 || (view == TRACE_VIEW_LIVE && (u64) site->live_bytes == 0)) {
+                        continue;
+                }
+                fprintf(file, "%" PRIu64 ": %" PRIu64 " [%" PRIu64 ": %" PRIu64 "] @",
+                        (u64) site->live_objs, (u64) site->live_bytes, (u64) site->total_objs,
+                        (u64) site->total_bytes);
+                for (u32 j = 0; j < site->depth; j++) {
+                        fprintf(file, " %p", site->frames[j]);
+                }
+                fprintf(file, "\n");
+        }
+
+        fprintf(file, "\nMAPPED_LIBRARIES:\n");
+        FILE *maps = fopen("/proc/self/maps", "r");
+        if (maps) {
+                char buffer[4096];
+                size_t nread;
+                while ((nread = fread(buffer, 1, sizeof(buffer), maps)) > 0) {
+                        fwrite(buffer, 1, nread, file);
+                }
+                fclose(maps);
+        }
+}
+
+static void dump_folded(FILE *file, enum trace_dump_view view)
+{
+        for (u32 i = 0; i < TRACE_SAMPLE_MAX_SITES; i++) {
+                const struct trace_sample_site *site = global_sampler.sites + i;
+                u64 bytes = (u64) (view == TRACE_VIEW_LIVE ? site->live_bytes : site->total_bytes);
+                if (site->depth == 0 || bytes == 0) {
+                        continue;
+                }
+                char **symbols = backtrace_symbols(site->frames, site->depth);
+                /* folded stacks are written root first */
+                for (u32 j = site->depth; j > 0; j--) {
+                        fprintf(file, "%s%s", symbols ? symbols[j - 1] : "??", j > 1 ? ";" : "");
+                }
+                fprintf(file, " %" PRIu64 "\n", bytes);
+                free(symbols);
+        }
+}
+
+bool trace_alloc_dump(FILE *file, enum trace_dump_format format, enum trace_dump_view view)
+{
+        error_if_null(file);
+        if (!global_sampler.sites) {
+                return false;
+        }
+
+        spin_acquire(&global_sampler.spinlock);
+        switch (format) {
+        case TRACE_DUMP_PPROF:
+                dump_pprof(file, view);
+                break;
+        case TRACE_DUMP_FOLDED:
+                dump_folded(file, view);
+                break;
+        default:
+                spin_release(&global_sampler.spinlock);
+                error_print(NG5_ERR_ILLEGALARG);
+                return false;
+        }
+        fflush(file);
+        spin_release(&global_sampler.spinlock);
+        return true;
+}
+
+/**
+ * Allocation trace recording
+ *
+ * The recording allocator delegates to clib and appends every malloc, realloc and free as an event to a compact
+ * binary trace file (see <code>trace.h</code> for the format). Objects are identified by logical object ids that are
+ * assigned on allocation and kept across reallocations, such that a trace can be replayed independent of the
+ * addresses handed out in the recorded run. The address-to-id mapping lives in a side table, hence blocks returned
+ * by this allocator are ordinary clib blocks. All operations are serialized by a spinlock to keep the event order
+ * consistent with address reuse; recording is therefore meant for capturing workloads, not for productive mode.
+ */
+
+struct trace_record_slot {
+        const void *ptr;
+        u64 object_id;
+};
+
+static struct {
+        FILE *file;
+        struct spinlock spinlock;
+        u64 next_object_id;
+        struct trace_record_slot *slots;
+        size_t num_slots;
+        size_t num_used;
+} global_recorder = {.file = NULL, .next_object_id = 0, .slots = NULL, .num_slots = 0, .num_used = 0};
+
+static void *invoke_recording_malloc(struct allocator *self, size_t size);
+static void *invoke_recording_realloc(struct allocator *self, void *ptr, size_t size);
+static void invoke_recording_free(struct allocator *self, void *ptr);
+
+static inline size_t recorder_slot_of(const void *ptr, size_t num_slots)
+{
+        u64 x = (u64) (uintptr_t) ptr;
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        return x & (num_slots - 1);
+}
+
+static void recorder_map_put(const void *ptr, u64 object_id);
+
+static void recorder_map_grow()
+{
+        struct trace_record_slot *old_slots = global_recorder.slots;
+        size_t old_num_slots = global_recorder.num_slots;
+
+        global_recorder.num_slots = old_num_slots ? 2 * old_num_slots : 1024;
+        global_recorder.slots = calloc(global_recorder.num_slots, sizeof(struct trace_record_slot));
+        error_print_and_die_if(!global_recorder.slots, NG5_ERR_MALLOCERR);
+        global_recorder.num_used = 0;
+
+        for (size_t i = 0; i < old_num_slots; i++) {
+                if (old_slots[i].ptr) {
+                        recorder_map_put(old_slots[i].ptr, old_slots[i].object_id);
+                }
+        }
+        free(old_slots);
+}
+
+static void recorder_map_put(const void *ptr, u64 object_id)
+{
+        if (unlikely(2 * (global_recorder.num_used + 1) > global_recorder.num_slots)) {
+                recorder_map_grow();
+        }
+        size_t slot = recorder_slot_of(ptr, global_recorder.num_slots);
+        while (global_recorder.slots[slot].ptr && global_recorder.slots[slot].ptr != ptr) {
+                slot = (slot + 1) & (global_recorder.num_slots - 1);
+        }
+        global_recorder.num_used += global_recorder.slots[slot].ptr ? 0 : 1;
+        global_recorder.slots[slot].ptr = ptr;
+        global_recorder.slots[slot].object_id = object_id;
+}
+
+static bool recorder_map_remove(u64 *object_id, const void *ptr)
+{
+        /* a null pointer would match the first free slot on its probe sequence */
+        if (unlikely(!ptr || global_recorder.num_slots == 0)) {
+                return false;
+        }
+        size_t mask = global_recorder.num_slots - 1;
+        size_t slot = recorder_slot_of(ptr, global_recorder.num_slots);
+        while (global_recorder.slots[slot].ptr != ptr) {
+                if (!global_recorder.slots[slot].ptr) {
+                        return false;
+                }
+                slot = (slot + 1) & mask;
+        }
+        *object_id = global_recorder.slots[slot].object_id;
+
+        /* backward-shift deletion keeps probe sequences intact without tombstones */
+        size_t hole = slot;
+        for (size_t next = (hole + 1) & mask; global_recorder.slots[next].ptr; next = (next + 1) & mask) {
+                size_t home = recorder_slot_of(global_recorder.slots[next].ptr, global_recorder.num_slots);
+                if (((next - home) & mask) >= ((next - hole) & mask)) {
+                        global_recorder.slots[hole] = global_recorder.slots[next];
+                        hole = next;
+                }
+        }
+        global_recorder.slots[hole].ptr = NULL;
+        global_recorder.num_used--;
+        return true;
+}
+
+static inline void recorder_write_varint(u64 value)
+{
+        u8 buffer[10];
+        u32 len = 0;
+        do {
+                buffer[len] = value & 0x7F;
+                value >>= 7;
+                buffer[len++] |= value ? 0x80 : 0;
+        } while (value);
+        fwrite(buffer, 1, len, global_recorder.file);
+}
+
+static void recorder_write_event(enum trace_event_type type, u64 object_id, u64 size)
+{
+        if (likely(global_recorder.file != NULL)) {
+                fputc((u8) type, global_recorder.file);
+                recorder_write_varint(object_id);
+                if (type != TRACE_EVENT_FREE) {
+                        recorder_write_varint(size);
+                }
+        }
+}
+
+int trace_alloc_create_recording(struct allocator *alloc, const char *path)
+{
+        error_if_null(alloc);
+        error_if_null(path);
+
+        if (global_recorder.file) {
+                trace_alloc_close_recording();
+        }
+        if (!(global_recorder.file = fopen(path, "wb"))) {
+                error_print(NG5_ERR_FOPENWRITE);
+                return false;
+        }
+        setvbuf(global_recorder.file, NULL, _IOFBF, 1 << 20);
+        fwrite(TRACE_FILE_MAGIC, 1, strlen(TRACE_FILE_MAGIC), global_recorder.file);
+        fputc(TRACE_FILE_VERSION, global_recorder.file);
+        spin_init(&global_recorder.spinlock);
+
+        alloc->extra = NULL;
+        alloc->malloc = invoke_recording_malloc;
+        alloc->realloc = invoke_recording_realloc;
+        alloc->free = invoke_recording_free;
+        alloc->clone = invoke_clone;
+        error_init(&alloc->err);
+
+        return true;
+}
+
+bool trace_alloc_close_recording()
+{
+        if (!global_recorder.file) {
+                return false;
+        }
+        spin_acquire(&global_recorder.spinlock);
+        fclose(global_recorder.file);
+        global_recorder.file = NULL;
+        spin_release(&global_recorder.spinlock);
+        return true;
+}
+
+static void *invoke_recording_malloc(struct allocator *self, size_t size)
+{
+        ng5_unused(self);
+
+        spin_acquire(&global_recorder.spinlock);
+        void *result = malloc(size);
+        error_print_and_die_if(!result, NG5_ERR_MALLOCERR);
+        u64 object_id = global_recorder.next_object_id++;
+        recorder_map_put(result, object_id);
+        recorder_write_event(TRACE_EVENT_ALLOC, object_id, size);
+        spin_release(&global_recorder.spinlock);
+
+        return result;
+}
+
+static void *invoke_recording_realloc(struct allocator *self, void *ptr, size_t size)
+{
+        u64 object_id;
+
+        /* as for realloc, a null pointer requests a new block */
+        if (!ptr) {
+                return invoke_recording_malloc(self, size);
+        }
+
+        spin_acquire(&global_recorder.spinlock);
+        bool known = recorder_map_remove(&object_id, ptr);
+        void *result = realloc(ptr, size);
+        if (unlikely(!result)) {
+                if (known) {
+                        recorder_map_put(ptr, object_id);
+                }
+                spin_release(&global_recorder.spinlock);
+                error_print(NG5_ERR_REALLOCERR);
+                return ptr;
+        }
+        if (likely(known)) {
+                recorder_map_put(result, object_id);
+                recorder_write_event(TRACE_EVENT_REALLOC, object_id, size);
+        } else {
+                /* block was allocated before recording started; it enters the trace as a new object */
+                object_id = global_recorder.next_object_id++;
+                recorder_map_put(result, object_id);
+                recorder_write_event(TRACE_EVENT_ALLOC, object_id, size);
+        }
+        spin_release(&global_recorder.spinlock);
+
+        return result;
+}
+
+static void invoke_recording_free(struct allocator *self, void *ptr)
+{
+        ng5_unused(self);
+
+        u64 object_id;
+
+        if (!ptr) {
+                return;
+        }
+
+        spin_acquire(&global_recorder.spinlock);
+        if (likely(recorder_map_remove(&object_id, ptr))) {
+                recorder_write_event(TRACE_EVENT_FREE, object_id, 0);
+        }
+        free(ptr);
+        spin_release(&global_recorder.spinlock);
+}
+
+static bool reader_read_varint(u64 *value, FILE *file)
+{
+        u64 result = 0;
+        for (u32 shift = 0; shift < 64; shift += 7) {
+                int c = fgetc(file);
+                if (unlikely(c == EOF)) {
+                        return false;
+                }
+                result |= ((u64) (c & 0x7F)) << shift;
+                if (!(c & 0x80)) {
+                        *value = result;
+                        return true;
+                }
+        }
+        return false;
+}
+
+bool trace_reader_open(struct trace_reader *reader, const char *path)
+{
+        error_if_null(reader);
+        error_if_null(path);
+
+        char magic[sizeof(TRACE_FILE_MAGIC)] = { 0 };
+        error_init(&reader->err);
+        reader->num_events = 0;
+        if (!(reader->file = fopen(path, "rb"))) {
+                error(&reader->err, NG5_ERR_FOPEN_FAILED);
+                return false;
+        }
+        if (fread(magic, 1, strlen(TRACE_FILE_MAGIC), reader->file) != strlen(TRACE_FILE_MAGIC) ||
+                strcmp(magic, TRACE_FILE_MAGIC) != 0) {
+                error(&reader->err, NG5_ERR_CORRUPTED);
+                fclose(reader->file);
+                return false;
+        }
+        if (fgetc(reader->file) != TRACE_FILE_VERSION) {
+                error(&reader->err, NG5_ERR_FORMATVERERR);
+                fclose(reader->file);
+                return false;
+        }
+        return true;
+}
+
+bool trace_reader_next(struct trace_event *event, struct trace_reader *reader)
+{
+        error_if_null(event);
+        error_if_null(reader);
+
+        int type = fgetc(reader->file);
+        if (type == EOF) {
+                return false;
+        }
+        event->type = type;
+        event->size = 0;
+        if (unlikely(type > TRACE_EVENT_FREE || !reader_read_varint(&event->object_id, reader->file) ||
+                (type != TRACE_EVENT_FREE && !reader_read_varint(&event->size, reader->file)))) {
+                error(&reader->err, NG5_ERR_CORRUPTED);
+                return false;
+        }
+        reader->num_events++;
+        return true;
+}
+
+bool trace_reader_close(struct trace_reader *reader)
+{
+        error_if_null(reader);
+        fclose(reader->file);
+        return true;
+}
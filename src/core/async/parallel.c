@@ -17,6 +17,11 @@
 
 #include "core/async/parallel.h"
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define PARALLEL_HAS_AVX2
+#endif
+
 NG5_EXPORT(void *)parallel_for_proxy_function(void *args)
 {
         ng5_cast(struct parallel_func_proxy *, proxy_arg, args);
@@ -243,12 +248,195 @@ NG5_EXPORT(bool) parallel_map_exec(void *dst, const void *src, size_t src_width,
         return parallel_for((void *) src, src_width, len, &mapProxy, &mapArgs, hint, num_threads);
 }
 
+/** distance (in elements) at which the kernels below prefetch upcoming source and destination slots */
+#define PARALLEL_PREFETCH_DISTANCE 16
+
+typedef void (*gather_kernel_t)(void *dst, const void *src, const size_t *idx, size_t len);
+typedef void (*scatter_kernel_t)(void *dst, const void *src, const size_t *idx, size_t len);
+typedef void (*shuffle_kernel_t)(void *dst, const void *src, const size_t *dst_idx, const size_t *src_idx,
+        size_t len);
+
+/** Width-specialized kernels for gather, scatter and shuffle. The element width is a compile-time constant in each
+ * kernel such that `memcpy` is lowered to a single (unaligned) load/store, the main loop is unrolled by four and
+ * upcoming random accesses are prefetched `PARALLEL_PREFETCH_DISTANCE` elements ahead. Widths other than 1, 2, 4, 8
+ * and 16 bytes are served by the generic `memcpy` path in the callers. */
+#define DEFINE_GATHER_KERNEL(w)                                                                                        \
+static void gather_kernel_##w(void *dst, const void *src, const size_t *idx, size_t len)                               \
+{                                                                                                                      \
+        size_t i = 0;                                                                                                  \
+        size_t prefetch_end = len > PARALLEL_PREFETCH_DISTANCE ? len - PARALLEL_PREFETCH_DISTANCE : 0;                 \
+        for (; i + 4 <= prefetch_end; i += 4) {                                                                        \
+                prefetch_read(src + idx[i + PARALLEL_PREFETCH_DISTANCE + 0] * w);                                      \
+                prefetch_read(src + idx[i + PARALLEL_PREFETCH_DISTANCE + 1] * w);                                      \
+                prefetch_read(src + idx[i + PARALLEL_PREFETCH_DISTANCE + 2] * w);                                      \
+                prefetch_read(src + idx[i + PARALLEL_PREFETCH_DISTANCE + 3] * w);                                      \
+                memcpy(dst + (i + 0) * w, src + idx[i + 0] * w, w);                                                    \
+                memcpy(dst + (i + 1) * w, src + idx[i + 1] * w, w);                                                    \
+                memcpy(dst + (i + 2) * w, src + idx[i + 2] * w, w);                                                    \
+                memcpy(dst + (i + 3) * w, src + idx[i + 3] * w, w);                                                    \
+        }                                                                                                              \
+        for (; i < len; i++) {                                                                                         \
+                memcpy(dst + i * w, src + idx[i] * w, w);                                                              \
+        }                                                                                                              \
+}
+
+#define DEFINE_SCATTER_KERNEL(w)                                                                                       \
+static void scatter_kernel_##w(void *dst, const void *src, const size_t *idx, size_t len)                              \
+{                                                                                                                      \
+        size_t i = 0;                                                                                                  \
+        size_t prefetch_end = len > PARALLEL_PREFETCH_DISTANCE ? len - PARALLEL_PREFETCH_DISTANCE : 0;                 \
+        for (; i + 4 <= prefetch_end; i += 4) {                                                                        \
+                prefetch_write(dst + idx[i + PARALLEL_PREFETCH_DISTANCE + 0] * w);                                     \
+                prefetch_write(dst + idx[i + PARALLEL_PREFETCH_DISTANCE + 1] * w);                                     \
+                prefetch_write(dst + idx[i + PARALLEL_PREFETCH_DISTANCE + 2] * w);                                     \
+                prefetch_write(dst + idx[i + PARALLEL_PREFETCH_DISTANCE + 3] * w);                                     \
+                memcpy(dst + idx[i + 0] * w, src + (i + 0) * w, w);                                                    \
+                memcpy(dst + idx[i + 1] * w, src + (i + 1) * w, w);                                                    \
+                memcpy(dst + idx[i + 2] * w, src + (i + 2) * w, w);                                                    \
+                memcpy(dst + idx[i + 3] * w, src + (i + 3) * w, w);                                                    \
+        }                                                                                                              \
+        for (; i < len; i++) {                                                                                         \
+                memcpy(dst + idx[i] * w, src + i * w, w);                                                              \
+        }                                                                                                              \
+}
+
+#define DEFINE_SHUFFLE_KERNEL(w)                                                                                       \
+static void shuffle_kernel_##w(void *dst, const void *src, const size_t *dst_idx, const size_t *src_idx, size_t len)  \
+{                                                                                                                      \
+        size_t i = 0;                                                                                                  \
+        size_t prefetch_end = len > PARALLEL_PREFETCH_DISTANCE ? len - PARALLEL_PREFETCH_DISTANCE : 0;                 \
+        for (; i + 4 <= prefetch_end; i += 4) {                                                                        \
+                prefetch_read(src + src_idx[i + PARALLEL_PREFETCH_DISTANCE + 0] * w);                                  \
+                prefetch_read(src + src_idx[i + PARALLEL_PREFETCH_DISTANCE + 1] * w);                                  \
+                prefetch_write(dst + dst_idx[i + PARALLEL_PREFETCH_DISTANCE + 0] * w);                                 \
+                prefetch_write(dst + dst_idx[i + PARALLEL_PREFETCH_DISTANCE + 1] * w);                                 \
+                prefetch_read(src + src_idx[i + PARALLEL_PREFETCH_DISTANCE + 2] * w);                                  \
+                prefetch_read(src + src_idx[i + PARALLEL_PREFETCH_DISTANCE + 3] * w);                                  \
+                prefetch_write(dst + dst_idx[i + PARALLEL_PREFETCH_DISTANCE + 2] * w);                                 \
+                prefetch_write(dst + dst_idx[i + PARALLEL_PREFETCH_DISTANCE + 3] * w);                                 \
+                memcpy(dst + dst_idx[i + 0] * w, src + src_idx[i + 0] * w, w);                                         \
+                memcpy(dst + dst_idx[i + 1] * w, src + src_idx[i + 1] * w, w);                                         \
+                memcpy(dst + dst_idx[i + 2] * w, src + src_idx[i + 2] * w, w);                                         \
+                memcpy(dst + dst_idx[i + 3] * w, src + src_idx[i + 3] * w, w);                                         \
+        }                                                                                                              \
+        for (; i < len; i++) {                                                                                         \
+                memcpy(dst + dst_idx[i] * w, src + src_idx[i] * w, w);                                                 \
+        }                                                                                                              \
+}
+
+DEFINE_GATHER_KERNEL(1)
+DEFINE_GATHER_KERNEL(2)
+DEFINE_GATHER_KERNEL(4)
+DEFINE_GATHER_KERNEL(8)
+DEFINE_GATHER_KERNEL(16)
+
+DEFINE_SCATTER_KERNEL(1)
+DEFINE_SCATTER_KERNEL(2)
+DEFINE_SCATTER_KERNEL(4)
+DEFINE_SCATTER_KERNEL(8)
+DEFINE_SCATTER_KERNEL(16)
+
+DEFINE_SHUFFLE_KERNEL(1)
+DEFINE_SHUFFLE_KERNEL(2)
+DEFINE_SHUFFLE_KERNEL(4)
+DEFINE_SHUFFLE_KERNEL(8)
+DEFINE_SHUFFLE_KERNEL(16)
+
+#ifdef PARALLEL_HAS_AVX2
+
+/** AVX2 gather kernels for 4 and 8 byte wide elements. Four 64-bit indices are loaded at once and resolved by a
+ * single `vpgatherqd` resp. `vpgatherqq`. Indices are interpreted as signed 64-bit integers by the hardware, which is
+ * not a restriction for any array that fits into the address space. */
+__attribute__((target("avx2")))
+static void gather_kernel_4_avx2(void *dst, const void *src, const size_t *idx, size_t len)
+{
+        size_t i = 0;
+        for (; i + 8 <= len; i += 8) {
+                __m256i lo = _mm256_loadu_si256((const __m256i *) (idx + i));
+                __m256i hi = _mm256_loadu_si256((const __m256i *) (idx + i + 4));
+                __m128i vlo = _mm256_i64gather_epi32((const int *) src, lo, 4);
+                __m128i vhi = _mm256_i64gather_epi32((const int *) src, hi, 4);
+                _mm_storeu_si128((__m128i *) (dst + (i + 0) * 4), vlo);
+                _mm_storeu_si128((__m128i *) (dst + (i + 4) * 4), vhi);
+        }
+        gather_kernel_4(dst + i * 4, src, idx + i, len - i);
+}
+
+__attribute__((target("avx2")))
+static void gather_kernel_8_avx2(void *dst, const void *src, const size_t *idx, size_t len)
+{
+        size_t i = 0;
+        for (; i + 8 <= len; i += 8) {
+                __m256i lo = _mm256_loadu_si256((const __m256i *) (idx + i));
+                __m256i hi = _mm256_loadu_si256((const __m256i *) (idx + i + 4));
+                __m256i vlo = _mm256_i64gather_epi64((const long long *) src, lo, 8);
+                __m256i vhi = _mm256_i64gather_epi64((const long long *) src, hi, 8);
+                _mm256_storeu_si256((__m256i *) (dst + (i + 0) * 8), vlo);
+                _mm256_storeu_si256((__m256i *) (dst + (i + 4) * 8), vhi);
+        }
+        gather_kernel_8(dst + i * 8, src, idx + i, len - i);
+}
+
+static bool has_avx2()
+{
+        return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+static gather_kernel_t gather_kernel_for(size_t width)
+{
+        switch (width) {
+        case 1:  return gather_kernel_1;
+        case 2:  return gather_kernel_2;
+#ifdef PARALLEL_HAS_AVX2
+        case 4:  return has_avx2() ? gather_kernel_4_avx2 : gather_kernel_4;
+        case 8:  return has_avx2() ? gather_kernel_8_avx2 : gather_kernel_8;
+#else
+        case 4:  return gather_kernel_4;
+        case 8:  return gather_kernel_8;
+#endif
+        case 16: return gather_kernel_16;
+        default: return NULL;
+        }
+}
+
+static scatter_kernel_t scatter_kernel_for(size_t width)
+{
+        switch (width) {
+        case 1:  return scatter_kernel_1;
+        case 2:  return scatter_kernel_2;
+        case 4:  return scatter_kernel_4;
+        case 8:  return scatter_kernel_8;
+        case 16: return scatter_kernel_16;
+        default: return NULL;
+        }
+}
+
+static shuffle_kernel_t shuffle_kernel_for(size_t width)
+{
+        switch (width) {
+        case 1:  return shuffle_kernel_1;
+        case 2:  return shuffle_kernel_2;
+        case 4:  return shuffle_kernel_4;
+        case 8:  return shuffle_kernel_8;
+        case 16: return shuffle_kernel_16;
+        default: return NULL;
+        }
+}
+
 void gather_function(const void *start, size_t width, size_t len, void *args, thread_id_t tid)
 {
         ng5_unused(tid);
         ng5_cast(struct gather_scatter_args *, gather_args, args);
         size_t global_index_start = (start - gather_args->dst) / width;
 
+        gather_kernel_t kernel = gather_kernel_for(width);
+        if (likely(kernel != NULL)) {
+                kernel((void *) start, gather_args->src, gather_args->idx + global_index_start, len);
+                return;
+        }
+
         prefetch_write(gather_args->dst);
         prefetch_write(gather_args->idx);
         prefetch_read((len > 0) ? gather_args->src + gather_args->idx[0] * width : NULL);
@@ -279,6 +467,12 @@ NG5_EXPORT(bool) parallel_sequential_gather(void *dst, const void *src, size_t w
         prefetch_read(idx);
         prefetch_write(dst);
 
+        gather_kernel_t kernel = gather_kernel_for(width);
+        if (likely(kernel != NULL)) {
+                kernel(dst, src, idx, dst_src_len);
+                return true;
+        }
+
         prefetch_read(idx);
         prefetch_write(dst);
         prefetch_read((dst_src_len > 0) ? src + idx[0] * width : NULL);
@@ -390,6 +584,14 @@ void parallel_scatter_func(const void *start, size_t width, size_t len, void *ar
         prefetch_write((len > 0) ? scatter_args->dst + scatter_args->idx[0] * width : NULL);
 
         size_t global_index_start = (start - scatter_args->dst) / width;
+
+        scatter_kernel_t kernel = scatter_kernel_for(width);
+        if (likely(kernel != NULL)) {
+                kernel(scatter_args->dst, scatter_args->src + global_index_start * width,
+                        scatter_args->idx + global_index_start, len);
+                return;
+        }
+
         for (register size_t i = 0, next_i = 1; i < len; next_i = ++i + 1) {
                 size_t global_index_cur = global_index_start + i;
                 size_t global_index_next = global_index_start + next_i;
@@ -413,6 +615,12 @@ NG5_EXPORT(bool) parallel_sequential_scatter_func(void *dst, const void *src, si
         error_if_null(idx)
         error_if_null(width)
 
+        scatter_kernel_t kernel = scatter_kernel_for(width);
+        if (likely(kernel != NULL)) {
+                kernel(dst, src, idx, num);
+                return true;
+        }
+
         prefetch_read(idx);
         prefetch_read(src);
         prefetch_write((num > 0) ? dst + idx[0] * width : NULL);
@@ -453,6 +661,12 @@ NG5_EXPORT(bool) parallel_sequential_shuffle(void *dst, const void *src, size_t
         error_if_null(src_idx)
         error_if_null(width)
 
+        shuffle_kernel_t kernel = shuffle_kernel_for(width);
+        if (likely(kernel != NULL)) {
+                kernel(dst, src, dst_idx, src_idx, idx_len);
+                return true;
+        }
+
         bool has_first = (idx_len > 0);
         prefetch_read(src_idx);
         prefetch_read(dst_idx);
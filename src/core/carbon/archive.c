@@ -15,10 +15,13 @@
  * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <ctype.h>
 #include <inttypes.h>
+#include <math.h>
 
 #include "core/oid/oid.h"
 #include "core/encode/encode_async.h"
+#include "core/encode/encode_concurrent.h"
 #include "core/pack/pack.h"
 #include "core/carbon/archive_strid_iter.h"
 #include "core/carbon/archive_int.h"
@@ -31,6 +34,7 @@
 #include "core/mem/block.h"
 #include "core/mem/file.h"
 #include "coding/coding_huffman.h"
+#include "std/bloom.h"
 #include "core/carbon/archive.h"
 
 #define WRITE_PRIMITIVE_VALUES(memfile, values_vec, type)                                                              \
@@ -127,12 +131,24 @@ static offset_t skip_record_header(struct memfile *memfile);
 static void update_record_header(struct memfile *memfile, offset_t root_object_header_offset, struct columndoc *model,
         u64 record_size);
 static bool __serialize(offset_t *offset, struct err *err, struct memfile *memfile, struct columndoc_obj *columndoc,
-        offset_t root_object_header_offset);
+        offset_t root_object_header_offset, offset_t base_off);
 static union object_flags *get_flags(union object_flags *flags, struct columndoc_obj *columndoc);
 static void update_file_header(struct memfile *memfile, offset_t root_object_header_offset);
 static void skip_file_header(struct memfile *memfile);
-static bool serialize_string_dic(struct memfile *memfile, struct err *err, const struct doc_bulk *context,
+static bool serialize_string_dic(struct memfile *memfile, struct err *err, const struct columndoc *model,
         enum packer_type compressor);
+static bool write_string_table(struct memfile *memfile, struct err *err,
+        const struct vector ofType (const char *) *strings, const struct vector ofType(field_sid_t) *string_ids,
+        enum packer_type compressor);
+static bool write_column_group(struct memfile *memfile, struct err *err,
+        const struct vector ofType(struct columndoc_column) *columns, u32 num_objects, bool is_row_group,
+        offset_t root_object_header_offset, offset_t base_off);
+static void split_row_groups(struct vector ofType(struct columndoc_column) *row_groups, u32 num_row_groups,
+        u32 rows_per_group, const struct columndoc_group *column_group);
+static void drop_row_groups(struct vector ofType(struct columndoc_column) *row_groups, u32 num_row_groups);
+static void propOffsetsWrite(struct memfile *memfile, const union object_flags *flags,
+        struct archive_prop_offs *prop_offsets);
+static u32 flags_to_int32(union object_flags *flags);
 static bool print_archive_from_memfile(FILE *file, struct err *err, struct memfile *memfile);
 
 NG5_EXPORT(bool) archive_from_json(struct archive *out, const char *file, struct err *err, const char *json_string,
@@ -196,6 +212,39 @@ NG5_EXPORT(bool) archive_from_json(struct archive *out, const char *file, struct
         return true;
 }
 
+static bool create_string_dic(struct strdic *dic, struct err *err, enum strdic_tag dictionary,
+        size_t num_async_dic_threads)
+{
+        if (dictionary == SYNC) {
+                encode_sync_create(dic, 1000, 1000, 1000, 0, NULL);
+        } else if (dictionary == ASYNC) {
+                encode_async_create(dic, 1000, 1000, 1000, num_async_dic_threads, NULL);
+        } else if (dictionary == CONCURRENT) {
+                encode_concurrent_create(dic, 1000, NULL);
+        } else {
+                error(err, NG5_ERR_UNKNOWN_DIC_TYPE);
+                return false;
+        }
+        return true;
+}
+
+static void set_json_parse_error(struct err *err, const struct json_err *error_desc)
+{
+        char buffer[2048];
+        if (error_desc->token) {
+                sprintf(buffer,
+                        "%s. Token %s was found in line %u column %u",
+                        error_desc->msg,
+                        error_desc->token_type_str,
+                        error_desc->token->line,
+                        error_desc->token->column);
+                error_with_details(err, NG5_ERR_JSONPARSEERR, &buffer[0]);
+        } else {
+                sprintf(buffer, "%s", error_desc->msg);
+                error_with_details(err, NG5_ERR_JSONPARSEERR, &buffer[0]);
+        }
+}
+
 NG5_EXPORT(bool) archive_stream_from_json(struct memblock **stream, struct err *err, const char *json_string,
         enum packer_type compressor, enum strdic_tag dictionary, size_t num_async_dic_threads, bool read_optimized,
         bool bake_id_index, struct archive_callback *callback)
@@ -215,32 +264,15 @@ NG5_EXPORT(bool) archive_stream_from_json(struct memblock **stream, struct err *
         ng5_optional_call(callback, begin_archive_stream_from_json)
 
         ng5_optional_call(callback, begin_setup_string_dictionary);
-        if (dictionary == SYNC) {
-                encode_sync_create(&dic, 1000, 1000, 1000, 0, NULL);
-        } else if (dictionary == ASYNC) {
-                encode_async_create(&dic, 1000, 1000, 1000, num_async_dic_threads, NULL);
-        } else {
-                error(err, NG5_ERR_UNKNOWN_DIC_TYPE);
+        if (!create_string_dic(&dic, err, dictionary, num_async_dic_threads)) {
+                return false;
         }
-
         ng5_optional_call(callback, end_setup_string_dictionary);
 
         ng5_optional_call(callback, begin_parse_json);
         json_parser_create(&parser, &bulk);
         if (!(json_parse(&json, &error_desc, &parser, json_string))) {
-                char buffer[2048];
-                if (error_desc.token) {
-                        sprintf(buffer,
-                                "%s. Token %s was found in line %u column %u",
-                                error_desc.msg,
-                                error_desc.token_type_str,
-                                error_desc.token->line,
-                                error_desc.token->column);
-                        error_with_details(err, NG5_ERR_JSONPARSEERR, &buffer[0]);
-                } else {
-                        sprintf(buffer, "%s", error_desc.msg);
-                        error_with_details(err, NG5_ERR_JSONPARSEERR, &buffer[0]);
-                }
+                set_json_parse_error(err, &error_desc);
                 return false;
         }
         ng5_optional_call(callback, end_parse_json);
@@ -265,6 +297,10 @@ NG5_EXPORT(bool) archive_stream_from_json(struct memblock **stream, struct err *
         doc_bulk_shrink(&bulk);
 
         columndoc = doc_entries_columndoc(&bulk, partition, read_optimized);
+        if (read_optimized) {
+                /** ids that compare like the strings they refer to allow to evaluate string predicates on ids */
+                columndoc_order_string_ids(columndoc);
+        }
 
         if (!archive_from_model(stream, err, columndoc, compressor, bake_id_index, callback)) {
                 return false;
@@ -285,9 +321,65 @@ NG5_EXPORT(bool) archive_stream_from_json(struct memblock **stream, struct err *
         return true;
 }
 
-static bool run_string_id_baking(struct err *err, struct memblock **stream)
+/** appends a string id to offset index to the archive file <code>file_name</code>, and links it in the file header */
+static bool append_string_id_index(struct err *err, const char *file_name)
 {
         struct archive archive;
+        FILE *file;
+
+        if (!archive_open(&archive, file_name)) {
+                error(err, NG5_ERR_ARCHIVEOPEN);
+                return false;
+        }
+
+        bool has_index;
+        archive_has_query_index_string_id_to_offset(&has_index, &archive);
+        if (has_index) {
+                error(err, NG5_ERR_INTERNALERR);
+                archive_close(&archive);
+                return false;
+        }
+
+        struct sid_to_offset *index;
+        struct archive_query query;
+        query_create(&query, &archive);
+        query_create_index_string_id_to_offset(&index, &query);
+        query_drop(&query);
+        archive_close(&archive);
+
+        if ((file = fopen(file_name, "rb+")) == NULL) {
+                error(err, NG5_ERR_TMP_FOPENWRITE);
+                query_drop_index_string_id_to_offset(index);
+                return false;
+        }
+
+        fseek(file, 0, SEEK_END);
+        offset_t index_pos = ftell(file);
+        query_index_id_to_offset_serialize(file, err, index);
+        fseek(file, 0, SEEK_SET);
+        query_drop_index_string_id_to_offset(index);
+
+        struct archive_header header;
+        size_t nread = fread(&header, sizeof(struct archive_header), 1, file);
+        if (nread != 1) {
+                fclose(file);
+                error(err, NG5_ERR_FREAD_FAILED);
+                return false;
+        }
+        header.string_id_to_offset_index_offset = index_pos;
+        fseek(file, 0, SEEK_SET);
+        int nwrite = fwrite(&header, sizeof(struct archive_header), 1, file);
+        fclose(file);
+        if (nwrite != 1) {
+                error(err, NG5_ERR_FWRITE_FAILED);
+                return false;
+        }
+
+        return true;
+}
+
+static bool run_string_id_baking(struct err *err, struct memblock **stream)
+{
         char tmp_file_name[512];
         object_id_t rand_part;
         object_id_create(&rand_part);
@@ -311,51 +403,25 @@ static bool run_string_id_baking(struct err *err, struct memblock **stream)
         fflush(tmp_file);
         fclose(tmp_file);
 
-        if (!archive_open(&archive, tmp_file_name)) {
-                error(err, NG5_ERR_ARCHIVEOPEN);
-                return false;
-        }
-
-        bool has_index;
-        archive_has_query_index_string_id_to_offset(&has_index, &archive);
-        if (has_index) {
-                error(err, NG5_ERR_INTERNALERR);
+        if (!append_string_id_index(err, tmp_file_name)) {
                 remove(tmp_file_name);
                 return false;
         }
 
-        struct sid_to_offset *index;
-        struct archive_query query;
-        query_create(&query, &archive);
-        query_create_index_string_id_to_offset(&index, &query);
-        query_drop(&query);
-        archive_close(&archive);
-
-        if ((tmp_file = fopen(tmp_file_name, "rb+")) == NULL) {
+        if ((tmp_file = fopen(tmp_file_name, "rb")) == NULL) {
                 error(err, NG5_ERR_TMP_FOPENWRITE);
+                remove(tmp_file_name);
                 return false;
         }
 
         fseek(tmp_file, 0, SEEK_END);
-        offset_t index_pos = ftell(tmp_file);
-        query_index_id_to_offset_serialize(tmp_file, err, index);
         offset_t file_length = ftell(tmp_file);
         fseek(tmp_file, 0, SEEK_SET);
 
-        struct archive_header header;
-        size_t nread = fread(&header, sizeof(struct archive_header), 1, tmp_file);
-        error_if(nread != 1, err, NG5_ERR_FREAD_FAILED);
-        header.string_id_to_offset_index_offset = index_pos;
-        fseek(tmp_file, 0, SEEK_SET);
-        int nwrite = fwrite(&header, sizeof(struct archive_header), 1, tmp_file);
-        error_if(nwrite != 1, err, NG5_ERR_FWRITE_FAILED);
-        fseek(tmp_file, 0, SEEK_SET);
-
-        query_drop_index_string_id_to_offset(index);
-
         memblock_drop(*stream);
         memblock_from_file(stream, tmp_file, file_length);
 
+        fclose(tmp_file);
         remove(tmp_file_name);
 
         return true;
@@ -376,7 +442,7 @@ bool archive_from_model(struct memblock **stream, struct err *err, struct column
 
         ng5_optional_call(callback, begin_write_string_table);
         skip_file_header(&memfile);
-        if (!serialize_string_dic(&memfile, err, model->bulk, compressor)) {
+        if (!serialize_string_dic(&memfile, err, model, compressor)) {
                 return false;
         }
         ng5_optional_call(callback, end_write_string_table);
@@ -385,7 +451,7 @@ bool archive_from_model(struct memblock **stream, struct err *err, struct column
         offset_t record_header_offset = skip_record_header(&memfile);
         update_file_header(&memfile, record_header_offset);
         offset_t root_object_header_offset = memfile_tell(&memfile);
-        if (!__serialize(NULL, err, &memfile, &model->columndoc, root_object_header_offset)) {
+        if (!__serialize(NULL, err, &memfile, &model->columndoc, root_object_header_offset, 0)) {
                 return false;
         }
         u64 record_size = memfile_tell(&memfile) - (record_header_offset + sizeof(struct record_header));
@@ -410,6 +476,398 @@ bool archive_from_model(struct memblock **stream, struct err *err, struct column
         return true;
 }
 
+/** State of an NDJSON conversion. Row groups are written to <code>record_table</code> as soon as their batch is
+ * complete, and only their keys and offsets are kept in memory. */
+struct ndjson_writer {
+        struct strdic dic;
+        field_sid_t root_key;                                   /** string id of the object array "/" */
+        struct vector ofType(char) text;                        /** JSON array of the documents of the current batch */
+        u32 num_docs;                                           /** number of documents in <code>text</code> */
+        struct memblock *batch;                                 /** row groups of the current batch */
+        FILE *record_table;                                     /** row groups of all batches written so far */
+        offset_t record_table_off;                              /** offset of the next row group in the record */
+        struct vector ofType(field_sid_t) group_keys;
+        struct vector ofType(offset_t) group_offsets;
+};
+
+/** offset of the first row group relative to the root object header, which is followed by the offset of the object
+ * array, the (nil) offset of the next object, and the object array header */
+#define NDJSON_FIRST_ROW_GROUP_OFF                                                                                     \
+        (sizeof(struct object_header) + 2 * sizeof(offset_t) + sizeof(struct object_array_stream_header))
+
+static bool ndjson_writer_create(struct ndjson_writer *writer, struct err *err, enum strdic_tag dictionary,
+        size_t num_async_dic_threads)
+{
+        if (!create_string_dic(&writer->dic, err, dictionary, num_async_dic_threads)) {
+                return false;
+        }
+        if ((writer->record_table = tmpfile()) == NULL) {
+                error(err, NG5_ERR_TMP_FOPENWRITE);
+                strdic_drop(&writer->dic);
+                return false;
+        }
+
+        field_sid_t *root_key_id;
+        char *root_key = "/";
+        strdic_insert(&writer->dic, &root_key_id, &root_key, 1, 0);
+        writer->root_key = *root_key_id;
+        strdic_free(&writer->dic, root_key_id);
+
+        vec_create(&writer->text, NULL, sizeof(char), 1024 * 1024);
+        writer->num_docs = 0;
+        memblock_create(&writer->batch, 1024 * 1024);
+        writer->record_table_off = NDJSON_FIRST_ROW_GROUP_OFF;
+        vec_create(&writer->group_keys, NULL, sizeof(field_sid_t), 64);
+        vec_create(&writer->group_offsets, NULL, sizeof(offset_t), 64);
+        return true;
+}
+
+static void ndjson_writer_drop(struct ndjson_writer *writer)
+{
+        strdic_drop(&writer->dic);
+        fclose(writer->record_table);
+        vec_drop(&writer->text);
+        memblock_drop(writer->batch);
+        vec_drop(&writer->group_keys);
+        vec_drop(&writer->group_offsets);
+}
+
+/** reads lines from <code>ndjson</code> into a JSON array until a batch limit is reached or the input is exhausted;
+ * lines that only contain white space are skipped */
+static bool ndjson_read_batch(struct ndjson_writer *writer, bool *eof, struct err *err, FILE *ndjson,
+        u32 batch_docs, size_t batch_bytes)
+{
+        char chunk[4096];
+
+        vec_clear(&writer->text);
+        vec_push(&writer->text, "[", 1);
+        writer->num_docs = 0;
+
+        /* a batch holds at least one document, even if that exceeds batch_bytes */
+        while (writer->num_docs == 0 || (writer->num_docs < batch_docs && vec_length(&writer->text) < batch_bytes)) {
+                size_t line_begin = vec_length(&writer->text);
+                bool has_line = false, is_blank = true;
+                if (writer->num_docs > 0) {
+                        vec_push(&writer->text, ",", 1);
+                }
+                while (fgets(chunk, sizeof(chunk), ndjson)) {
+                        size_t len = strlen(chunk);
+                        has_line = true;
+                        for (size_t i = 0; is_blank && i < len; i++) {
+                                is_blank = isspace((unsigned char) chunk[i]);
+                        }
+                        vec_push(&writer->text, chunk, len);
+                        if (len > 0 && chunk[len - 1] == '\n') {
+                                break;
+                        }
+                }
+                if (is_blank) {
+                        writer->text.num_elems = line_begin;
+                } else {
+                        writer->num_docs++;
+                }
+                if (!has_line) {
+                        *eof = true;
+                        break;
+                }
+        }
+        vec_push(&writer->text, "]", 2);
+
+        if (ferror(ndjson)) {
+                error(err, NG5_ERR_FREAD_FAILED);
+                return false;
+        }
+        return true;
+}
+
+/** writes the documents of the current batch as row groups of at most <code>NG5_ROW_GROUP_SIZE</code> objects */
+static bool ndjson_write_row_groups(struct ndjson_writer *writer, struct err *err, const struct columndoc *columndoc)
+{
+        const struct vector ofType(struct columndoc_group) *arrays = &columndoc->columndoc.obj_array_props;
+        assert(arrays->num_elems <= 1);
+
+        u32 num_row_groups = (writer->num_docs + NG5_ROW_GROUP_SIZE - 1) / NG5_ROW_GROUP_SIZE;
+        struct vector ofType(struct columndoc_column) *row_groups = malloc(num_row_groups * sizeof(struct vector));
+        if (!row_groups) {
+                error(err, NG5_ERR_MALLOCERR)
+                return false;
+        }
+        if (arrays->num_elems > 0) {
+                const struct columndoc_group *array = vec_get(arrays, 0, struct columndoc_group);
+                assert(array->key == writer->root_key);
+                split_row_groups(row_groups, num_row_groups, NG5_ROW_GROUP_SIZE, array);
+        } else {
+                /* a batch of empty objects has no columns */
+                for (u32 i = 0; i < num_row_groups; i++) {
+                        vec_create(&row_groups[i], NULL, sizeof(struct columndoc_column), 1);
+                }
+        }
+
+        /* the batch starts batch_off bytes after the root object header, which is not part of the batch */
+        offset_t batch_off = writer->record_table_off;
+        struct memfile memfile;
+        memfile_open(&memfile, writer->batch, READ_WRITE);
+
+        bool status = true;
+        for (u32 i = 0; status && i < num_row_groups; i++) {
+                offset_t row_group_off = batch_off + memfile_tell(&memfile);
+                u32 num_objects = ng5_min(NG5_ROW_GROUP_SIZE, writer->num_docs - i * NG5_ROW_GROUP_SIZE);
+                vec_push(&writer->group_keys, &writer->root_key, 1);
+                vec_push(&writer->group_offsets, &row_group_off, 1);
+                status = write_column_group(&memfile, err, &row_groups[i], num_objects, true, 0, batch_off);
+        }
+
+        drop_row_groups(row_groups, num_row_groups);
+        free(row_groups);
+
+        if (status) {
+                size_t batch_size = memfile_tell(&memfile);
+                if (fwrite(memblock_raw_data(writer->batch), 1, batch_size, writer->record_table) != batch_size) {
+                        error(err, NG5_ERR_FWRITE_FAILED);
+                        return false;
+                }
+                writer->record_table_off += batch_size;
+        }
+        return status;
+}
+
+static bool ndjson_flush_batch(struct ndjson_writer *writer, struct err *err)
+{
+        struct json_parser parser;
+        struct json_err error_desc;
+        struct doc_bulk bulk;
+        struct doc_entries *partition;
+        struct columndoc *columndoc;
+        struct json json;
+
+        json_parser_create(&parser, &bulk);
+        if (!(json_parse(&json, &error_desc, &parser, vec_data(&writer->text)))) {
+                set_json_parse_error(err, &error_desc);
+                return false;
+        }
+        if (!json_test(err, &json)) {
+                json_drop(&json);
+                return false;
+        }
+
+        if (!doc_bulk_create(&bulk, &writer->dic)) {
+                error(err, NG5_ERR_BULKCREATEFAILED);
+                json_drop(&json);
+                return false;
+        }
+        partition = doc_bulk_new_entries(&bulk);
+        if (!doc_bulk_add_json(partition, &json)) {
+                error(err, NG5_ERR_JSONTYPE);
+                json_drop(&json);
+                doc_bulk_Drop(&bulk);
+                doc_entries_drop(partition);
+                return false;
+        }
+        json_drop(&json);
+
+        /* a batch of a single document is still a row group of the object array "/" */
+        columndoc = doc_entries_columndoc_array(&bulk, partition, false);
+        bool status = ndjson_write_row_groups(writer, err, columndoc);
+
+        doc_bulk_Drop(&bulk);
+        doc_entries_drop(partition);
+        columndoc_free(columndoc);
+        free(columndoc);
+        return status;
+}
+
+static bool ndjson_write_head(struct memfile *memfile, struct err *err, struct ndjson_writer *writer,
+        enum packer_type compressor, struct archive_callback *callback)
+{
+        ng5_optional_call(callback, begin_write_string_table);
+        size_t num_strings;
+        strdic_num_distinct(&num_strings, &writer->dic);
+        struct vector ofType (const char *) strings;
+        struct vector ofType(field_sid_t) string_ids;
+        vec_create(&strings, NULL, sizeof(const char *), num_strings);
+        vec_create(&string_ids, NULL, sizeof(field_sid_t), num_strings);
+        strdic_get_contents(&strings, &string_ids, &writer->dic);
+
+        skip_file_header(memfile);
+        bool status = write_string_table(memfile, err, &strings, &string_ids, compressor);
+        vec_drop(&strings);
+        vec_drop(&string_ids);
+        if (!status) {
+                return false;
+        }
+        ng5_optional_call(callback, end_write_string_table);
+
+        offset_t record_header_offset = skip_record_header(memfile);
+        update_file_header(memfile, record_header_offset);
+        offset_t root_object_header_offset = memfile_tell(memfile);
+
+        u32 num_groups = vec_length(&writer->group_keys);
+        union object_flags flags = {.value = 0};
+        flags.bits.has_object_array_props = num_groups > 0;
+
+        object_id_t oid;
+        if (!object_id_create(&oid)) {
+                error(err, NG5_ERR_THREADOOOBJIDS);
+                return false;
+        }
+        struct object_header header = {.marker = marker_symbols[MARKER_TYPE_OBJECT_BEGIN].symbol, .oid = oid, .flags =
+                flags_to_int32(&flags)};
+        memfile_write(memfile, &header, sizeof(struct object_header));
+
+        offset_t default_next_nil = 0;
+        u64 record_size;
+        if (num_groups > 0) {
+                struct archive_prop_offs prop_offsets = {.object_arrays = sizeof(struct object_header)
+                        + 2 * sizeof(offset_t)};
+                propOffsetsWrite(memfile, &flags, &prop_offsets);
+                memfile_write(memfile, &default_next_nil, sizeof(offset_t));
+
+                struct object_array_stream_header array_header =
+                        {.marker = marker_symbols[MARKER_TYPE_PROP_OBJECT_ARRAY_STREAM].symbol, .num_entries =
+                                num_groups, .directory_off = writer->record_table_off};
+                memfile_write(memfile, &array_header, sizeof(struct object_array_stream_header));
+                assert(memfile_tell(memfile) - root_object_header_offset == NDJSON_FIRST_ROW_GROUP_OFF);
+
+                record_size = writer->record_table_off + num_groups * (sizeof(field_sid_t) + sizeof(offset_t)) + 1;
+        } else {
+                memfile_write(memfile, &default_next_nil, sizeof(offset_t));
+                record_size = memfile_tell(memfile) - root_object_header_offset + 1;
+        }
+
+        struct record_header record_header =
+                {.marker = MARKER_SYMBOL_RECORD_HEADER, .flags = 0, .record_size = record_size};
+        offset_t continue_pos = memfile_tell(memfile);
+        memfile_seek(memfile, record_header_offset);
+        memfile_write(memfile, &record_header, sizeof(struct record_header));
+        memfile_seek(memfile, continue_pos);
+        return true;
+}
+
+/** writes the file header, string table and root object, followed by the spilled row groups, their directory and the
+ * end of the root object */
+static bool ndjson_write_archive(struct ndjson_writer *writer, struct err *err, const char *file,
+        enum packer_type compressor, struct archive_callback *callback)
+{
+        struct memblock *head;
+        struct memfile memfile;
+        FILE *out_file;
+        bool status;
+
+        memblock_create(&head, 1024 * 1024);
+        memfile_open(&memfile, head, READ_WRITE);
+        if (!ndjson_write_head(&memfile, err, writer, compressor, callback)) {
+                memblock_drop(head);
+                return false;
+        }
+
+        ng5_optional_call(callback, begin_write_archive_file_to_disk);
+        if ((out_file = fopen(file, "w")) == NULL) {
+                error(err, NG5_ERR_FOPENWRITE);
+                memblock_drop(head);
+                return false;
+        }
+
+        size_t head_size = memfile_tell(&memfile);
+        status = fwrite(memblock_raw_data(head), 1, head_size, out_file) == head_size;
+        memblock_drop(head);
+
+        size_t num_groups = vec_length(&writer->group_keys);
+        if (status && num_groups > 0) {
+                char *buffer = malloc(1024 * 1024);
+                size_t nread;
+                if (!buffer) {
+                        error(err, NG5_ERR_MALLOCERR);
+                        fclose(out_file);
+                        return false;
+                }
+                rewind(writer->record_table);
+                while (status && (nread = fread(buffer, 1, 1024 * 1024, writer->record_table)) > 0) {
+                        status = fwrite(buffer, 1, nread, out_file) == nread;
+                }
+                free(buffer);
+                status = status && fwrite(vec_data(&writer->group_keys), sizeof(field_sid_t), num_groups, out_file)
+                        == num_groups;
+                status = status && fwrite(vec_data(&writer->group_offsets), sizeof(offset_t), num_groups, out_file)
+                        == num_groups;
+        }
+        status = status && fwrite(&marker_symbols[MARKER_TYPE_OBJECT_END].symbol, 1, 1, out_file) == 1;
+
+        fclose(out_file);
+        if (!status) {
+                error(err, NG5_ERR_FWRITE_FAILED);
+                return false;
+        }
+        ng5_optional_call(callback, end_write_archive_file_to_disk);
+        return true;
+}
+
+NG5_EXPORT(bool) archive_from_ndjson(struct archive *out, const char *file, struct err *err, FILE *ndjson,
+        enum packer_type compressor, enum strdic_tag dictionary, size_t num_async_dic_threads, u32 batch_docs,
+        size_t batch_bytes, bool bake_string_id_index, struct archive_callback *callback)
+{
+        error_if_null(out);
+        error_if_null(file);
+        error_if_null(err);
+        error_if_null(ndjson);
+
+        if (batch_docs == 0 || batch_bytes == 0) {
+                error(err, NG5_ERR_ILLEGALARG);
+                return false;
+        }
+
+        struct ndjson_writer writer;
+        bool eof = false;
+        bool status;
+
+        ng5_optional_call(callback, begin_create_from_json);
+
+        ng5_optional_call(callback, begin_setup_string_dictionary);
+        if (!ndjson_writer_create(&writer, err, dictionary, num_async_dic_threads)) {
+                return false;
+        }
+        ng5_optional_call(callback, end_setup_string_dictionary);
+
+        ng5_optional_call(callback, begin_import_json);
+        do {
+                status = ndjson_read_batch(&writer, &eof, err, ndjson, batch_docs, batch_bytes);
+                if (status && writer.num_docs > 0) {
+                        status = ndjson_flush_batch(&writer, err);
+                }
+        } while (status && !eof);
+        ng5_optional_call(callback, end_import_json);
+
+        status = status && ndjson_write_archive(&writer, err, file, compressor, callback);
+
+        ng5_optional_call(callback, begin_cleanup);
+        ndjson_writer_drop(&writer);
+        ng5_optional_call(callback, end_cleanup);
+
+        if (!status) {
+                return false;
+        }
+
+        if (bake_string_id_index) {
+                ng5_optional_call(callback, begin_string_id_index_baking);
+                if (!append_string_id_index(err, file)) {
+                        return false;
+                }
+                ng5_optional_call(callback, end_string_id_index_baking);
+        } else {
+                ng5_optional_call(callback, skip_string_id_index_baking);
+        }
+
+        ng5_optional_call(callback, begin_load_archive);
+        if (!archive_open(out, file)) {
+                error(err, NG5_ERR_ARCHIVEOPEN);
+                return false;
+        }
+        ng5_optional_call(callback, end_load_archive);
+
+        ng5_optional_call(callback, end_create_from_json);
+
+        return true;
+}
+
 NG5_EXPORT(struct io_context *)archive_io_context_create(struct archive *archive)
 {
         error_if_null(archive);
@@ -552,14 +1010,14 @@ static bool write_primitive_fixed_value_column(struct memfile *memfile, struct e
 }
 
 static offset_t *__write_primitive_column(struct memfile *memfile, struct err *err,
-        struct vector ofType(struct columndoc_obj) *values_vec, offset_t root_offset)
+        struct vector ofType(struct columndoc_obj) *values_vec, offset_t root_offset, offset_t base_off)
 {
         offset_t *result = malloc(values_vec->num_elems * sizeof(offset_t));
         struct columndoc_obj *mapped = vec_all(values_vec, struct columndoc_obj);
         for (u32 i = 0; i < values_vec->num_elems; i++) {
                 struct columndoc_obj *obj = mapped + i;
-                result[i] = memfile_tell(memfile) - root_offset;
-                if (!__serialize(NULL, err, memfile, obj, root_offset)) {
+                result[i] = memfile_tell(memfile) - root_offset + base_off;
+                if (!__serialize(NULL, err, memfile, obj, root_offset, base_off)) {
                         return NULL;
                 }
         }
@@ -636,7 +1094,7 @@ static bool write_array_value_column(struct memfile *memfile, struct err *err, f
 
 static bool write_array_prop(offset_t *offset, struct err *err, struct memfile *memfile,
         struct vector ofType(field_sid_t) *keys, field_e type, struct vector ofType(...) *values,
-        offset_t root_object_header_offset)
+        offset_t root_object_header_offset, offset_t base_off)
 {
         assert(keys->num_elems == values->num_elems);
 
@@ -654,7 +1112,7 @@ static bool write_array_prop(offset_t *offset, struct err *err, struct memfile *
                 if (!write_array_value_column(memfile, err, type, values)) {
                         return false;
                 }
-                *offset = (prop_ofOffset - root_object_header_offset);
+                *offset = (prop_ofOffset - root_object_header_offset + base_off);
         } else {
                 *offset = 0;
         }
@@ -662,7 +1120,7 @@ static bool write_array_prop(offset_t *offset, struct err *err, struct memfile *
 }
 
 static bool write_array_props(struct memfile *memfile, struct err *err, struct columndoc_obj *columndoc,
-        struct archive_prop_offs *offsets, offset_t root_object_header_offset)
+        struct archive_prop_offs *offsets, offset_t root_object_header_offset, offset_t base_off)
 {
         if (!write_array_prop(&offsets->null_arrays,
                 err,
@@ -670,7 +1128,7 @@ static bool write_array_props(struct memfile *memfile, struct err *err, struct c
                 &columndoc->null_array_prop_keys,
                 FIELD_NULL,
                 &columndoc->null_array_prop_vals,
-                root_object_header_offset)) {
+                root_object_header_offset, base_off)) {
                 return false;
         }
         if (!write_array_prop(&offsets->bool_arrays,
@@ -679,7 +1137,7 @@ static bool write_array_props(struct memfile *memfile, struct err *err, struct c
                 &columndoc->bool_array_prop_keys,
                 FIELD_BOOLEAN,
                 &columndoc->bool_array_prop_vals,
-                root_object_header_offset)) {
+                root_object_header_offset, base_off)) {
                 return false;
         }
         if (!write_array_prop(&offsets->int8_arrays,
@@ -688,7 +1146,7 @@ static bool write_array_props(struct memfile *memfile, struct err *err, struct c
                 &columndoc->int8_array_prop_keys,
                 FIELD_INT8,
                 &columndoc->int8_array_prop_vals,
-                root_object_header_offset)) {
+                root_object_header_offset, base_off)) {
                 return false;
         }
         if (!write_array_prop(&offsets->int16_arrays,
@@ -697,7 +1155,7 @@ static bool write_array_props(struct memfile *memfile, struct err *err, struct c
                 &columndoc->int16_array_prop_keys,
                 FIELD_INT16,
                 &columndoc->int16_array_prop_vals,
-                root_object_header_offset)) {
+                root_object_header_offset, base_off)) {
                 return false;
         }
         if (!write_array_prop(&offsets->int32_arrays,
@@ -706,7 +1164,7 @@ static bool write_array_props(struct memfile *memfile, struct err *err, struct c
                 &columndoc->int32_array_prop_keys,
                 FIELD_INT32,
                 &columndoc->int32_array_prop_vals,
-                root_object_header_offset)) {
+                root_object_header_offset, base_off)) {
                 return false;
         }
         if (!write_array_prop(&offsets->int64_arrays,
@@ -715,7 +1173,7 @@ static bool write_array_props(struct memfile *memfile, struct err *err, struct c
                 &columndoc->int64_array_prop_keys,
                 FIELD_INT64,
                 &columndoc->int64_array_prop_vals,
-                root_object_header_offset)) {
+                root_object_header_offset, base_off)) {
                 return false;
         }
         if (!write_array_prop(&offsets->uint8_arrays,
@@ -724,7 +1182,7 @@ static bool write_array_props(struct memfile *memfile, struct err *err, struct c
                 &columndoc->uint8_array_prop_keys,
                 FIELD_UINT8,
                 &columndoc->uint8_array_prop_vals,
-                root_object_header_offset)) {
+                root_object_header_offset, base_off)) {
                 return false;
         }
         if (!write_array_prop(&offsets->uint16_arrays,
@@ -733,7 +1191,7 @@ static bool write_array_props(struct memfile *memfile, struct err *err, struct c
                 &columndoc->uint16_array_prop_keys,
                 FIELD_UINT16,
                 &columndoc->uint16_array_prop_vals,
-                root_object_header_offset)) {
+                root_object_header_offset, base_off)) {
                 return false;
         }
         if (!write_array_prop(&offsets->uint32_arrays,
@@ -742,7 +1200,7 @@ static bool write_array_props(struct memfile *memfile, struct err *err, struct c
                 &columndoc->uint32_array_prop_keys,
                 FIELD_UINT32,
                 &columndoc->uint32_array_prop_vals,
-                root_object_header_offset)) {
+                root_object_header_offset, base_off)) {
                 return false;
         }
         if (!write_array_prop(&offsets->uint64_arrays,
@@ -751,7 +1209,7 @@ static bool write_array_props(struct memfile *memfile, struct err *err, struct c
                 &columndoc->uint64_array_prop_keys,
                 FIELD_UINT64,
                 &columndoc->ui64_array_prop_vals,
-                root_object_header_offset)) {
+                root_object_header_offset, base_off)) {
                 return false;
         }
         if (!write_array_prop(&offsets->float_arrays,
@@ -760,7 +1218,7 @@ static bool write_array_props(struct memfile *memfile, struct err *err, struct c
                 &columndoc->float_array_prop_keys,
                 FIELD_FLOAT,
                 &columndoc->float_array_prop_vals,
-                root_object_header_offset)) {
+                root_object_header_offset, base_off)) {
                 return false;
         }
         if (!write_array_prop(&offsets->string_arrays,
@@ -769,7 +1227,7 @@ static bool write_array_props(struct memfile *memfile, struct err *err, struct c
                 &columndoc->string_array_prop_keys,
                 FIELD_STRING,
                 &columndoc->string_array_prop_vals,
-                root_object_header_offset)) {
+                root_object_header_offset, base_off)) {
                 return false;
         }
         return true;
@@ -809,7 +1267,7 @@ static bool write_fixed_props(offset_t *offset, struct err *err, struct memfile
  * In contrast, fixed-length property list doesn't require an additional offset column (see 'write_fixed_props') */
 static bool write_var_props(offset_t *offset, struct err *err, struct memfile *memfile,
         struct vector ofType(field_sid_t) *keys, struct vector ofType(struct columndoc_obj) *objects,
-        offset_t root_object_header_offset)
+        offset_t root_object_header_offset, offset_t base_off)
 {
         assert(!objects || keys->num_elems == objects->num_elems);
 
@@ -821,7 +1279,8 @@ static bool write_var_props(offset_t *offset, struct err *err, struct memfile *m
 
                 write_primitive_key_column(memfile, keys);
                 offset_t value_offset = skip_var_value_offset_column(memfile, keys->num_elems);
-                offset_t *value_offsets = __write_primitive_column(memfile, err, objects, root_object_header_offset);
+                offset_t *value_offsets = __write_primitive_column(memfile, err, objects, root_object_header_offset,
+                        base_off);
                 if (!value_offsets) {
                         return false;
                 }
@@ -837,7 +1296,7 @@ static bool write_var_props(offset_t *offset, struct err *err, struct memfile *m
 }
 
 static bool write_primitive_props(struct memfile *memfile, struct err *err, struct columndoc_obj *columndoc,
-        struct archive_prop_offs *offsets, offset_t root_object_header_offset)
+        struct archive_prop_offs *offsets, offset_t root_object_header_offset, offset_t base_off)
 {
         if (!write_fixed_props(&offsets->nulls, err, memfile, &columndoc->null_prop_keys, FIELD_NULL, NULL)) {
                 return false;
@@ -935,28 +1394,28 @@ static bool write_primitive_props(struct memfile *memfile, struct err *err, stru
                 memfile,
                 &columndoc->obj_prop_keys,
                 &columndoc->obj_prop_vals,
-                root_object_header_offset)) {
-                return false;
-        }
-
-        offsets->nulls -= root_object_header_offset;
-        offsets->bools -= root_object_header_offset;
-        offsets->int8s -= root_object_header_offset;
-        offsets->int16s -= root_object_header_offset;
-        offsets->int32s -= root_object_header_offset;
-        offsets->int64s -= root_object_header_offset;
-        offsets->uint8s -= root_object_header_offset;
-        offsets->uint16s -= root_object_header_offset;
-        offsets->uint32s -= root_object_header_offset;
-        offsets->uint64s -= root_object_header_offset;
-        offsets->floats -= root_object_header_offset;
-        offsets->strings -= root_object_header_offset;
-        offsets->objects -= root_object_header_offset;
+                root_object_header_offset, base_off)) {
+                return false;
+        }
+
+        offsets->nulls = offsets->nulls - root_object_header_offset + base_off;
+        offsets->bools = offsets->bools - root_object_header_offset + base_off;
+        offsets->int8s = offsets->int8s - root_object_header_offset + base_off;
+        offsets->int16s = offsets->int16s - root_object_header_offset + base_off;
+        offsets->int32s = offsets->int32s - root_object_header_offset + base_off;
+        offsets->int64s = offsets->int64s - root_object_header_offset + base_off;
+        offsets->uint8s = offsets->uint8s - root_object_header_offset + base_off;
+        offsets->uint16s = offsets->uint16s - root_object_header_offset + base_off;
+        offsets->uint32s = offsets->uint32s - root_object_header_offset + base_off;
+        offsets->uint64s = offsets->uint64s - root_object_header_offset + base_off;
+        offsets->floats = offsets->floats - root_object_header_offset + base_off;
+        offsets->strings = offsets->strings - root_object_header_offset + base_off;
+        offsets->objects = offsets->objects - root_object_header_offset + base_off;
         return true;
 }
 
 static bool write_column_entry(struct memfile *memfile, struct err *err, field_e type,
-        struct vector ofType(<T>) *column, offset_t root_object_header_offset)
+        struct vector ofType(<T>) *column, offset_t root_object_header_offset, offset_t base_off)
 {
         memfile_write(memfile, &column->num_elems, sizeof(u32));
         switch (type) {
@@ -982,12 +1441,12 @@ static bool write_column_entry(struct memfile *memfile, struct err *err, field_e
                         struct columndoc_obj *object = vec_get(column, i, struct columndoc_obj);
                         if (likely(preObjectNext != 0)) {
                                 offset_t continuePos = memfile_tell(memfile);
-                                offset_t relativeContinuePos = continuePos - root_object_header_offset;
+                                offset_t relativeContinuePos = continuePos - root_object_header_offset + base_off;
                                 memfile_seek(memfile, preObjectNext);
                                 memfile_write(memfile, &relativeContinuePos, sizeof(offset_t));
                                 memfile_seek(memfile, continuePos);
                         }
-                        if (!__serialize(&preObjectNext, err, memfile, object, root_object_header_offset)) {
+                        if (!__serialize(&preObjectNext, err, memfile, object, root_object_header_offset, base_off)) {
                                 return false;
                         }
                 }
@@ -999,11 +1458,68 @@ static bool write_column_entry(struct memfile *memfile, struct err *err, field_e
         return true;
 }
 
+static bool is_packable_column(struct columndoc_column *column)
+{
+        if (!int_is_packable_type(column->type) || column->values.num_elems == 0) {
+                return false;
+        }
+        for (size_t i = 0; i < column->values.num_elems; i++) {
+                struct vector ofType(<T>) *column_data = vec_get(&column->values, i, struct vector);
+                if (column_data->num_elems != 1) {
+                        return false;
+                }
+        }
+        return true;
+}
+
+/** Columns with exactly one integer, boolean or string id per entry are packed by the smallest of frame-of-reference,
+ * delta or run-length encoding; such a column has neither entry offsets nor entry lengths. */
+static bool write_packed_column(struct memfile *memfile, struct err *err, struct columndoc_column *column)
+{
+        u32 num_values = column->values.num_elems;
+        struct coding_intpack_header packed;
+        u64 *keys = malloc(num_values * sizeof(u64));
+        if (!keys) {
+                error(err, NG5_ERR_MALLOCERR)
+                return false;
+        }
+        for (u32 i = 0; i < num_values; i++) {
+                struct vector ofType(<T>) *column_data = vec_get(&column->values, i, struct vector);
+                keys[i] = int_packed_key_of(column->type, column_data->base);
+        }
+
+        coding_intpack_plan(&packed, keys, num_values);
+        size_t payload_size = coding_intpack_payload_size(&packed);
+        void *payload = malloc(ng5_max(payload_size, (size_t) 1));
+        if (!payload || !coding_intpack_encode(payload, &packed, keys)) {
+                free(payload);
+                free(keys);
+                error(err, NG5_ERR_MALLOCERR)
+                return false;
+        }
+
+        struct column_header header = {.marker = marker_symbols[MARKER_TYPE_COLUMN_PACKED].symbol, .column_name = column
+                ->key_name, .value_type = marker_symbols[value_array_marker_mapping[column->type].marker]
+                .symbol, .num_entries = num_values};
+        memfile_write(memfile, &header, sizeof(struct column_header));
+        memfile_write(memfile, column->array_positions.base, column->array_positions.num_elems * sizeof(u32));
+        memfile_write(memfile, &packed, sizeof(struct coding_intpack_header));
+        memfile_write(memfile, payload, payload_size);
+
+        free(payload);
+        free(keys);
+        return true;
+}
+
 static bool write_column(struct memfile *memfile, struct err *err, struct columndoc_column *column,
-        offset_t root_object_header_offset)
+        offset_t root_object_header_offset, offset_t base_off)
 {
         assert(column->array_positions.num_elems == column->values.num_elems);
 
+        if (is_packable_column(column)) {
+                return write_packed_column(memfile, err, column);
+        }
+
         struct column_header header = {.marker = marker_symbols[MARKER_TYPE_COLUMN].symbol, .column_name = column
                 ->key_name, .value_type = marker_symbols[value_array_marker_mapping[column->type].marker]
                 .symbol, .num_entries = column->values.num_elems};
@@ -1019,87 +1535,357 @@ static bool write_column(struct memfile *memfile, struct err *err, struct column
         for (size_t i = 0; i < column->values.num_elems; i++) {
                 struct vector ofType(<T>) *column_data = vec_get(&column->values, i, struct vector);
                 offset_t column_entry_offset = memfile_tell(memfile);
-                offset_t relative_entry_offset = column_entry_offset - root_object_header_offset;
+                offset_t relative_entry_offset = column_entry_offset - root_object_header_offset + base_off;
                 memfile_seek(memfile, value_entry_offsets + i * sizeof(offset_t));
                 memfile_write(memfile, &relative_entry_offset, sizeof(offset_t));
                 memfile_seek(memfile, column_entry_offset);
-                if (!write_column_entry(memfile, err, column->type, column_data, root_object_header_offset)) {
+                if (!write_column_entry(memfile, err, column->type, column_data, root_object_header_offset, base_off)) {
+                        return false;
+                }
+        }
+        return true;
+}
+
+static bool is_zone_ordered_type(field_e type)
+{
+        return int_is_packable_type(type) || type == FIELD_FLOAT;
+}
+
+/** Returns true if <code>value</code> is the null value of <code>type</code>; NaN is the null value of numbers */
+static bool is_zone_null_value(field_e type, const void *value)
+{
+        switch (type) {
+        case FIELD_BOOLEAN: return NG5_IS_NULL_BOOLEAN(*(const FIELD_BOOLEANean_t *) value);
+        case FIELD_INT8: return NG5_IS_NULL_INT8(*(const field_i8_t *) value);
+        case FIELD_INT16: return NG5_IS_NULL_INT16(*(const field_i16_t *) value);
+        case FIELD_INT32: return NG5_IS_NULL_INT32(*(const field_i32_t *) value);
+        case FIELD_INT64: return NG5_IS_NULL_INT64(*(const field_i64_t *) value);
+        case FIELD_UINT8: return NG5_IS_NULL_UINT8(*(const field_u8_t *) value);
+        case FIELD_UINT16: return NG5_IS_NULL_UINT16(*(const field_u16_t *) value);
+        case FIELD_UINT32: return NG5_IS_NULL_UINT32(*(const field_u32_t *) value);
+        case FIELD_UINT64: return NG5_IS_NULL_UINT64(*(const field_u64_t *) value);
+        case FIELD_FLOAT: return isnan(*(const field_number_t *) value);
+        case FIELD_STRING: return NG5_IS_NULL_STRING(*(const field_sid_t *) value);
+        default: return false;
+        }
+}
+
+static int compare_zone_keys(const void *lhs, const void *rhs)
+{
+        u64 a = *(const u64 *) lhs;
+        u64 b = *(const u64 *) rhs;
+        return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+static bool write_zone_map_entry(struct memfile *memfile, struct err *err, const struct columndoc_column *column)
+{
+        struct zone_map_entry entry = {.column_name = column->key_name, .value_type = marker_symbols[
+                value_array_marker_mapping[column->type].marker].symbol, .num_values = 0, .num_nulls = 0, .min = 0,
+                .max = 0, .bloom_blocks = 0};
+        for (size_t i = 0; i < column->values.num_elems; i++) {
+                entry.num_values += (vec_get(&column->values, i, struct vector))->num_elems;
+        }
+        if (column->type == FIELD_NULL) {
+                entry.num_nulls = entry.num_values;
+        }
+
+        if (!is_zone_ordered_type(column->type) || entry.num_values == 0) {
+                memfile_write(memfile, &entry, sizeof(struct zone_map_entry));
+                return true;
+        }
+
+        u64 *keys = malloc(entry.num_values * sizeof(u64));
+        if (!keys) {
+                error(err, NG5_ERR_MALLOCERR)
+                return false;
+        }
+        u32 num_keys = 0;
+        size_t value_size = GET_TYPE_SIZE(column->type);
+        for (size_t i = 0; i < column->values.num_elems; i++) {
+                const struct vector ofType(<T>) *column_data = vec_get(&column->values, i, struct vector);
+                for (size_t k = 0; k < column_data->num_elems; k++) {
+                        const void *value = (const char *) column_data->base + k * value_size;
+                        /* null values (e.g., the largest value of an integer type) would distort min and max */
+                        if (is_zone_null_value(column->type, value)) {
+                                entry.num_nulls++;
+                                continue;
+                        }
+                        keys[num_keys++] = int_zone_key_of(column->type, value);
+                }
+        }
+
+        bloom_t filter = {.blocks = NULL, .num_blocks = 0};
+        if (num_keys > 0) {
+                entry.min = entry.max = keys[0];
+                for (u32 i = 1; i < num_keys; i++) {
+                        entry.min = ng5_min(entry.min, keys[i]);
+                        entry.max = ng5_max(entry.max, keys[i]);
+                }
+                if (column->type == FIELD_STRING) {
+                        /* the filter is sized by the number of distinct string ids */
+                        qsort(keys, num_keys, sizeof(u64), compare_zone_keys);
+                        u32 num_distinct = 0;
+                        for (u32 i = 0; i < num_keys; i++) {
+                                if (i == 0 || keys[i] != keys[i - 1]) {
+                                        keys[num_distinct++] = keys[i];
+                                }
+                        }
+                        if (!bloom_create(&filter, (size_t) num_distinct * NG5_ZONE_MAP_BLOOM_BITS)) {
+                                free(keys);
+                                error(err, NG5_ERR_MALLOCERR)
+                                return false;
+                        }
+                        for (u32 i = 0; i < num_distinct; i++) {
+                                NG5_BLOOM_SET(&filter, &keys[i], sizeof(field_sid_t));
+                        }
+                        entry.bloom_blocks = filter.num_blocks;
+                }
+        }
+
+        memfile_write(memfile, &entry, sizeof(struct zone_map_entry));
+        if (filter.blocks) {
+                memfile_write(memfile, filter.blocks, filter.num_blocks * NG5_BLOOM_BLOCK_WORDS * sizeof(u32));
+                bloom_drop(&filter);
+        }
+        free(keys);
+        return true;
+}
+
+/** Writes the zone map of a row group, i.e., per column, the number of values, the smallest and largest value and,
+ * for string columns, a Bloom filter over the contained string ids */
+static bool write_zone_map(struct memfile *memfile, struct err *err,
+        const struct vector ofType(struct columndoc_column) *columns)
+{
+        struct zone_map_header header = {.marker = marker_symbols[MARKER_TYPE_ZONE_MAP].symbol, .num_entries = columns
+                ->num_elems};
+        memfile_write(memfile, &header, sizeof(struct zone_map_header));
+        for (size_t i = 0; i < columns->num_elems; i++) {
+                if (!write_zone_map_entry(memfile, err, vec_get(columns, i, struct columndoc_column))) {
+                        return false;
+                }
+        }
+        return true;
+}
+
+/** Writes a column group, or a row group if <code>is_row_group</code> is set. Offsets are stored relative to the root
+ * object header at <code>root_object_header_offset</code> in <code>memfile</code>. If <code>memfile</code> holds only
+ * a part of the record that starts after the root object header, <code>base_off</code> is the record offset of its
+ * first byte and <code>root_object_header_offset</code> is 0; otherwise <code>base_off</code> is 0. */
+static bool write_column_group(struct memfile *memfile, struct err *err,
+        const struct vector ofType(struct columndoc_column) *columns, u32 num_objects, bool is_row_group,
+        offset_t root_object_header_offset, offset_t base_off)
+{
+        char marker = marker_symbols[is_row_group ? MARKER_TYPE_ROW_GROUP : MARKER_TYPE_COLUMN_GROUP].symbol;
+        struct column_group_header column_group_header =
+                {.marker = marker, .num_columns = columns->num_elems, .num_objects = num_objects};
+        memfile_write(memfile, &column_group_header, sizeof(struct column_group_header));
+
+        offset_t zone_map_offset = memfile_tell(memfile);
+        if (is_row_group) {
+                memfile_skip(memfile, sizeof(offset_t));
+        }
+
+        /* write an object-id for each position number */
+        for (size_t i = 0; i < column_group_header.num_objects; i++) {
+                object_id_t oid;
+                if (!object_id_create(&oid)) {
+                        error(err, NG5_ERR_THREADOOOBJIDS);
+                        return false;
+                }
+                memfile_write(memfile, &oid, sizeof(object_id_t));
+        }
+
+        offset_t offset_column_to_columns = memfile_tell(memfile);
+        memfile_skip(memfile, columns->num_elems * sizeof(offset_t));
+
+        for (size_t k = 0; k < columns->num_elems; k++) {
+                struct columndoc_column *column = vec_get(columns, k, struct columndoc_column);
+                offset_t continue_write = memfile_tell(memfile);
+                offset_t column_off = continue_write - root_object_header_offset + base_off;
+                memfile_seek(memfile, offset_column_to_columns + k * sizeof(offset_t));
+                memfile_write(memfile, &column_off, sizeof(offset_t));
+                memfile_seek(memfile, continue_write);
+                if (!write_column(memfile, err, column, root_object_header_offset, base_off)) {
+                        return false;
+                }
+        }
+
+        if (is_row_group) {
+                offset_t continue_write = memfile_tell(memfile);
+                offset_t zone_map_off = continue_write - root_object_header_offset + base_off;
+                memfile_seek(memfile, zone_map_offset);
+                memfile_write(memfile, &zone_map_off, sizeof(offset_t));
+                memfile_seek(memfile, continue_write);
+                if (!write_zone_map(memfile, err, columns)) {
                         return false;
                 }
         }
         return true;
 }
 
+static void drop_row_groups(struct vector ofType(struct columndoc_column) *row_groups, u32 num_row_groups)
+{
+        for (u32 i = 0; i < num_row_groups; i++) {
+                for (size_t k = 0; k < row_groups[i].num_elems; k++) {
+                        struct columndoc_column *slice = vec_get(&row_groups[i], k, struct columndoc_column);
+                        vec_drop(&slice->array_positions);
+                        vec_drop(&slice->values);
+                }
+                vec_drop(&row_groups[i]);
+        }
+}
+
+/** Distributes the entries of the columns of an object array to row groups of <code>rows_per_group</code> objects
+ * each, and rebases entry positions to the first object of their row group. Entry values are not copied. Columns
+ * without entries in a row group are left out of that group. */
+static void split_row_groups(struct vector ofType(struct columndoc_column) *row_groups, u32 num_row_groups,
+        u32 rows_per_group, const struct columndoc_group *column_group)
+{
+        for (u32 i = 0; i < num_row_groups; i++) {
+                vec_create(&row_groups[i], NULL, sizeof(struct columndoc_column), column_group->columns.num_elems);
+        }
+        for (size_t k = 0; k < column_group->columns.num_elems; k++) {
+                struct columndoc_column *column = vec_get(&column_group->columns, k, struct columndoc_column);
+                size_t cap_entries = column->values.num_elems / num_row_groups + 1;
+                for (u32 i = 0; i < num_row_groups; i++) {
+                        struct columndoc_column *slice = vec_new_and_get(&row_groups[i], struct columndoc_column);
+                        slice->key_name = column->key_name;
+                        slice->type = column->type;
+                        vec_create(&slice->array_positions, NULL, sizeof(u32), cap_entries);
+                        vec_create(&slice->values, NULL, sizeof(struct vector), cap_entries);
+                }
+                /* entries of read-optimized archives are sorted by value, not by position */
+                const u32 *array_pos = vec_all(&column->array_positions, u32);
+                for (size_t m = 0; m < column->values.num_elems; m++) {
+                        u32 group_idx = array_pos[m] / rows_per_group;
+                        u32 group_pos = array_pos[m] % rows_per_group;
+                        struct columndoc_column *slice = vec_get(&row_groups[group_idx],
+                                row_groups[group_idx].num_elems - 1, struct columndoc_column);
+                        vec_push(&slice->array_positions, &group_pos, 1);
+                        vec_push(&slice->values, vec_at(&column->values, m), 1);
+                }
+                for (u32 i = 0; i < num_row_groups; i++) {
+                        struct columndoc_column *slice = vec_get(&row_groups[i], row_groups[i].num_elems - 1,
+                                struct columndoc_column);
+                        if (slice->values.num_elems == 0) {
+                                vec_drop(&slice->array_positions);
+                                vec_drop(&slice->values);
+                                vec_pop(&row_groups[i]);
+                        }
+                }
+        }
+}
+
+static u32 get_num_array_objects(const struct columndoc_group *column_group)
+{
+        size_t max_pos = 0;
+        for (size_t k = 0; k < column_group->columns.num_elems; k++) {
+                struct columndoc_column *column = vec_get(&column_group->columns, k, struct columndoc_column);
+                const u32 *array_pos = vec_all(&column->array_positions, u32);
+                for (size_t m = 0; m < column->array_positions.num_elems; m++) {
+                        max_pos = ng5_max(max_pos, array_pos[m]);
+                }
+        }
+        return max_pos + 1;
+}
+
 static bool write_object_array_props(struct memfile *memfile, struct err *err,
         struct vector ofType(struct columndoc_group) *object_key_columns, struct archive_prop_offs *offsets,
-        offset_t root_object_header_offset)
+        offset_t root_object_header_offset, offset_t base_off)
 {
         if (object_key_columns->num_elems > 0) {
+                u32 num_keys = object_key_columns->num_elems;
+                u32 *num_objects = malloc(num_keys * sizeof(u32));
+                u32 *num_row_groups = malloc(num_keys * sizeof(u32));
+                u32 *rows_per_group = malloc(num_keys * sizeof(u32));
+                u32 num_groups = 0;
+                if (!num_objects || !num_row_groups || !rows_per_group) {
+                        free(num_objects);
+                        free(num_row_groups);
+                        free(rows_per_group);
+                        error(err, NG5_ERR_MALLOCERR)
+                        return false;
+                }
+
+                /* object arrays larger than a row group are split into row groups, but a single object array
+                 * header addresses at most UINT8_MAX groups; hence, larger arrays get larger row groups */
+                u32 max_row_groups_per_key = ng5_max(1, UINT8_MAX / num_keys);
+                for (u32 i = 0; i < num_keys; i++) {
+                        struct columndoc_group *column_group = vec_get(object_key_columns, i, struct columndoc_group);
+                        num_objects[i] = get_num_array_objects(column_group);
+                        if (num_objects[i] <= NG5_ROW_GROUP_SIZE) {
+                                rows_per_group[i] = num_objects[i];
+                                num_row_groups[i] = 1;
+                        } else {
+                                rows_per_group[i] = ng5_max(NG5_ROW_GROUP_SIZE,
+                                        (num_objects[i] + max_row_groups_per_key - 1) / max_row_groups_per_key);
+                                num_row_groups[i] = (num_objects[i] + rows_per_group[i] - 1) / rows_per_group[i];
+                        }
+                        num_groups += num_row_groups[i];
+                }
+
                 struct object_array_header header = {.marker = marker_symbols[MARKER_TYPE_PROP_OBJECT_ARRAY]
-                        .symbol, .num_entries = object_key_columns->num_elems};
+                        .symbol, .num_entries = num_groups};
 
-                offsets->object_arrays = memfile_tell(memfile) - root_object_header_offset;
+                offsets->object_arrays = memfile_tell(memfile) - root_object_header_offset + base_off;
                 memfile_write(memfile, &header, sizeof(struct object_array_header));
 
-                for (size_t i = 0; i < object_key_columns->num_elems; i++) {
+                for (u32 i = 0; i < num_keys; i++) {
                         struct columndoc_group *column_group = vec_get(object_key_columns, i, struct columndoc_group);
-                        memfile_write(memfile, &column_group->key, sizeof(field_sid_t));
+                        for (u32 k = 0; k < num_row_groups[i]; k++) {
+                                memfile_write(memfile, &column_group->key, sizeof(field_sid_t));
+                        }
                 }
 
                 // skip offset column to column groups
                 offset_t column_offsets = memfile_tell(memfile);
-                memfile_skip(memfile, object_key_columns->num_elems * sizeof(offset_t));
+                memfile_skip(memfile, num_groups * sizeof(offset_t));
 
-                for (size_t i = 0; i < object_key_columns->num_elems; i++) {
+                bool status = true;
+                u32 group_idx = 0;
+                for (u32 i = 0; status && i < num_keys; i++) {
                         struct columndoc_group *column_group = vec_get(object_key_columns, i, struct columndoc_group);
-                        offset_t this_column_offset_relative = memfile_tell(memfile) - root_object_header_offset;
-
-                        /* write an object-id for each position number */
-                        size_t max_pos = 0;
-                        for (size_t k = 0; k < column_group->columns.num_elems; k++) {
-                                struct columndoc_column
-                                        *column = vec_get(&column_group->columns, k, struct columndoc_column);
-                                const u32 *array_pos = vec_all(&column->array_positions, u32);
-                                for (size_t m = 0; m < column->array_positions.num_elems; m++) {
-                                        max_pos = ng5_max(max_pos, array_pos[m]);
-                                }
-                        }
-                        struct column_group_header column_group_header =
-                                {.marker = marker_symbols[MARKER_TYPE_COLUMN_GROUP].symbol, .num_columns = column_group
-                                        ->columns.num_elems, .num_objects = max_pos + 1};
-                        memfile_write(memfile, &column_group_header, sizeof(struct column_group_header));
-
-                        for (size_t i = 0; i < column_group_header.num_objects; i++) {
-                                object_id_t oid;
-                                if (!object_id_create(&oid)) {
-                                        error(err, NG5_ERR_THREADOOOBJIDS);
-                                        return false;
+                        struct vector ofType(struct columndoc_column) *row_groups = NULL;
+                        if (num_row_groups[i] > 1) {
+                                row_groups = malloc(num_row_groups[i] * sizeof(struct vector));
+                                if (!row_groups) {
+                                        error(err, NG5_ERR_MALLOCERR)
+                                        status = false;
+                                        break;
                                 }
-                                memfile_write(memfile, &oid, sizeof(object_id_t));
+                                split_row_groups(row_groups, num_row_groups[i], rows_per_group[i], column_group);
                         }
 
-                        offset_t continue_write = memfile_tell(memfile);
-                        memfile_seek(memfile, column_offsets + i * sizeof(offset_t));
-                        memfile_write(memfile, &this_column_offset_relative, sizeof(offset_t));
-                        memfile_seek(memfile, continue_write);
-
-                        offset_t offset_column_to_columns = continue_write;
-                        memfile_skip(memfile, column_group->columns.num_elems * sizeof(offset_t));
-
-                        for (size_t k = 0; k < column_group->columns.num_elems; k++) {
-                                struct columndoc_column
-                                        *column = vec_get(&column_group->columns, k, struct columndoc_column);
+                        for (u32 k = 0; status && k < num_row_groups[i]; k++, group_idx++) {
                                 offset_t continue_write = memfile_tell(memfile);
-                                offset_t column_off = continue_write - root_object_header_offset;
-                                memfile_seek(memfile, offset_column_to_columns + k * sizeof(offset_t));
-                                memfile_write(memfile, &column_off, sizeof(offset_t));
+                                offset_t this_column_offset_relative = continue_write - root_object_header_offset
+                                        + base_off;
+                                memfile_seek(memfile, column_offsets + group_idx * sizeof(offset_t));
+                                memfile_write(memfile, &this_column_offset_relative, sizeof(offset_t));
                                 memfile_seek(memfile, continue_write);
-                                if (!write_column(memfile, err, column, root_object_header_offset)) {
-                                        return false;
+
+                                if (row_groups) {
+                                        u32 first_object = k * rows_per_group[i];
+                                        u32 num_group_objects = ng5_min(rows_per_group[i],
+                                                num_objects[i] - first_object);
+                                        status = write_column_group(memfile, err, &row_groups[k], num_group_objects,
+                                                true, root_object_header_offset, base_off);
+                                } else {
+                                        status = write_column_group(memfile, err, &column_group->columns,
+                                                num_objects[i], false, root_object_header_offset, base_off);
                                 }
                         }
 
+                        if (row_groups) {
+                                drop_row_groups(row_groups, num_row_groups[i]);
+                                free(row_groups);
+                        }
                 }
+
+                free(num_objects);
+                free(num_row_groups);
+                free(rows_per_group);
+                return status;
         } else {
                 offsets->object_arrays = 0;
         }
@@ -1117,7 +1903,8 @@ static offset_t skip_record_header(struct memfile *memfile)
 static void update_record_header(struct memfile *memfile, offset_t root_object_header_offset, struct columndoc *model,
         u64 record_size)
 {
-        struct record_flags flags = {.bits.is_sorted = model->read_optimized};
+        union record_flags flags = {.bits.is_sorted = model->read_optimized,
+                                     .bits.has_ordered_string_ids = model->ordered_string_ids};
         struct record_header
                 header = {.marker = MARKER_SYMBOL_RECORD_HEADER, .flags = flags.value, .record_size = record_size};
         offset_t offset;
@@ -1296,7 +2083,7 @@ static void prop_offsets_skip_write(struct memfile *memfile, const union object_
 }
 
 static bool __serialize(offset_t *offset, struct err *err, struct memfile *memfile, struct columndoc_obj *columndoc,
-        offset_t root_object_header_offset)
+        offset_t root_object_header_offset, offset_t base_off)
 {
         union object_flags flags;
         struct archive_prop_offs prop_offsets;
@@ -1310,17 +2097,17 @@ static bool __serialize(offset_t *offset, struct err *err, struct memfile *memfi
         offset_t default_next_nil = 0;
         memfile_write(memfile, &default_next_nil, sizeof(offset_t));
 
-        if (!write_primitive_props(memfile, err, columndoc, &prop_offsets, root_object_header_offset)) {
+        if (!write_primitive_props(memfile, err, columndoc, &prop_offsets, root_object_header_offset, base_off)) {
                 return false;
         }
-        if (!write_array_props(memfile, err, columndoc, &prop_offsets, root_object_header_offset)) {
+        if (!write_array_props(memfile, err, columndoc, &prop_offsets, root_object_header_offset, base_off)) {
                 return false;
         }
         if (!write_object_array_props(memfile,
                 err,
                 &columndoc->obj_array_props,
                 &prop_offsets,
-                root_object_header_offset)) {
+                root_object_header_offset, base_off)) {
                 return false;
         }
 
@@ -1374,7 +2161,7 @@ static char *embedded_dic_flags_to_string(const union string_tab_flags *flags)
         return string;
 }
 
-static char *record_header_flags_to_string(const struct record_flags *flags)
+static char *record_header_flags_to_string(const union record_flags *flags)
 {
         size_t max = 2048;
         char *string = malloc(max + 1);
@@ -1390,25 +2177,44 @@ static char *record_header_flags_to_string(const struct record_flags *flags)
                         length = strlen(string);
                         assert(length <= max);
                 }
+                if (flags->bits.has_ordered_string_ids) {
+                        strcpy(string + length, " ordered-string-ids");
+                        length = strlen(string);
+                        assert(length <= max);
+                }
         }
         string[length] = '\0';
         return string;
 }
 
-static bool serialize_string_dic(struct memfile *memfile, struct err *err, const struct doc_bulk *context,
+struct string_table_entry {
+        field_sid_t id;
+        const char *string;
+};
+
+static int compare_string_table_entries(const void *lhs, const void *rhs)
+{
+        field_sid_t a = ((const struct string_table_entry *) lhs)->id;
+        field_sid_t b = ((const struct string_table_entry *) rhs)->id;
+        return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+static int compare_string_table_entries_by_string(const void *lhs, const void *rhs)
+{
+        return strcmp((*(const struct string_table_entry **) lhs)->string,
+                (*(const struct string_table_entry **) rhs)->string);
+}
+
+/** writes a string table for <code>strings</code>; without <code>string_ids</code>, the id of a string is its position
+ * in <code>strings</code> plus one */
+static bool write_string_table(struct memfile *memfile, struct err *err,
+        const struct vector ofType (const char *) *strings, const struct vector ofType(field_sid_t) *string_ids,
         enum packer_type compressor)
 {
         union string_tab_flags flags;
         struct packer strategy;
         struct string_table_header header;
 
-        struct vector ofType (const char *) *strings;
-        struct vector ofType(field_sid_t) *string_ids;
-
-        doc_bulk_get_dic_contents(&strings, &string_ids, context);
-
-        assert(strings->num_elems == string_ids->num_elems);
-
         flags.value = 0;
         if (!pack_by_type(err, &strategy, compressor)) {
                 return false;
@@ -1423,45 +2229,98 @@ static bool serialize_string_dic(struct memfile *memfile, struct err *err, const
         pack_write_extra(err, &strategy, memfile, strings);
         offset_t extra_end_off = memfile_tell(memfile);
 
-        header = (struct string_table_header) {.marker = marker_symbols[MARKER_TYPE_EMBEDDED_STR_DIC]
+        header = (struct string_table_header) {.marker = marker_symbols[MARKER_TYPE_EMBEDDED_STR_TAB]
                 .symbol, .flags = flags.value, .num_entries = strings
                 ->num_elems, .first_entry = memfile_tell(memfile), .compressor_extra_size = (extra_end_off
                 - extra_begin_off)};
 
-        for (size_t i = 0; i < strings->num_elems; i++) {
-                field_sid_t id = *vec_get(string_ids, i, field_sid_t);
-                const char *string = *vec_get(strings, i, char *);
+        /** the slot directory is sorted by string id, and the heap stores the strings in the same order */
+        size_t num_strings = strings->num_elems;
+        struct string_table_entry *entries = malloc(ng5_max(num_strings, 1) * sizeof(struct string_table_entry));
+        struct string_table_slot *slots = malloc(ng5_max(num_strings, 1) * sizeof(struct string_table_slot));
+        if (!entries || !slots) {
+                free(entries);
+                free(slots);
+                error(err, NG5_ERR_MALLOCERR);
+                return false;
+        }
+        for (size_t i = 0; i < num_strings; i++) {
+                entries[i].id = string_ids ? *vec_get(string_ids, i, field_sid_t) : i + 1;
+                entries[i].string = *vec_get(strings, i, char *);
+        }
+        if (string_ids) {
+                qsort(entries, num_strings, sizeof(struct string_table_entry), compare_string_table_entries);
+        }
 
-                struct string_entry_header header = {.marker = marker_symbols[MARKER_TYPE_EMBEDDED_UNCOMP_STR]
-                        .symbol, .next_entry_off = 0, .string_id = id, .string_len = strlen(string)};
+        /** front coding depends on neighboring strings sharing prefixes; unless ids already follow the order of the
+         * strings, the heap is then written in string order, while the directory stays sorted by id */
+        struct string_table_entry **heap_order = NULL;
+        if (compressor == PACK_FRONT && string_ids) {
+                if (!(heap_order = malloc(ng5_max(num_strings, 1) * sizeof(struct string_table_entry *)))) {
+                        free(entries);
+                        free(slots);
+                        error(err, NG5_ERR_MALLOCERR);
+                        return false;
+                }
+                for (size_t i = 0; i < num_strings; i++) {
+                        heap_order[i] = entries + i;
+                }
+                qsort(heap_order, num_strings, sizeof(struct string_table_entry *),
+                        compare_string_table_entries_by_string);
+        }
 
-                offset_t header_pos_off = memfile_tell(memfile);
-                memfile_skip(memfile, sizeof(struct string_entry_header));
+        offset_t directory_off = memfile_tell(memfile);
+        memfile_skip(memfile, num_strings * sizeof(struct string_table_slot));
 
-                if (!pack_encode(err, &strategy, memfile, string)) {
+        for (size_t k = 0; k < num_strings; k++) {
+                size_t i = heap_order ? (size_t) (heap_order[k] - entries) : k;
+                slots[i] = (struct string_table_slot) {.string_id = entries[i].id, .offset = memfile_tell(memfile),
+                        .string_len = strlen(entries[i].string)};
+                if (!pack_encode(err, &strategy, memfile, entries[i].string)) {
                         error_print(err.code);
+                        free(heap_order);
+                        free(entries);
+                        free(slots);
                         return false;
                 }
-                offset_t continue_off = memfile_tell(memfile);
-                memfile_seek(memfile, header_pos_off);
-                header.next_entry_off = i + 1 < strings->num_elems ? continue_off : 0;
-                memfile_write(memfile, &header, sizeof(struct string_entry_header));
-                memfile_seek(memfile, continue_off);
         }
+        free(heap_order);
 
         offset_t continue_pos = memfile_tell(memfile);
+        memfile_seek(memfile, directory_off);
+        memfile_write(memfile, slots, num_strings * sizeof(struct string_table_slot));
         memfile_seek(memfile, header_pos);
         memfile_write(memfile, &header, sizeof(struct string_table_header));
         memfile_seek(memfile, continue_pos);
 
-        vec_drop(strings);
-        vec_drop(string_ids);
-        free(strings);
-        free(string_ids);
+        free(entries);
+        free(slots);
 
         return pack_drop(err, &strategy);
 }
 
+static bool serialize_string_dic(struct memfile *memfile, struct err *err, const struct columndoc *model,
+        enum packer_type compressor)
+{
+        if (model->ordered_string_ids) {
+                /** the id of a string is its position in the ordered string list plus one */
+                return write_string_table(memfile, err, &model->ordered_strings, NULL, compressor);
+        } else {
+                struct vector ofType (const char *) *strings;
+                struct vector ofType(field_sid_t) *string_ids;
+                doc_bulk_get_dic_contents(&strings, &string_ids, model->bulk);
+                assert(strings->num_elems == string_ids->num_elems);
+
+                bool status = write_string_table(memfile, err, strings, string_ids, compressor);
+
+                vec_drop(strings);
+                vec_drop(string_ids);
+                free(strings);
+                free(string_ids);
+                return status;
+        }
+}
+
 static void skip_file_header(struct memfile *memfile)
 {
         memfile_skip(memfile, sizeof(struct archive_header));
@@ -1479,11 +2338,83 @@ static void update_file_header(struct memfile *memfile, offset_t record_header_o
         memfile_seek(memfile, current_pos);
 }
 
+static const char *intpack_scheme_to_string(u8 scheme)
+{
+        switch (scheme) {
+        case INTPACK_FOR:
+                return "for";
+        case INTPACK_DELTA:
+                return "delta";
+        case INTPACK_RLE:
+                return "rle";
+        default:
+                return "unknown";
+        }
+}
+
+static bool print_packed_column_from_memfile(FILE *file, struct err *err, struct memfile *memfile,
+        const struct column_header *header, offset_t offset, unsigned nesting_level)
+{
+        field_e data_type = int_marker_to_field_type(header->value_type);
+        const char *type_name = array_value_type_to_string(err, data_type);
+        if (!type_name) {
+                return false;
+        }
+
+        fprintf(file, "0x%04x ", (unsigned) offset);
+        INTENT_LINE(nesting_level);
+        fprintf(file,
+                "[marker: %c (Packed Column)] [column_name: '%"PRIu64"'] [value_type: %c (%s)] [nentries: %d] ",
+                header->marker,
+                header->column_name,
+                header->value_type,
+                type_name,
+                header->num_entries);
+
+        u32 *positions = (u32 *) NG5_MEMFILE_READ(memfile, header->num_entries * sizeof(u32));
+        fprintf(file, "[positions: [");
+        for (size_t i = 0; i < header->num_entries; i++) {
+                fprintf(file, "%d%s", positions[i], i + 1 < header->num_entries ? ", " : "");
+        }
+        fprintf(file, "]]\n");
+
+        offset = memfile_tell(memfile);
+        const struct coding_intpack_header *packed = NG5_MEMFILE_READ_TYPE(memfile, struct coding_intpack_header);
+        const void *payload = NG5_MEMFILE_READ(memfile, coding_intpack_payload_size(packed));
+        fprintf(file, "0x%04x ", (unsigned) offset);
+        INTENT_LINE(nesting_level);
+        fprintf(file, "   [scheme: %s] [width: %d] [run-width: %d] [num-runs: %d] [reference: %"PRIu64"] [values: [",
+                intpack_scheme_to_string(packed->scheme), packed->width, packed->run_width, packed->num_runs,
+                packed->reference);
+
+        bool is_signed = data_type == FIELD_INT8 || data_type == FIELD_INT16 || data_type == FIELD_INT32 ||
+                data_type == FIELD_INT64;
+        struct coding_intpack_cursor cursor;
+        u64 window[NG5_INTPACK_WINDOW];
+        u32 num_decoded;
+        coding_intpack_cursor_init(&cursor, packed);
+        while ((num_decoded = coding_intpack_decode(window, NG5_INTPACK_WINDOW, &cursor, packed, payload))) {
+                for (u32 i = 0; i < num_decoded; i++) {
+                        const char *sep = cursor.idx - num_decoded + i + 1 < packed->num_values ? ", " : "";
+                        if (is_signed) {
+                                fprintf(file, "%"PRIi64"%s", coding_intpack_signed_from_key(window[i]), sep);
+                        } else {
+                                fprintf(file, "%"PRIu64"%s", window[i], sep);
+                        }
+                }
+        }
+        fprintf(file, "]]\n");
+        return true;
+}
+
 static bool print_column_form_memfile(FILE *file, struct err *err, struct memfile *memfile, unsigned nesting_level)
 {
         offset_t offset;
         memfile_get_offset(&offset, memfile);
         struct column_header *header = NG5_MEMFILE_READ_TYPE(memfile, struct column_header);
+        if (header->marker == MARKER_SYMBOL_COLUMN_PACKED) {
+                return print_packed_column_from_memfile(file, err, memfile, header, offset, nesting_level);
+        }
         if (header->marker != MARKER_SYMBOL_COLUMN) {
                 char buffer[256];
                 sprintf(buffer, "expected marker [%c] but found [%c]", MARKER_SYMBOL_COLUMN, header->marker);
@@ -1595,6 +2526,101 @@ static bool print_column_form_memfile(FILE *file, struct err *err, struct memfil
         return true;
 }
 
+static bool print_zone_map_from_memfile(FILE *file, struct err *err, struct memfile *memfile, unsigned nesting_level)
+{
+        offset_t offset = memfile_tell(memfile);
+        struct zone_map_header *header = NG5_MEMFILE_READ_TYPE(memfile, struct zone_map_header);
+        if (header->marker != MARKER_SYMBOL_ZONE_MAP) {
+                char buffer[256];
+                sprintf(buffer, "expected marker [%c] but found [%c]", MARKER_SYMBOL_ZONE_MAP, header->marker);
+                error_with_details(err, NG5_ERR_CORRUPTED, buffer);
+                return false;
+        }
+        fprintf(file, "0x%04x ", (unsigned) offset);
+        INTENT_LINE(nesting_level);
+        fprintf(file, "[marker: %c (Zone Map)] [num_entries: %d]\n", header->marker, header->num_entries);
+
+        for (u32 i = 0; i < header->num_entries; i++) {
+                offset = memfile_tell(memfile);
+                struct zone_map_entry *entry = NG5_MEMFILE_READ_TYPE(memfile, struct zone_map_entry);
+                fprintf(file, "0x%04x ", (unsigned) offset);
+                INTENT_LINE(nesting_level + 1);
+                fprintf(file,
+                        "[column_name: %"PRIu64"] [value_type: %c] [num_values: %d] [num_nulls: %d] "
+                        "[min_key: %"PRIu64"] [max_key: %"PRIu64"] [bloom_blocks: %d]\n",
+                        entry->column_name,
+                        entry->value_type,
+                        entry->num_values,
+                        entry->num_nulls,
+                        entry->min,
+                        entry->max,
+                        entry->bloom_blocks);
+                memfile_skip(memfile, entry->bloom_blocks * NG5_BLOOM_BLOCK_WORDS * sizeof(u32));
+        }
+        return true;
+}
+
+static bool print_column_group_from_memfile(FILE *file, struct err *err, struct memfile *memfile,
+        unsigned nesting_level)
+{
+        unsigned offset = (unsigned) memfile_tell(memfile);
+        struct column_group_header
+                *column_group_header = NG5_MEMFILE_READ_TYPE(memfile, struct column_group_header);
+        bool is_row_group = column_group_header->marker == MARKER_SYMBOL_ROW_GROUP;
+        if (column_group_header->marker != MARKER_SYMBOL_COLUMN_GROUP && !is_row_group) {
+                char buffer[256];
+                sprintf(buffer,
+                        "expected marker [%c] but found [%c]",
+                        MARKER_SYMBOL_COLUMN_GROUP,
+                        column_group_header->marker);
+                error_with_details(err, NG5_ERR_CORRUPTED, buffer);
+                return false;
+        }
+        fprintf(file, "0x%04x ", offset);
+        INTENT_LINE(nesting_level);
+        fprintf(file,
+                "[marker: %c (%s)] [num_columns: %d] [num_objects: %d] ",
+                column_group_header->marker,
+                is_row_group ? "Row Group" : "Column Group",
+                column_group_header->num_columns,
+                column_group_header->num_objects);
+        if (is_row_group) {
+                offset_t zone_map_off = *NG5_MEMFILE_READ_TYPE(memfile, offset_t);
+                fprintf(file, "[zone_map: 0x%04x] ", (unsigned) zone_map_off);
+        }
+        fprintf(file, "[object_ids: ");
+        const object_id_t
+                *oids = NG5_MEMFILE_READ_TYPE_LIST(memfile, object_id_t, column_group_header->num_objects);
+        for (size_t k = 0; k < column_group_header->num_objects; k++) {
+                fprintf(file, "%"PRIu64"%s", oids[k], k + 1 < column_group_header->num_objects ? ", " : "");
+        }
+        fprintf(file, "] [offsets: ");
+        for (size_t k = 0; k < column_group_header->num_columns; k++) {
+                offset_t column_off = *NG5_MEMFILE_READ_TYPE(memfile, offset_t);
+                fprintf(file,
+                        "0x%04x%s",
+                        (unsigned) column_off,
+                        k + 1 < column_group_header->num_columns ? ", " : "");
+        }
+
+        fprintf(file, "]\n");
+
+        for (size_t k = 0; k < column_group_header->num_columns; k++) {
+                if (!print_column_form_memfile(file, err, memfile, nesting_level + 1)) {
+                        return false;
+                }
+        }
+
+        if (is_row_group && !print_zone_map_from_memfile(file, err, memfile, nesting_level + 1)) {
+                return false;
+        }
+
+        fprintf(file, "0x%04x ", offset);
+        INTENT_LINE(nesting_level);
+        fprintf(file, "]\n");
+        return true;
+}
+
 static bool print_object_array_from_memfile(FILE *file, struct err *err, struct memfile *memfile,
         unsigned nesting_level)
 {
@@ -1628,51 +2654,46 @@ static bool print_object_array_from_memfile(FILE *file, struct err *err, struct
         nesting_level++;
 
         for (size_t i = 0; i < header->num_entries; i++) {
-                offset = memfile_tell(memfile);
-                struct column_group_header
-                        *column_group_header = NG5_MEMFILE_READ_TYPE(memfile, struct column_group_header);
-                if (column_group_header->marker != MARKER_SYMBOL_COLUMN_GROUP) {
-                        char buffer[256];
-                        sprintf(buffer,
-                                "expected marker [%c] but found [%c]",
-                                MARKER_SYMBOL_COLUMN_GROUP,
-                                column_group_header->marker);
-                        error_with_details(err, NG5_ERR_CORRUPTED, buffer);
+                if (!print_column_group_from_memfile(file, err, memfile, nesting_level)) {
                         return false;
                 }
-                fprintf(file, "0x%04x ", offset);
-                INTENT_LINE(nesting_level);
-                fprintf(file,
-                        "[marker: %c (Column Group)] [num_columns: %d] [num_objects: %d] [object_ids: ",
-                        column_group_header->marker,
-                        column_group_header->num_columns,
-                        column_group_header->num_objects);
-                const object_id_t
-                        *oids = NG5_MEMFILE_READ_TYPE_LIST(memfile, object_id_t, column_group_header->num_objects);
-                for (size_t k = 0; k < column_group_header->num_objects; k++) {
-                        fprintf(file, "%"PRIu64"%s", oids[k], k + 1 < column_group_header->num_objects ? ", " : "");
-                }
-                fprintf(file, "] [offsets: ");
-                for (size_t k = 0; k < column_group_header->num_columns; k++) {
-                        offset_t column_off = *NG5_MEMFILE_READ_TYPE(memfile, offset_t);
-                        fprintf(file,
-                                "0x%04x%s",
-                                (unsigned) column_off,
-                                k + 1 < column_group_header->num_columns ? ", " : "");
-                }
+        }
+        return true;
+}
 
-                fprintf(file, "]\n");
+static bool print_object_array_stream_from_memfile(FILE *file, struct err *err, struct memfile *memfile,
+        unsigned nesting_level)
+{
+        unsigned offset = (unsigned) memfile_tell(memfile);
+        struct object_array_stream_header *header = NG5_MEMFILE_READ_TYPE(memfile, struct object_array_stream_header);
 
-                for (size_t k = 0; k < column_group_header->num_columns; k++) {
-                        if (!print_column_form_memfile(file, err, memfile, nesting_level + 1)) {
-                                return false;
-                        }
+        fprintf(file, "0x%04x ", offset);
+        INTENT_LINE(nesting_level);
+        fprintf(file, "[marker: %c (Object Array Stream)] [nentries: %d] [directory: 0x%04x]\n", header->marker,
+                header->num_entries, (unsigned) header->directory_off);
+
+        /** groups are printed in file order, and are followed by the directory that addresses them */
+        u32 num_entries = header->num_entries;
+        for (u32 i = 0; i < num_entries; i++) {
+                if (!print_column_group_from_memfile(file, err, memfile, nesting_level + 1)) {
+                        return false;
                 }
+        }
 
-                fprintf(file, "0x%04x ", offset);
-                INTENT_LINE(nesting_level);
-                fprintf(file, "]\n");
+        offset = (unsigned) memfile_tell(memfile);
+        fprintf(file, "0x%04x ", offset);
+        INTENT_LINE(nesting_level + 1);
+        fprintf(file, "[directory] [");
+        for (u32 i = 0; i < num_entries; i++) {
+                field_sid_t string_id = *NG5_MEMFILE_READ_TYPE(memfile, field_sid_t);
+                fprintf(file, "key: %"PRIu64"%s", string_id, i + 1 < num_entries ? ", " : "");
         }
+        fprintf(file, "] [");
+        for (u32 i = 0; i < num_entries; i++) {
+                offset_t column_group_offset = *NG5_MEMFILE_READ_TYPE(memfile, offset_t);
+                fprintf(file, "offset: 0x%04x%s", (unsigned) column_group_offset, i + 1 < num_entries ? ", " : "");
+        }
+        fprintf(file, "]\n");
         return true;
 }
 
@@ -2115,6 +3136,11 @@ bool print_object(FILE *file, struct err *err, struct memfile *memfile, unsigned
                                 return false;
                         }
                         break;
+                case MARKER_SYMBOL_PROP_OBJECT_ARRAY_STREAM:
+                        if (!print_object_array_stream_from_memfile(file, err, memfile, nesting_level)) {
+                                return false;
+                        }
+                        break;
                 case MARKER_SYMBOL_OBJECT_END:
                         continue_read = false;
                         break;
@@ -2150,7 +3176,7 @@ static bool is_valid_file(const struct archive_header *header)
                                 return false;
                         }
                 }
-                if (header->version != CARBON_ARCHIVE_VERSION) {
+                if (header->version < CARBON_ARCHIVE_VERSION_MIN || header->version > CARBON_ARCHIVE_VERSION) {
                         return false;
                 }
                 if (header->root_object_header_offset == 0) {
@@ -2164,8 +3190,8 @@ static void print_record_header_from_memfile(FILE *file, struct memfile *memfile
 {
         unsigned offset = memfile_tell(memfile);
         struct record_header *header = NG5_MEMFILE_READ_TYPE(memfile, struct record_header);
-        struct record_flags flags;
-        memset(&flags, 0, sizeof(struct record_flags));
+        union record_flags flags;
+        memset(&flags, 0, sizeof(union record_flags));
         flags.value = header->flags;
         char *flags_string = record_header_flags_to_string(&flags);
         fprintf(file, "0x%04x ", offset);
@@ -2203,11 +3229,13 @@ static bool print_embedded_dic_from_memfile(FILE *file, struct err *err, struct
 
         unsigned offset = memfile_tell(memfile);
         struct string_table_header *header = NG5_MEMFILE_READ_TYPE(memfile, struct string_table_header);
-        if (header->marker != marker_symbols[MARKER_TYPE_EMBEDDED_STR_DIC].symbol) {
+        bool indexed = header->marker == marker_symbols[MARKER_TYPE_EMBEDDED_STR_TAB].symbol;
+        if (header->marker != marker_symbols[MARKER_TYPE_EMBEDDED_STR_DIC].symbol && !indexed) {
                 char buffer[256];
                 sprintf(buffer,
-                        "expected [%c] marker, but found [%c]",
+                        "expected [%c] or [%c] marker, but found [%c]",
                         marker_symbols[MARKER_TYPE_EMBEDDED_STR_DIC].symbol,
+                        marker_symbols[MARKER_TYPE_EMBEDDED_STR_TAB].symbol,
                         header->marker);
                 error_with_details(err, NG5_ERR_CORRUPTED, buffer);
                 return false;
@@ -2232,6 +3260,26 @@ static bool print_embedded_dic_from_memfile(FILE *file, struct err *err, struct
 
         pack_print_extra(err, &strategy, file, memfile);
 
+        if (indexed) {
+                u32 num_entries = header->num_entries;
+                memfile_seek(memfile, header->first_entry);
+                const struct string_table_slot *slots = (const struct string_table_slot *) NG5_MEMFILE_READ(memfile,
+                        num_entries * sizeof(struct string_table_slot));
+                for (u32 i = 0; i < num_entries; i++) {
+                        fprintf(file,
+                                "0x%04x    [slot: %"PRIu32"] [string-id: %"PRIu64"] [string-off: 0x%04zx] [string-length: %"PRIu32"]",
+                                (unsigned) (header->first_entry + i * sizeof(struct string_table_slot)),
+                                i,
+                                slots[i].string_id,
+                                (size_t) slots[i].offset,
+                                slots[i].string_len);
+                        memfile_seek(memfile, slots[i].offset);
+                        pack_print_encoded(err, &strategy, file, memfile, slots[i].string_len);
+                        fprintf(file, "\n");
+                }
+                return pack_drop(err, &strategy);
+        }
+
         while ((*NG5_MEMFILE_PEEK(memfile, char)) == marker_symbols[MARKER_TYPE_EMBEDDED_UNCOMP_STR].symbol) {
                 unsigned offset = memfile_tell(memfile);
                 struct string_entry_header header = *NG5_MEMFILE_READ_TYPE(memfile, struct string_entry_header);
@@ -2299,15 +3347,21 @@ static union object_flags *get_flags(union object_flags *flags, struct columndoc
 
 static bool init_decompressor(struct packer *strategy, u8 flags);
 
-static bool read_stringtable(struct string_table *table, struct err *err, FILE *disk_file);
+static bool read_stringtable(struct string_table *table, struct err *err, FILE *disk_file,
+        enum archive_open_mode mode);
 
 static bool read_record(struct record_header *header_read, struct archive *archive, FILE *disk_file,
-        offset_t record_header_offset);
+        offset_t record_header_offset, enum archive_open_mode mode);
 
 static bool read_string_id_to_offset_index(struct err *err, struct archive *archive, const char *file_path,
         offset_t string_id_to_offset_index_offset);
 
 bool archive_open(struct archive *out, const char *file_path)
+{
+        return archive_open_with_mode(out, file_path, ARCHIVE_OPEN_MAPPED);
+}
+
+bool archive_open_with_mode(struct archive *out, const char *file_path, enum archive_open_mode mode)
 {
         int status;
         FILE *disk_file;
@@ -2335,13 +3389,14 @@ bool archive_open(struct archive *out, const char *file_path)
 
                                 struct record_header record_header;
 
-                                if ((status = read_stringtable(&out->string_table, &out->err, disk_file)) != true) {
+                                if ((status = read_stringtable(&out->string_table, &out->err, disk_file, mode)) != true) {
                                         return status;
                                 }
                                 if ((status = read_record(&record_header,
                                         out,
                                         disk_file,
-                                        header.root_object_header_offset)) != true) {
+                                        header.root_object_header_offset,
+                                        mode)) != true) {
                                         return status;
                                 }
 
@@ -2390,12 +3445,21 @@ NG5_EXPORT(bool) archive_get_info(struct archive_info *info, const struct archiv
         return true;
 }
 
+NG5_EXPORT(bool) archive_advise(struct archive *archive, enum memblock_advice advice)
+{
+        error_if_null(archive);
+        return memblock_advise(archive->record_table.recordDataBase, advice);
+}
+
 NG5_EXPORT(bool) archive_close(struct archive *archive)
 {
         error_if_null(archive);
         archive_drop_indexes(archive);
         archive_drop_query_string_id_cache(archive);
         free(archive->diskFilePath);
+        if (archive->string_table.directory) {
+                memblock_drop(archive->string_table.directory);
+        }
         memblock_drop(archive->record_table.recordDataBase);
         query_drop(archive->default_query);
         free(archive->default_query);
@@ -2416,7 +3480,8 @@ NG5_EXPORT(bool) archive_query(struct archive_query *query, struct archive *arch
         if (query_create(query, archive)) {
                 bool has_index = false;
                 archive_has_query_index_string_id_to_offset(&has_index, archive);
-                if (!has_index) {
+                /** indexed string tables are looked up by their slot directory */
+                if (!has_index && !archive->string_table.indexed) {
                         query_create_index_string_id_to_offset(&archive->query_index_string_id_to_offset, query);
                 }
                 bool has_cache = false;
@@ -2474,7 +3539,8 @@ static bool init_decompressor(struct packer *strategy, u8 flags)
         return true;
 }
 
-static bool read_stringtable(struct string_table *table, struct err *err, FILE *disk_file)
+static bool read_stringtable(struct string_table *table, struct err *err, FILE *disk_file,
+        enum archive_open_mode mode)
 {
         assert(disk_file);
 
@@ -2486,7 +3552,8 @@ static bool read_stringtable(struct string_table *table, struct err *err, FILE *
                 error(err, NG5_ERR_IO);
                 return false;
         }
-        if (header.marker != marker_symbols[MARKER_TYPE_EMBEDDED_STR_DIC].symbol) {
+        if (header.marker != marker_symbols[MARKER_TYPE_EMBEDDED_STR_DIC].symbol &&
+                header.marker != marker_symbols[MARKER_TYPE_EMBEDDED_STR_TAB].symbol) {
                 error(err, NG5_ERR_CORRUPTED);
                 return false;
         }
@@ -2494,6 +3561,8 @@ static bool read_stringtable(struct string_table *table, struct err *err, FILE *
         flags.value = header.flags;
         table->first_entry_off = header.first_entry;
         table->num_embeddded_strings = header.num_entries;
+        table->indexed = header.marker == marker_symbols[MARKER_TYPE_EMBEDDED_STR_TAB].symbol;
+        table->directory = NULL;
 
         if ((init_decompressor(&table->compressor, flags.value)) != true) {
                 return false;
@@ -2501,11 +3570,22 @@ static bool read_stringtable(struct string_table *table, struct err *err, FILE *
         if ((pack_read_extra(err, &table->compressor, disk_file, header.compressor_extra_size)) != true) {
                 return false;
         }
+        if (table->indexed && table->num_embeddded_strings > 0) {
+                size_t directory_size = table->num_embeddded_strings * sizeof(struct string_table_slot);
+                fseek(disk_file, table->first_entry_off, SEEK_SET);
+                bool status = mode == ARCHIVE_OPEN_MAPPED ?
+                              memblock_map_file(&table->directory, disk_file, directory_size) :
+                              memblock_from_file(&table->directory, disk_file, directory_size);
+                if (!status) {
+                        error(err, mode == ARCHIVE_OPEN_MAPPED ? NG5_ERR_MMAP_FAILED : NG5_ERR_IO);
+                        return false;
+                }
+        }
         return true;
 }
 
 static bool read_record(struct record_header *header_read, struct archive *archive, FILE *disk_file,
-        offset_t record_header_offset)
+        offset_t record_header_offset, enum archive_open_mode mode)
 {
         struct err err;
         fseek(disk_file, record_header_offset, SEEK_SET);
@@ -2515,10 +3595,16 @@ static bool read_record(struct record_header *header_read, struct archive *archi
                 return false;
         } else {
                 archive->record_table.flags.value = header.flags;
-                bool status = memblock_from_file(&archive->record_table.recordDataBase, disk_file, header.record_size);
+                bool status = mode == ARCHIVE_OPEN_MAPPED ?
+                              memblock_map_file(&archive->record_table.recordDataBase, disk_file, header.record_size) :
+                              memblock_from_file(&archive->record_table.recordDataBase, disk_file, header.record_size);
                 if (!status) {
-                        memblock_get_error(&err, archive->record_table.recordDataBase);
-                        error_cpy(&archive->err, &err);
+                        if (mode == ARCHIVE_OPEN_MAPPED) {
+                                error(&archive->err, NG5_ERR_MMAP_FAILED);
+                        } else {
+                                memblock_get_error(&err, archive->record_table.recordDataBase);
+                                error_cpy(&archive->err, &err);
+                        }
                         return false;
                 }
 
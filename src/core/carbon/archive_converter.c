@@ -230,7 +230,10 @@ static void before_visit_object_array_objects(bool *skip_group_object_ids, struc
 
         struct converter_capture *extra = (struct converter_capture *) capture;
         struct encoded_doc *doc = encoded_doc_collection_get_or_append(extra->collection, parent_id);
-        encoded_doc_add_prop_array_object(doc, key);
+        /* row groups of a large object array append their objects to the array created for the first row group */
+        if (!hashtable_get_value(&doc->prop_array_index, &key)) {
+                encoded_doc_add_prop_array_object(doc, key);
+        }
         for (u32 i = 0; i < num_group_object_ids; i++) {
                 encoded_doc_array_push_object(doc, key, group_object_ids[i]);
         }
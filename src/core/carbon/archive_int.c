@@ -16,6 +16,7 @@
  */
 
 #include <assert.h>
+#include <string.h>
 #include "core/carbon/archive_int.h"
 
 struct archive_header this_file_header = {.version = CARBON_ARCHIVE_VERSION, .root_object_header_offset = 0};
@@ -46,7 +47,11 @@ struct marker_symbol_entry marker_symbols[] =
          {MARKER_TYPE_EMBEDDED_UNCOMP_STR, MARKER_SYMBOL_EMBEDDED_STR},
          {MARKER_TYPE_COLUMN_GROUP, MARKER_SYMBOL_COLUMN_GROUP}, {MARKER_TYPE_COLUMN, MARKER_SYMBOL_COLUMN},
          {MARKER_TYPE_HUFFMAN_DIC_ENTRY, MARKER_SYMBOL_HUFFMAN_DIC_ENTRY},
-         {MARKER_TYPE_RECORD_HEADER, MARKER_SYMBOL_RECORD_HEADER}};
+         {MARKER_TYPE_RECORD_HEADER, MARKER_SYMBOL_RECORD_HEADER},
+         {MARKER_TYPE_EMBEDDED_STR_TAB, MARKER_SYMBOL_EMBEDDED_STR_TAB},
+         {MARKER_TYPE_COLUMN_PACKED, MARKER_SYMBOL_COLUMN_PACKED},
+         {MARKER_TYPE_ROW_GROUP, MARKER_SYMBOL_ROW_GROUP}, {MARKER_TYPE_ZONE_MAP, MARKER_SYMBOL_ZONE_MAP},
+         {MARKER_TYPE_PROP_OBJECT_ARRAY_STREAM, MARKER_SYMBOL_PROP_OBJECT_ARRAY_STREAM}};
 
 struct value_array_marker_mapping_entry value_array_marker_mapping[] =
         {{FIELD_NULL, MARKER_TYPE_PROP_NULL_ARRAY}, {FIELD_BOOLEAN, MARKER_TYPE_PROP_BOOLEAN_ARRAY},
@@ -187,6 +192,129 @@ void int_embedded_table_props_read(struct table_prop *prop, struct memfile *memf
         prop->groupOffs = (offset_t *) NG5_MEMFILE_READ(memfile, prop->header->num_entries * sizeof(offset_t));
 }
 
+const struct string_table_slot *int_string_table_slots(const struct string_table *table)
+{
+        return table->directory ? (const struct string_table_slot *) memblock_raw_data(table->directory) : NULL;
+}
+
+const struct string_table_slot *int_string_table_find(const struct string_table *table, field_sid_t id)
+{
+        const struct string_table_slot *slots = int_string_table_slots(table);
+        size_t num_slots = table->num_embeddded_strings;
+        if (!slots) {
+                return NULL;
+        }
+        /* ids handed out in order (e.g., in read-optimized archives) are the slot position plus one */
+        if (id >= 1 && id <= num_slots && slots[id - 1].string_id == id) {
+                return slots + id - 1;
+        }
+        size_t lo = 0, hi = num_slots;
+        while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (slots[mid].string_id < id) {
+                        lo = mid + 1;
+                } else {
+                        hi = mid;
+                }
+        }
+        return lo < num_slots && slots[lo].string_id == id ? slots + lo : NULL;
+}
+
+bool int_is_packable_type(field_e type)
+{
+        switch (type) {
+        case FIELD_BOOLEAN:
+        case FIELD_INT8:
+        case FIELD_INT16:
+        case FIELD_INT32:
+        case FIELD_INT64:
+        case FIELD_UINT8:
+        case FIELD_UINT16:
+        case FIELD_UINT32:
+        case FIELD_UINT64:
+        case FIELD_STRING:
+                return true;
+        default:
+                return false;
+        }
+}
+
+u64 int_packed_key_of(field_e type, const void *value)
+{
+        switch (type) {
+        case FIELD_BOOLEAN:
+                return *(const FIELD_BOOLEANean_t *) value;
+        case FIELD_INT8:
+                return coding_intpack_key_from_signed(*(const field_i8_t *) value);
+        case FIELD_INT16:
+                return coding_intpack_key_from_signed(*(const field_i16_t *) value);
+        case FIELD_INT32:
+                return coding_intpack_key_from_signed(*(const field_i32_t *) value);
+        case FIELD_INT64:
+                return coding_intpack_key_from_signed(*(const field_i64_t *) value);
+        case FIELD_UINT8:
+                return *(const field_u8_t *) value;
+        case FIELD_UINT16:
+                return *(const field_u16_t *) value;
+        case FIELD_UINT32:
+                return *(const field_u32_t *) value;
+        case FIELD_UINT64:
+                return *(const field_u64_t *) value;
+        case FIELD_STRING:
+                return *(const field_sid_t *) value;
+        default: print_error_and_die(NG5_ERR_NOTYPE)
+        }
+}
+
+void int_packed_value_of(void *dst, field_e type, u64 key)
+{
+        switch (type) {
+        case FIELD_BOOLEAN:
+                *(FIELD_BOOLEANean_t *) dst = (FIELD_BOOLEANean_t) key;
+                break;
+        case FIELD_INT8:
+                *(field_i8_t *) dst = (field_i8_t) coding_intpack_signed_from_key(key);
+                break;
+        case FIELD_INT16:
+                *(field_i16_t *) dst = (field_i16_t) coding_intpack_signed_from_key(key);
+                break;
+        case FIELD_INT32:
+                *(field_i32_t *) dst = (field_i32_t) coding_intpack_signed_from_key(key);
+                break;
+        case FIELD_INT64:
+                *(field_i64_t *) dst = coding_intpack_signed_from_key(key);
+                break;
+        case FIELD_UINT8:
+                *(field_u8_t *) dst = (field_u8_t) key;
+                break;
+        case FIELD_UINT16:
+                *(field_u16_t *) dst = (field_u16_t) key;
+                break;
+        case FIELD_UINT32:
+                *(field_u32_t *) dst = (field_u32_t) key;
+                break;
+        case FIELD_UINT64:
+                *(field_u64_t *) dst = key;
+                break;
+        case FIELD_STRING:
+                *(field_sid_t *) dst = key;
+                break;
+        default: print_error_and_die(NG5_ERR_NOTYPE)
+        }
+}
+
+u64 int_zone_key_of(field_e type, const void *value)
+{
+        if (type == FIELD_FLOAT) {
+                /* flips all bits of negative numbers, and the sign bit of positive ones */
+                u32 bits;
+                memcpy(&bits, value, sizeof(u32));
+                return (bits & 0x80000000U) ? (u32) ~bits : bits | 0x80000000U;
+        } else {
+                return int_packed_key_of(type, value);
+        }
+}
+
 field_e int_get_value_type_of_char(char c)
 {
         size_t len = sizeof(value_array_marker_mapping) / sizeof(value_array_marker_mapping[0]);
@@ -240,6 +368,7 @@ int_marker_to_field_type(char symbol)
                 return FIELD_STRING;
         case MARKER_SYMBOL_PROP_OBJECT:
         case MARKER_SYMBOL_PROP_OBJECT_ARRAY:
+        case MARKER_SYMBOL_PROP_OBJECT_ARRAY_STREAM:
                 return FIELD_OBJECT;
         default: {
                 print_error_and_die(NG5_ERR_MARKERMAPPING);
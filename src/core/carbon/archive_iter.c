@@ -17,6 +17,7 @@
 
 #include "core/carbon/archive_iter.h"
 #include "core/carbon/archive_int.h"
+#include "std/bloom.h"
 
 static bool init_object_from_memfile(struct archive_object *obj, struct memfile *memfile)
 {
@@ -110,11 +111,27 @@ static bool prop_iter_read_colum_entry(struct collection_iter_state *state, stru
                 < state->current_column_group.current_column.num_elem);
 
         u32 current_idx = state->current_column_group.current_column.current_entry.idx;
-        offset_t entry_off = state->current_column_group.current_column.elem_offsets[current_idx];
-        memfile_seek(memfile, entry_off);
+        if (state->current_column_group.current_column.packed) {
+                /* entries are read in order; decode the next window of values once the current one is used up */
+                u64 *window = state->current_column_group.current_column.packed_window;
+                if (current_idx % NG5_INTPACK_WINDOW == 0) {
+                        coding_intpack_decode(window, NG5_INTPACK_WINDOW,
+                                &state->current_column_group.current_column.packed_cursor,
+                                state->current_column_group.current_column.packed,
+                                state->current_column_group.current_column.packed_values);
+                }
+                int_packed_value_of(&state->current_column_group.current_column.current_entry.packed_value,
+                        state->current_column_group.current_column.type, window[current_idx % NG5_INTPACK_WINDOW]);
+                state->current_column_group.current_column.current_entry.array_length = 1;
+                state->current_column_group.current_column.current_entry.array_base = NULL;
+        } else {
+                offset_t entry_off = state->current_column_group.current_column.elem_offsets[current_idx];
+                memfile_seek(memfile, entry_off);
 
-        state->current_column_group.current_column.current_entry.array_length = *NG5_MEMFILE_READ_TYPE(memfile, u32);
-        state->current_column_group.current_column.current_entry.array_base = NG5_MEMFILE_PEEK(memfile, void);
+                state->current_column_group.current_column.current_entry.array_length =
+                        *NG5_MEMFILE_READ_TYPE(memfile, u32);
+                state->current_column_group.current_column.current_entry.array_base = NG5_MEMFILE_PEEK(memfile, void);
+        }
 
         return (++state->current_column_group.current_column.current_entry.idx)
                 < state->current_column_group.current_column.num_elem;
@@ -129,15 +146,27 @@ static bool prop_iter_read_column(struct collection_iter_state *state, struct me
         memfile_seek(memfile, column_off);
         const struct column_header *header = NG5_MEMFILE_READ_TYPE(memfile, struct column_header);
 
-        assert(header->marker == MARKER_SYMBOL_COLUMN);
+        assert(header->marker == MARKER_SYMBOL_COLUMN || header->marker == MARKER_SYMBOL_COLUMN_PACKED);
         state->current_column_group.current_column.name = header->column_name;
         state->current_column_group.current_column.type = int_marker_to_field_type(header->value_type);
 
         state->current_column_group.current_column.num_elem = header->num_entries;
-        state->current_column_group.current_column.elem_offsets =
-                NG5_MEMFILE_READ_TYPE_LIST(memfile, offset_t, header->num_entries);
-        state->current_column_group.current_column.elem_positions =
-                NG5_MEMFILE_READ_TYPE_LIST(memfile, u32, header->num_entries);
+        if (header->marker == MARKER_SYMBOL_COLUMN_PACKED) {
+                const struct coding_intpack_header *packed;
+                state->current_column_group.current_column.elem_offsets = NULL;
+                state->current_column_group.current_column.elem_positions =
+                        NG5_MEMFILE_READ_TYPE_LIST(memfile, u32, header->num_entries);
+                packed = NG5_MEMFILE_READ_TYPE(memfile, struct coding_intpack_header);
+                state->current_column_group.current_column.packed = packed;
+                state->current_column_group.current_column.packed_values = memfile_peek(memfile, 0);
+                coding_intpack_cursor_init(&state->current_column_group.current_column.packed_cursor, packed);
+        } else {
+                state->current_column_group.current_column.elem_offsets =
+                        NG5_MEMFILE_READ_TYPE_LIST(memfile, offset_t, header->num_entries);
+                state->current_column_group.current_column.elem_positions =
+                        NG5_MEMFILE_READ_TYPE_LIST(memfile, u32, header->num_entries);
+                state->current_column_group.current_column.packed = NULL;
+        }
         state->current_column_group.current_column.current_entry.idx = 0;
 
         return (++state->current_column_group.current_column.idx) < state->current_column_group.num_columns;
@@ -148,7 +177,9 @@ static bool collection_iter_read_next_column_group(struct collection_iter_state
         assert(state->current_column_group_idx < state->num_column_groups);
         memfile_seek(memfile, state->column_group_offsets[state->current_column_group_idx]);
         const struct column_group_header *header = NG5_MEMFILE_READ_TYPE(memfile, struct column_group_header);
-        assert(header->marker == MARKER_SYMBOL_COLUMN_GROUP);
+        assert(header->marker == MARKER_SYMBOL_COLUMN_GROUP || header->marker == MARKER_SYMBOL_ROW_GROUP);
+        state->current_column_group.zone_map_off = header->marker == MARKER_SYMBOL_ROW_GROUP ?
+                                                   *NG5_MEMFILE_READ_TYPE(memfile, offset_t) : 0;
         state->current_column_group.num_columns = header->num_columns;
         state->current_column_group.num_objects = header->num_objects;
         state->current_column_group.object_ids = NG5_MEMFILE_READ_TYPE_LIST(memfile, object_id_t, header->num_objects);
@@ -190,9 +221,16 @@ static void prop_iter_cursor_init(struct prop_iter *iter)
         if (iter->mode == PROP_ITER_MODE_COLLECTION) {
                 iter->mode_collection.collection_start_off = offset_by_state(iter);
                 memfile_seek(&iter->record_table_memfile, iter->mode_collection.collection_start_off);
-                const struct object_array_header
-                        *header = NG5_MEMFILE_READ_TYPE(&iter->record_table_memfile, struct object_array_header);
-                iter->mode_collection.num_column_groups = header->num_entries;
+                if (*NG5_MEMFILE_PEEK(&iter->record_table_memfile, char) == MARKER_SYMBOL_PROP_OBJECT_ARRAY_STREAM) {
+                        const struct object_array_stream_header *header = NG5_MEMFILE_READ_TYPE(
+                                &iter->record_table_memfile, struct object_array_stream_header);
+                        iter->mode_collection.num_column_groups = header->num_entries;
+                        memfile_seek(&iter->record_table_memfile, header->directory_off);
+                } else {
+                        const struct object_array_header *header = NG5_MEMFILE_READ_TYPE(
+                                &iter->record_table_memfile, struct object_array_header);
+                        iter->mode_collection.num_column_groups = header->num_entries;
+                }
                 iter->mode_collection.current_column_group_idx = 0;
                 iter->mode_collection.column_group_keys = NG5_MEMFILE_READ_TYPE_LIST(&iter->record_table_memfile,
                         field_sid_t,
@@ -580,6 +618,175 @@ NG5_EXPORT(const object_id_t *)archive_column_group_get_object_ids(u32 *num_obje
         }
 }
 
+NG5_EXPORT(bool) archive_column_group_get_zone_map(struct archive_zone_map *zone_map,
+        archive_column_group_iter_t *iter)
+{
+        error_if_null(zone_map)
+        error_if_null(iter)
+
+        offset_t zone_map_off = iter->state.current_column_group.zone_map_off;
+        if (zone_map_off != 0) {
+                struct memfile memfile;
+                memfile_open(&memfile, iter->record_table_memfile.memblock, READ_ONLY);
+                memfile_seek(&memfile, zone_map_off);
+                const struct zone_map_header *header = NG5_MEMFILE_READ_TYPE(&memfile, struct zone_map_header);
+                if (header->marker != MARKER_SYMBOL_ZONE_MAP) {
+                        error(&iter->err, NG5_ERR_CORRUPTED);
+                        return false;
+                }
+                zone_map->exists = true;
+                zone_map->num_entries = header->num_entries;
+                zone_map->entries = memfile_peek(&memfile, 0);
+        } else {
+                zone_map->exists = false;
+                zone_map->num_entries = 0;
+                zone_map->entries = NULL;
+        }
+        return true;
+}
+
+static const struct zone_map_entry *zone_map_next_entry(const struct zone_map_entry *entry)
+{
+        return (const struct zone_map_entry *) ((const char *) (entry + 1)
+                + entry->bloom_blocks * NG5_BLOOM_BLOCK_WORDS * sizeof(u32));
+}
+
+static bool zone_map_entry_overlaps(const struct zone_map_entry *entry, u64 lo_key, u64 hi_key)
+{
+        return entry->num_values > entry->num_nulls && lo_key <= hi_key && lo_key <= entry->max
+                && entry->min <= hi_key;
+}
+
+static bool is_signed_type(field_e type)
+{
+        return type == FIELD_INT8 || type == FIELD_INT16 || type == FIELD_INT32 || type == FIELD_INT64;
+}
+
+static bool is_unsigned_type(field_e type)
+{
+        return type == FIELD_UINT8 || type == FIELD_UINT16 || type == FIELD_UINT32 || type == FIELD_UINT64;
+}
+
+NG5_EXPORT(bool) archive_zone_map_may_contain_int(const struct archive_zone_map *zone_map, field_sid_t column, i64 lo,
+        i64 hi)
+{
+        if (!zone_map || !zone_map->exists) {
+                return true;
+        }
+        const struct zone_map_entry *entry = zone_map->entries;
+        for (u32 i = 0; i < zone_map->num_entries; i++, entry = zone_map_next_entry(entry)) {
+                if (entry->column_name != column) {
+                        continue;
+                }
+                field_e type = int_marker_to_field_type(entry->value_type);
+                if (is_signed_type(type) && zone_map_entry_overlaps(entry, coding_intpack_key_from_signed(lo),
+                        coding_intpack_key_from_signed(hi))) {
+                        return true;
+                }
+                if (is_unsigned_type(type) && hi >= 0 && zone_map_entry_overlaps(entry, ng5_max(lo, 0), hi)) {
+                        return true;
+                }
+        }
+        return false;
+}
+
+NG5_EXPORT(bool) archive_zone_map_may_contain_uint(const struct archive_zone_map *zone_map, field_sid_t column, u64 lo,
+        u64 hi)
+{
+        if (!zone_map || !zone_map->exists) {
+                return true;
+        }
+        const struct zone_map_entry *entry = zone_map->entries;
+        for (u32 i = 0; i < zone_map->num_entries; i++, entry = zone_map_next_entry(entry)) {
+                if (entry->column_name != column) {
+                        continue;
+                }
+                field_e type = int_marker_to_field_type(entry->value_type);
+                if (is_unsigned_type(type) && zone_map_entry_overlaps(entry, lo, hi)) {
+                        return true;
+                }
+                if (is_signed_type(type) && lo <= INT64_MAX && zone_map_entry_overlaps(entry,
+                        coding_intpack_key_from_signed(lo), coding_intpack_key_from_signed(ng5_min(hi, INT64_MAX)))) {
+                        return true;
+                }
+        }
+        return false;
+}
+
+NG5_EXPORT(bool) archive_zone_map_may_contain_number(const struct archive_zone_map *zone_map, field_sid_t column,
+        field_number_t lo, field_number_t hi)
+{
+        if (!zone_map || !zone_map->exists) {
+                return true;
+        }
+        u64 lo_key = int_zone_key_of(FIELD_FLOAT, &lo);
+        u64 hi_key = int_zone_key_of(FIELD_FLOAT, &hi);
+        const struct zone_map_entry *entry = zone_map->entries;
+        for (u32 i = 0; i < zone_map->num_entries; i++, entry = zone_map_next_entry(entry)) {
+                if (entry->column_name == column && int_marker_to_field_type(entry->value_type) == FIELD_FLOAT
+                        && zone_map_entry_overlaps(entry, lo_key, hi_key)) {
+                        return true;
+                }
+        }
+        return false;
+}
+
+NG5_EXPORT(bool) archive_zone_map_may_contain_string(const struct archive_zone_map *zone_map, field_sid_t column,
+        field_sid_t value)
+{
+        if (!zone_map || !zone_map->exists) {
+                return true;
+        }
+        const struct zone_map_entry *entry = zone_map->entries;
+        for (u32 i = 0; i < zone_map->num_entries; i++, entry = zone_map_next_entry(entry)) {
+                if (entry->column_name != column || int_marker_to_field_type(entry->value_type) != FIELD_STRING) {
+                        continue;
+                }
+                if (NG5_IS_NULL_STRING(value)) {
+                        if (entry->num_nulls > 0) {
+                                return true;
+                        }
+                        continue;
+                }
+                if (!zone_map_entry_overlaps(entry, value, value)) {
+                        continue;
+                }
+                if (entry->bloom_blocks == 0) {
+                        return true;
+                }
+                /* the filter is not aligned inside the record table, but its tests use aligned loads; hence, the
+                 * block in question is copied */
+                u32 block[NG5_BLOOM_BLOCK_WORDS] __attribute__((aligned(32)));
+                u64 hash = bloom_hash(&value, sizeof(field_sid_t));
+                bloom_t filter = {.blocks = (u32 *) (entry + 1), .num_blocks = entry->bloom_blocks};
+                memcpy(block, bloom_block(&filter, hash), sizeof(block));
+                filter.blocks = block;
+                filter.num_blocks = 1;
+                if (bloom_test_hash(&filter, hash)) {
+                        return true;
+                }
+        }
+        return false;
+}
+
+NG5_EXPORT(bool) archive_zone_map_get_num_nulls(u32 *num_nulls, const struct archive_zone_map *zone_map,
+        field_sid_t column)
+{
+        error_if_null(num_nulls)
+        error_if_null(zone_map)
+        if (!zone_map->exists) {
+                return false;
+        }
+        *num_nulls = 0;
+        const struct zone_map_entry *entry = zone_map->entries;
+        for (u32 i = 0; i < zone_map->num_entries; i++, entry = zone_map_next_entry(entry)) {
+                if (entry->column_name == column) {
+                        *num_nulls += entry->num_nulls;
+                }
+        }
+        return true;
+}
+
 NG5_EXPORT(bool) archive_column_group_next_column(archive_column_iter_t *column_iter, archive_column_group_iter_t *iter)
 {
         error_if_null(column_iter)
@@ -648,6 +855,10 @@ archive_column_entry_get_##name(u32 *array_length, archive_column_entry_iter_t *
         if (entry->state.current_column_group.current_column.type == basic_type)                                       \
         {                                                                                                              \
             *array_length =  entry->state.current_column_group.current_column.current_entry.array_length;              \
+            if (entry->state.current_column_group.current_column.packed) {                                             \
+                return (const built_in_type *) &entry->state.current_column_group.current_column.current_entry         \
+                        .packed_value;                                                                                 \
+            }                                                                                                          \
             return (const built_in_type *) entry->state.current_column_group.current_column.current_entry.array_base;  \
         } else {                                                                                                       \
             error(&entry->err, NG5_ERR_TYPEMISMATCH);                                                        \
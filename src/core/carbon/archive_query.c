@@ -19,6 +19,7 @@
 #include "core/carbon/archive_string_pred.h"
 #include "core/carbon/archive_sid_cache.h"
 #include "core/carbon/archive_query.h"
+#include "core/carbon/archive_visitor.h"
 
 struct sid_to_offset_arg {
         offset_t offset;
@@ -289,6 +290,37 @@ static char *fetch_string_by_id_via_index(struct archive_query *query, struct si
         }
 }
 
+static char *fetch_string_by_id_via_directory(struct archive_query *query, field_sid_t id)
+{
+        const struct string_table_slot *slot = int_string_table_find(&query->archive->string_table, id);
+        if (!slot) {
+                error(&query->err, NG5_ERR_NOTFOUND);
+                return NULL;
+        }
+
+        FILE *file = io_context_lock_and_access(query->context);
+        if (!file) {
+                error_cpy(&query->err, io_context_get_error(query->context));
+                return NULL;
+        }
+        bool decode_result;
+        char *result = fetch_string_from_file(&decode_result,
+                file,
+                slot->offset,
+                slot->string_len,
+                &query->err,
+                query->archive);
+        io_context_unlock(query->context);
+
+        if (decode_result) {
+                return result;
+        } else {
+                free(result);
+                error(&query->err, NG5_ERR_DECOMPRESSFAILED);
+                return NULL;
+        }
+}
+
 NG5_EXPORT(char *)query_fetch_string_by_id(struct archive_query *query, field_sid_t id)
 {
         assert(query);
@@ -305,6 +337,9 @@ NG5_EXPORT(char *)query_fetch_string_by_id(struct archive_query *query, field_si
 NG5_EXPORT(char *)query_fetch_string_by_id_nocache(struct archive_query *query, field_sid_t id)
 {
         bool has_index;
+        if (query->archive->string_table.indexed) {
+                return fetch_string_by_id_via_directory(query, id);
+        }
         archive_has_query_index_string_id_to_offset(&has_index, query->archive);
         if (has_index) {
                 return fetch_string_by_id_via_index(query, query->archive->query_index_string_id_to_offset, id);
@@ -374,6 +409,106 @@ NG5_EXPORT(char **)query_fetch_strings_by_offset(struct archive_query *query, of
         return NULL;
 }
 
+/** compares a string to the capture of an equality or prefix predicate, in lexicographic order */
+static int compare_to_pred(const char *string, const char *capture, size_t capture_len, enum string_pred_kind kind)
+{
+        return kind == STRING_PRED_PREFIX ? strncmp(string, capture, capture_len) : strcmp(string, capture);
+}
+
+static char *fetch_string_by_slot(bool *success, FILE *file, const struct string_table_slot *slot,
+        struct archive_query *query)
+{
+        char *string = fetch_string_from_file(success, file, slot->offset, slot->string_len, &query->err,
+                query->archive);
+        if (!*success) {
+                free(string);
+                error(&query->err, NG5_ERR_DECOMPRESSFAILED);
+                return NULL;
+        }
+        return string;
+}
+
+/**
+ * Answers equality and prefix predicates on string tables whose ids follow the lexicographic order of the strings,
+ * i.e., whose slot directory is sorted by string. The first string of each packer block (or each string if the
+ * packer has no blocks) is searched for the last block that may contain the first match, and the matching range is
+ * scanned from there on.
+ */
+static field_sid_t *find_ids_by_search(size_t *num_found, struct archive_query *query,
+        const struct string_pred_t *pred, const char *capture, i64 limit)
+{
+        const struct string_table *table = &query->archive->string_table;
+        const struct string_table_slot *slots = int_string_table_slots(table);
+        const size_t num_slots = table->num_embeddded_strings;
+        const size_t block_size = pack_front_block_size(&table->compressor);
+        const size_t num_blocks = (num_slots + block_size - 1) / block_size;
+        const size_t capture_len = strlen(capture);
+        size_t result_cap = limit < 0 ? 16 : (size_t) limit;
+        size_t result_len = 0;
+        field_sid_t *result = malloc(ng5_max(result_cap, (size_t) 1) * sizeof(field_sid_t));
+        bool success = true;
+        char *string;
+
+        if (!result) {
+                error(&query->err, NG5_ERR_MALLOCERR);
+                return NULL;
+        }
+        FILE *file = io_context_lock_and_access(query->context);
+        if (!file) {
+                error_cpy(&query->err, io_context_get_error(query->context));
+                free(result);
+                return NULL;
+        }
+
+        /** first block whose first string is not less than the capture */
+        size_t lo = 0, hi = num_blocks;
+        while (success && lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if ((string = fetch_string_by_slot(&success, file, slots + mid * block_size, query))) {
+                        if (compare_to_pred(string, capture, capture_len, pred->kind) < 0) {
+                                lo = mid + 1;
+                        } else {
+                                hi = mid;
+                        }
+                        free(string);
+                }
+        }
+
+        for (size_t i = lo > 0 ? (lo - 1) * block_size : 0; success && i < num_slots; i++) {
+                if (limit >= 0 && result_len == (size_t) limit) {
+                        break;
+                }
+                if (!(string = fetch_string_by_slot(&success, file, slots + i, query))) {
+                        break;
+                }
+                int cmp = compare_to_pred(string, capture, capture_len, pred->kind);
+                free(string);
+                if (cmp > 0) {
+                        break;
+                } else if (cmp == 0) {
+                        if (result_len == result_cap) {
+                                result_cap = 2 * result_cap;
+                                field_sid_t *tmp = realloc(result, result_cap * sizeof(field_sid_t));
+                                if (!tmp) {
+                                        error(&query->err, NG5_ERR_MALLOCERR);
+                                        success = false;
+                                        break;
+                                }
+                                result = tmp;
+                        }
+                        result[result_len++] = slots[i].string_id;
+                }
+        }
+        io_context_unlock(query->context);
+
+        if (!success) {
+                free(result);
+                return NULL;
+        }
+        *num_found = result_len;
+        return result;
+}
+
 NG5_EXPORT(field_sid_t *)query_find_ids(size_t *num_found, struct archive_query *query,
         const struct string_pred_t *pred, void *capture, i64 limit)
 {
@@ -410,6 +545,11 @@ NG5_EXPORT(field_sid_t *)query_find_ids(size_t *num_found, struct archive_query
                 return NULL;
         }
 
+        if (pred->kind != STRING_PRED_GENERIC && capture && query->archive->string_table.indexed &&
+                query->archive->record_table.flags.bits.has_ordered_string_ids) {
+                return find_ids_by_search(num_found, query, pred, (const char *) capture, pred_limit);
+        }
+
         if (unlikely((step_ids = malloc(str_cap * sizeof(field_sid_t))) == NULL)) {
                 error(&query->err, NG5_ERR_MALLOCERR);
                 return NULL;
@@ -498,11 +638,7 @@ NG5_EXPORT(field_sid_t *)query_find_ids(size_t *num_found, struct archive_query
 
                 for (size_t i = 0; i < num_matching; i++) {
                         assert (idxs_matching[i] < info_len);
-                        result_ids[result_len++] = info[idxs_matching[i]].id;
-                        if (pred_limit > 0 && result_len == (size_t) pred_limit) {
-                                goto stop_search_and_return;
-                        }
-                        if (unlikely(result_len > result_cap)) {
+                        if (unlikely(result_len == result_cap)) {
                                 result_cap = (result_len + 1) * 1.7f;
                                 if (unlikely(
                                         (tmp = realloc(result_ids, result_cap * sizeof(field_sid_t))) == NULL)) {
@@ -512,15 +648,23 @@ NG5_EXPORT(field_sid_t *)query_find_ids(size_t *num_found, struct archive_query
                                         result_ids = tmp;
                                 }
                         }
+                        result_ids[result_len++] = info[idxs_matching[i]].id;
+                        if (pred_limit > 0 && result_len == (size_t) pred_limit) {
+                                goto stop_search_and_return;
+                        }
                 }
         }
 
         stop_search_and_return:
+        strid_iter_close(&it);
         if (unlikely(success == false)) {
-                strid_iter_close(&it);
                 goto cleanup_intermediate;
         }
 
+        free(str_offs);
+        free(str_lens);
+        free(idxs_matching);
+        free(step_ids);
         *num_found = result_len;
         return result_ids;
 
@@ -536,4 +680,103 @@ NG5_EXPORT(field_sid_t *)query_find_ids(size_t *num_found, struct archive_query
         cleanup_result_and_error:
         free(step_ids);
         return NULL;
-}
\ No newline at end of file
+}
+
+struct find_object_ids_capture {
+        field_sid_t column;
+        const field_sid_t *values;
+        size_t num_values;
+        object_id_t *result;
+        size_t result_len;
+        size_t result_cap;
+        bool out_of_memory;
+};
+
+static enum visit_policy find_object_ids_before_row_group(struct archive *archive, path_stack_t path,
+        object_id_t parent_id, field_sid_t key, const struct archive_zone_map *zone_map, void *capture)
+{
+        ng5_unused(archive);
+        ng5_unused(path);
+        ng5_unused(parent_id);
+        ng5_unused(key);
+
+        const struct find_object_ids_capture *search = capture;
+        for (size_t i = 0; i < search->num_values; i++) {
+                if (archive_zone_map_may_contain_string(zone_map, search->column, search->values[i])) {
+                        return VISIT_INCLUDE;
+                }
+        }
+        return VISIT_EXCLUDE;
+}
+
+static void find_object_ids_visit_strings(struct archive *archive, path_stack_t path, object_id_t parent_id,
+        field_sid_t key, object_id_t nested_object_id, field_sid_t nested_key, const field_sid_t *nested_values,
+        u32 num_nested_values, void *capture)
+{
+        ng5_unused(archive);
+        ng5_unused(path);
+        ng5_unused(parent_id);
+        ng5_unused(key);
+
+        struct find_object_ids_capture *search = capture;
+        if (nested_key != search->column || search->out_of_memory) {
+                return;
+        }
+        for (u32 i = 0; i < num_nested_values; i++) {
+                for (size_t j = 0; j < search->num_values; j++) {
+                        if (nested_values[i] == search->values[j]) {
+                                if (unlikely(search->result_len == search->result_cap)) {
+                                        size_t cap = (search->result_cap + 1) * 1.7f;
+                                        object_id_t *tmp = realloc(search->result, cap * sizeof(object_id_t));
+                                        if (unlikely(tmp == NULL)) {
+                                                search->out_of_memory = true;
+                                                return;
+                                        }
+                                        search->result = tmp;
+                                        search->result_cap = cap;
+                                }
+                                search->result[search->result_len++] = nested_object_id;
+                                return;
+                        }
+                }
+        }
+}
+
+NG5_EXPORT(object_id_t *)query_find_object_ids(size_t *num_found, struct archive_query *query, field_sid_t column,
+        const field_sid_t *values, size_t num_values)
+{
+        if (unlikely(!num_found || !query || (!values && num_values > 0))) {
+                error(&query->err, NG5_ERR_NULLPTR);
+                return NULL;
+        }
+        *num_found = 0;
+
+        struct archive_visitor visitor = {0};
+        struct archive_visitor_desc desc = {.visit_mask = NG5_ARCHIVE_ITER_MASK_ANY};
+        struct find_object_ids_capture capture = {
+                .column = column,
+                .values = values,
+                .num_values = num_values,
+                .result = NULL,
+                .result_len = 0,
+                .result_cap = 0,
+                .out_of_memory = false
+        };
+
+        visitor.before_visit_row_group = find_object_ids_before_row_group;
+        visitor.visit_object_array_object_property_strings = find_object_ids_visit_strings;
+
+        if (unlikely(!archive_visit_archive(query->archive, &desc, &visitor, &capture))) {
+                free(capture.result);
+                error(&query->err, NG5_ERR_VITEROPEN_FAILED);
+                return NULL;
+        }
+        if (unlikely(capture.out_of_memory)) {
+                free(capture.result);
+                error(&query->err, NG5_ERR_REALLOCERR);
+                return NULL;
+        }
+
+        *num_found = capture.result_len;
+        return capture.result;
+}
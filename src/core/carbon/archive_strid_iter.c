@@ -15,26 +15,79 @@
  * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <unistd.h>
+
 #include "core/carbon/archive_strid_iter.h"
 
+/** block reads start at multiples of this */
+#define BLOCK_ALIGNMENT 4096
+
 NG5_EXPORT(bool) strid_iter_open(struct strid_iter *it, struct err *err, struct archive *archive)
+{
+        return strid_iter_open_with(it, err, archive, NG5_STRID_ITER_BATCH_SIZE, NG5_STRID_ITER_BLOCK_SIZE);
+}
+
+NG5_EXPORT(bool) strid_iter_open_with(struct strid_iter *it, struct err *err, struct archive *archive,
+        size_t batch_size, size_t block_size)
 {
         error_if_null(it)
         error_if_null(archive)
 
-        memset(&it->vector, 0, sizeof(it->vector));
+        it->is_open = false;
+        if (batch_size == 0 || block_size < 2 * BLOCK_ALIGNMENT) {
+                ng5_optional(err, error(err, NG5_ERR_ILLEGALARG))
+                return false;
+        }
+
         it->disk_file = fopen(archive->diskFilePath, "r");
         if (!it->disk_file) {
                 ng5_optional(err, error(err, NG5_ERR_FOPEN_FAILED))
-                it->is_open = false;
                 return false;
         }
-        fseek(it->disk_file, archive->string_table.first_entry_off, SEEK_SET);
-        it->is_open = true;
+
         it->disk_offset = archive->string_table.first_entry_off;
+        it->slots = int_string_table_slots(&archive->string_table);
+        it->num_slots = it->slots ? archive->string_table.num_embeddded_strings : 0;
+        it->slot_pos = 0;
+        if (archive->string_table.indexed && !it->slots) {
+                /** indexed but empty string table */
+                it->disk_offset = 0;
+        }
+
+        it->batch_size = batch_size;
+        it->block_size = block_size;
+        it->block_off = 0;
+        it->block_len = 0;
+        it->vector = malloc(batch_size * sizeof(struct strid_info));
+        it->block = it->slots ? NULL : malloc(block_size);
+        if (!it->vector || (!it->slots && !it->block)) {
+                free(it->vector);
+                free(it->block);
+                fclose(it->disk_file);
+                ng5_optional(err, error(err, NG5_ERR_MALLOCERR))
+                return false;
+        }
+
+        it->is_open = true;
         return true;
 }
 
+/** returns the entry header at 'offset', reading the block that contains it if needed; NULL on a short read */
+static const struct string_entry_header *block_entry_at(struct strid_iter *it, offset_t offset)
+{
+        if (offset < it->block_off || offset + sizeof(struct string_entry_header) > it->block_off + it->block_len) {
+                offset_t block_off = offset & ~((offset_t) BLOCK_ALIGNMENT - 1);
+                ssize_t nread = pread(fileno(it->disk_file), it->block, it->block_size, block_off);
+                if (nread < 0 || (size_t) nread < offset - block_off + sizeof(struct string_entry_header)) {
+                        it->block_len = 0;
+                        return NULL;
+                }
+                it->block_off = block_off;
+                it->block_len = nread;
+        }
+        return (const struct string_entry_header *) (it->block + (offset - it->block_off));
+}
+
 NG5_EXPORT(bool) strid_iter_next(bool *success, struct strid_info **info, struct err *err, size_t *info_length,
         struct strid_iter *it)
 {
@@ -42,33 +95,49 @@ NG5_EXPORT(bool) strid_iter_next(bool *success, struct strid_info **info, struct
         error_if_null(info_length)
         error_if_null(it)
 
-        if (it->disk_offset != 0 && it->is_open) {
+        if (it->slots) {
+                if (it->slot_pos < it->num_slots && it->is_open) {
+                        size_t vec_len = ng5_min(it->num_slots - it->slot_pos, it->batch_size);
+                        for (size_t i = 0; i < vec_len; i++) {
+                                const struct string_table_slot *slot = it->slots + it->slot_pos + i;
+                                it->vector[i].id = slot->string_id;
+                                it->vector[i].offset = slot->offset;
+                                it->vector[i].strlen = slot->string_len;
+                        }
+                        it->slot_pos += vec_len;
+                        *info_length = vec_len;
+                        *success = true;
+                        *info = it->vector;
+                        return true;
+                } else {
+                        return false;
+                }
+        } else if (it->disk_offset != 0 && it->is_open) {
                 struct string_entry_header header;
                 size_t vec_pos = 0;
                 do {
-                        fseek(it->disk_file, it->disk_offset, SEEK_SET);
-                        int num_read = fread(&header, sizeof(struct string_entry_header), 1, it->disk_file);
-                        if (header.marker != '-') {
-                                error_print(NG5_ERR_INTERNALERR);
-                                return false;
-                        }
-                        if (num_read != 1) {
+                        const struct string_entry_header *entry = block_entry_at(it, it->disk_offset);
+                        if (!entry) {
                                 ng5_optional(err, error(err, NG5_ERR_FREAD_FAILED))
                                 *success = false;
                                 return false;
-                        } else {
-                                it->vector[vec_pos].id = header.string_id;
-                                it->vector[vec_pos].offset = ftell(it->disk_file);
-                                it->vector[vec_pos].strlen = header.string_len;
-                                it->disk_offset = header.next_entry_off;
-                                vec_pos++;
                         }
+                        memcpy(&header, entry, sizeof(struct string_entry_header));
+                        if (header.marker != marker_symbols[MARKER_TYPE_EMBEDDED_UNCOMP_STR].symbol) {
+                                error_print(NG5_ERR_INTERNALERR);
+                                return false;
+                        }
+                        it->vector[vec_pos].id = header.string_id;
+                        it->vector[vec_pos].offset = it->disk_offset + sizeof(struct string_entry_header);
+                        it->vector[vec_pos].strlen = header.string_len;
+                        it->disk_offset = header.next_entry_off;
+                        vec_pos++;
                 }
-                while (header.next_entry_off != 0 && vec_pos < NG5_ARRAY_LENGTH(it->vector));
+                while (header.next_entry_off != 0 && vec_pos < it->batch_size);
 
                 *info_length = vec_pos;
                 *success = true;
-                *info = &it->vector[0];
+                *info = it->vector;
                 return true;
         } else {
                 return false;
@@ -80,6 +149,8 @@ NG5_EXPORT(bool) strid_iter_close(struct strid_iter *it)
         error_if_null(it)
         if (it->is_open) {
                 fclose(it->disk_file);
+                free(it->vector);
+                free(it->block);
                 it->is_open = false;
         }
         return true;
@@ -340,6 +340,12 @@ static void iterate_props(struct archive *archive, struct prop_iter *prop_iter,
                         if (visitor->before_visit_object_array) {
                                 for (u32 i = 0; i < num_column_groups; i++) {
 
+                                        /* row groups of the same object array share its key */
+                                        if (i > 0 && keys[i] == keys[i - 1]) {
+                                                skip_groups_by_key[i] = skip_groups_by_key[i - 1];
+                                                continue;
+                                        }
+
                                         //     struct path_entry e = { .key = parent_key, .idx = i };
                                         //vec_push(path_stack, &e, 1);
 
@@ -358,7 +364,27 @@ static void iterate_props(struct archive *archive, struct prop_iter *prop_iter,
 
                         u32 current_group_idx = 0;
 
+                        u32 current_key_idx = 0;
+
                         while (archive_collection_next_column_group(&group_iter, &collection_iter)) {
+                                if (current_group_idx > 0 && keys[current_group_idx] != keys[current_group_idx - 1]) {
+                                        current_key_idx = current_group_idx;
+                                }
+
+                                if (!skip_groups_by_key[current_group_idx] && visitor->before_visit_row_group) {
+                                        struct archive_zone_map zone_map;
+                                        archive_column_group_get_zone_map(&zone_map, &group_iter);
+                                        if (zone_map.exists) {
+                                                enum visit_policy policy = visitor->before_visit_row_group(archive,
+                                                        path_stack,
+                                                        this_object_oid,
+                                                        keys[current_group_idx],
+                                                        &zone_map,
+                                                        capture);
+                                                skip_groups_by_key[current_group_idx] = policy == VISIT_EXCLUDE;
+                                        }
+                                }
+
                                 if (!skip_groups_by_key[current_group_idx]) {
 
                                         u32 num_column_group_objs;
@@ -586,7 +612,7 @@ static void iterate_props(struct archive *archive, struct prop_iter *prop_iter,
                                                                                                         capture,
                                                                                                         false,
                                                                                                         current_column_name,
-                                                                                                        current_group_idx);
+                                                                                                        current_key_idx);
 
                                                                                                 struct path_entry e =
                                                                                                         {.key = current_column_name, .idx = 0};
@@ -637,9 +663,11 @@ NG5_EXPORT(bool) archive_visit_archive(struct archive *archive, const struct arc
 
         if (archive_prop_iter_from_archive(&prop_iter, &archive->err, mask, archive)) {
                 vec_create(&path_stack, NULL, sizeof(struct path_entry), 100);
+                archive_advise(archive, MEMBLOCK_ADVICE_SEQUENTIAL);
                 ng5_optional_call(visitor, before_visit_starts, archive, capture);
                 iterate_props(archive, &prop_iter, &path_stack, visitor, mask, capture, true, 0, 0);
                 ng5_optional_call(visitor, after_visit_ends, archive, capture);
+                archive_advise(archive, MEMBLOCK_ADVICE_NORMAL);
                 vec_drop(&path_stack);
                 return true;
         } else {
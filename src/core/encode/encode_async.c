@@ -24,26 +24,53 @@
 #include "utils/time.h"
 #include "core/async/parallel.h"
 #include "stdx/slicelist.h"
-#include "hash/sax.h"
+#include "hash/hashcode.h"
 
 #define STRING_DIC_ASYNC_TAG "strdic_async"
 
-#define HASH_FUNCTION                  NG5_HASH_SAX
+
+/** maximum number of tasks in flight per carrier; the producer blocks if a carrier's queue is full */
+#define CARRIER_QUEUE_CAPACITY         64
+
+/** a task is executed by a carrier thread; a task without function stops the carrier */
+struct carrier_task {
+        void *(*function)(void *args);
+        void *args;
+};
+
+/** single-producer/single-consumer ring buffer; the producer is the (locked) dictionary, the consumer its carrier */
+struct carrier_queue {
+        struct carrier_task tasks[CARRIER_QUEUE_CAPACITY];
+        atomic_size_t head;                     /* position of next task to be consumed */
+        atomic_size_t tail;                     /* position of next task to be produced */
+};
 
 struct carrier {
         struct strdic local_dictionary;
         pthread_t thread;
         size_t id;
+
+        struct carrier_queue queue;
+        size_t num_submitted;                   /* tasks submitted by the producer */
+        atomic_size_t num_done;                 /* tasks completed by the carrier */
+        pthread_mutex_t mutex;                  /* guards sleeping on 'wakeup' and 'done' only */
+        pthread_cond_t wakeup;
+        pthread_cond_t done;
 };
 
 struct async_extra {
         struct vector ofType(carrier) carriers;
         struct vector ofType(struct carrier *) carrier_mapping;
         struct spinlock lock;
+
+        /** scratch buffers for assigning strings to carriers that are re-used among calls */
+        struct vector ofType(uint_fast16_t) str_carrier_mapping;
+        struct vector ofType(size_t) str_carrier_idx_mapping;
+        struct vector ofType(size_t) carrier_num_strings;
 };
 
 struct parallel_insert_arg {
-        struct vector ofType(char *) strings;
+        struct vector ofType(struct string_key) keys;
         field_sid_t *out;
         struct carrier *carrier;
         bool enable_write_out;
@@ -71,12 +98,16 @@ struct parallel_locate_arg {
 struct parallel_extract_arg {
         struct vector ofType(field_sid_t) local_ids_in;
         char **strings_out;
+        struct string_view *views_out;
+        bool as_views;
         struct carrier *carrier;
         bool did_work;
 };
 
-#define HASHCODE_OF(string)                                                                                            \
-    HASH_FUNCTION(strlen(string), string)
+/** carrier owning a string with a particular hash; uses the high bits of the hash, since the local dictionaries of
+ * the carriers select buckets by the low bits */
+#define OWNER_OF(hash, num_threads)                                                                                    \
+    ((uint_fast16_t) (((u64) (hash) * (num_threads)) >> 32))
 
 #define MAKE_GLOBAL(thread_id, localstring_id_t)                                                                \
     ((thread_id << 54) | localstring_id_t)
@@ -90,11 +121,16 @@ struct parallel_extract_arg {
 static bool this_drop(struct strdic *self);
 static bool this_insert(struct strdic *self, field_sid_t **out, char *const *strings, size_t num_strings,
         size_t __num_threads);
+static bool this_insert_keys(struct strdic *self, field_sid_t **out, const struct string_key *keys,
+        size_t num_strings, size_t __num_threads);
 static bool this_remove(struct strdic *self, field_sid_t *strings, size_t num_strings);
 static bool this_locate_safe(struct strdic *self, field_sid_t **out, bool **found_mask, size_t *num_not_found,
         char *const *keys, size_t num_keys);
 static bool this_locate_fast(struct strdic *self, field_sid_t **out, char *const *keys, size_t num_keys);
 static char **this_extract(struct strdic *self, const field_sid_t *ids, size_t num_ids);
+static struct string_view *this_extract_views(struct strdic *self, const field_sid_t *ids, size_t num_ids);
+static void extract(struct strdic *self, char **strings_out, struct string_view *views_out, const field_sid_t *ids,
+        size_t num_ids);
 static bool this_free(struct strdic *self, void *ptr);
 
 static bool this_num_distinct(struct strdic *self, size_t *num);
@@ -112,6 +148,8 @@ static bool this_create_extra(struct strdic *self, size_t capacity, size_t num_i
 
 static bool this_setup_carriers(struct strdic *self, size_t capacity, size_t num_index_buckets,
         size_t approx_num_unique_str, size_t num_threads);
+static void *carrier_main(void *args);
+static void carrier_submit(struct carrier *carrier, void *(*function)(void *args), void *args);
 
 #define THIS_EXTRAS(self)                                                                                              \
 ({                                                                                                                     \
@@ -127,10 +165,12 @@ NG5_EXPORT (int) encode_async_create(struct strdic *dic, size_t capacity, size_t
         dic->tag = ASYNC;
         dic->drop = this_drop;
         dic->insert = this_insert;
+        dic->insert_keys = this_insert_keys;
         dic->remove = this_remove;
         dic->locate_safe = this_locate_safe;
         dic->locate_fast = this_locate_fast;
         dic->extract = this_extract;
+        dic->extract_views = this_extract_views;
         dic->free = this_free;
         dic->resetCounters = this_reset_counters;
         dic->counters = this_counters;
@@ -152,6 +192,9 @@ static bool this_create_extra(struct strdic *self, size_t capacity, size_t num_i
         vec_create(&extra->carriers, &self->alloc, sizeof(struct carrier), num_threads);
         this_setup_carriers(self, capacity, num_index_buckets, approx_num_unique_str, num_threads);
         vec_create(&extra->carrier_mapping, &self->alloc, sizeof(struct carrier *), capacity);
+        vec_create(&extra->str_carrier_mapping, &self->alloc, sizeof(uint_fast16_t), capacity);
+        vec_create(&extra->str_carrier_idx_mapping, &self->alloc, sizeof(size_t), capacity);
+        vec_create(&extra->carrier_num_strings, &self->alloc, sizeof(size_t), num_threads);
 
         return true;
 }
@@ -162,10 +205,21 @@ static bool this_drop(struct strdic *self)
         struct async_extra *extra = THIS_EXTRAS(self);
         for (size_t i = 0; i < extra->carriers.num_elems; i++) {
                 struct carrier *carrier = vec_get(&extra->carriers, i, struct carrier);
+                carrier_submit(carrier, NULL, NULL);
+        }
+        for (size_t i = 0; i < extra->carriers.num_elems; i++) {
+                struct carrier *carrier = vec_get(&extra->carriers, i, struct carrier);
+                pthread_join(carrier->thread, NULL);
+                pthread_cond_destroy(&carrier->wakeup);
+                pthread_cond_destroy(&carrier->done);
+                pthread_mutex_destroy(&carrier->mutex);
                 strdic_drop(&carrier->local_dictionary);
         }
         ng5_check_success(vec_drop(&extra->carriers));
         ng5_check_success(vec_drop(&extra->carrier_mapping));
+        ng5_check_success(vec_drop(&extra->str_carrier_mapping));
+        ng5_check_success(vec_drop(&extra->str_carrier_idx_mapping));
+        ng5_check_success(vec_drop(&extra->carrier_num_strings));
         ng5_check_success(alloc_free(&self->alloc, extra));
         return true;
 }
@@ -196,25 +250,25 @@ void *parallel_remove_function(void *args)
 void *parallel_insert_function(void *args)
 {
         struct parallel_insert_arg *restrict this_args = (struct parallel_insert_arg *restrict) args;
-        this_args->did_work = this_args->strings.num_elems > 0;
+        this_args->did_work = this_args->keys.num_elems > 0;
 
         ng5_trace(STRING_DIC_ASYNC_TAG, "thread-local insert function started (thread %zu)", this_args->carrier->id);
         ng5_debug(STRING_DIC_ASYNC_TAG,
                 "thread %zu spawned for insert task (%zu elements)",
                 this_args->carrier->id,
-                vec_length(&this_args->strings));
+                vec_length(&this_args->keys));
 
         if (this_args->did_work) {
                 ng5_trace(STRING_DIC_ASYNC_TAG,
                         "thread %zu starts insertion of %zu strings",
                         this_args->carrier->id,
-                        vec_length(&this_args->strings));
-                char **data = (char **) vec_data(&this_args->strings);
+                        vec_length(&this_args->keys));
+                const struct string_key *data = vec_all(&this_args->keys, struct string_key);
 
-                int status = strdic_insert(&this_args->carrier->local_dictionary,
+                int status = strdic_insert_keys(&this_args->carrier->local_dictionary,
                         this_args->enable_write_out ? &this_args->out : NULL,
                         data,
-                        vec_length(&this_args->strings),
+                        vec_length(&this_args->keys),
                         this_args->insert_num_threads);
 
                 /** internal error during thread-local string dictionary building process */
@@ -251,6 +305,7 @@ void *parallel_locate_safe_function(void *args)
 
                 ng5_debug(STRING_DIC_ASYNC_TAG, "thread %zu done", this_args->carrier->id);
         } else {
+                this_args->num_not_found_out = 0;
                 ng5_warn(STRING_DIC_ASYNC_TAG, "thread %zu had nothing to do", this_args->carrier->id);
         }
 
@@ -268,9 +323,15 @@ void *parallel_extract_function(void *args)
                 vec_length(&this_args->local_ids_in));
 
         if (this_args->did_work) {
-                this_args->strings_out = strdic_extract(&this_args->carrier->local_dictionary,
-                        vec_all(&this_args->local_ids_in, field_sid_t),
-                        vec_length(&this_args->local_ids_in));
+                if (this_args->as_views) {
+                        this_args->views_out = strdic_extract_views(&this_args->carrier->local_dictionary,
+                                vec_all(&this_args->local_ids_in, field_sid_t),
+                                vec_length(&this_args->local_ids_in));
+                } else {
+                        this_args->strings_out = strdic_extract(&this_args->carrier->local_dictionary,
+                                vec_all(&this_args->local_ids_in, field_sid_t),
+                                vec_length(&this_args->local_ids_in));
+                }
                 ng5_debug(STRING_DIC_ASYNC_TAG, "thread %zu done", this_args->carrier->id);
         } else {
                 ng5_warn(STRING_DIC_ASYNC_TAG, "thread %zu had nothing to do", this_args->carrier->id);
@@ -279,15 +340,75 @@ void *parallel_extract_function(void *args)
         return NULL;
 }
 
+static void *carrier_main(void *args)
+{
+        struct carrier *carrier = (struct carrier *) args;
+        struct carrier_queue *queue = &carrier->queue;
+
+        while (true) {
+                size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+                /** sleep until the producer published a task */
+                if (atomic_load_explicit(&queue->tail, memory_order_acquire) == head) {
+                        pthread_mutex_lock(&carrier->mutex);
+                        while (atomic_load_explicit(&queue->tail, memory_order_acquire) == head) {
+                                pthread_cond_wait(&carrier->wakeup, &carrier->mutex);
+                        }
+                        pthread_mutex_unlock(&carrier->mutex);
+                }
+
+                struct carrier_task task = queue->tasks[head % CARRIER_QUEUE_CAPACITY];
+                atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+
+                if (unlikely(task.function == NULL)) {
+                        ng5_debug(STRING_DIC_ASYNC_TAG, "carrier %zu shut down", carrier->id);
+                        return NULL;
+                }
+
+                task.function(task.args);
+
+                pthread_mutex_lock(&carrier->mutex);
+                atomic_fetch_add_explicit(&carrier->num_done, 1, memory_order_release);
+                pthread_cond_broadcast(&carrier->done);
+                pthread_mutex_unlock(&carrier->mutex);
+        }
+}
+
+static void carrier_submit(struct carrier *carrier, void *(*function)(void *args), void *args)
+{
+        struct carrier_queue *queue = &carrier->queue;
+        size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+        /** the queue is only full if more than 'CARRIER_QUEUE_CAPACITY' tasks are in flight */
+        while (tail - atomic_load_explicit(&queue->head, memory_order_acquire) == CARRIER_QUEUE_CAPACITY) {
+                sched_yield();
+        }
+
+        queue->tasks[tail % CARRIER_QUEUE_CAPACITY] = (struct carrier_task) {
+                .function = function,
+                .args = args
+        };
+        carrier->num_submitted += function ? 1 : 0;
+
+        pthread_mutex_lock(&carrier->mutex);
+        atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+        pthread_cond_signal(&carrier->wakeup);
+        pthread_mutex_unlock(&carrier->mutex);
+}
+
 static void synchronize(struct vector ofType(carrier) *carriers, size_t num_threads)
 {
         ng5_debug(STRING_DIC_ASYNC_TAG, "barrier installed for %d threads", num_threads);
 
         timestamp_t begin = time_now_wallclock();
         for (uint_fast16_t thread_id = 0; thread_id < num_threads; thread_id++) {
-                volatile struct carrier *carrier = vec_get(carriers, thread_id, struct carrier);
-                pthread_join(carrier->thread, NULL);
-                ng5_debug(STRING_DIC_ASYNC_TAG, "thread %d joined", carrier->id);
+                struct carrier *carrier = vec_get(carriers, thread_id, struct carrier);
+                pthread_mutex_lock(&carrier->mutex);
+                while (atomic_load_explicit(&carrier->num_done, memory_order_acquire) != carrier->num_submitted) {
+                        pthread_cond_wait(&carrier->done, &carrier->mutex);
+                }
+                pthread_mutex_unlock(&carrier->mutex);
+                ng5_debug(STRING_DIC_ASYNC_TAG, "thread %d in sync", carrier->id);
         }
         timestamp_t end = time_now_wallclock();
         timestamp_t duration = (end - begin);
@@ -299,77 +420,47 @@ static void synchronize(struct vector ofType(carrier) *carriers, size_t num_thre
                 duration / 1000.0f);
 }
 
-static void create_thread_assignment(atomic_uint_fast16_t **str_carrier_mapping, atomic_size_t **carrier_num_strings,
-        size_t **str_carrier_idx_mapping, struct allocator *alloc, size_t num_strings, size_t num_threads)
-{
-        /** parallel_map_exec string depending on hash values to a particular carrier */
-        *str_carrier_mapping = alloc_malloc(alloc, num_strings * sizeof(atomic_uint_fast16_t));
-        memset(*str_carrier_mapping, 0, num_strings * sizeof(atomic_uint_fast16_t));
-
-        /** counters to compute how many strings go to a particular carrier */
-        *carrier_num_strings = alloc_malloc(alloc, num_threads * sizeof(atomic_size_t));
-        memset(*carrier_num_strings, 0, num_threads * sizeof(atomic_size_t));
-
-        /** an inverted index that contains the i-th position for string k that was assigned to carrier m.
-         * With this, given a (global) string and and its carrier, one can have directly the position of the
-         * string in the carriers "thread-local locate" args */
-        *str_carrier_idx_mapping = alloc_malloc(alloc, num_strings * sizeof(size_t));
-}
-
-static void drop_thread_assignment(struct allocator *alloc, atomic_uint_fast16_t *str_carrier_mapping,
-        atomic_size_t *carrier_num_strings, size_t *str_carrier_idx_mapping)
-{
-        alloc_free(alloc, carrier_num_strings);
-        alloc_free(alloc, str_carrier_mapping);
-        alloc_free(alloc, str_carrier_idx_mapping);
-}
-
-struct thread_assign_arg {
-        atomic_uint_fast16_t *str_carrier_mapping;
-        size_t num_threads;
-        atomic_size_t *carrier_num_strings;
-        char *const *base_strings;
-};
-
-static void parallel_compute_thread_assignment_function(const void *restrict start, size_t width, size_t len,
-        void *restrict args, thread_id_t tid)
+/**
+ * Assigns each string to the carrier owning it (by hash), and counts the strings per carrier. Results are stored
+ * in the dictionaries scratch buffers, which are re-used among calls. This is done by the calling thread: hashing is
+ * cheap compared to spawning threads for each call. Strings are given either as plain 'strings', or as 'keys' whose
+ * hash codes are known already (the other one is NULL).
+ */
+static void compute_thread_assignment(uint_fast16_t **str_carrier_mapping, size_t **carrier_num_strings,
+        size_t **str_carrier_idx_mapping, struct async_extra *extra, char *const *strings,
+        const struct string_key *keys, size_t num_strings, size_t num_threads)
 {
-        ng5_unused(tid);
-        ng5_unused(width);
+        vec_grow_to(&extra->str_carrier_mapping, num_strings);
+        vec_grow_to(&extra->str_carrier_idx_mapping, num_strings);
+        vec_grow_to(&extra->carrier_num_strings, num_threads);
 
-        char *const *strings = (char *const *) start;
+        *str_carrier_mapping = (uint_fast16_t *) vec_data(&extra->str_carrier_mapping);
+        *str_carrier_idx_mapping = (size_t *) vec_data(&extra->str_carrier_idx_mapping);
+        *carrier_num_strings = (size_t *) vec_data(&extra->carrier_num_strings);
+        memset(*carrier_num_strings, 0, num_threads * sizeof(size_t));
 
-        struct thread_assign_arg *func_args = (struct thread_assign_arg *) args;
-
-        while (len--) {
-                size_t i = strings - func_args->base_strings;
-                const char *key = *strings;
-                /** re-using this hashcode for the thread-local dictionary is more costly than to compute it fresh
-                 * (due to more I/O with the RAM) */
-                size_t thread_id = HASHCODE_OF(key) % func_args->num_threads;
-                atomic_fetch_add(&func_args->str_carrier_mapping[i], thread_id);
-                atomic_fetch_add(&func_args->carrier_num_strings[thread_id], 1);
-                strings++;
+        for (size_t i = 0; i < num_strings; i++) {
+                hash32_t hash = keys ? keys[i].hash : string_key_of(strings[i]).hash;
+                uint_fast16_t thread_id = OWNER_OF(hash, num_threads);
+                (*str_carrier_mapping)[i] = thread_id;
+                (*carrier_num_strings)[thread_id]++;
         }
 }
 
-static void compute_thread_assignment(atomic_uint_fast16_t *str_carrier_mapping, atomic_size_t *carrier_num_strings,
-        char *const *strings, size_t num_strings, size_t num_threads)
+static bool this_insert(struct strdic *self, field_sid_t **out, char *const *strings, size_t num_strings,
+        size_t __num_threads)
 {
-        struct thread_assign_arg args =
-                {.base_strings = strings, .carrier_num_strings = carrier_num_strings, .num_threads = num_threads, .str_carrier_mapping = str_carrier_mapping};
-        parallel_for(strings,
-                sizeof(char *const *),
-                num_strings,
-                parallel_compute_thread_assignment_function,
-                &args,
-                THREADING_HINT_MULTI,
-                num_threads);
-
+        ng5_check_tag(self->tag, ASYNC);
+        struct string_key *keys = alloc_malloc(&self->alloc, num_strings * sizeof(struct string_key));
+        error_print_and_die_if(num_strings > 0 && !keys, NG5_ERR_MALLOCERR)
+        string_keys_of(keys, strings, num_strings);
+        bool status = this_insert_keys(self, out, keys, num_strings, __num_threads);
+        alloc_free(&self->alloc, keys);
+        return status;
 }
 
-static bool this_insert(struct strdic *self, field_sid_t **out, char *const *strings, size_t num_strings,
-        size_t __num_threads)
+static bool this_insert_keys(struct strdic *self, field_sid_t **out, const struct string_key *keys,
+        size_t num_strings, size_t __num_threads)
 {
         timestamp_t begin = time_now_wallclock();
         ng5_info(STRING_DIC_ASYNC_TAG, "insert operation invoked: %zu strings in total", num_strings)
@@ -383,22 +474,16 @@ static bool this_insert(struct strdic *self, field_sid_t **out, char *const *str
         struct async_extra *extra = THIS_EXTRAS(self);
         uint_fast16_t num_threads = vec_length(&extra->carriers);
 
-        atomic_uint_fast16_t *str_carrier_mapping;
+        uint_fast16_t *str_carrier_mapping;
         size_t *str_carrier_idx_mapping;
-        atomic_size_t *carrier_num_strings;
-
-        create_thread_assignment(&str_carrier_mapping,
-                &carrier_num_strings,
-                &str_carrier_idx_mapping,
-                &self->alloc,
-                num_strings,
-                num_threads);
+        size_t *carrier_num_strings;
 
         struct vector ofType(struct parallel_insert_arg *) carrier_args;
         vec_create(&carrier_args, &self->alloc, sizeof(struct parallel_insert_arg *), num_threads);
 
         /** compute which carrier is responsible for which string */
-        compute_thread_assignment(str_carrier_mapping, carrier_num_strings, strings, num_strings, num_threads);
+        compute_thread_assignment(&str_carrier_mapping, &carrier_num_strings, &str_carrier_idx_mapping, extra,
+                NULL, keys, num_strings, num_threads);
 
         /** prepare to move string subsets to carriers */
         for (uint_fast16_t i = 0; i < num_threads; i++) {
@@ -406,9 +491,9 @@ static bool this_insert(struct strdic *self, field_sid_t **out, char *const *str
                 entry->carrier = vec_get(&extra->carriers, i, struct carrier);
                 entry->insert_num_threads = num_threads;
 
-                vec_create(&entry->strings, &self->alloc, sizeof(char *), ng5_max(1, carrier_num_strings[i]));
+                vec_create(&entry->keys, &self->alloc, sizeof(struct string_key), ng5_max(1, carrier_num_strings[i]));
                 vec_push(&carrier_args, &entry, 1);
-                assert (entry->strings.base != NULL);
+                assert (entry->keys.base != NULL);
 
                 struct parallel_insert_arg *carrier_arg = *vec_get(&carrier_args, i, struct parallel_insert_arg *);
                 carrier_arg->out = NULL;
@@ -423,9 +508,9 @@ static bool this_insert(struct strdic *self, field_sid_t **out, char *const *str
                 carrier_arg->enable_write_out = out != NULL;
 
                 /** store local index of string i inside the thread */
-                str_carrier_idx_mapping[i] = vec_length(&carrier_arg->strings);
+                str_carrier_idx_mapping[i] = vec_length(&carrier_arg->keys);
 
-                vec_push(&carrier_arg->strings, &strings[i], 1);
+                vec_push(&carrier_arg->keys, &keys[i], 1);
         }
 
 
@@ -435,9 +520,8 @@ static bool this_insert(struct strdic *self, field_sid_t **out, char *const *str
                 struct parallel_insert_arg
                         *carrier_arg = *vec_get(&carrier_args, thread_id, struct parallel_insert_arg *);
                 struct carrier *carrier = vec_get(&extra->carriers, thread_id, struct carrier);
-                ng5_trace(STRING_DIC_ASYNC_TAG, "create thread %zu...", thread_id)
-                pthread_create(&carrier->thread, NULL, parallel_insert_function, carrier_arg);
-                ng5_trace(STRING_DIC_ASYNC_TAG, "thread %zu created", thread_id)
+                carrier_submit(carrier, parallel_insert_function, carrier_arg);
+                ng5_trace(STRING_DIC_ASYNC_TAG, "task submitted to thread %zu", thread_id)
         }
         ng5_trace(STRING_DIC_ASYNC_TAG, "scheduling done for %zu threads", num_threads)
 
@@ -483,12 +567,11 @@ static bool this_insert(struct strdic *self, field_sid_t **out, char *const *str
                 if (carrier_arg->did_work) {
                         strdic_free(&carrier_arg->carrier->local_dictionary, carrier_arg->out);
                 }
-                vec_drop(&carrier_arg->strings);
+                vec_drop(&carrier_arg->keys);
                 alloc_free(&self->alloc, carrier_arg);
         }
 
         /** cleanup */
-        drop_thread_assignment(&self->alloc, str_carrier_mapping, carrier_num_strings, str_carrier_idx_mapping);
         vec_drop(&carrier_args);
 
         this_unlock(self);
@@ -542,7 +625,7 @@ static bool this_remove(struct strdic *self, field_sid_t *strings, size_t num_st
                 carrier_arg->carrier = carrier;
                 carrier_arg->local_ids = string_map + thread_id;
 
-                pthread_create(&carrier->thread, NULL, parallel_remove_function, carrier_arg);
+                carrier_submit(carrier, parallel_remove_function, carrier_arg);
         }
 
         /** synchronize */
@@ -585,21 +668,15 @@ static bool this_locate_safe(struct strdic *self, field_sid_t **out, bool **foun
 
         size_t global_num_not_found = 0;
 
-        atomic_uint_fast16_t *str_carrier_mapping;
+        uint_fast16_t *str_carrier_mapping;
         size_t *str_carrier_idx_mapping;
-        atomic_size_t *carrier_num_strings;
+        size_t *carrier_num_strings;
 
         struct parallel_locate_arg carrier_args[num_threads];
 
-        create_thread_assignment(&str_carrier_mapping,
-                &carrier_num_strings,
-                &str_carrier_idx_mapping,
-                &self->alloc,
-                num_keys,
-                num_threads);
-
         /** compute which carrier is responsible for which string */
-        compute_thread_assignment(str_carrier_mapping, carrier_num_strings, keys, num_keys, num_threads);
+        compute_thread_assignment(&str_carrier_mapping, &carrier_num_strings, &str_carrier_idx_mapping, extra,
+                keys, NULL, num_keys, num_threads);
 
         /** prepare to move string subsets to carriers */
         for (uint_fast16_t thread_id = 0; thread_id < num_threads; thread_id++) {
@@ -630,7 +707,7 @@ static bool this_locate_safe(struct strdic *self, field_sid_t **out, bool **foun
                 struct carrier *carrier = vec_get(&extra->carriers, thread_id, struct carrier);
                 struct parallel_locate_arg *arg = carrier_args + thread_id;
                 carrier_args[thread_id].carrier = carrier;
-                pthread_create(&carrier->thread, NULL, parallel_locate_safe_function, arg);
+                carrier_submit(carrier, parallel_locate_safe_function, arg);
         }
 
         /** synchronize */
@@ -671,8 +748,6 @@ static bool this_locate_safe(struct strdic *self, field_sid_t **out, bool **foun
         ng5_trace(STRING_DIC_ASYNC_TAG, "cleanup%s", "...")
 
         /** cleanup */
-        drop_thread_assignment(&self->alloc, str_carrier_mapping, carrier_num_strings, str_carrier_idx_mapping);
-
         for (size_t thread_id = 0; thread_id < num_threads; thread_id++) {
                 struct parallel_locate_arg *arg = carrier_args + thread_id;
                 vec_drop(&arg->keys_in);
@@ -716,16 +791,34 @@ static bool this_locate_fast(struct strdic *self, field_sid_t **out, char *const
 
 static char **this_extract(struct strdic *self, const field_sid_t *ids, size_t num_ids)
 {
-        timestamp_t begin = time_now_wallclock();
-        ng5_info(STRING_DIC_ASYNC_TAG, "extract (safe) operation started: %zu strings to extract", num_ids)
+        if (self->tag != ASYNC) {
+                return NULL;
+        }
 
+        ng5_malloc(char *, globalResult, num_ids, &self->alloc);
+        extract(self, globalResult, NULL, ids, num_ids);
+        return globalResult;
+}
+
+static struct string_view *this_extract_views(struct strdic *self, const field_sid_t *ids, size_t num_ids)
+{
         if (self->tag != ASYNC) {
                 return NULL;
         }
 
-        this_lock(self);
+        ng5_malloc(struct string_view, globalResult, num_ids, &self->alloc);
+        extract(self, NULL, globalResult, ids, num_ids);
+        return globalResult;
+}
 
-        ng5_malloc(char *, globalResult, num_ids, &self->alloc);
+/** extracts either strings (if 'strings_out' is non-null), or views on strings (into 'views_out') */
+static void extract(struct strdic *self, char **strings_out, struct string_view *views_out, const field_sid_t *ids,
+        size_t num_ids)
+{
+        timestamp_t begin = time_now_wallclock();
+        ng5_info(STRING_DIC_ASYNC_TAG, "extract (safe) operation started: %zu strings to extract", num_ids)
+
+        this_lock(self);
 
         struct async_extra *extra = (struct async_extra *) self->extra;
         uint_fast16_t num_threads = vec_length(&extra->carriers);
@@ -757,7 +850,8 @@ static char **this_extract(struct strdic *self, const field_sid_t *ids, size_t n
                 struct carrier *carrier = vec_get(&extra->carriers, thread_id, struct carrier);
                 struct parallel_extract_arg *carrier_arg = thread_args + thread_id;
                 carrier_arg->carrier = carrier;
-                pthread_create(&carrier->thread, NULL, parallel_extract_function, carrier_arg);
+                carrier_arg->as_views = strings_out == NULL;
+                carrier_submit(carrier, parallel_extract_function, carrier_arg);
         }
 
         /** synchronize */
@@ -767,8 +861,11 @@ static char **this_extract(struct strdic *self, const field_sid_t *ids, size_t n
                 uint_fast16_t owning_thread_id = owning_thread_ids[i];
                 size_t localIdx = local_thread_idx[i];
                 struct parallel_extract_arg *carrier_arg = thread_args + owning_thread_id;
-                char *extractedString = carrier_arg->strings_out[localIdx];
-                globalResult[i] = extractedString;
+                if (strings_out) {
+                        strings_out[i] = carrier_arg->strings_out[localIdx];
+                } else {
+                        views_out[i] = carrier_arg->views_out[localIdx];
+                }
         }
 
         /** cleanup */
@@ -776,7 +873,8 @@ static char **this_extract(struct strdic *self, const field_sid_t *ids, size_t n
                 struct parallel_extract_arg *carrier_arg = thread_args + thread_id;
                 vec_drop(&carrier_arg->local_ids_in);
                 if (likely(carrier_arg->did_work)) {
-                        strdic_free(&carrier_arg->carrier->local_dictionary, carrier_arg->strings_out);
+                        strdic_free(&carrier_arg->carrier->local_dictionary, carrier_arg->as_views ?
+                                (void *) carrier_arg->views_out : (void *) carrier_arg->strings_out);
                 }
         }
 
@@ -790,8 +888,6 @@ static char **this_extract(struct strdic *self, const field_sid_t *ids, size_t n
         ng5_unused(begin);
         ng5_unused(end);
         ng5_info(STRING_DIC_ASYNC_TAG, "extract (safe) operation done: %f seconds spent here", (end - begin) / 1000.0f)
-
-        return globalResult;
 }
 
 static bool this_free(struct strdic *self, void *ptr)
@@ -926,7 +1022,6 @@ static void parallel_create_carrier(const void *restrict start, size_t width, si
                         createArgs->local_bucket_cap,
                         0,
                         createArgs->alloc);
-                memset(&carrier->thread, 0, sizeof(pthread_t));
                 carrier++;
         }
 }
@@ -956,6 +1051,20 @@ static bool this_setup_carriers(struct strdic *self, size_t capacity, size_t num
                 THREADING_HINT_MULTI,
                 num_threads);
 
+        /** carriers are long-lived threads that serve their local dictionary until the dictionary is dropped; the
+         * carriers vector does not grow anymore, i.e., carriers do not move in memory */
+        for (size_t thread_id = 0; thread_id < num_threads; thread_id++) {
+                struct carrier *carrier = vec_get(&extra->carriers, thread_id, struct carrier);
+                atomic_init(&carrier->queue.head, 0);
+                atomic_init(&carrier->queue.tail, 0);
+                atomic_init(&carrier->num_done, 0);
+                carrier->num_submitted = 0;
+                pthread_mutex_init(&carrier->mutex, NULL);
+                pthread_cond_init(&carrier->wakeup, NULL);
+                pthread_cond_init(&carrier->done, NULL);
+                pthread_create(&carrier->thread, NULL, carrier_main, carrier);
+        }
+
         return true;
 }
 
@@ -0,0 +1,554 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdatomic.h>
+
+#include "core/encode/encode_concurrent.h"
+#include "stdx/strhash.h"
+#include "hash/hashcode.h"
+
+#define STRING_DIC_CONCURRENT_TAG "string-dic-concurrent"
+
+#define HASHCODE_OF(key, key_len)       NG5_HASHCODE_OF(key_len, key)
+
+/** slots of the index encode (hash << 32 | state) where state is a string id or one of the following */
+#define SLOT_EMPTY                      0
+#define SLOT_STATE_BUSY                 UINT32_MAX              /* claimed, string id not yet published */
+#define SLOT_STATE_REMOVED              (UINT32_MAX - 1)
+#define SLOT_MAX_STRING_ID              (UINT32_MAX - 2)
+
+#define SLOT_MAKE(hash, state)          (((u64) (hash) << 32) | (u32) (state))
+#define SLOT_HASH(slot)                 ((hash32_t) ((slot) >> 32))
+#define SLOT_STATE(slot)                ((u32) (slot))
+
+#define SEGMENTS_MAX                    40
+#define ENTRIES_FIRST_SEGMENT_BITS      12                      /* 4096 entries in first segment */
+#define ARENA_FIRST_SEGMENT_BITS        16                      /* 64 KiB of strings in first segment */
+
+/**
+ * Storage for elements addressed by a 64bit position that grows by segments of doubling size. Segments are
+ * installed once (by CAS) and never move, such that threads can append and read concurrently without locking.
+ */
+struct segmented {
+        _Atomic(void *) segments[SEGMENTS_MAX];
+        size_t elem_size;
+        u32 first_bits;
+};
+
+struct entry {
+        const char *str;
+        u32 len;
+        bool removed;
+};
+
+struct concurrent_extra {
+        /** open addressing index from strings to ids, slots are claimed by CAS */
+        _Atomic(u64) *slots;
+        size_t slot_mask;
+        atomic_size_t num_claimed;
+
+        /** string ids to strings, and strings themselves */
+        struct segmented entries;
+        struct segmented arena;
+        atomic_size_t arena_cursor;
+        atomic_size_t next_id;
+        atomic_size_t num_removed;
+
+        /** held shared by each operation, and exclusively only to double the index */
+        pthread_rwlock_t resize_lock;
+};
+
+static bool this_drop(struct strdic *self);
+static bool this_insert(struct strdic *self, field_sid_t **out, char *const *strings, size_t num_strings,
+        size_t num_threads);
+static bool this_insert_keys(struct strdic *self, field_sid_t **out, const struct string_key *keys,
+        size_t num_strings, size_t num_threads);
+static bool this_remove(struct strdic *self, field_sid_t *strings, size_t num_strings);
+static bool this_locate_safe(struct strdic *self, field_sid_t **out, bool **found_mask, size_t *num_not_found,
+        char *const *keys, size_t num_keys);
+static bool this_locate_fast(struct strdic *self, field_sid_t **out, char *const *keys, size_t num_keys);
+static char **this_extract(struct strdic *self, const field_sid_t *ids, size_t num_ids);
+static struct string_view *this_extract_views(struct strdic *self, const field_sid_t *ids, size_t num_ids);
+static bool this_free(struct strdic *self, void *ptr);
+static bool this_reset_counters(struct strdic *self);
+static bool this_counters(struct strdic *self, struct strhash_counters *counters);
+static bool this_num_distinct(struct strdic *self, size_t *num);
+static bool this_get_contents(struct strdic *self, struct vector ofType (char *) *strings,
+        struct vector ofType(field_sid_t) *string_ids);
+
+static bool index_create(struct concurrent_extra *extra, struct allocator *alloc, size_t num_slots);
+static bool index_grow(struct concurrent_extra *extra, struct allocator *alloc);
+static field_sid_t index_find(struct concurrent_extra *extra, const char *key, u32 key_len, hash32_t hash);
+static field_sid_t index_insert(struct concurrent_extra *extra, struct allocator *alloc, const char *key, u32 key_len,
+        hash32_t hash);
+
+static void segmented_create(struct segmented *storage, size_t elem_size, u32 first_bits);
+static void segmented_drop(struct segmented *storage, struct allocator *alloc);
+static void *segmented_at(struct segmented *storage, struct allocator *alloc, u64 pos);
+
+int encode_concurrent_create(struct strdic *dic, size_t capacity, const struct allocator *alloc)
+{
+        error_if_null(dic);
+        ng5_check_success(alloc_this_or_std(&dic->alloc, alloc));
+
+        dic->tag = CONCURRENT;
+        dic->drop = this_drop;
+        dic->insert = this_insert;
+        dic->insert_keys = this_insert_keys;
+        dic->remove = this_remove;
+        dic->locate_safe = this_locate_safe;
+        dic->locate_fast = this_locate_fast;
+        dic->extract = this_extract;
+        dic->extract_views = this_extract_views;
+        dic->free = this_free;
+        dic->resetCounters = this_reset_counters;
+        dic->counters = this_counters;
+        dic->num_distinct = this_num_distinct;
+        dic->get_contents = this_get_contents;
+
+        struct concurrent_extra *extra = alloc_malloc(&dic->alloc, sizeof(struct concurrent_extra));
+        error_if_null(extra);
+        dic->extra = extra;
+
+        size_t num_slots = 16;
+        while (num_slots < 2 * capacity) {
+                num_slots <<= 1;
+        }
+        ng5_check_success(index_create(extra, &dic->alloc, num_slots));
+        segmented_create(&extra->entries, sizeof(struct entry), ENTRIES_FIRST_SEGMENT_BITS);
+        segmented_create(&extra->arena, 1, ARENA_FIRST_SEGMENT_BITS);
+        atomic_init(&extra->arena_cursor, 0);
+        atomic_init(&extra->next_id, NG5_NULL_ENCODED_STRING + 1);
+        atomic_init(&extra->num_removed, 0);
+        pthread_rwlock_init(&extra->resize_lock, NULL);
+        return true;
+}
+
+static inline struct concurrent_extra *this_extra(struct strdic *self)
+{
+        assert(self->tag == CONCURRENT);
+        return (struct concurrent_extra *) self->extra;
+}
+
+static bool this_drop(struct strdic *self)
+{
+        ng5_check_tag(self->tag, CONCURRENT)
+        struct concurrent_extra *extra = this_extra(self);
+        pthread_rwlock_destroy(&extra->resize_lock);
+        alloc_free(&self->alloc, (void *) extra->slots);
+        segmented_drop(&extra->entries, &self->alloc);
+        segmented_drop(&extra->arena, &self->alloc);
+        alloc_free(&self->alloc, extra);
+        return true;
+}
+
+/** inserts strings given either as plain 'strings' or as 'keys' whose hash codes are known (the other one is NULL) */
+static bool insert(struct strdic *self, field_sid_t **out, char *const *strings, const struct string_key *keys,
+        size_t num_strings)
+{
+        ng5_check_tag(self->tag, CONCURRENT)
+
+        struct concurrent_extra *extra = this_extra(self);
+        field_sid_t *ids_out = out ? alloc_malloc(&self->alloc, num_strings * sizeof(field_sid_t)) : NULL;
+
+        pthread_rwlock_rdlock(&extra->resize_lock);
+        for (size_t i = 0; i < num_strings; i++) {
+                struct string_key key = keys ? keys[i] : string_key_of(strings[i]);
+                field_sid_t id = NG5_NULL_ENCODED_STRING;
+                if (likely(key.str != NULL)) {
+                        /** keep the load factor below 1/2; growing requires all other operations to step aside */
+                        if (unlikely(2 * (atomic_load_explicit(&extra->num_claimed, memory_order_relaxed) + 1) >
+                                extra->slot_mask + 1)) {
+                                pthread_rwlock_unlock(&extra->resize_lock);
+                                pthread_rwlock_wrlock(&extra->resize_lock);
+                                bool status = index_grow(extra, &self->alloc);
+                                pthread_rwlock_unlock(&extra->resize_lock);
+                                pthread_rwlock_rdlock(&extra->resize_lock);
+                                if (unlikely(!status)) {
+                                        pthread_rwlock_unlock(&extra->resize_lock);
+                                        alloc_free(&self->alloc, ids_out);
+                                        error_print(NG5_ERR_MALLOCERR);
+                                        return false;
+                                }
+                        }
+                        id = index_insert(extra, &self->alloc, key.str, key.len, key.hash);
+                }
+                if (ids_out) {
+                        ids_out[i] = id;
+                }
+        }
+        pthread_rwlock_unlock(&extra->resize_lock);
+
+        ng5_optional_set(out, ids_out);
+        return true;
+}
+
+static bool this_insert(struct strdic *self, field_sid_t **out, char *const *strings, size_t num_strings,
+        size_t num_threads)
+{
+        ng5_unused(num_threads);
+        return insert(self, out, strings, NULL, num_strings);
+}
+
+static bool this_insert_keys(struct strdic *self, field_sid_t **out, const struct string_key *keys,
+        size_t num_strings, size_t num_threads)
+{
+        ng5_unused(num_threads);
+        return insert(self, out, NULL, keys, num_strings);
+}
+
+static bool this_remove(struct strdic *self, field_sid_t *strings, size_t num_strings)
+{
+        ng5_check_tag(self->tag, CONCURRENT)
+        struct concurrent_extra *extra = this_extra(self);
+
+        pthread_rwlock_rdlock(&extra->resize_lock);
+        for (size_t i = 0; i < num_strings; i++) {
+                field_sid_t id = strings[i];
+                if (unlikely(id == NG5_NULL_ENCODED_STRING || id >= atomic_load(&extra->next_id))) {
+                        continue;
+                }
+                struct entry *entry = segmented_at(&extra->entries, &self->alloc, id);
+                hash32_t hash = HASHCODE_OF(entry->str, entry->len);
+                for (size_t pos = hash & extra->slot_mask; ; pos = (pos + 1) & extra->slot_mask) {
+                        u64 slot = atomic_load_explicit(&extra->slots[pos], memory_order_acquire);
+                        if (slot == SLOT_EMPTY) {
+                                break;
+                        }
+                        if (slot == SLOT_MAKE(hash, id)) {
+                                /** only one of concurrent removals of the same id succeeds */
+                                if (atomic_compare_exchange_strong(&extra->slots[pos], &slot,
+                                        SLOT_MAKE(hash, SLOT_STATE_REMOVED))) {
+                                        entry->removed = true;
+                                        atomic_fetch_add(&extra->num_removed, 1);
+                                }
+                                break;
+                        }
+                }
+        }
+        pthread_rwlock_unlock(&extra->resize_lock);
+        return true;
+}
+
+static bool this_locate_safe(struct strdic *self, field_sid_t **out, bool **found_mask, size_t *num_not_found,
+        char *const *keys, size_t num_keys)
+{
+        ng5_check_tag(self->tag, CONCURRENT)
+        struct concurrent_extra *extra = this_extra(self);
+
+        field_sid_t *ids_out = alloc_malloc(&self->alloc, num_keys * sizeof(field_sid_t));
+        bool *found_mask_out = alloc_malloc(&self->alloc, num_keys * sizeof(bool));
+        size_t num_misses = 0;
+
+        pthread_rwlock_rdlock(&extra->resize_lock);
+        for (size_t i = 0; i < num_keys; i++) {
+                const char *key = keys[i];
+                field_sid_t id = NG5_NULL_ENCODED_STRING;
+                if (likely(key != NULL)) {
+                        u32 key_len = strlen(key);
+                        id = index_find(extra, key, key_len, HASHCODE_OF(key, key_len));
+                }
+                bool found = key == NULL || id != NG5_NULL_ENCODED_STRING;
+                found_mask_out[i] = found;
+                ids_out[i] = found ? id : ((field_sid_t) -1);
+                num_misses += found ? 0 : 1;
+        }
+        pthread_rwlock_unlock(&extra->resize_lock);
+
+        *out = ids_out;
+        *found_mask = found_mask_out;
+        *num_not_found = num_misses;
+        return true;
+}
+
+static bool this_locate_fast(struct strdic *self, field_sid_t **out, char *const *keys, size_t num_keys)
+{
+        bool *found_mask;
+        size_t num_not_found;
+        bool result = this_locate_safe(self, out, &found_mask, &num_not_found, keys, num_keys);
+        this_free(self, found_mask);
+        return result;
+}
+
+static char **this_extract(struct strdic *self, const field_sid_t *ids, size_t num_ids)
+{
+        if (unlikely(!self || !ids || self->tag != CONCURRENT)) {
+                return NULL;
+        }
+
+        struct concurrent_extra *extra = this_extra(self);
+        char **result = alloc_malloc(&self->alloc, num_ids * sizeof(char *));
+
+        /** published entries never move, hence no need to synchronize with inserts or resizes */
+        for (size_t i = 0; i < num_ids; i++) {
+                field_sid_t id = ids[i];
+                assert(id < atomic_load(&extra->next_id));
+                if (id == NG5_NULL_ENCODED_STRING) {
+                        result[i] = NG5_NULL_TEXT;
+                } else {
+                        struct entry *entry = segmented_at(&extra->entries, &self->alloc, id);
+                        assert(!entry->removed);
+                        result[i] = (char *) entry->str;
+                }
+        }
+        return result;
+}
+
+static struct string_view *this_extract_views(struct strdic *self, const field_sid_t *ids, size_t num_ids)
+{
+        if (unlikely(!self || !ids || self->tag != CONCURRENT)) {
+                return NULL;
+        }
+
+        struct concurrent_extra *extra = this_extra(self);
+        struct string_view *result = alloc_malloc(&self->alloc, num_ids * sizeof(struct string_view));
+
+        for (size_t i = 0; i < num_ids; i++) {
+                field_sid_t id = ids[i];
+                assert(id < atomic_load(&extra->next_id));
+                if (id == NG5_NULL_ENCODED_STRING) {
+                        result[i].str = NG5_NULL_TEXT;
+                        result[i].len = strlen(NG5_NULL_TEXT);
+                } else {
+                        struct entry *entry = segmented_at(&extra->entries, &self->alloc, id);
+                        assert(!entry->removed);
+                        result[i].str = entry->str;
+                        result[i].len = entry->len;
+                }
+        }
+        return result;
+}
+
+static bool this_free(struct strdic *self, void *ptr)
+{
+        return alloc_free(&self->alloc, ptr);
+}
+
+static bool this_reset_counters(struct strdic *self)
+{
+        ng5_unused(self);
+        ng5_check_tag(self->tag, CONCURRENT)
+        return true;
+}
+
+static bool this_counters(struct strdic *self, struct strhash_counters *counters)
+{
+        ng5_unused(self);
+        ng5_check_tag(self->tag, CONCURRENT)
+        return strhash_counters_init(counters);
+}
+
+static bool this_num_distinct(struct strdic *self, size_t *num)
+{
+        ng5_check_tag(self->tag, CONCURRENT)
+        struct concurrent_extra *extra = this_extra(self);
+        *num = atomic_load(&extra->next_id) - (NG5_NULL_ENCODED_STRING + 1) - atomic_load(&extra->num_removed);
+        return true;
+}
+
+static bool this_get_contents(struct strdic *self, struct vector ofType (char *) *strings,
+        struct vector ofType(field_sid_t) *string_ids)
+{
+        ng5_check_tag(self->tag, CONCURRENT)
+        struct concurrent_extra *extra = this_extra(self);
+
+        /** strings whose insertion is still in progress may not yet be published; do not wait for them */
+        size_t num_ids = atomic_load(&extra->next_id);
+        for (field_sid_t id = NG5_NULL_ENCODED_STRING + 1; id < num_ids; id++) {
+                struct entry *entry = segmented_at(&extra->entries, &self->alloc, id);
+                if (atomic_load_explicit((_Atomic(const char *) *) &entry->str, memory_order_acquire) &&
+                        !entry->removed) {
+                        vec_push(strings, &entry->str, 1);
+                        vec_push(string_ids, &id, 1);
+                }
+        }
+        return true;
+}
+
+static bool index_create(struct concurrent_extra *extra, struct allocator *alloc, size_t num_slots)
+{
+        extra->slots = alloc_malloc(alloc, num_slots * sizeof(u64));
+        error_if_null(extra->slots);
+        for (size_t i = 0; i < num_slots; i++) {
+                atomic_init(&extra->slots[i], SLOT_EMPTY);
+        }
+        extra->slot_mask = num_slots - 1;
+        atomic_init(&extra->num_claimed, 0);
+        return true;
+}
+
+static bool index_grow(struct concurrent_extra *extra, struct allocator *alloc)
+{
+        /** another thread may have grown the index while this thread waited for exclusive access */
+        size_t num_claimed = atomic_load(&extra->num_claimed);
+        if (2 * (num_claimed + 1) <= extra->slot_mask + 1) {
+                return true;
+        }
+
+        _Atomic(u64) *old_slots = extra->slots;
+        size_t old_num_slots = extra->slot_mask + 1;
+        size_t num_live = num_claimed - atomic_load(&extra->num_removed);
+        size_t num_slots = old_num_slots;
+        while (num_slots < 4 * num_live) {
+                num_slots <<= 1;
+        }
+        num_slots = ng5_max(num_slots, 2 * old_num_slots);
+
+        ng5_check_success(index_create(extra, alloc, num_slots));
+
+        /** no other operation is running, i.e., there are no busy slots; removed slots are dropped */
+        size_t num_moved = 0;
+        for (size_t i = 0; i < old_num_slots; i++) {
+                u64 slot = atomic_load_explicit(&old_slots[i], memory_order_relaxed);
+                if (slot != SLOT_EMPTY && SLOT_STATE(slot) != SLOT_STATE_REMOVED) {
+                        size_t pos = SLOT_HASH(slot) & extra->slot_mask;
+                        while (atomic_load_explicit(&extra->slots[pos], memory_order_relaxed) != SLOT_EMPTY) {
+                                pos = (pos + 1) & extra->slot_mask;
+                        }
+                        atomic_store_explicit(&extra->slots[pos], slot, memory_order_relaxed);
+                        num_moved++;
+                }
+        }
+        atomic_store(&extra->num_claimed, num_moved);
+        alloc_free(alloc, (void *) old_slots);
+        return true;
+}
+
+static inline bool entry_equals(struct concurrent_extra *extra, struct allocator *alloc, u32 id, const char *key,
+        u32 key_len)
+{
+        struct entry *entry = segmented_at(&extra->entries, alloc, id);
+        return entry->len == key_len && memcmp(entry->str, key, key_len) == 0;
+}
+
+static field_sid_t index_find(struct concurrent_extra *extra, const char *key, u32 key_len, hash32_t hash)
+{
+        for (size_t pos = hash & extra->slot_mask; ; pos = (pos + 1) & extra->slot_mask) {
+                u64 slot = atomic_load_explicit(&extra->slots[pos], memory_order_acquire);
+                if (slot == SLOT_EMPTY) {
+                        return NG5_NULL_ENCODED_STRING;
+                }
+                if (SLOT_HASH(slot) == hash) {
+                        /** the string being inserted into this slot might be the one searched for */
+                        while (SLOT_STATE(slot) == SLOT_STATE_BUSY) {
+                                slot = atomic_load_explicit(&extra->slots[pos], memory_order_acquire);
+                        }
+                        if (SLOT_STATE(slot) != SLOT_STATE_REMOVED &&
+                                entry_equals(extra, NULL, SLOT_STATE(slot), key, key_len)) {
+                                return SLOT_STATE(slot);
+                        }
+                }
+        }
+}
+
+static const char *arena_append(struct concurrent_extra *extra, struct allocator *alloc, const char *key, u32 key_len)
+{
+        while (true) {
+                u64 begin = atomic_fetch_add_explicit(&extra->arena_cursor, key_len + 1, memory_order_relaxed);
+                char *first = segmented_at(&extra->arena, alloc, begin);
+                char *last = segmented_at(&extra->arena, alloc, begin + key_len);
+                /** a string must not span two segments; the remainder of the segment is left unused then */
+                if (likely(last == first + key_len)) {
+                        memcpy(first, key, key_len);
+                        first[key_len] = '\0';
+                        return first;
+                }
+        }
+}
+
+static field_sid_t index_insert(struct concurrent_extra *extra, struct allocator *alloc, const char *key, u32 key_len,
+        hash32_t hash)
+{
+        for (size_t pos = hash & extra->slot_mask; ; pos = (pos + 1) & extra->slot_mask) {
+                u64 slot = atomic_load_explicit(&extra->slots[pos], memory_order_acquire);
+                if (slot == SLOT_EMPTY) {
+                        if (!atomic_compare_exchange_strong_explicit(&extra->slots[pos], &slot,
+                                SLOT_MAKE(hash, SLOT_STATE_BUSY), memory_order_acq_rel, memory_order_acquire)) {
+                                /** lost the race for this slot; re-inspect the winner's claim */
+                                pos = (pos - 1) & extra->slot_mask;
+                                continue;
+                        }
+                        atomic_fetch_add_explicit(&extra->num_claimed, 1, memory_order_relaxed);
+
+                        /** this thread owns the slot: assign the next dense id, and publish the string */
+                        field_sid_t id = atomic_fetch_add_explicit(&extra->next_id, 1, memory_order_relaxed);
+                        error_print_and_die_if(id > SLOT_MAX_STRING_ID, NG5_ERR_OPPFAILED);
+                        struct entry *entry = segmented_at(&extra->entries, alloc, id);
+                        entry->len = key_len;
+                        entry->removed = false;
+                        atomic_store_explicit((_Atomic(const char *) *) &entry->str,
+                                arena_append(extra, alloc, key, key_len), memory_order_release);
+                        atomic_store_explicit(&extra->slots[pos], SLOT_MAKE(hash, id), memory_order_release);
+                        return id;
+                }
+                if (SLOT_HASH(slot) == hash) {
+                        while (SLOT_STATE(slot) == SLOT_STATE_BUSY) {
+                                slot = atomic_load_explicit(&extra->slots[pos], memory_order_acquire);
+                        }
+                        if (SLOT_STATE(slot) != SLOT_STATE_REMOVED &&
+                                entry_equals(extra, alloc, SLOT_STATE(slot), key, key_len)) {
+                                return SLOT_STATE(slot);
+                        }
+                }
+        }
+}
+
+static void segmented_create(struct segmented *storage, size_t elem_size, u32 first_bits)
+{
+        for (u32 i = 0; i < SEGMENTS_MAX; i++) {
+                atomic_init(&storage->segments[i], NULL);
+        }
+        storage->elem_size = elem_size;
+        storage->first_bits = first_bits;
+}
+
+static void segmented_drop(struct segmented *storage, struct allocator *alloc)
+{
+        for (u32 i = 0; i < SEGMENTS_MAX; i++) {
+                void *segment = atomic_load(&storage->segments[i]);
+                if (segment) {
+                        alloc_free(alloc, segment);
+                }
+        }
+}
+
+/** returns the element at 'pos', and installs its segment if required (only if 'alloc' is non-null) */
+static void *segmented_at(struct segmented *storage, struct allocator *alloc, u64 pos)
+{
+        u64 scaled = (pos >> storage->first_bits) + 1;
+        u32 segment_idx = 63 - __builtin_clzll(scaled);
+        u64 offset = pos - (((1ULL << segment_idx) - 1) << storage->first_bits);
+        assert(segment_idx < SEGMENTS_MAX);
+
+        void *segment = atomic_load_explicit(&storage->segments[segment_idx], memory_order_acquire);
+        if (unlikely(segment == NULL)) {
+                assert(alloc);
+                size_t segment_size = (storage->elem_size << storage->first_bits) << segment_idx;
+                void *expected = NULL, *fresh = alloc_malloc(alloc, segment_size);
+                error_print_and_die_if(fresh == NULL, NG5_ERR_MALLOCERR);
+                memset(fresh, 0, segment_size);
+                if (atomic_compare_exchange_strong_explicit(&storage->segments[segment_idx], &expected, fresh,
+                        memory_order_acq_rel, memory_order_acquire)) {
+                        segment = fresh;
+                } else {
+                        /** installed concurrently by another thread */
+                        alloc_free(alloc, fresh);
+                        segment = expected;
+                }
+        }
+        return segment + offset * storage->elem_size;
+}
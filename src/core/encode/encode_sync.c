@@ -20,8 +20,10 @@
 #include "stdx/strhash.h"
 #include "core/encode/encode_sync.h"
 #include "core/strhash/strhash_mem.h"
+#include "core/strhash/strhash_swiss.h"
 #include "utils/time.h"
 #include "std/bloom.h"
+#include "std/strarena.h"
 #include "hash/fnv.h"
 #include "hash/add.h"
 #include "hash/xor.h"
@@ -30,14 +32,18 @@
 
 #define STRING_DIC_SYNC_TAG "string-dic-sync"
 
+/** average number of bytes per string for which the arena reserves memory upfront */
+#define ARENA_BYTES_PER_STRING 16
+
 struct entry {
-        char *str;
+        strarena_off_t off;
         bool in_use;
 };
 
 struct sync_extra {
         struct vector ofType(entry) contents;
         struct vector ofType(string_id_t_t) freelist;
+        struct strarena strings;
         struct strhash index;
         struct spinlock lock;
 };
@@ -45,11 +51,14 @@ struct sync_extra {
 static bool this_drop(struct strdic *self);
 static bool this_insert(struct strdic *self, field_sid_t **out, char *const *strings, size_t num_strings,
         size_t num_threads);
+static bool this_insert_keys(struct strdic *self, field_sid_t **out, const struct string_key *keys,
+        size_t num_strings, size_t num_threads);
 static bool this_remove(struct strdic *self, field_sid_t *strings, size_t num_strings);
 static bool this_locate_safe(struct strdic *self, field_sid_t **out, bool **found_mask, size_t *num_not_found,
         char *const *keys, size_t num_keys);
 static bool this_locate_fast(struct strdic *self, field_sid_t **out, char *const *keys, size_t num_keys);
 static char **this_extract(struct strdic *self, const field_sid_t *ids, size_t num_ids);
+static struct string_view *this_extract_views(struct strdic *self, const field_sid_t *ids, size_t num_ids);
 static bool this_free(struct strdic *self, void *ptr);
 
 static bool this_reset_counters(struct strdic *self);
@@ -80,10 +89,12 @@ int encode_sync_create(struct strdic *dic, size_t capacity, size_t num_indx_buck
         dic->tag = SYNC;
         dic->drop = this_drop;
         dic->insert = this_insert;
+        dic->insert_keys = this_insert_keys;
         dic->remove = this_remove;
         dic->locate_safe = this_locate_safe;
         dic->locate_fast = this_locate_fast;
         dic->extract = this_extract;
+        dic->extract_views = this_extract_views;
         dic->free = this_free;
         dic->resetCounters = this_reset_counters;
         dic->counters = this_counters;
@@ -116,10 +127,14 @@ static int create_extra(struct strdic *self, size_t capacity, size_t num_index_b
         spin_init(&extra->lock);
         ng5_check_success(vec_create(&extra->contents, &self->alloc, sizeof(struct entry), capacity));
         ng5_check_success(vec_create(&extra->freelist, &self->alloc, sizeof(field_sid_t), capacity));
-        struct entry empty = {.str    = NULL, .in_use = false};
+        ng5_check_success(strarena_create(&extra->strings, capacity * ARENA_BYTES_PER_STRING, &self->alloc));
+        struct entry empty = {.off = 0, .in_use = false};
         for (size_t i = 0; i < capacity; i++) {
                 ng5_check_success(vec_push(&extra->contents, &empty, 1));
-                freelist_push(self, i);
+                /** the null string is encoded by a reserved id, which must never be handed out for a string */
+                if (i != NG5_NULL_ENCODED_STRING) {
+                        freelist_push(self, i);
+                }
         }
         ng5_unused(num_threads);
 
@@ -130,10 +145,15 @@ static int create_extra(struct strdic *self, size_t capacity, size_t num_index_b
         ng5_check_success(alloc_this_or_std(&hashtable_alloc, &self->alloc));
 #endif
 
+#ifdef NG5_STRHASH_USE_SLICED
         ng5_check_success(strhash_create_inmemory(&extra->index,
                 &hashtable_alloc,
                 num_index_buckets,
                 num_index_bucket_cap));
+#else
+        ng5_unused(num_index_bucket_cap);
+        ng5_check_success(strhash_create_swiss(&extra->index, &hashtable_alloc, ng5_max(capacity, num_index_buckets)));
+#endif
         return true;
 }
 
@@ -152,7 +172,7 @@ static int freelist_pop(field_sid_t *out, struct strdic *self)
                 ng5_check_success(vec_grow(&num_new_pos, &extra->freelist));
                 ng5_check_success(vec_grow(NULL, &extra->contents));
                 assert (extra->freelist.cap_elems == extra->contents.cap_elems);
-                struct entry empty = {.in_use = false, .str    = NULL};
+                struct entry empty = {.in_use = false, .off = 0};
                 while (num_new_pos--) {
                         size_t new_pos = vec_length(&extra->contents);
                         ng5_check_success(vec_push(&extra->freelist, &new_pos, 1));
@@ -178,16 +198,7 @@ static bool this_drop(struct strdic *self)
 
         struct sync_extra *extra = this_extra(self);
 
-        struct entry *entries = (struct entry *) extra->contents.base;
-        for (size_t i = 0; i < extra->contents.num_elems; i++) {
-                struct entry *entry = entries + i;
-                if (entry->in_use) {
-                        assert (entry->str);
-                        alloc_free(&self->alloc, entry->str);
-                        entry->str = NULL;
-                }
-        }
-
+        strarena_drop(&extra->strings);
         vec_drop(&extra->freelist);
         vec_drop(&extra->contents);
         strhash_drop(&extra->index);
@@ -198,6 +209,18 @@ static bool this_drop(struct strdic *self)
 
 static bool this_insert(struct strdic *self, field_sid_t **out, char *const *strings, size_t num_strings,
         size_t num_threads)
+{
+        ng5_check_tag(self->tag, SYNC)
+        struct string_key *keys = alloc_malloc(&self->alloc, num_strings * sizeof(struct string_key));
+        error_print_and_die_if(num_strings > 0 && !keys, NG5_ERR_MALLOCERR)
+        string_keys_of(keys, strings, num_strings);
+        bool status = this_insert_keys(self, out, keys, num_strings, num_threads);
+        alloc_free(&self->alloc, keys);
+        return status;
+}
+
+static bool this_insert_keys(struct strdic *self, field_sid_t **out, const struct string_key *keys,
+        size_t num_strings, size_t num_threads)
 {
         ng5_trace(STRING_DIC_SYNC_TAG, "local string dictionary insertion invoked for %zu strings", num_strings);
         timestamp_t begin = time_now_wallclock();
@@ -227,7 +250,7 @@ static bool this_insert(struct strdic *self, field_sid_t **out, char *const *str
         ng5_trace(STRING_DIC_SYNC_TAG, "local string dictionary check for new strings in insertion bulk%s", "...");
 
         /** NOTE: palatalization of the call to this function decreases performance */
-        strhash_get_bulk_safe(&values, &found_mask, &num_not_found, &extra->index, strings, num_strings);
+        strhash_get_bulk_safe_keys(&values, &found_mask, &num_not_found, &extra->index, keys, num_strings);
 
         /** OPTIMIZATION: use a bloom_t to check whether a string (which has not appeared in the
          * dictionary before this batch but might occur multiple times in the current batch) was seen
@@ -246,7 +269,8 @@ static bool this_insert(struct strdic *self, field_sid_t **out, char *const *str
                          * must be done anyway for each string in the insertion batch that is inserted. */
 
                         field_sid_t string_id = 0;
-                        const char *key = (const char *) (strings[i]);
+                        const struct string_key *string_key = keys + i;
+                        const char *key = string_key->str;
 
                         bool found = false;
                         field_sid_t value;
@@ -254,9 +278,8 @@ static bool this_insert(struct strdic *self, field_sid_t **out, char *const *str
                         /** Query the bloom_t if the keys was already seend. If the filter returns "yes", a lookup
                          * is requried since the filter maybe made a mistake. Of the filter returns "no", the
                          * keys is new for sure. In this case, one can skip the lookup into the buckets. */
-                        size_t key_length = strlen(key);
-                        hash32_t bloom_key = key_length > 0 ? NG5_HASH_FNV(strlen(key), key)
-                                                            : 0; /** using a hash of a keys instead of the string keys itself avoids reading the entire string for computing k hashes inside the bloom_t */
+                        size_t key_length = string_key->len;
+                        hash32_t bloom_key = string_key->hash; /** using the hash of a key instead of the string key itself avoids reading the entire string for computing k hashes inside the bloom_t */
                         if (NG5_BLOOM_TEST_AND_SET(&bloom_t, &bloom_key, sizeof(hash32_t))) {
                                 /** ensure that the string really was seen (due to collisions in the bloom filter the keys might not
                                  * been actually seen) */
@@ -264,10 +287,10 @@ static bool this_insert(struct strdic *self, field_sid_t **out, char *const *str
                                 /** query index for strings to get a boolean mask which strings are new and which must be added */
                                 /** This is for the case that the string was not already contained in the string dictionary but may have
                                  * duplicates in this insertion batch that are already inserted */
-                                strhash_get_bulk_safe_exact(&value,
+                                strhash_get_bulk_safe_exact_key(&value,
                                         &found,
                                         &extra->index,
-                                        key);  /** OPTIMIZATION: use specialized function for "exact" query to avoid unnessecary malloc calls to manage set of results if only a single result is needed */
+                                        string_key);  /** OPTIMIZATION: use specialized function for "exact" query to avoid unnessecary malloc calls to manage set of results if only a single result is needed */
                         }
 
                         if (found) {
@@ -280,12 +303,16 @@ static bool this_insert(struct strdic *self, field_sid_t **out, char *const *str
                                 struct entry *entries = (struct entry *) vec_data(&extra->contents);
                                 struct entry *entry = entries + string_id;
                                 assert (!entry->in_use);
+                                bool append_result = strarena_append(&entry->off, &extra->strings, key, key_length);
+                                error_print_and_die_if(!append_result, NG5_ERR_MALLOCERR)
                                 entry->in_use = true;
-                                entry->str = strdup(strings[i]);
                                 ids_out[i] = string_id;
 
-                                /** add for not yet registered pairs to buffer for fast import */
-                                strhash_put_exact_fast(&extra->index, entry->str, string_id);
+                                /** add for not yet registered pairs to buffer for fast import; the arena copy is
+                                 * never moved, hence the index can refer to it */
+                                struct string_key stored_key = *string_key;
+                                stored_key.str = strarena_str(&extra->strings, entry->off);
+                                strhash_put_exact_fast_key(&extra->index, &stored_key, string_id);
                         }
                 }
         }
@@ -328,23 +355,17 @@ static bool this_remove(struct strdic *self, field_sid_t *strings, size_t num_st
                 field_sid_t field_sid_t = strings[i];
                 struct entry *entry = (struct entry *) vec_data(&extra->contents) + field_sid_t;
                 if (likely(entry->in_use)) {
-                        string_to_delete[num_strings_to_delete] = entry->str;
+                        string_to_delete[num_strings_to_delete] = (char *) strarena_str(&extra->strings, entry->off);
                         string_ids_to_delete[num_strings_to_delete] = strings[i];
-                        entry->str = NULL;
                         entry->in_use = false;
                         num_strings_to_delete++;
                         ng5_check_success(freelist_push(self, field_sid_t));
                 }
         }
 
-        /** remove from index */
+        /** remove from index; the space of removed strings in the arena is not reclaimed */
         ng5_check_success(strhash_remove(&extra->index, string_to_delete, num_strings_to_delete));
 
-        /** free up resources for strings that should be removed */
-        for (size_t i = 0; i < num_strings_to_delete; i++) {
-                free(string_to_delete[i]);
-        }
-
         /** cleanup */
         alloc_free(&self->alloc, string_to_delete);
         alloc_free(&self->alloc, string_ids_to_delete);
@@ -422,7 +443,44 @@ static char **this_extract(struct strdic *self, const field_sid_t *ids, size_t n
                 field_sid_t field_sid_t = ids[i];
                 assert(field_sid_t < vec_length(&extra->contents));
                 assert(field_sid_t == NG5_NULL_ENCODED_STRING || entries[field_sid_t].in_use);
-                result[i] = field_sid_t != NG5_NULL_ENCODED_STRING ? entries[field_sid_t].str : NG5_NULL_TEXT;
+                result[i] = field_sid_t != NG5_NULL_ENCODED_STRING ?
+                        (char *) strarena_str(&extra->strings, entries[field_sid_t].off) : NG5_NULL_TEXT;
+        }
+
+        unlock(self);
+        return result;
+}
+
+static struct string_view *this_extract_views(struct strdic *self, const field_sid_t *ids, size_t num_ids)
+{
+        if (unlikely(!self || !ids || num_ids == 0 || self->tag != SYNC)) {
+                return NULL;
+        }
+
+        lock(self);
+
+        struct allocator hashtable_alloc;
+#if defined(NG5_CONFIG_TRACE_STRING_DIC_ALLOC) && !defined(NDEBUG)
+        allocatorTrace(&hashtable_alloc);
+#else
+        alloc_this_or_std(&hashtable_alloc, &self->alloc);
+#endif
+
+        struct sync_extra *extra = this_extra(self);
+        struct string_view *result = alloc_malloc(&hashtable_alloc, num_ids * sizeof(struct string_view));
+        struct entry *entries = (struct entry *) vec_data(&extra->contents);
+
+        for (size_t i = 0; i < num_ids; i++) {
+                field_sid_t id = ids[i];
+                assert(id < vec_length(&extra->contents));
+                assert(id == NG5_NULL_ENCODED_STRING || entries[id].in_use);
+                if (likely(id != NG5_NULL_ENCODED_STRING)) {
+                        result[i].str = strarena_str(&extra->strings, entries[id].off);
+                        result[i].len = strarena_len(&extra->strings, entries[id].off);
+                } else {
+                        result[i].str = NG5_NULL_TEXT;
+                        result[i].len = strlen(NG5_NULL_TEXT);
+                }
         }
 
         unlock(self);
@@ -476,7 +534,8 @@ static bool this_get_contents(struct strdic *self, struct vector ofType (char *)
         for (field_sid_t i = 0; i < extra->contents.num_elems; i++) {
                 const struct entry *e = vec_get(&extra->contents, i, struct entry);
                 if (e->in_use) {
-                        vec_push(strings, &e->str, 1);
+                        const char *str = strarena_str(&extra->strings, e->off);
+                        vec_push(strings, &str, 1);
                         vec_push(string_ids, &i, 1);
                 }
         }
@@ -16,6 +16,8 @@
  */
 
 #include <assert.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include "core/mem/block.h"
 #include "shared/error.h"
@@ -24,6 +26,8 @@ struct memblock {
         offset_t blockLength;
         offset_t lastByte;
         void *base;
+        void *mapping;          /* start of the page-aligned mapping, or NULL for heap blocks */
+        size_t mapping_size;
         struct err err;
 };
 
@@ -36,6 +40,8 @@ bool memblock_create(struct memblock **block, size_t size)
         result->blockLength = size;
         result->lastByte = 0;
         result->base = malloc(size);
+        result->mapping = NULL;
+        result->mapping_size = 0;
         error_init(&result->err);
         *block = result;
         return true;
@@ -48,10 +54,88 @@ bool memblock_from_file(struct memblock **block, FILE *file, size_t nbytes)
         return numRead == nbytes ? true : false;
 }
 
+bool memblock_map_file(struct memblock **block, FILE *file, size_t nbytes)
+{
+        error_if_null(block)
+        error_if_null(file)
+        if (nbytes == 0) {
+                error_print(NG5_ERR_ILLEGALARG)
+                return false;
+        }
+
+        long start = ftell(file);
+        if (start < 0) {
+                error_print(NG5_ERR_IO)
+                return false;
+        }
+
+        /* mmap offsets must be page-aligned; map from the page holding 'start' and skip the slack */
+        size_t page_size = sysconf(_SC_PAGESIZE);
+        off_t map_start = start & ~((off_t) page_size - 1);
+        size_t slack = start - map_start;
+
+        void *mapping = mmap(NULL, nbytes + slack, PROT_READ, MAP_PRIVATE, fileno(file), map_start);
+        if (mapping == MAP_FAILED) {
+                error_print(NG5_ERR_MMAP_FAILED)
+                return false;
+        }
+
+        struct memblock *result = malloc(sizeof(struct memblock));
+        if (!result) {
+                munmap(mapping, nbytes + slack);
+                error_print(NG5_ERR_MALLOCERR)
+                return false;
+        }
+        result->blockLength = nbytes;
+        result->lastByte = nbytes;
+        result->base = mapping + slack;
+        result->mapping = mapping;
+        result->mapping_size = nbytes + slack;
+        error_init(&result->err);
+
+        fseek(file, nbytes, SEEK_CUR);
+        *block = result;
+        return true;
+}
+
+bool memblock_advise(struct memblock *block, enum memblock_advice advice)
+{
+        error_if_null(block)
+        if (block->mapping) {
+                int hint;
+                switch (advice) {
+                case MEMBLOCK_ADVICE_SEQUENTIAL:
+                        hint = MADV_SEQUENTIAL;
+                        break;
+                case MEMBLOCK_ADVICE_RANDOM:
+                        hint = MADV_RANDOM;
+                        break;
+                case MEMBLOCK_ADVICE_WILLNEED:
+                        hint = MADV_WILLNEED;
+                        break;
+                default:
+                        hint = MADV_NORMAL;
+                        break;
+                }
+                /* a hint only; failing to apply it does not affect correctness */
+                madvise(block->mapping, block->mapping_size, hint);
+        }
+        return true;
+}
+
+bool memblock_is_mapped(const struct memblock *block)
+{
+        return block && block->mapping;
+}
+
 bool memblock_drop(struct memblock *block)
 {
         error_if_null(block)
-        free(block->base);
+        if (block->mapping) {
+                munmap(block->mapping, block->mapping_size);
+        } else {
+                free(block->base);
+        }
         free(block);
         return true;
 }
@@ -85,6 +169,10 @@ bool memblock_resize(struct memblock *block, size_t size)
 {
         error_if_null(block)
         error_print_if(size == 0, NG5_ERR_ILLEGALARG)
+        if (unlikely(block->mapping != NULL)) {
+                error(&block->err, NG5_ERR_WRITEPROT)
+                return false;
+        }
         block->base = realloc(block->base, size);
         block->blockLength = size;
         return true;
@@ -94,6 +182,10 @@ bool memblock_write(struct memblock *block, offset_t position, const char *data,
 {
         error_if_null(block)
         error_if_null(data)
+        if (unlikely(block->mapping != NULL)) {
+                error(&block->err, NG5_ERR_WRITEPROT)
+                return false;
+        }
         if (likely(position + nbytes < block->blockLength)) {
                 memcpy(block->base + position, data, nbytes);
                 block->lastByte = ng5_max(block->lastByte, position + nbytes);
@@ -118,6 +210,10 @@ bool memblock_cpy(struct memblock **dst, struct memblock *src)
 bool memblock_shrink(struct memblock *block)
 {
         error_if_null(block)
+        if (unlikely(block->mapping != NULL)) {
+                error(&block->err, NG5_ERR_WRITEPROT)
+                return false;
+        }
         block->blockLength = block->lastByte;
         block->base = realloc(block->base, block->blockLength);
         return true;
@@ -125,6 +221,13 @@ bool memblock_shrink(struct memblock *block)
 
 void *memblock_move_contents_and_drop(struct memblock *block)
 {
+        if (block->mapping) {
+                /* callers take ownership via free(), so hand out a heap copy of the mapped contents */
+                void *result = malloc(block->blockLength);
+                memcpy(result, block->base, block->blockLength);
+                memblock_drop(block);
+                return result;
+        }
         void *result = block->base;
         block->base = NULL;
         free(block);
@@ -15,9 +15,32 @@
  * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <stdatomic.h>
+
 #include <core/mem/pool.h>
 #include "core/mem/pool.h"
 
+#define POOL_SLOT_CHUNK_BITS  10
+#define POOL_SLOT_CHUNK_SIZE  (1 << POOL_SLOT_CHUNK_BITS)
+#define POOL_SLOT_MAX_CHUNKS  ((POOL_MAX_MANAGED_PTRS + POOL_SLOT_CHUNK_SIZE - 1) / POOL_SLOT_CHUNK_SIZE)
+
+struct pool_slot_chunk {
+        struct pool_ptr_info        infos[POOL_SLOT_CHUNK_SIZE];
+        atomic_uint_fast32_t        next_free[POOL_SLOT_CHUNK_SIZE]; /* successor (+1) in the slot freelist */
+};
+
+/**
+ * Registry of pointers managed by a pool. Slots are stored in fixed-size chunks that are installed once and never
+ * moved, such that a 'pool_ptr_info' obtained by its position stays valid while other threads register or unregister
+ * pointers. Free'd slots are recycled via a Treiber stack whose head is tagged with a version counter against ABA.
+ * Lookups are wait-free, registration and unregistration are lock-free.
+ */
+struct pool_slot_registry {
+        _Atomic(struct pool_slot_chunk *) chunks[POOL_SLOT_MAX_CHUNKS];
+        atomic_uint_fast32_t              num_slots;  /* high-water mark of slots ever handed out */
+        atomic_uint_fast64_t              free_head;  /* (version << 32) | (position + 1), or version only if empty */
+};
+
 struct pool_register_entry pool_register[] = {
         {
                 .ops.pooled     = false,
@@ -66,13 +89,21 @@ static bool strategy_free(struct pool *pool, data_ptr_t ptr);
 static bool strategy_gc(struct pool *pool);
 static bool strategy_get_counters(struct pool *pool, struct pool_counters *counters);
 static bool strategy_reset_counters(struct pool *pool);
+static void slot_registry_create(struct pool_slot_registry *registry);
+static void slot_registry_drop(struct pool_slot_registry *registry);
+static bool slot_registry_acquire(u16 *pos, struct pool_slot_registry *registry);
+static void slot_registry_release(struct pool_slot_registry *registry, u16 pos);
 
 static bool pool_setup(struct pool *pool)
 {
         error_if_null(pool)
         error_init(&pool->err);
-        ng5_check_success(vec_create(&pool->in_use, NULL, sizeof(struct pool_ptr_info), 100));
-        ng5_check_success(vec_create(&pool->in_use_pos_freelist, NULL, sizeof(u16), 100));
+        pool->in_use = malloc(sizeof(struct pool_slot_registry));
+        if (unlikely(!pool->in_use)) {
+                error(&pool->err, NG5_ERR_MALLOCERR);
+                return false;
+        }
+        slot_registry_create(pool->in_use);
         ng5_check_success(spin_init(&pool->lock));
         return true;
 }
@@ -84,7 +115,7 @@ NG5_EXPORT(size_t) pool_get_num_registered_strategies()
 
 NG5_EXPORT(bool) pool_create(struct pool *pool, enum pool_options options)
 {
-        pool_setup(pool);
+        ng5_check_success(pool_setup(pool));
 
         if (!strategy_by_options(pool, &pool->strategy, options)) {
                 print_error_and_die(NG5_ERR_NOTIMPLEMENTED);
@@ -96,7 +127,7 @@ NG5_EXPORT(bool) pool_create(struct pool *pool, enum pool_options options)
 
 NG5_EXPORT(bool) pool_create_by_name(struct pool *pool, const char *name)
 {
-        pool_setup(pool);
+        ng5_check_success(pool_setup(pool));
 
         for (u32 i = 0; i < NG5_ARRAY_LENGTH(pool_register); i++) {
                 struct pool_register_entry *entry = pool_register + i;
@@ -120,8 +151,9 @@ NG5_EXPORT(bool) pool_drop(struct pool *pool)
         lock(pool);
 
         pool_free_all(pool);
-        vec_drop(&pool->in_use);
-        vec_drop(&pool->in_use_pos_freelist);
+        slot_registry_drop(pool->in_use);
+        free(pool->in_use);
+        pool->in_use = NULL;
 
         unlock(pool);
         return true;
@@ -185,11 +217,11 @@ NG5_EXPORT(bool) pool_free_all(struct pool *pool)
         ng5_implemented_or_error(&pool->err, (&pool->strategy), _free)
 
         lock(pool);
-        u32 nptrs = pool->in_use.num_elems;
-        struct pool_ptr_info *ptr_infos = vec_all(&pool->in_use, struct pool_ptr_info);
-        while (nptrs--) {
-                struct pool_ptr_info *ptr_info = ptr_infos++;
-                if (!ptr_info->is_free) {
+        u32 nptrs = ng5_min(atomic_load(&pool->in_use->num_slots), POOL_MAX_MANAGED_PTRS);
+        for (u32 pos = 0; pos < nptrs; pos++) {
+                struct pool_slot_chunk *chunk = atomic_load(&pool->in_use->chunks[pos >> POOL_SLOT_CHUNK_BITS]);
+                struct pool_ptr_info *ptr_info = chunk ? chunk->infos + (pos & (POOL_SLOT_CHUNK_SIZE - 1)) : NULL;
+                if (ptr_info && !ptr_info->is_free) {
                         bool result = strategy_free(pool, ptr_info->ptr);
                         if (unlikely(!result)) {
                                 error_print(NG5_ERR_FREE_FAILED);
@@ -236,23 +268,13 @@ NG5_EXPORT(bool) pool_internal_register(data_ptr_t *dst, struct pool *pool, cons
         assert(pool);
         assert(ptr);
 
-        struct pool_ptr_info *pool_ptr_info;
         u16 pos;
-
-        if (!vec_is_empty(&pool->in_use_pos_freelist)) {
-                /* update-in-place */
-                pos = *(u16 *) vec_pop(&pool->in_use_pos_freelist);
-                pool_ptr_info = (struct pool_ptr_info *) vec_at(&pool->in_use, pos);
-                assert(pool_ptr_info->is_free);
-        } else {
-                /* append */
-                pos = vec_length(&pool->in_use);
-                pool_ptr_info = vec_new_and_get(&pool->in_use, struct pool_ptr_info);
-
+        if (unlikely(!slot_registry_acquire(&pos, pool->in_use))) {
+                error(&pool->err, NG5_ERR_MEMPOOL_LIMIT);
+                return false;
         }
 
-        error_if(pos + 1 == UINT16_MAX, &pool->err, NG5_ERR_MEMPOOL_LIMIT);
-
+        struct pool_ptr_info *pool_ptr_info = pool_internal_slot(pool, pos);
         *pool_ptr_info = (struct pool_ptr_info) {
                 .is_free = false,
                 .bytes_used = bytes_used,
@@ -261,8 +283,7 @@ NG5_EXPORT(bool) pool_internal_register(data_ptr_t *dst, struct pool *pool, cons
         data_ptr_create(&pool_ptr_info->ptr, ptr);
         data_ptr_set_data(&pool_ptr_info->ptr, pos);
 
-        assert(!((struct pool_ptr_info *) vec_at(&pool->in_use, pos))->is_free);
-        assert(data_ptr_get(void *, ((struct pool_ptr_info *) vec_at(&pool->in_use, pos))->ptr) == ptr);
+        assert(data_ptr_get(void *, pool_internal_slot(pool, pos)->ptr) == ptr);
 
         *dst = pool_ptr_info->ptr;
         return true;
@@ -275,14 +296,98 @@ NG5_EXPORT(void) pool_internal_unregister(struct pool *pool, data_ptr_t ptr)
 
         u16 pos;
         data_ptr_get_data(&pos, ptr);
-        assert(pos < pool->in_use.num_elems);
-
-        struct pool_ptr_info *pool_ptr_info = (struct pool_ptr_info *) vec_at(&pool->in_use, pos);
+        struct pool_ptr_info *pool_ptr_info = pool_internal_slot(pool, pos);
         assert(data_ptr_get(void *, pool_ptr_info->ptr) == data_ptr_get(void *, ptr));
         assert(!pool_ptr_info->is_free);
 
         pool_ptr_info->is_free = true;
-        vec_push(&pool->in_use_pos_freelist, &pos, 1);
+        slot_registry_release(pool->in_use, pos);
+}
+
+NG5_EXPORT(struct pool_ptr_info *) pool_internal_slot(struct pool *pool, u16 pos)
+{
+        assert(pos < atomic_load(&pool->in_use->num_slots));
+        struct pool_slot_chunk *chunk = atomic_load_explicit(&pool->in_use->chunks[pos >> POOL_SLOT_CHUNK_BITS],
+                memory_order_acquire);
+        assert(chunk);
+        return chunk->infos + (pos & (POOL_SLOT_CHUNK_SIZE - 1));
+}
+
+static void slot_registry_create(struct pool_slot_registry *registry)
+{
+        for (u32 i = 0; i < POOL_SLOT_MAX_CHUNKS; i++) {
+                atomic_init(&registry->chunks[i], NULL);
+        }
+        atomic_init(&registry->num_slots, 0);
+        atomic_init(&registry->free_head, 0);
+}
+
+static void slot_registry_drop(struct pool_slot_registry *registry)
+{
+        for (u32 i = 0; i < POOL_SLOT_MAX_CHUNKS; i++) {
+                free(atomic_exchange(&registry->chunks[i], NULL));
+        }
+        atomic_store(&registry->num_slots, 0);
+        atomic_store(&registry->free_head, 0);
+}
+
+static inline atomic_uint_fast32_t *slot_registry_next_free(struct pool_slot_registry *registry, u32 pos)
+{
+        struct pool_slot_chunk *chunk = atomic_load_explicit(&registry->chunks[pos >> POOL_SLOT_CHUNK_BITS],
+                memory_order_acquire);
+        return chunk->next_free + (pos & (POOL_SLOT_CHUNK_SIZE - 1));
+}
+
+static bool slot_registry_acquire(u16 *pos, struct pool_slot_registry *registry)
+{
+        /* recycle a released slot, if any */
+        u64 head = atomic_load_explicit(&registry->free_head, memory_order_acquire);
+        while ((u32) head != 0) {
+                u32 top = (u32) head - 1;
+                u64 next = atomic_load_explicit(slot_registry_next_free(registry, top), memory_order_relaxed);
+                u64 new_head = (((head >> 32) + 1) << 32) | next;
+                if (atomic_compare_exchange_weak_explicit(&registry->free_head, &head, new_head,
+                        memory_order_acquire, memory_order_acquire)) {
+                        *pos = top;
+                        return true;
+                }
+        }
+
+        /* otherwise, hand out a fresh slot; its chunk is installed before the slot is claimed such that a failed
+         * allocation leaves the high-water mark untouched, and the mark never grows beyond the limit */
+        uint_fast32_t fresh = atomic_load_explicit(&registry->num_slots, memory_order_relaxed);
+        do {
+                if (unlikely(fresh >= POOL_MAX_MANAGED_PTRS)) {
+                        return false;
+                }
+                _Atomic(struct pool_slot_chunk *) *chunk_ref = &registry->chunks[fresh >> POOL_SLOT_CHUNK_BITS];
+                if (unlikely(atomic_load_explicit(chunk_ref, memory_order_acquire) == NULL)) {
+                        struct pool_slot_chunk *expected = NULL, *chunk = calloc(1, sizeof(struct pool_slot_chunk));
+                        if (unlikely(!chunk)) {
+                                return false;
+                        }
+                        if (!atomic_compare_exchange_strong_explicit(chunk_ref, &expected, chunk,
+                                memory_order_acq_rel, memory_order_acquire)) {
+                                /* installed concurrently by another thread */
+                                free(chunk);
+                        }
+                }
+        } while (!atomic_compare_exchange_weak_explicit(&registry->num_slots, &fresh, fresh + 1,
+                memory_order_relaxed, memory_order_relaxed));
+        *pos = fresh;
+        return true;
+}
+
+static void slot_registry_release(struct pool_slot_registry *registry, u16 pos)
+{
+        atomic_uint_fast32_t *next_free = slot_registry_next_free(registry, pos);
+        u64 head = atomic_load_explicit(&registry->free_head, memory_order_relaxed);
+        u64 new_head;
+        do {
+                atomic_store_explicit(next_free, (u32) head, memory_order_relaxed);
+                new_head = (((head >> 32) + 1) << 32) | ((u32) pos + 1);
+        } while (!atomic_compare_exchange_weak_explicit(&registry->free_head, &head, new_head,
+                memory_order_release, memory_order_relaxed));
 }
 
 static void lock(struct pool *pool)
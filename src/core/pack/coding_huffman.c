@@ -72,21 +72,10 @@ bool huffman_dump_dictionary(FILE *file, struct memfile *memfile)
 
                 fprintf(file, "0x%04x ", (unsigned) offset);
                 fprintf(file,
-                        "[marker: %c] [letter: '%c'] [nbytes_prefix: %d] [code: ",
+                        "[marker: %c] [letter: '%c'] [nbits: %d]\n",
                         MARKER_SYMBOL_HUFFMAN_DIC_ENTRY,
                         entry_info.letter,
-                        entry_info.nbytes_prefix);
-
-                if (entry_info.nbytes_prefix > 0) {
-                        for (u16 i = 0; i < entry_info.nbytes_prefix; i++) {
-                                bitmap_print_bits_in_char(file, entry_info.prefix_code[i]);
-                                fprintf(file, "%s", i + 1 < entry_info.nbytes_prefix ? ", " : "");
-                        }
-                } else {
-                        fprintf(file, "0b00000000");
-                }
-
-                fprintf(file, "]\n");
+                        entry_info.nbits);
         }
         return true;
 }
@@ -128,12 +117,19 @@ NG5_EXPORT(bool) pack_huffman_read_extra(struct packer *self, FILE *src, size_t
 {
         ng5_check_tag(self->tag, PACK_HUFFMAN);
 
-        ng5_unused(self);
-        ng5_unused(src);
-        ng5_unused(nbytes);
+        struct coding_huffman *decoder = (struct coding_huffman *) self->extra;
+        struct memblock *block;
+        struct memfile memfile;
+
+        if (!memblock_from_file(&block, src, nbytes)) {
+                error(&decoder->err, NG5_ERR_IO);
+                return false;
+        }
+        memfile_open(&memfile, block, READ_ONLY);
+        bool status = coding_huffman_read_dictionary(decoder, &memfile, MARKER_SYMBOL_HUFFMAN_DIC_ENTRY);
+        memblock_drop(block);
 
-        abort(); /* not implemented */
-        return false;
+        return status;
 }
 
 NG5_EXPORT(bool) pack_huffman_print_extra(struct packer *self, FILE *file, struct memfile *src)
@@ -171,10 +167,27 @@ bool pack_huffman_encode_string(struct packer *self, struct memfile *dst, struct
 
 NG5_EXPORT(bool) pack_huffman_decode_string(struct packer *self, char *dst, size_t strlen, FILE *src)
 {
-        ng5_unused(self);
-        ng5_unused(dst);
-        ng5_unused(strlen);
-        ng5_unused(src);
-        abort(); /* not implemented */
-        return false;
+        ng5_check_tag(self->tag, PACK_HUFFMAN);
+
+        struct coding_huffman *decoder = (struct coding_huffman *) self->extra;
+        u32 nbytes_encoded;
+        /** the decoder reads its input in 64-bit words and may look up to 8 bytes past the encoded string */
+        char buffer[256 + sizeof(u64)];
+
+        if (fread(&nbytes_encoded, sizeof(u32), 1, src) != 1) {
+                return false;
+        }
+        char *encoded = nbytes_encoded <= 256 ? buffer : malloc(nbytes_encoded + sizeof(u64));
+        if (!encoded) {
+                return false;
+        }
+        bool status = fread(encoded, sizeof(char), nbytes_encoded, src) == nbytes_encoded;
+        if (status) {
+                ng5_zero_memory(encoded + nbytes_encoded, sizeof(u64));
+                status = coding_huffman_decode(dst, strlen, decoder, encoded, nbytes_encoded);
+        }
+        if (encoded != buffer) {
+                free(encoded);
+        }
+        return status;
 }
\ No newline at end of file
@@ -20,7 +20,9 @@
 
 struct compressor_strategy_entry compressor_strategy_register[] =
         {{.type = PACK_NONE, .name = "none", .create = pack_none_create, .flag_bit = 1 << 0},
-         {.type = PACK_HUFFMAN, .name = "huffman", .create = pack_huffman_create, .flag_bit = 1 << 1}};
+         {.type = PACK_HUFFMAN, .name = "huffman", .create = pack_huffman_create, .flag_bit = 1 << 1},
+         {.type = PACK_FSST, .name = "fsst", .create = pack_fsst_create, .flag_bit = 1 << 2},
+         {.type = PACK_FRONT, .name = "front", .create = pack_front_create, .flag_bit = 1 << 3}};
 
 static bool create_strategy(size_t i, struct packer *strategy)
 {
@@ -64,6 +66,34 @@ NG5_EXPORT(void) pack_huffman_create(struct packer *strategy)
         strategy->print_encoded = pack_huffman_print_encoded;
 }
 
+NG5_EXPORT(void) pack_fsst_create(struct packer *strategy)
+{
+        strategy->tag = PACK_FSST;
+        strategy->create = pack_fsst_init;
+        strategy->cpy = pack_fsst_cpy;
+        strategy->drop = pack_fsst_drop;
+        strategy->write_extra = pack_fsst_write_extra;
+        strategy->read_extra = pack_fsst_read_extra;
+        strategy->encode_string = pack_fsst_encode_string;
+        strategy->decode_string = pack_fsst_decode_string;
+        strategy->print_extra = pack_fsst_print_extra;
+        strategy->print_encoded = pack_fsst_print_encoded;
+}
+
+NG5_EXPORT(void) pack_front_create(struct packer *strategy)
+{
+        strategy->tag = PACK_FRONT;
+        strategy->create = pack_front_init;
+        strategy->cpy = pack_front_cpy;
+        strategy->drop = pack_front_drop;
+        strategy->write_extra = pack_front_write_extra;
+        strategy->read_extra = pack_front_read_extra;
+        strategy->encode_string = pack_front_encode_string;
+        strategy->decode_string = pack_front_decode_string;
+        strategy->print_extra = pack_front_print_extra;
+        strategy->print_encoded = pack_front_print_encoded;
+}
+
 NG5_EXPORT(size_t) pack_get_num_registered_strategies()
 {
         return NG5_ARRAY_LENGTH(compressor_strategy_register);
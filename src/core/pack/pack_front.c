@@ -0,0 +1,192 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <ctype.h>
+
+#include "core/pack/pack.h"
+#include "coding/coding_front.h"
+
+NG5_EXPORT(bool) pack_front_init(struct packer *self)
+{
+        self->extra = malloc(sizeof(struct coding_front));
+        if (self->extra != NULL) {
+                return coding_front_create((struct coding_front *) self->extra, NG5_FRONT_BLOCK_SIZE);
+        } else {
+                return false;
+        }
+}
+
+NG5_EXPORT(bool) pack_front_cpy(const struct packer *self, struct packer *dst)
+{
+        ng5_check_tag(self->tag, PACK_FRONT);
+
+        *dst = *self;
+        dst->extra = malloc(sizeof(struct coding_front));
+        if (dst->extra != NULL) {
+                return coding_front_cpy((struct coding_front *) dst->extra, (const struct coding_front *) self->extra);
+        } else {
+                return false;
+        }
+}
+
+NG5_EXPORT(bool) pack_front_drop(struct packer *self)
+{
+        ng5_check_tag(self->tag, PACK_FRONT);
+
+        coding_front_drop((struct coding_front *) self->extra);
+        free(self->extra);
+        self->extra = NULL;
+
+        return true;
+}
+
+NG5_EXPORT(bool) pack_front_write_extra(struct packer *self, struct memfile *dst,
+        const struct vector ofType (const char *) *strings)
+{
+        ng5_check_tag(self->tag, PACK_FRONT);
+
+        ng5_unused(strings);
+
+        const struct coding_front *coder = (const struct coding_front *) self->extra;
+        return memfile_write(dst, &coder->block_size, sizeof(u32));
+}
+
+NG5_EXPORT(bool) pack_front_read_extra(struct packer *self, FILE *src, size_t nbytes)
+{
+        ng5_check_tag(self->tag, PACK_FRONT);
+
+        struct coding_front *coder = (struct coding_front *) self->extra;
+        u32 block_size;
+
+        if (nbytes != sizeof(u32) || fread(&block_size, sizeof(u32), 1, src) != 1 || block_size == 0) {
+                error(&coder->err, NG5_ERR_CORRUPTED);
+                return false;
+        }
+        coder->block_size = block_size;
+        return true;
+}
+
+NG5_EXPORT(bool) pack_front_print_extra(struct packer *self, FILE *file, struct memfile *src)
+{
+        ng5_check_tag(self->tag, PACK_FRONT);
+
+        struct coding_front *coder = (struct coding_front *) self->extra;
+        offset_t offset = memfile_tell(src);
+
+        coder->block_size = *NG5_MEMFILE_READ_TYPE(src, u32);
+        fprintf(file, "0x%04x [block-size: %"PRIu32"]\n", (unsigned) offset, coder->block_size);
+
+        return true;
+}
+
+NG5_EXPORT(bool) pack_front_print_encoded(struct packer *self, FILE *file, struct memfile *src,
+        u32 decompressed_strlen)
+{
+        ng5_check_tag(self->tag, PACK_FRONT);
+
+        ng5_unused(self);
+        ng5_unused(decompressed_strlen);
+
+        u64 back, shared, suffix_len;
+        size_t remain = memfile_remain_size(src);
+        size_t header_len = coding_front_read_header(&back, &shared, &suffix_len, NG5_MEMFILE_PEEK(src, char),
+                ng5_min(remain, (size_t) NG5_FRONT_MAX_HEADER_SIZE));
+        if (!header_len || suffix_len > remain - header_len) {
+                return false;
+        }
+        memfile_skip(src, header_len);
+        const char *suffix = NG5_MEMFILE_READ(src, suffix_len);
+
+        fprintf(file, "[back: %"PRIu64"] [shared: %"PRIu64"] [suffix: '", back, shared);
+        for (u64 i = 0; i < suffix_len; i++) {
+                unsigned char c = suffix[i];
+                fprintf(file, isprint(c) && c != '\'' && c != '\\' ? "%c" : "\\x%02x", c);
+        }
+        fprintf(file, "']");
+
+        return true;
+}
+
+NG5_EXPORT(bool) pack_front_encode_string(struct packer *self, struct memfile *dst, struct err *err,
+        const char *string)
+{
+        ng5_check_tag(self->tag, PACK_FRONT);
+
+        struct coding_front *coder = (struct coding_front *) self->extra;
+        bool status = coding_front_encode(dst, coder, string);
+        if (!status) {
+                error_cpy(err, &coder->err);
+        }
+
+        return status;
+}
+
+NG5_EXPORT(bool) pack_front_decode_string(struct packer *self, char *dst, size_t strlen, FILE *src)
+{
+        ng5_check_tag(self->tag, PACK_FRONT);
+
+        ng5_unused(self);
+
+        char buffer[1024];
+        char *data = buffer;
+        size_t capacity = sizeof(buffer);
+        size_t nbytes = NG5_FRONT_MAX_HEADER_SIZE + strlen;
+        offset_t entry_off = ftell(src);
+        u64 back, shared, suffix_len;
+        bool status = false;
+
+        /** the first read covers the entry itself, which suffices for the first string of a block */
+        if (nbytes > capacity) {
+                if (!(data = malloc(nbytes))) {
+                        return false;
+                }
+                capacity = nbytes;
+        }
+        nbytes = fread(data, sizeof(char), nbytes, src);
+        size_t header_len = coding_front_read_header(&back, &shared, &suffix_len, data, nbytes);
+
+        if (header_len > 0 && back == 0) {
+                status = suffix_len == strlen && header_len + suffix_len <= nbytes;
+                if (status) {
+                        memcpy(dst, data + header_len, strlen);
+                }
+        } else if (header_len > 0 && back <= entry_off) {
+                /** otherwise the block is read from its first entry up to the requested one */
+                nbytes = back + NG5_FRONT_MAX_HEADER_SIZE + strlen;
+                if (nbytes > capacity) {
+                        char *block = data == buffer ? malloc(nbytes) : realloc(data, nbytes);
+                        if (!block) {
+                                goto cleanup;
+                        }
+                        data = block;
+                }
+                fseek(src, entry_off - back, SEEK_SET);
+                nbytes = fread(data, sizeof(char), nbytes, src);
+                status = coding_front_decode(dst, strlen, data, nbytes, back);
+        }
+
+cleanup:
+        if (data != buffer) {
+                free(data);
+        }
+        return status;
+}
+
+NG5_EXPORT(u32) pack_front_block_size(const struct packer *self)
+{
+        return self->tag == PACK_FRONT ? ((const struct coding_front *) self->extra)->block_size : 1;
+}
@@ -0,0 +1,185 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <ctype.h>
+
+#include "core/pack/pack.h"
+#include "coding/coding_fsst.h"
+
+NG5_EXPORT(bool) pack_fsst_init(struct packer *self)
+{
+        self->extra = malloc(sizeof(struct coding_fsst));
+        if (self->extra != NULL) {
+                return coding_fsst_create((struct coding_fsst *) self->extra);
+        } else {
+                return false;
+        }
+}
+
+NG5_EXPORT(bool) pack_fsst_cpy(const struct packer *self, struct packer *dst)
+{
+        ng5_check_tag(self->tag, PACK_FSST);
+
+        *dst = *self;
+        dst->extra = malloc(sizeof(struct coding_fsst));
+        if (dst->extra != NULL) {
+                return coding_fsst_cpy((struct coding_fsst *) dst->extra, (const struct coding_fsst *) self->extra);
+        } else {
+                return false;
+        }
+}
+
+NG5_EXPORT(bool) pack_fsst_drop(struct packer *self)
+{
+        ng5_check_tag(self->tag, PACK_FSST);
+
+        coding_fsst_drop((struct coding_fsst *) self->extra);
+        free(self->extra);
+        self->extra = NULL;
+
+        return true;
+}
+
+NG5_EXPORT(bool) pack_fsst_write_extra(struct packer *self, struct memfile *dst,
+        const struct vector ofType (const char *) *strings)
+{
+        ng5_check_tag(self->tag, PACK_FSST);
+
+        struct coding_fsst *encoder = (struct coding_fsst *) self->extra;
+
+        return coding_fsst_build(encoder, strings) && coding_fsst_serialize(dst, encoder);
+}
+
+NG5_EXPORT(bool) pack_fsst_read_extra(struct packer *self, FILE *src, size_t nbytes)
+{
+        ng5_check_tag(self->tag, PACK_FSST);
+
+        struct coding_fsst *decoder = (struct coding_fsst *) self->extra;
+        struct memblock *block;
+        struct memfile memfile;
+
+        if (!memblock_from_file(&block, src, nbytes)) {
+                error(&decoder->err, NG5_ERR_IO);
+                return false;
+        }
+        memfile_open(&memfile, block, READ_ONLY);
+        bool status = coding_fsst_read(decoder, &memfile);
+        memblock_drop(block);
+
+        return status;
+}
+
+static void print_symbol(FILE *file, u64 symbol, u8 len)
+{
+        const unsigned char *bytes = (const unsigned char *) &symbol;
+        for (u8 i = 0; i < len; i++) {
+                if (isprint(bytes[i]) && bytes[i] != '\'' && bytes[i] != '\\') {
+                        fprintf(file, "%c", bytes[i]);
+                } else {
+                        fprintf(file, "\\x%02x", bytes[i]);
+                }
+        }
+}
+
+NG5_EXPORT(bool) pack_fsst_print_extra(struct packer *self, FILE *file, struct memfile *src)
+{
+        ng5_check_tag(self->tag, PACK_FSST);
+
+        /** the symbol table is kept such that the encoded strings that follow can be printed */
+        struct coding_fsst *dic = (struct coding_fsst *) self->extra;
+        offset_t offset = memfile_tell(src);
+        if (!coding_fsst_read(dic, src)) {
+                return false;
+        }
+
+        fprintf(file, "0x%04x [num-symbols: %d]\n", (unsigned) offset, dic->num_symbols);
+        for (u16 code = 0; code < dic->num_symbols; code++) {
+                fprintf(file, "       [code: %d] [length: %d] [symbol: '", code, dic->lengths[code]);
+                print_symbol(file, dic->symbols[code], dic->lengths[code]);
+                fprintf(file, "']\n");
+        }
+
+        return true;
+}
+
+NG5_EXPORT(bool) pack_fsst_print_encoded(struct packer *self, FILE *file, struct memfile *src,
+        u32 decompressed_strlen)
+{
+        ng5_check_tag(self->tag, PACK_FSST);
+
+        const struct coding_fsst *dic = (const struct coding_fsst *) self->extra;
+
+        fprintf(file, "[codes: ");
+        for (u32 decoded = 0; decoded < decompressed_strlen && memfile_remain_size(src) > 0; ) {
+                unsigned char code = *NG5_MEMFILE_READ_TYPE(src, unsigned char);
+                if (code == NG5_FSST_ESCAPE && memfile_remain_size(src) > 0) {
+                        unsigned char literal = *NG5_MEMFILE_READ_TYPE(src, unsigned char);
+                        fprintf(file, "%s<esc>", decoded > 0 ? "," : "");
+                        print_symbol(file, literal, 1);
+                        decoded++;
+                } else if (dic->lengths[code] > 0) {
+                        fprintf(file, "%s%d", decoded > 0 ? "," : "", code);
+                        decoded += dic->lengths[code];
+                } else {
+                        break;
+                }
+        }
+        fprintf(file, "]");
+
+        return true;
+}
+
+NG5_EXPORT(bool) pack_fsst_encode_string(struct packer *self, struct memfile *dst, struct err *err,
+        const char *string)
+{
+        ng5_check_tag(self->tag, PACK_FSST);
+
+        struct coding_fsst *encoder = (struct coding_fsst *) self->extra;
+        bool status = coding_fsst_encode(dst, encoder, string);
+        if (!status) {
+                error_cpy(err, &encoder->err);
+        }
+
+        return status;
+}
+
+NG5_EXPORT(bool) pack_fsst_decode_string(struct packer *self, char *dst, size_t strlen, FILE *src)
+{
+        ng5_check_tag(self->tag, PACK_FSST);
+
+        const struct coding_fsst *decoder = (const struct coding_fsst *) self->extra;
+
+        /** the encoded length is not stored; it is at most twice the decoded length, when every byte is escaped */
+        char buffer[512];
+        char *encoded = 2 * strlen <= sizeof(buffer) ? buffer : malloc(2 * strlen);
+        if (!encoded) {
+                return false;
+        }
+
+        size_t nbytes_available = fread(encoded, sizeof(char), 2 * strlen, src);
+        size_t nbytes_read;
+        bool status = coding_fsst_decode(dst, strlen, &nbytes_read, decoder, encoded, nbytes_available);
+        if (status) {
+                /** leave the file positioned right after this string */
+                fseek(src, (long) nbytes_read - (long) nbytes_available, SEEK_CUR);
+        }
+
+        if (encoded != buffer) {
+                free(encoded);
+        }
+        return status;
+}
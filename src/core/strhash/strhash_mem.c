@@ -22,12 +22,13 @@
 #include "utils/time.h"
 #include "std/bloom.h"
 #include "stdx/slicelist.h"
-#include "hash/bern.h"
-
-#define HASHCODE_OF(key)      NG5_HASH_BERNSTEIN(strlen(key), key)
+#include "hash/hashcode.h"
 
 #define SMART_MAP_TAG "strhash-mem"
 
+/** number of keys for which bucket headers and slice data are prefetched before any of them is looked up */
+#define PREFETCH_BATCH_SIZE 16
+
 struct bucket {
         slice_list_t slice_list;
 };
@@ -44,29 +45,36 @@ static int this_put_fast_exact(struct strhash *self, const char *key, field_sid_
 static int this_get_safe(struct strhash *self, field_sid_t **out, bool **found_mask, size_t *num_not_found,
         char *const *keys, size_t num_keys);
 static int this_get_safe_exact(struct strhash *self, field_sid_t *out, bool *found_mask, const char *key);
+static int this_put_fast_exact_key(struct strhash *self, const struct string_key *key, field_sid_t value);
+static int this_get_safe_keys(struct strhash *self, field_sid_t **out, bool **found_mask, size_t *num_not_found,
+        const struct string_key *keys, size_t num_keys);
+static int this_get_safe_exact_key(struct strhash *self, field_sid_t *out, bool *found_mask,
+        const struct string_key *key);
 static int this_get_fast(struct strhash *self, field_sid_t **out, char *const *keys, size_t num_keys);
 static int this_update_key_fast(struct strhash *self, const field_sid_t *values, char *const *keys, size_t num_keys);
 static int this_remove(struct strhash *self, char *const *keys, size_t num_keys);
 static int this_free(struct strhash *self, void *ptr);
 
-static int this_insert_bulk(struct vector ofType(bucket) *buckets, char *const *restrict keys,
+static int this_insert_bulk(struct vector ofType(bucket) *buckets, const struct string_key *restrict keys,
         const field_sid_t *restrict values, size_t *restrict bucket_idxs, size_t num_pairs, struct allocator *alloc,
         struct strhash_counters *counter);
 
-static int this_insert_exact(struct vector ofType(bucket) *buckets, const char *restrict key, field_sid_t value,
-        size_t bucket_idx, struct allocator *alloc, struct strhash_counters *counter);
+static int this_insert_exact(struct vector ofType(bucket) *buckets, const struct string_key *restrict key,
+        field_sid_t value, size_t bucket_idx, struct allocator *alloc, struct strhash_counters *counter);
 static int this_fetch_bulk(struct vector ofType(bucket) *buckets, field_sid_t *values_out, bool *key_found_mask,
-        size_t *num_keys_not_found, size_t *bucket_idxs, char *const *keys, size_t num_keys, struct allocator *alloc,
-        struct strhash_counters *counter);
+        size_t *num_keys_not_found, size_t *bucket_idxs, const struct string_key *keys, size_t num_keys,
+        struct allocator *alloc, struct strhash_counters *counter);
 static int this_fetch_single(struct vector ofType(bucket) *buckets, field_sid_t *value_out, bool *key_found,
-        const size_t bucket_idx, const char *key, struct strhash_counters *counter);
+        const size_t bucket_idx, const struct string_key *key, struct strhash_counters *counter);
+
+static void batch_prefetch(struct bucket *data, const size_t *bucket_idxs, size_t num_keys);
 
 static int this_create_extra(struct strhash *self, size_t num_buckets, size_t cap_buckets);
 static struct mem_extra *this_get_exta(struct strhash *self);
 static int bucket_create(struct bucket *buckets, size_t num_buckets, size_t bucket_cap, struct allocator *alloc);
 static int bucket_drop(struct bucket *buckets, size_t num_buckets, struct allocator *alloc);
-static int bucket_insert(struct bucket *bucket, const char *restrict key, field_sid_t value, struct allocator *alloc,
-        struct strhash_counters *counter);
+static int bucket_insert(struct bucket *bucket, const struct string_key *restrict key, field_sid_t value,
+        struct allocator *alloc, struct strhash_counters *counter);
 
 bool strhash_create_inmemory(struct strhash *parallel_map_exec, const struct allocator *alloc, size_t num_buckets,
         size_t cap_buckets)
@@ -88,6 +96,9 @@ bool strhash_create_inmemory(struct strhash *parallel_map_exec, const struct all
         parallel_map_exec->remove = this_remove;
         parallel_map_exec->free = this_free;
         parallel_map_exec->get_exact_safe = this_get_safe_exact;
+        parallel_map_exec->put_exact_fast_key = this_put_fast_exact_key;
+        parallel_map_exec->get_bulk_safe_keys = this_get_safe_keys;
+        parallel_map_exec->get_exact_safe_key = this_get_safe_exact_key;
         error_init(&parallel_map_exec->err);
 
         strhash_reset_counters(parallel_map_exec);
@@ -111,39 +122,45 @@ static int this_put_safe_bulk(struct strhash *self, char *const *keys, const fie
         assert(self->tag == MEMORY_RESIDENT);
         struct mem_extra *extra = this_get_exta(self);
         size_t *bucket_idxs = alloc_malloc(&self->allocator, num_pairs * sizeof(size_t));
+        struct string_key *string_keys = alloc_malloc(&self->allocator, num_pairs * sizeof(struct string_key));
 
         prefetch_write(bucket_idxs);
 
         for (size_t i = 0; i < num_pairs; i++) {
-                const char *key = keys[i];
-                hash32_t hash = HASHCODE_OF(key);
-                bucket_idxs[i] = hash % extra->buckets.cap_elems;
+                string_keys[i] = string_key_of(keys[i]);
+                bucket_idxs[i] = string_keys[i].hash % extra->buckets.cap_elems;
         }
 
         prefetch_read(bucket_idxs);
-        prefetch_read(keys);
+        prefetch_read(string_keys);
         prefetch_read(values);
 
         ng5_check_success(this_insert_bulk(&extra->buckets,
-                keys,
+                string_keys,
                 values,
                 bucket_idxs,
                 num_pairs,
                 &self->allocator,
                 &self->counters));
         ng5_check_success(alloc_free(&self->allocator, bucket_idxs));
+        ng5_check_success(alloc_free(&self->allocator, string_keys));
         return true;
 }
 
 static int this_put_safe_exact(struct strhash *self, const char *key, field_sid_t value)
+{
+        struct string_key string_key = string_key_of(key);
+        return this_put_fast_exact_key(self, &string_key, value);
+}
+
+static int this_put_fast_exact_key(struct strhash *self, const struct string_key *key, field_sid_t value)
 {
         assert(self->tag == MEMORY_RESIDENT);
         struct mem_extra *extra = this_get_exta(self);
 
-        hash32_t hash = strcmp("", key) != 0 ? HASHCODE_OF(key) : 0;
-        size_t bucket_idx = hash % extra->buckets.cap_elems;
+        size_t bucket_idx = key->hash % extra->buckets.cap_elems;
 
-        prefetch_read(key);
+        prefetch_read(key->str);
 
         ng5_check_success(this_insert_exact(&extra->buckets,
                 key,
@@ -166,8 +183,8 @@ static int this_put_fast_bulk(struct strhash *self, char *const *keys, const fie
 }
 
 static int this_fetch_bulk(struct vector ofType(bucket) *buckets, field_sid_t *values_out, bool *key_found_mask,
-        size_t *num_keys_not_found, size_t *bucket_idxs, char *const *keys, size_t num_keys, struct allocator *alloc,
-        struct strhash_counters *counter)
+        size_t *num_keys_not_found, size_t *bucket_idxs, const struct string_key *keys, size_t num_keys,
+        struct allocator *alloc, struct strhash_counters *counter)
 {
         ng5_unused(counter);
         ng5_unused(alloc);
@@ -178,19 +195,23 @@ static int this_fetch_bulk(struct vector ofType(bucket) *buckets, field_sid_t *v
 
         prefetch_write(values_out);
 
-        for (size_t i = 0; i < num_keys; i++) {
-                struct bucket *bucket = data + bucket_idxs[i];
-                const char *key = keys[i];
-                if (likely(key != NULL)) {
-                        slice_list_lookup(&result_handle, &bucket->slice_list, key);
-                } else {
-                        result_handle.is_contained = true;
-                        result_handle.value = NG5_NULL_ENCODED_STRING;
+        for (size_t begin = 0; begin < num_keys; begin += PREFETCH_BATCH_SIZE) {
+                size_t end = ng5_min(num_keys, begin + PREFETCH_BATCH_SIZE);
+                batch_prefetch(data, bucket_idxs + begin, end - begin);
+
+                for (size_t i = begin; i < end; i++) {
+                        struct bucket *bucket = data + bucket_idxs[i];
+                        if (likely(keys[i].str != NULL)) {
+                                slice_list_lookup_key(&result_handle, &bucket->slice_list, keys + i);
+                        } else {
+                                result_handle.is_contained = true;
+                                result_handle.value = NG5_NULL_ENCODED_STRING;
+                        }
+
+                        num_not_found += result_handle.is_contained ? 0 : 1;
+                        key_found_mask[i] = result_handle.is_contained;
+                        values_out[i] = result_handle.is_contained ? result_handle.value : ((field_sid_t) -1);
                 }
-
-                num_not_found += result_handle.is_contained ? 0 : 1;
-                key_found_mask[i] = result_handle.is_contained;
-                values_out[i] = result_handle.is_contained ? result_handle.value : ((field_sid_t) -1);
         }
 
         *num_keys_not_found = num_not_found;
@@ -198,7 +219,7 @@ static int this_fetch_bulk(struct vector ofType(bucket) *buckets, field_sid_t *v
 }
 
 static int this_fetch_single(struct vector ofType(bucket) *buckets, field_sid_t *value_out, bool *key_found,
-        const size_t bucket_idx, const char *key, struct strhash_counters *counter)
+        const size_t bucket_idx, const struct string_key *key, struct strhash_counters *counter)
 {
         ng5_unused(counter);
 
@@ -211,7 +232,7 @@ static int this_fetch_single(struct vector ofType(bucket) *buckets, field_sid_t
         struct bucket *bucket = data + bucket_idx;
 
         /** Optimization 1/5: EMPTY GUARD (but before "find" call); if this bucket has no occupied slots, do not perform any lookup and comparison */
-        slice_list_lookup(&handle, &bucket->slice_list, key);
+        slice_list_lookup_key(&handle, &bucket->slice_list, key);
         *key_found = !SliceListIsEmpty(&bucket->slice_list) && handle.is_contained;
         *value_out = (*key_found) ? handle.value : ((field_sid_t) -1);
 
@@ -220,6 +241,16 @@ static int this_fetch_single(struct vector ofType(bucket) *buckets, field_sid_t
 
 static int this_get_safe(struct strhash *self, field_sid_t **out, bool **found_mask, size_t *num_not_found,
         char *const *keys, size_t num_keys)
+{
+        struct string_key *string_keys = alloc_malloc(&self->allocator, num_keys * sizeof(struct string_key));
+        string_keys_of(string_keys, keys, num_keys);
+        int status = this_get_safe_keys(self, out, found_mask, num_not_found, string_keys, num_keys);
+        ng5_check_success(alloc_free(&self->allocator, string_keys));
+        return status;
+}
+
+static int this_get_safe_keys(struct strhash *self, field_sid_t **out, bool **found_mask, size_t *num_not_found,
+        const struct string_key *keys, size_t num_keys)
 {
         assert(self->tag == MEMORY_RESIDENT);
 
@@ -243,10 +274,7 @@ static int this_get_safe(struct strhash *self, field_sid_t **out, bool **found_m
         assert(found_mask_out != NULL);
 
         for (register size_t i = 0; i < num_keys; i++) {
-                const char *key = keys[i];
-                hash32_t hash = key && strcmp("", key) != 0 ? HASHCODE_OF(key) : 0;
-                bucket_idxs[i] = hash % extra->buckets.cap_elems;
-                prefetch_read((struct bucket *) vec_data(&extra->buckets) + bucket_idxs[i]);
+                bucket_idxs[i] = keys[i].hash % extra->buckets.cap_elems;
         }
 
         ng5_trace(SMART_MAP_TAG, "'get_safe' function invoke fetch...for %zu strings", num_keys)
@@ -277,6 +305,13 @@ static int this_get_safe(struct strhash *self, field_sid_t **out, bool **found_m
 }
 
 static int this_get_safe_exact(struct strhash *self, field_sid_t *out, bool *found_mask, const char *key)
+{
+        struct string_key string_key = string_key_of(key);
+        return this_get_safe_exact_key(self, out, found_mask, &string_key);
+}
+
+static int this_get_safe_exact_key(struct strhash *self, field_sid_t *out, bool *found_mask,
+        const struct string_key *key)
 {
         assert(self->tag == MEMORY_RESIDENT);
 
@@ -289,8 +324,7 @@ static int this_get_safe_exact(struct strhash *self, field_sid_t *out, bool *fou
 
         struct mem_extra *extra = this_get_exta(self);
 
-        hash32_t hash = strcmp("", key) != 0 ? HASHCODE_OF(key) : 0;
-        size_t bucket_idx = hash % extra->buckets.cap_elems;
+        size_t bucket_idx = key->hash % extra->buckets.cap_elems;
         prefetch_read((struct bucket *) vec_data(&extra->buckets) + bucket_idx);
 
         ng5_check_success(this_fetch_single(&extra->buckets, out, found_mask, bucket_idx, key, &self->counters));
@@ -318,8 +352,8 @@ static int this_update_key_fast(struct strhash *self, const field_sid_t *values,
         return false;
 }
 
-static int simple_map_remove(struct mem_extra *extra, size_t *bucket_idxs, char *const *keys, size_t num_keys,
-        struct allocator *alloc, struct strhash_counters *counter)
+static int simple_map_remove(struct mem_extra *extra, size_t *bucket_idxs, const struct string_key *keys,
+        size_t num_keys, struct allocator *alloc, struct strhash_counters *counter)
 {
         ng5_unused(counter);
         ng5_unused(alloc);
@@ -329,10 +363,9 @@ static int simple_map_remove(struct mem_extra *extra, size_t *bucket_idxs, char
 
         for (register size_t i = 0; i < num_keys; i++) {
                 struct bucket *bucket = data + bucket_idxs[i];
-                const char *key = keys[i];
 
                 /** Optimization 1/5: EMPTY GUARD (but before "find" call); if this bucket has no occupied slots, do not perform any lookup and comparison */
-                slice_list_lookup(&handle, &bucket->slice_list, key);
+                slice_list_lookup_key(&handle, &bucket->slice_list, keys + i);
                 if (likely(handle.is_contained)) {
                         SliceListRemove(&bucket->slice_list, &handle);
                 }
@@ -346,14 +379,16 @@ static int this_remove(struct strhash *self, char *const *keys, size_t num_keys)
 
         struct mem_extra *extra = this_get_exta(self);
         size_t *bucket_idxs = alloc_malloc(&self->allocator, num_keys * sizeof(size_t));
+        struct string_key *string_keys = alloc_malloc(&self->allocator, num_keys * sizeof(struct string_key));
         for (register size_t i = 0; i < num_keys; i++) {
-                const char *key = keys[i];
-                hash32_t hash = HASHCODE_OF(key);
-                bucket_idxs[i] = hash % extra->buckets.cap_elems;
+                string_keys[i] = string_key_of(keys[i]);
+                bucket_idxs[i] = string_keys[i].hash % extra->buckets.cap_elems;
         }
 
-        ng5_check_success(simple_map_remove(extra, bucket_idxs, keys, num_keys, &self->allocator, &self->counters));
+        ng5_check_success(simple_map_remove(extra, bucket_idxs, string_keys, num_keys, &self->allocator,
+                &self->counters));
         ng5_check_success(alloc_free(&self->allocator, bucket_idxs));
+        ng5_check_success(alloc_free(&self->allocator, string_keys));
         return true;
 }
 
@@ -364,6 +399,24 @@ static int this_free(struct strhash *self, void *ptr)
         return true;
 }
 
+/**
+ * Group prefetching: the lookup of a single key is a chain of dependent cache misses (bucket header, then hash bounds
+ * and slices of that bucket). Instead of resolving keys one after another, all bucket headers of a batch are
+ * requested first, then all hash bounds and first slices (whose addresses are known from the headers by now), such that
+ * the misses of a batch are served in parallel before the first key of the batch is actually looked up.
+ */
+static void batch_prefetch(struct bucket *data, const size_t *bucket_idxs, size_t num_keys)
+{
+        for (size_t i = 0; i < num_keys; i++) {
+                prefetch_read(data + bucket_idxs[i]);
+        }
+        for (size_t i = 0; i < num_keys; i++) {
+                slice_list_t *list = &data[bucket_idxs[i]].slice_list;
+                prefetch_read(list->bounds.base);
+                prefetch_read(list->slices.base);
+        }
+}
+
 ng5_func_unused
 static int this_create_extra(struct strhash *self, size_t num_buckets, size_t cap_buckets)
 {
@@ -417,19 +470,19 @@ static int bucket_drop(struct bucket *buckets, size_t num_buckets, struct alloca
         return true;
 }
 
-static int bucket_insert(struct bucket *bucket, const char *restrict key, field_sid_t value, struct allocator *alloc,
-        struct strhash_counters *counter)
+static int bucket_insert(struct bucket *bucket, const struct string_key *restrict key, field_sid_t value,
+        struct allocator *alloc, struct strhash_counters *counter)
 {
         ng5_unused(counter);
         ng5_unused(alloc);
 
         error_if_null(bucket);
-        error_if_null(key);
+        error_if_null(key->str);
 
         slice_handle_t handle;
 
         /** Optimization 1/5: EMPTY GUARD (but before "find" call); if this bucket has no occupied slots, do not perform any lookup and comparison */
-        slice_list_lookup(&handle, &bucket->slice_list, key);
+        slice_list_lookup_key(&handle, &bucket->slice_list, key);
 
         if (handle.is_contained) {
                 /** entry found by keys */
@@ -438,13 +491,13 @@ static int bucket_insert(struct bucket *bucket, const char *restrict key, field_
         } else {
                 /** no entry found */
                 //debug(SMART_MAP_TAG, "*** put *** '%s' into bucket [new]", keys);
-                slice_list_insert(&bucket->slice_list, (char **) &key, &value, 1);
+                slice_list_insert_keys(&bucket->slice_list, key, &value, 1);
         }
 
         return true;
 }
 
-static int this_insert_bulk(struct vector ofType(bucket) *buckets, char *const *restrict keys,
+static int this_insert_bulk(struct vector ofType(bucket) *buckets, const struct string_key *restrict keys,
         const field_sid_t *restrict values, size_t *restrict bucket_idxs, size_t num_pairs, struct allocator *alloc,
         struct strhash_counters *counter)
 {
@@ -455,20 +508,24 @@ static int this_insert_bulk(struct vector ofType(bucket) *buckets, char *const *
 
         struct bucket *buckets_data = (struct bucket *) vec_data(buckets);
         int status = true;
-        for (register size_t i = 0; status == true && i < num_pairs; i++) {
-                size_t bucket_idx = bucket_idxs[i];
-                const char *key = keys[i];
-                field_sid_t value = values[i];
+        for (size_t begin = 0; status == true && begin < num_pairs; begin += PREFETCH_BATCH_SIZE) {
+                size_t end = ng5_min(num_pairs, begin + PREFETCH_BATCH_SIZE);
+                batch_prefetch(buckets_data, bucket_idxs + begin, end - begin);
 
-                struct bucket *bucket = buckets_data + bucket_idx;
-                status = bucket_insert(bucket, key, value, alloc, counter);
+                for (register size_t i = begin; status == true && i < end; i++) {
+                        size_t bucket_idx = bucket_idxs[i];
+                        field_sid_t value = values[i];
+
+                        struct bucket *bucket = buckets_data + bucket_idx;
+                        status = bucket_insert(bucket, keys + i, value, alloc, counter);
+                }
         }
 
         return status;
 }
 
-static int this_insert_exact(struct vector ofType(bucket) *buckets, const char *restrict key, field_sid_t value,
-        size_t bucket_idx, struct allocator *alloc, struct strhash_counters *counter)
+static int this_insert_exact(struct vector ofType(bucket) *buckets, const struct string_key *restrict key,
+        field_sid_t value, size_t bucket_idx, struct allocator *alloc, struct strhash_counters *counter)
 {
         error_if_null(buckets)
         error_if_null(key)
@@ -0,0 +1,493 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "core/strhash/strhash_swiss.h"
+#include "hash/hashcode.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define STRHASH_SWISS_HAS_SSE2
+#endif
+
+#define SWISS_GROUP_SIZE        16
+#define SWISS_CTRL_EMPTY        ((u8) 0x80)
+#define SWISS_CTRL_DELETED      ((u8) 0xFE)
+#define SWISS_MAX_LOAD_NUM      7
+#define SWISS_MAX_LOAD_DENOM    8
+#define SWISS_BATCH_SIZE        16      /* keys hashed and prefetched together before any of them is probed */
+
+#define HASHCODE_OF(key, key_len)       swiss_mix(NG5_HASHCODE_OF(key_len, key))
+#define HASHCODE_OF_KEY(string_key)     swiss_mix((string_key)->hash)
+#define SWISS_H1(hash)                  ((hash) >> 7)
+#define SWISS_H2(hash)                  ((u8) ((hash) & 0x7F))
+
+struct swiss_slot {
+        hash32_t hash;
+        u32 key_len;
+        const char *key;
+        field_sid_t value;
+};
+
+struct swiss_extra {
+        u8 *ctrl;                       /* one control byte per slot, 'num_groups * SWISS_GROUP_SIZE' in total */
+        struct swiss_slot *slots;
+        size_t num_groups;              /* power of two */
+        size_t num_used;
+        size_t num_deleted;
+};
+
+static int this_drop(struct strhash *self);
+static int this_put_safe_bulk(struct strhash *self, char *const *keys, const field_sid_t *values, size_t num_pairs);
+static int this_put_fast_bulk(struct strhash *self, char *const *keys, const field_sid_t *values, size_t num_pairs);
+static int this_put_safe_exact(struct strhash *self, const char *key, field_sid_t value);
+static int this_put_fast_exact(struct strhash *self, const char *key, field_sid_t value);
+static int this_get_safe(struct strhash *self, field_sid_t **out, bool **found_mask, size_t *num_not_found,
+        char *const *keys, size_t num_keys);
+static int this_get_safe_exact(struct strhash *self, field_sid_t *out, bool *found_mask, const char *key);
+static int this_put_fast_exact_key(struct strhash *self, const struct string_key *key, field_sid_t value);
+static int this_get_safe_keys(struct strhash *self, field_sid_t **out, bool **found_mask, size_t *num_not_found,
+        const struct string_key *keys, size_t num_keys);
+static int this_get_safe_exact_key(struct strhash *self, field_sid_t *out, bool *found_mask,
+        const struct string_key *key);
+static int this_get_fast(struct strhash *self, field_sid_t **out, char *const *keys, size_t num_keys);
+static int this_update_key_fast(struct strhash *self, const field_sid_t *values, char *const *keys, size_t num_keys);
+static int this_remove(struct strhash *self, char *const *keys, size_t num_keys);
+static int this_free(struct strhash *self, void *ptr);
+
+static bool table_create(struct swiss_extra *extra, struct allocator *alloc, size_t num_groups);
+static bool table_grow(struct swiss_extra *extra, struct allocator *alloc);
+static struct swiss_slot *table_find(struct swiss_extra *extra, const char *key, u32 key_len, hash32_t hash);
+static bool table_insert(struct strhash *self, const char *key, u32 key_len, hash32_t hash, field_sid_t value,
+        bool check_exists);
+static void batch_prefetch(const struct swiss_extra *extra, const struct string_key *keys, size_t num_keys);
+static size_t batch_find(struct swiss_extra *extra, field_sid_t *values_out, bool *found_mask_out,
+        const struct string_key *keys, size_t num_keys);
+
+bool strhash_create_swiss(struct strhash *map, const struct allocator *alloc, size_t capacity)
+{
+        error_if_null(map);
+        ng5_check_success(alloc_this_or_std(&map->allocator, alloc));
+
+        map->tag = MEMORY_RESIDENT_SWISS;
+        map->drop = this_drop;
+        map->put_bulk_safe = this_put_safe_bulk;
+        map->put_bulk_fast = this_put_fast_bulk;
+        map->put_exact_safe = this_put_safe_exact;
+        map->put_exact_fast = this_put_fast_exact;
+        map->get_bulk_safe = this_get_safe;
+        map->get_fast = this_get_fast;
+        map->update_key_fast = this_update_key_fast;
+        map->remove = this_remove;
+        map->free = this_free;
+        map->get_exact_safe = this_get_safe_exact;
+        map->put_exact_fast_key = this_put_fast_exact_key;
+        map->get_bulk_safe_keys = this_get_safe_keys;
+        map->get_exact_safe_key = this_get_safe_exact_key;
+        error_init(&map->err);
+        strhash_reset_counters(map);
+
+        size_t num_groups = 1;
+        while (num_groups * SWISS_GROUP_SIZE * SWISS_MAX_LOAD_NUM / SWISS_MAX_LOAD_DENOM < capacity) {
+                num_groups <<= 1;
+        }
+
+        if ((map->extra = alloc_malloc(&map->allocator, sizeof(struct swiss_extra))) == NULL) {
+                error(&map->err, NG5_ERR_MALLOCERR);
+                return false;
+        }
+        if (!table_create(map->extra, &map->allocator, num_groups)) {
+                alloc_free(&map->allocator, map->extra);
+                error(&map->err, NG5_ERR_MALLOCERR);
+                return false;
+        }
+        return true;
+}
+
+static inline hash32_t swiss_mix(hash32_t hash)
+{
+        /* the classic hashes selectable for NG5_HASHCODE_OF leave the high bits poorly mixed for short keys, but both
+         * H1 and H2 must be well distributed */
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6b;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35;
+        hash ^= hash >> 16;
+        return hash;
+}
+
+static inline struct swiss_extra *this_extra(struct strhash *self)
+{
+        assert(self->tag == MEMORY_RESIDENT_SWISS);
+        return (struct swiss_extra *) self->extra;
+}
+
+/** bitmask of slots in the group at 'ctrl' whose control byte equals 'value' */
+static inline u32 group_match(const u8 *ctrl, u8 value)
+{
+#ifdef STRHASH_SWISS_HAS_SSE2
+        __m128i group = _mm_loadu_si128((const __m128i *) ctrl);
+        return (u32) _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char) value)));
+#else
+        u32 mask = 0;
+        for (u32 i = 0; i < SWISS_GROUP_SIZE; i++) {
+                mask |= (u32) (ctrl[i] == value) << i;
+        }
+        return mask;
+#endif
+}
+
+/** bitmask of slots in the group at 'ctrl' that are empty or deleted (i.e., have the high bit set) */
+static inline u32 group_match_free(const u8 *ctrl)
+{
+#ifdef STRHASH_SWISS_HAS_SSE2
+        return (u32) _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) ctrl));
+#else
+        u32 mask = 0;
+        for (u32 i = 0; i < SWISS_GROUP_SIZE; i++) {
+                mask |= (u32) (ctrl[i] >> 7) << i;
+        }
+        return mask;
+#endif
+}
+
+static int this_drop(struct strhash *self)
+{
+        struct swiss_extra *extra = this_extra(self);
+        alloc_free(&self->allocator, extra->ctrl);
+        alloc_free(&self->allocator, extra->slots);
+        alloc_free(&self->allocator, extra);
+        return true;
+}
+
+static int put_bulk(struct strhash *self, char *const *keys, const field_sid_t *values, size_t num_pairs,
+        bool check_exists)
+{
+        struct swiss_extra *extra = this_extra(self);
+        struct string_key batch[SWISS_BATCH_SIZE];
+
+        for (size_t begin = 0; begin < num_pairs; begin += SWISS_BATCH_SIZE) {
+                size_t batch_size = ng5_min(num_pairs - begin, SWISS_BATCH_SIZE);
+                string_keys_of(batch, keys + begin, batch_size);
+                /* a table growth within this batch only turns some of the prefetches into useless hints */
+                batch_prefetch(extra, batch, batch_size);
+                for (size_t i = 0; i < batch_size; i++) {
+                        if (unlikely(!table_insert(self, batch[i].str, batch[i].len, HASHCODE_OF_KEY(batch + i),
+                                values[begin + i], check_exists))) {
+                                return false;
+                        }
+                }
+        }
+        return true;
+}
+
+static int this_put_safe_bulk(struct strhash *self, char *const *keys, const field_sid_t *values, size_t num_pairs)
+{
+        return put_bulk(self, keys, values, num_pairs, true);
+}
+
+static int this_put_fast_bulk(struct strhash *self, char *const *keys, const field_sid_t *values, size_t num_pairs)
+{
+        return put_bulk(self, keys, values, num_pairs, false);
+}
+
+static int this_put_safe_exact(struct strhash *self, const char *key, field_sid_t value)
+{
+        error_if_null(key);
+        u32 key_len = strlen(key);
+        return table_insert(self, key, key_len, HASHCODE_OF(key, key_len), value, true);
+}
+
+static int this_put_fast_exact(struct strhash *self, const char *key, field_sid_t value)
+{
+        error_if_null(key);
+        u32 key_len = strlen(key);
+        return table_insert(self, key, key_len, HASHCODE_OF(key, key_len), value, false);
+}
+
+static int get_safe(struct strhash *self, field_sid_t **out, bool **found_mask, size_t *num_not_found,
+        char *const *strings, const struct string_key *keys, size_t num_keys)
+{
+        struct swiss_extra *extra = this_extra(self);
+        field_sid_t *values_out = alloc_malloc(&self->allocator, num_keys * sizeof(field_sid_t));
+        bool *found_mask_out = alloc_malloc(&self->allocator, num_keys * sizeof(bool));
+        size_t num_misses = 0;
+
+        struct string_key batch[SWISS_BATCH_SIZE];
+
+        error_if(values_out == NULL || found_mask_out == NULL, &self->err, NG5_ERR_MALLOCERR);
+
+        /* group prefetching: all keys of a batch are hashed and their first probe group is requested from memory,
+         * before the first key of that batch is probed, such that cache misses of a batch overlap; keys given as
+         * plain strings are hashed batch-wise, keys given as string keys are hashed already */
+        for (size_t begin = 0; begin < num_keys; begin += SWISS_BATCH_SIZE) {
+                size_t batch_size = ng5_min(num_keys - begin, SWISS_BATCH_SIZE);
+                const struct string_key *batch_keys = keys ? keys + begin : batch;
+                if (!keys) {
+                        string_keys_of(batch, strings + begin, batch_size);
+                }
+                num_misses += batch_find(extra, values_out + begin, found_mask_out + begin, batch_keys, batch_size);
+        }
+
+        self->counters.num_bucket_search_hit += num_keys - num_misses;
+        self->counters.num_bucket_search_miss += num_misses;
+
+        *out = values_out;
+        *found_mask = found_mask_out;
+        *num_not_found = num_misses;
+        return true;
+}
+
+static int this_get_safe(struct strhash *self, field_sid_t **out, bool **found_mask, size_t *num_not_found,
+        char *const *keys, size_t num_keys)
+{
+        return get_safe(self, out, found_mask, num_not_found, keys, NULL, num_keys);
+}
+
+static int this_get_safe_keys(struct strhash *self, field_sid_t **out, bool **found_mask, size_t *num_not_found,
+        const struct string_key *keys, size_t num_keys)
+{
+        return get_safe(self, out, found_mask, num_not_found, NULL, keys, num_keys);
+}
+
+static int this_get_safe_exact(struct strhash *self, field_sid_t *out, bool *found_mask, const char *key)
+{
+        struct string_key string_key = string_key_of(key);
+        return this_get_safe_exact_key(self, out, found_mask, &string_key);
+}
+
+static int this_get_safe_exact_key(struct strhash *self, field_sid_t *out, bool *found_mask,
+        const struct string_key *key)
+{
+        struct swiss_extra *extra = this_extra(self);
+        struct swiss_slot *slot = table_find(extra, key->str, key->len, HASHCODE_OF_KEY(key));
+        *found_mask = slot != NULL;
+        *out = slot ? slot->value : ((field_sid_t) -1);
+        if (slot) {
+                self->counters.num_bucket_search_hit++;
+        } else {
+                self->counters.num_bucket_search_miss++;
+        }
+        return true;
+}
+
+static int this_put_fast_exact_key(struct strhash *self, const struct string_key *key, field_sid_t value)
+{
+        error_if_null(key->str);
+        return table_insert(self, key->str, key->len, HASHCODE_OF_KEY(key), value, false);
+}
+
+static int this_get_fast(struct strhash *self, field_sid_t **out, char *const *keys, size_t num_keys)
+{
+        bool *found_mask;
+        size_t num_not_found;
+        int status = this_get_safe(self, out, &found_mask, &num_not_found, keys, num_keys);
+        this_free(self, found_mask);
+        return status;
+}
+
+static int this_update_key_fast(struct strhash *self, const field_sid_t *values, char *const *keys, size_t num_keys)
+{
+        ng5_unused(values);
+        ng5_unused(keys);
+        ng5_unused(num_keys);
+        error(&self->err, NG5_ERR_NOTIMPL);
+        error_print_to_stderr(&self->err);
+        return false;
+}
+
+static int this_remove(struct strhash *self, char *const *keys, size_t num_keys)
+{
+        struct swiss_extra *extra = this_extra(self);
+        for (size_t i = 0; i < num_keys; i++) {
+                const char *key = keys[i];
+                u32 key_len = strlen(key);
+                struct swiss_slot *slot = table_find(extra, key, key_len, HASHCODE_OF(key, key_len));
+                if (likely(slot != NULL)) {
+                        size_t pos = slot - extra->slots;
+                        size_t group_begin = pos & ~((size_t) SWISS_GROUP_SIZE - 1);
+                        /* a slot in a group that never was full can be marked empty again, since no probe sequence
+                         * continued beyond this group */
+                        bool group_had_empty = group_match(extra->ctrl + group_begin, SWISS_CTRL_EMPTY) != 0;
+                        extra->ctrl[pos] = group_had_empty ? SWISS_CTRL_EMPTY : SWISS_CTRL_DELETED;
+                        extra->num_deleted += group_had_empty ? 0 : 1;
+                        extra->num_used--;
+                }
+        }
+        return true;
+}
+
+static int this_free(struct strhash *self, void *ptr)
+{
+        ng5_check_success(alloc_free(&self->allocator, ptr));
+        return true;
+}
+
+static bool table_create(struct swiss_extra *extra, struct allocator *alloc, size_t num_groups)
+{
+        size_t num_slots = num_groups * SWISS_GROUP_SIZE;
+        extra->ctrl = alloc_malloc(alloc, num_slots);
+        extra->slots = alloc_malloc(alloc, num_slots * sizeof(struct swiss_slot));
+        if (unlikely(!extra->ctrl || !extra->slots)) {
+                if (extra->ctrl) {
+                        alloc_free(alloc, extra->ctrl);
+                }
+                if (extra->slots) {
+                        alloc_free(alloc, extra->slots);
+                }
+                return false;
+        }
+        memset(extra->ctrl, SWISS_CTRL_EMPTY, num_slots);
+        extra->num_groups = num_groups;
+        extra->num_used = 0;
+        extra->num_deleted = 0;
+        return true;
+}
+
+/** returns the position of a free slot in the probe sequence of 'hash' (the table must not be full) */
+static inline size_t table_find_free(const struct swiss_extra *extra, hash32_t hash)
+{
+        size_t group_mask = extra->num_groups - 1;
+        size_t group = SWISS_H1(hash) & group_mask;
+        for (size_t step = 1; ; step++) {
+                u32 free_mask = group_match_free(extra->ctrl + group * SWISS_GROUP_SIZE);
+                if (free_mask) {
+                        return group * SWISS_GROUP_SIZE + __builtin_ctz(free_mask);
+                }
+                /* triangular probing visits every group once for power-of-two group counts */
+                group = (group + step) & group_mask;
+        }
+}
+
+static bool table_grow(struct swiss_extra *extra, struct allocator *alloc)
+{
+        struct swiss_extra table;
+
+        /* rehash in place if most of the load are tombstones, otherwise double the table; the table in 'extra' is
+         * replaced only once the new one is complete, such that it stays intact if an allocation fails */
+        size_t num_groups = extra->num_used * 2 < extra->num_groups * SWISS_GROUP_SIZE * SWISS_MAX_LOAD_NUM /
+                SWISS_MAX_LOAD_DENOM ? extra->num_groups : extra->num_groups * 2;
+        if (unlikely(!table_create(&table, alloc, num_groups))) {
+                return false;
+        }
+
+        for (size_t i = 0; i < extra->num_groups * SWISS_GROUP_SIZE; i++) {
+                if (!(extra->ctrl[i] & 0x80)) {
+                        struct swiss_slot *slot = extra->slots + i;
+                        size_t pos = table_find_free(&table, slot->hash);
+                        table.ctrl[pos] = SWISS_H2(slot->hash);
+                        table.slots[pos] = *slot;
+                        table.num_used++;
+                }
+        }
+
+        alloc_free(alloc, extra->ctrl);
+        alloc_free(alloc, extra->slots);
+        *extra = table;
+        return true;
+}
+
+static struct swiss_slot *table_find(struct swiss_extra *extra, const char *key, u32 key_len, hash32_t hash)
+{
+        size_t group_mask = extra->num_groups - 1;
+        size_t group = SWISS_H1(hash) & group_mask;
+        u8 h2 = SWISS_H2(hash);
+
+        for (size_t step = 1; step <= extra->num_groups; step++) {
+                const u8 *ctrl = extra->ctrl + group * SWISS_GROUP_SIZE;
+                struct swiss_slot *slots = extra->slots + group * SWISS_GROUP_SIZE;
+                prefetch_read(slots);
+                for (u32 match = group_match(ctrl, h2); match; match &= match - 1) {
+                        struct swiss_slot *slot = slots + __builtin_ctz(match);
+                        if (likely(slot->hash == hash && slot->key_len == key_len &&
+                                memcmp(slot->key, key, key_len) == 0)) {
+                                return slot;
+                        }
+                }
+                if (likely(group_match(ctrl, SWISS_CTRL_EMPTY) != 0)) {
+                        return NULL;
+                }
+                group = (group + step) & group_mask;
+        }
+        return NULL;
+}
+
+static void batch_prefetch(const struct swiss_extra *extra, const struct string_key *keys, size_t num_keys)
+{
+        size_t group_mask = extra->num_groups - 1;
+        for (size_t i = 0; i < num_keys; i++) {
+                size_t first_slot = (SWISS_H1(HASHCODE_OF_KEY(keys + i)) & group_mask) * SWISS_GROUP_SIZE;
+                prefetch_read(extra->ctrl + first_slot);
+                prefetch_read(extra->slots + first_slot);
+        }
+}
+
+/** looks up a batch of keys after prefetching their first probe groups; returns the number of keys not found */
+static size_t batch_find(struct swiss_extra *extra, field_sid_t *values_out, bool *found_mask_out,
+        const struct string_key *keys, size_t num_keys)
+{
+        size_t num_misses = 0;
+        batch_prefetch(extra, keys, num_keys);
+        for (size_t i = 0; i < num_keys; i++) {
+                const struct string_key *key = keys + i;
+                if (unlikely(key->str == NULL)) {
+                        found_mask_out[i] = true;
+                        values_out[i] = NG5_NULL_ENCODED_STRING;
+                        continue;
+                }
+                struct swiss_slot *slot = table_find(extra, key->str, key->len, HASHCODE_OF_KEY(key));
+                found_mask_out[i] = slot != NULL;
+                values_out[i] = slot ? slot->value : ((field_sid_t) -1);
+                num_misses += slot ? 0 : 1;
+        }
+        return num_misses;
+}
+
+static bool table_insert(struct strhash *self, const char *key, u32 key_len, hash32_t hash, field_sid_t value,
+        bool check_exists)
+{
+        error_if_null(key);
+
+        struct swiss_extra *extra = this_extra(self);
+
+        if (check_exists) {
+                struct swiss_slot *slot = table_find(extra, key, key_len, hash);
+                if (slot) {
+                        slot->value = value;
+                        return true;
+                }
+        }
+
+        if (unlikely((extra->num_used + extra->num_deleted + 1) * SWISS_MAX_LOAD_DENOM >
+                extra->num_groups * SWISS_GROUP_SIZE * SWISS_MAX_LOAD_NUM)) {
+                if (!table_grow(extra, &self->allocator)) {
+                        error(&self->err, NG5_ERR_MALLOCERR);
+                        return false;
+                }
+        }
+
+        size_t pos = table_find_free(extra, hash);
+        extra->num_deleted -= extra->ctrl[pos] == SWISS_CTRL_DELETED ? 1 : 0;
+        extra->ctrl[pos] = SWISS_H2(hash);
+        extra->slots[pos] = (struct swiss_slot) {
+                .hash = hash,
+                .key_len = key_len,
+                .key = key,
+                .value = value
+        };
+        extra->num_used++;
+        return true;
+}
@@ -0,0 +1,78 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NG5_CODING_FRONT_H
+#define NG5_CODING_FRONT_H
+
+#include "shared/common.h"
+#include "std/vec.h"
+#include "core/mem/file.h"
+#include "shared/types.h"
+
+NG5_BEGIN_DECL
+
+/** number of strings per block; the first string of a block is stored in full */
+#define NG5_FRONT_BLOCK_SIZE            16
+
+/** upper bound of the size of an entry header (three varints) */
+#define NG5_FRONT_MAX_HEADER_SIZE       30
+
+/**
+ * Front coding. Strings are grouped into blocks of <code>block_size</code> consecutive strings. The first string of a
+ * block is stored in full; each other string stores the length of the prefix it shares with its predecessor and the
+ * remaining suffix. Each entry starts with the distance in bytes back to the first entry of its block, so that a
+ * string is decoded from its block alone. Front coding pays off if strings are encoded in lexicographic order.
+ *
+ * An entry is <code>varint back, [varint shared,] varint suffix_len, suffix</code>, where <code>back</code> is 0
+ * for the first entry of a block, which has no <code>shared</code> field.
+ */
+struct coding_front {
+        u32 block_size;
+        /** the previously encoded string */
+        char *prev;
+        size_t prev_len;
+        size_t prev_cap;
+        u64 num_encoded;
+        offset_t block_begin;
+        struct err err;
+};
+
+NG5_EXPORT(bool) coding_front_create(struct coding_front *coder, u32 block_size);
+
+NG5_EXPORT(bool) coding_front_cpy(struct coding_front *dst, const struct coding_front *src);
+
+NG5_EXPORT(bool) coding_front_drop(struct coding_front *coder);
+
+NG5_EXPORT(bool) coding_front_encode(struct memfile *file, struct coding_front *coder, const char *string);
+
+/**
+ * Reads the header of the entry at <code>entry</code>, with at most <code>nbytes</code> readable bytes. Returns the
+ * length of the header, or 0 if it is malformed.
+ */
+NG5_EXPORT(size_t) coding_front_read_header(u64 *back, u64 *shared, u64 *suffix_len, const char *entry,
+        size_t nbytes);
+
+/**
+ * Decodes the string stored in the entry at offset <code>entry_off</code> of <code>block</code>, which starts with
+ * the first entry of that block and holds <code>nbytes</code> bytes, into <code>dst</code> of length <code>
+ * strlen</code>.
+ */
+NG5_EXPORT(bool) coding_front_decode(char *dst, size_t strlen, const char *block, size_t nbytes, size_t entry_off);
+
+NG5_END_DECL
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NG5_CODING_FSST_H
+#define NG5_CODING_FSST_H
+
+#include <limits.h>
+
+#include "shared/common.h"
+#include "std/vec.h"
+#include "core/mem/file.h"
+#include "shared/types.h"
+
+NG5_BEGIN_DECL
+
+/** code that is followed by a single literal byte not covered by the symbol table */
+#define NG5_FSST_ESCAPE                 255
+
+/** maximum number of symbols; all codes but the escape code */
+#define NG5_FSST_MAX_SYMBOLS            255
+
+/** maximum length of a symbol in bytes; a symbol is held in a single 64-bit word */
+#define NG5_FSST_MAX_SYMBOL_LENGTH      8
+
+/** maximum number of bytes taken from the input strings to learn the symbol table */
+#define NG5_FSST_SAMPLE_SIZE            (16 * 1024)
+
+/** number of rounds in which the symbol table is refined on the sample */
+#define NG5_FSST_GENERATIONS            5
+
+/**
+ * Static symbol table compression (FSST). A table of up to 255 symbols of 1 to 8 bytes each is learned from a sample
+ * of the input strings. A string is encoded as a sequence of one-byte codes, each standing for a symbol, or the escape
+ * code followed by a literal byte. Since the table is static, each string is decoded on its own by table lookups.
+ */
+struct coding_fsst {
+        /** symbol bytes for each code, in memory order and zero-padded to 8 bytes */
+        u64 symbols[UCHAR_MAX + 1];
+        u8 lengths[UCHAR_MAX + 1];
+        u16 num_symbols;
+        /** codes are ordered by (first byte, decreasing length); symbols starting with byte 'c' have the codes
+         * 'first_code[c]' up to (excluding) 'first_code[c + 1]' */
+        u16 first_code[UCHAR_MAX + 2];
+        struct err err;
+};
+
+NG5_EXPORT(bool) coding_fsst_create(struct coding_fsst *dic);
+
+NG5_EXPORT(bool) coding_fsst_cpy(struct coding_fsst *dst, const struct coding_fsst *src);
+
+NG5_EXPORT(bool) coding_fsst_drop(struct coding_fsst *dic);
+
+/**
+ * Learns the symbol table from a sample of <code>strings</code>
+ */
+NG5_EXPORT(bool) coding_fsst_build(struct coding_fsst *dic, const string_vector_t *strings);
+
+NG5_EXPORT(bool) coding_fsst_serialize(struct memfile *file, const struct coding_fsst *dic);
+
+NG5_EXPORT(bool) coding_fsst_read(struct coding_fsst *dic, struct memfile *file);
+
+NG5_EXPORT(bool) coding_fsst_encode(struct memfile *file, struct coding_fsst *dic, const char *string);
+
+/**
+ * Decodes <code>strlen</code> bytes into <code>dst</code> from the codes at <code>encoded</code>, which holds at
+ * most <code>nbytes_encoded</code> bytes. On success, the number of bytes consumed is returned in <code>nbytes_read
+ * </code>.
+ */
+NG5_EXPORT(bool) coding_fsst_decode(char *dst, size_t strlen, size_t *nbytes_read, const struct coding_fsst *dic,
+        const char *encoded, size_t nbytes_encoded);
+
+NG5_END_DECL
+
+#endif
@@ -18,6 +18,8 @@
 #ifndef NG5_HUFFMAN_H
 #define NG5_HUFFMAN_H
 
+#include <limits.h>
+
 #include "shared/common.h"
 #include "std/vec.h"
 #include "core/mem/file.h"
@@ -25,21 +27,47 @@
 
 NG5_BEGIN_DECL
 
+/** number of code bits resolved by a single lookup in the decoding table */
+#define NG5_HUFFMAN_TABLE_BITS                  11
+
+/** maximum number of symbols a single lookup in the decoding table may decode */
+#define NG5_HUFFMAN_SYMBOLS_PER_LOOKUP          5
+
+/** maximum length of a code; bounded by the depth of a Huffman tree over 32-bit letter frequencies */
+#define NG5_HUFFMAN_MAX_CODE_LENGTH             64
+
+struct pack_huffman_decoder;
+
+struct pack_huffman_code {
+        /** the code in the order its bits are written, i.e., reversed and right-aligned */
+        u64 stream_bits;
+        /** code length, or 0 for letters that do not occur */
+        u8 nbits;
+};
+
+/**
+ * Canonical Huffman code over bytes. Codes are assigned in order of (code length, letter), so that the letters and
+ * their code lengths suffice to restore the code. Encoded bits are stored least-significant bit first per byte, and
+ * each code is stored starting with its most-significant bit.
+ */
 struct coding_huffman {
         struct vector ofType(struct pack_huffman_entry) table;
+        /** the entries of 'table' indexed by letter, used for encoding */
+        struct pack_huffman_code codes[UCHAR_MAX + 1];
+        /** decoding tables, built when the code is read back by <code>coding_huffman_read_dictionary</code> */
+        struct pack_huffman_decoder *decoder;
         struct err err;
 };
 
 struct pack_huffman_entry {
         unsigned char letter;
-        u32 *blocks;
-        u16 nblocks;
+        u8 nbits;
+        u64 code;
 };
 
 struct pack_huffman_info {
         unsigned char letter;
-        u8 nbytes_prefix;
-        char *prefix_code;
+        u8 nbits;
 };
 
 struct pack_huffman_str_info {
@@ -47,6 +75,28 @@ struct pack_huffman_str_info {
         const char *encoded_bytes;
 };
 
+struct pack_huffman_lookup {
+        /** number of letters decoded by this entry, or 0 if the next code is longer than the table width */
+        u8 nletters;
+        /** number of bits consumed by all these letters */
+        u8 nbits;
+        /** number of bits consumed by the first letter only */
+        u8 first_nbits;
+        unsigned char letters[NG5_HUFFMAN_SYMBOLS_PER_LOOKUP];
+};
+
+struct pack_huffman_decoder {
+        /** indexed by the next <code>NG5_HUFFMAN_TABLE_BITS</code> bits of the input */
+        struct pack_huffman_lookup lookup[1 << NG5_HUFFMAN_TABLE_BITS];
+        /** for codes longer than the table width: canonical code, number of codes and position in 'letters' of the
+         * first code for each code length */
+        u64 first_code[NG5_HUFFMAN_MAX_CODE_LENGTH + 1];
+        u16 num_codes[NG5_HUFFMAN_MAX_CODE_LENGTH + 1];
+        u16 first_letter[NG5_HUFFMAN_MAX_CODE_LENGTH + 1];
+        unsigned char letters[UCHAR_MAX + 1];
+        u8 max_nbits;
+};
+
 NG5_EXPORT(bool) coding_huffman_create(struct coding_huffman *dic);
 
 NG5_EXPORT(bool) coding_huffman_cpy(struct coding_huffman *dst, struct coding_huffman *src);
@@ -65,6 +115,19 @@ NG5_EXPORT(bool) coding_huffman_serialize(struct memfile *file, const struct cod
 
 NG5_EXPORT(bool) coding_huffman_read_entry(struct pack_huffman_info *info, struct memfile *file, char marker_symbol);
 
+/**
+ * Reads the dictionary entries at the current position of <code>file</code> (as written by <code>
+ * coding_huffman_serialize</code>) and builds the decoding tables of <code>dic</code>.
+ */
+NG5_EXPORT(bool) coding_huffman_read_dictionary(struct coding_huffman *dic, struct memfile *file, char marker_symbol);
+
+/**
+ * Decodes <code>strlen</code> letters from <code>nbytes_encoded</code> bytes at <code>encoded</code> into <code>dst
+ * </code>. The input is read in 64-bit words and must be followed by at least 8 readable bytes.
+ */
+NG5_EXPORT(bool) coding_huffman_decode(char *dst, size_t strlen, const struct coding_huffman *dic,
+        const char *encoded, size_t nbytes_encoded);
+
 NG5_END_DECL
 
 #endif
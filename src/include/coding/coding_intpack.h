@@ -0,0 +1,107 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NG5_CODING_INTPACK_H
+#define NG5_CODING_INTPACK_H
+
+#include "shared/common.h"
+#include "shared/types.h"
+
+NG5_BEGIN_DECL
+
+/** number of values that readers of a packed column decode at once */
+#define NG5_INTPACK_WINDOW              32
+
+/**
+ * Lightweight integer encodings. A sequence of integers is packed with one of the schemes below, chosen per sequence
+ * such that the packed data is smallest. Values are handled as 64-bit keys; signed values are mapped to keys that keep
+ * their order (see <code>coding_intpack_key_from_signed</code>).
+ */
+enum coding_intpack_scheme {
+        /** frame of reference: each value minus the minimum, bit-packed */
+        INTPACK_FOR = 0,
+        /** zig-zag encoded difference of each value to its predecessor, bit-packed */
+        INTPACK_DELTA = 1,
+        /** runs of equal values: run values minus the minimum and run lengths minus one, each bit-packed */
+        INTPACK_RLE = 2
+};
+
+struct __attribute__((packed)) coding_intpack_header {
+        u8 scheme;
+        /** bits per packed value (or run value), 0 to 64 */
+        u8 width;
+        /** bits per packed run length (RLE only) */
+        u8 run_width;
+        u32 num_values;
+        /** number of runs (RLE only) */
+        u32 num_runs;
+        /** the minimum (FOR, RLE), or the value preceding the first value (delta) */
+        u64 reference;
+};
+
+/** position of a sequential decoder in a packed sequence */
+struct coding_intpack_cursor {
+        /** index of the next value */
+        u32 idx;
+        /** last decoded value (delta) */
+        u64 last;
+        /** index of the next run, the value of the current run and the number of values left in it (RLE) */
+        u32 run;
+        u64 run_value;
+        u32 run_left;
+};
+
+static inline u64 coding_intpack_key_from_signed(i64 value)
+{
+        return ((u64) value) ^ (1ULL << 63);
+}
+
+static inline i64 coding_intpack_signed_from_key(u64 key)
+{
+        return (i64) (key ^ (1ULL << 63));
+}
+
+/** Chooses the scheme under which <code>values</code> pack smallest and fills <code>header</code> accordingly. */
+NG5_EXPORT(bool) coding_intpack_plan(struct coding_intpack_header *header, const u64 *values, u32 num_values);
+
+/** Returns the number of bytes of packed data that follow <code>header</code>. */
+NG5_EXPORT(size_t) coding_intpack_payload_size(const struct coding_intpack_header *header);
+
+/** Packs <code>values</code> as planned in <code>header</code> into <code>dst</code>, which holds <code>
+ * coding_intpack_payload_size(header)</code> bytes. */
+NG5_EXPORT(bool) coding_intpack_encode(void *dst, const struct coding_intpack_header *header, const u64 *values);
+
+NG5_EXPORT(void) coding_intpack_cursor_init(struct coding_intpack_cursor *cursor, const struct coding_intpack_header
+        *header);
+
+/**
+ * Decodes up to <code>n</code> values following <code>cursor</code> from <code>payload</code> into <code>dst</code>,
+ * and advances the cursor. Returns the number of decoded values.
+ */
+NG5_EXPORT(u32) coding_intpack_decode(u64 *dst, u32 n, struct coding_intpack_cursor *cursor,
+        const struct coding_intpack_header *header, const void *payload);
+
+/**
+ * Bit-unpacking kernel. Sets <code>dst[i]</code> to <code>reference</code> plus the <code>width</code> bits of value
+ * <code>first + i</code> in the packed data <code>src</code> of <code>nbytes</code> bytes, for <code>i < n</code>.
+ */
+NG5_EXPORT(void) coding_intpack_unpack(u64 *dst, const void *src, size_t nbytes, u8 width, u64 first, size_t n,
+        u64 reference);
+
+NG5_END_DECL
+
+#endif
@@ -81,6 +81,19 @@ struct allocator {
  */
 NG5_EXPORT (bool) alloc_create_std(struct allocator *alloc);
 
+/**
+ * Replaces the allocator that is returned by 'alloc_create_std' (and hence used by all components that are not
+ * given an explicit allocator) process-wide by a copy of 'alloc', or restores clibs allocator if 'alloc' is null.
+ * Blocks allocated before the call remain owned by the allocator that was active at their creation.
+ *
+ * This is meant to be called once at startup, e.g., to install a tracing allocator. The allocator 'alloc' must not
+ * call 'alloc_create_std' by itself.
+ *
+ * @param alloc possibly null-pointer to an allocator implementation
+ * @return true
+ */
+NG5_EXPORT (bool) alloc_override_std(const struct allocator *alloc);
+
 /**
  * Creates a new allocator 'dst' with default constructor (in case of 'this' is null), or as copy of
  * 'this' (in case 'this' is non-null)
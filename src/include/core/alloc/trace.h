@@ -19,6 +19,7 @@
 #define NG5_ALLOC_TRACER_H
 
 #include "alloc.h"
+#include "shared/types.h"
 
 NG5_BEGIN_DECL
 
@@ -32,6 +33,99 @@ NG5_BEGIN_DECL
  */
 NG5_EXPORT (int) trace_alloc_create(struct allocator *alloc);
 
+#define TRACE_SAMPLE_STACK_DEPTH        16
+
+enum trace_dump_format {
+        TRACE_DUMP_PPROF,       /* legacy pprof heap profile (text) with call-site addresses and mapped libraries */
+        TRACE_DUMP_FOLDED       /* one 'root;...;leaf bytes' line per call-site, as consumed by flamegraph tools */
+};
+
+enum trace_dump_view {
+        TRACE_VIEW_LIVE,        /* estimated bytes currently allocated per call-site */
+        TRACE_VIEW_CUMULATIVE   /* estimated bytes allocated per call-site since creation of the sampler */
+};
+
+/**
+ * Returns standard c-lib allocator (malloc, realloc, free) that samples roughly one out of <code>sample_period</code>
+ * allocated bytes, and attributes the sampled allocations to their call-sites (up to
+ * <code>TRACE_SAMPLE_STACK_DEPTH</code> frames). Non-sampled allocations do not take any lock, such that this
+ * allocator is cheap enough to be enabled in productive mode for reasonable periods (e.g., 512 KiB).
+ *
+ * The call-site aggregates are process-wide and can be written with <code>trace_alloc_dump</code>.
+ *
+ * @param alloc must be non-null
+ * @param sample_period mean number of allocated bytes between two samples, must be non-zero
+ * @return true in case of non-null parameter alloc and non-zero sample period, false otherwise
+ */
+NG5_EXPORT (int) trace_alloc_create_sampling(struct allocator *alloc, size_t sample_period);
+
+/**
+ * Writes the per-call-site aggregates collected by sampling allocators to <code>file</code>.
+ *
+ * @param file non-null file opened for writing
+ * @param format either pprof heap profile, or folded stacks
+ * @param view either live heap, or cumulative allocations
+ * @return true on success, false if no sampling allocator was created so far
+ */
+NG5_EXPORT (bool) trace_alloc_dump(FILE *file, enum trace_dump_format format, enum trace_dump_view view);
+
+/**
+ * Allocation trace files
+ *
+ * A trace file starts with the magic string <code>TRACE_FILE_MAGIC</code> (without terminating zero) followed by one
+ * byte <code>TRACE_FILE_VERSION</code>. Then a sequence of events follows, each encoded as one byte event type
+ * (<code>enum trace_event_type</code>), the object id as LEB128 variable-length integer, and (for alloc and realloc
+ * only) the requested size in bytes as LEB128 variable-length integer. Object ids are dense and assigned in order of
+ * allocation, starting with 0.
+ */
+
+#define TRACE_FILE_MAGIC                "NG5/ATRC"
+#define TRACE_FILE_VERSION              1
+
+enum trace_event_type {
+        TRACE_EVENT_ALLOC = 0,
+        TRACE_EVENT_REALLOC = 1,
+        TRACE_EVENT_FREE = 2
+};
+
+struct trace_event {
+        enum trace_event_type type;
+        u64 object_id;
+        u64 size;
+};
+
+struct trace_reader {
+        FILE *file;
+        u64 num_events;
+        struct err err;
+};
+
+/**
+ * Returns standard c-lib allocator (malloc, realloc, free) that writes each call as event into an allocation trace
+ * file at <code>path</code>. Blocks are plain clib blocks. All calls are serialized, hence this allocator is meant
+ * to capture workloads for replay benchmarks only. Only one trace file is recorded at a time; creating another
+ * recording allocator closes the previous trace.
+ *
+ * @param alloc must be non-null
+ * @param path non-null path of the trace file that is created (or truncated)
+ * @return true on success, false if the trace file cannot be opened for writing
+ */
+NG5_EXPORT (int) trace_alloc_create_recording(struct allocator *alloc, const char *path);
+
+/**
+ * Flushes and closes the trace file of the recording allocator. Calls to recording allocators after closing are still
+ * delegated to clib but are not recorded anymore.
+ *
+ * @return true if a trace file was closed, false if no recording was active
+ */
+NG5_EXPORT (bool) trace_alloc_close_recording();
+
+NG5_EXPORT (bool) trace_reader_open(struct trace_reader *reader, const char *path);
+
+NG5_EXPORT (bool) trace_reader_next(struct trace_event *event, struct trace_reader *reader);
+
+NG5_EXPORT (bool) trace_reader_close(struct trace_reader *reader);
+
 NG5_END_DECL
 
 #endif
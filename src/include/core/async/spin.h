@@ -18,7 +18,12 @@
 #ifndef NG5_SPINLOCK_H
 #define NG5_SPINLOCK_H
 
+#ifdef __cplusplus
+#include <atomic>
+using std::atomic_flag;
+#else
 #include <stdatomic.h>
+#endif
 
 #include "shared/common.h"
 #include "std/vec.h"
@@ -82,14 +82,50 @@ NG5_EXPORT(bool) archive_stream_from_json(struct memblock **stream, struct err *
 NG5_EXPORT(bool) archive_from_model(struct memblock **stream, struct err *err, struct columndoc *model,
         enum packer_type compressor, bool bake_string_id_index, struct archive_callback *callback);
 
+/** Default number of documents after which <code>archive_from_ndjson</code> flushes a batch */
+#define NG5_NDJSON_BATCH_DOCS            NG5_ROW_GROUP_SIZE
+
+/** Default number of bytes of JSON text after which <code>archive_from_ndjson</code> flushes a batch */
+#define NG5_NDJSON_BATCH_BYTES           (16 * 1024 * 1024)
+
+/**
+ * Converts the newline-delimited JSON read from <code>ndjson</code>, one object per line, into the archive <code>file
+ * </code> and opens it as <code>out</code>. Other than <code>archive_from_json</code>, the input is never held in
+ * memory as a whole: lines are parsed in batches of at most <code>batch_docs</code> documents or about <code>
+ * batch_bytes</code> bytes, and each batch is written as row groups of the object array "/" to a temporary file before
+ * the next batch is read. All batches share one string dictionary, which is written as the string table at the end.
+ * Peak memory is thereby bounded by the batch size plus the dictionary. Blank lines are skipped.
+ */
+NG5_EXPORT(bool) archive_from_ndjson(struct archive *out, const char *file, struct err *err, FILE *ndjson,
+        enum packer_type compressor, enum strdic_tag dictionary, size_t num_async_dic_threads, u32 batch_docs,
+        size_t batch_bytes, bool bake_string_id_index, struct archive_callback *callback);
+
 NG5_EXPORT(bool) archive_write(FILE *file, const struct memblock *stream);
 
 NG5_EXPORT(bool) archive_load(struct memblock **stream, FILE *file);
 
 NG5_EXPORT(bool) archive_print(FILE *file, struct err *err, struct memblock *stream);
 
+/** How <code>archive_open_with_mode</code> brings the record table into memory */
+enum archive_open_mode {
+        ARCHIVE_OPEN_MAPPED,    /** map the record table read-only from the file; pages are loaded on access */
+        ARCHIVE_OPEN_BUFFERED   /** read the entire record table into a heap buffer on open */
+};
+
+/**
+ * Opens the archive at <code>file_path</code> with <code>ARCHIVE_OPEN_MAPPED</code>. Opening costs are thereby
+ * independent of the archive size. The archive file must not be truncated or rewritten while the archive is open.
+ */
 NG5_EXPORT(bool) archive_open(struct archive *out, const char *file_path);
 
+NG5_EXPORT(bool) archive_open_with_mode(struct archive *out, const char *file_path, enum archive_open_mode mode);
+
+/**
+ * Hints the expected access pattern to the record table, e.g., <code>MEMBLOCK_ADVICE_SEQUENTIAL</code> before a
+ * full scan or <code>MEMBLOCK_ADVICE_RANDOM</code> for point lookups. Has no effect on buffered archives.
+ */
+NG5_EXPORT(bool) archive_advise(struct archive *archive, enum memblock_advice advice);
+
 NG5_EXPORT(bool) archive_get_info(struct archive_info *info, const struct archive *archive);
 
 NG5_DEFINE_GET_ERROR_FUNCTION(archive, struct archive, archive);
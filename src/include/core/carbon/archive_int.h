@@ -23,9 +23,15 @@
 #include "shared/types.h"
 #include "core/oid/oid.h"
 #include "core/pack/pack.h"
+#include "coding/coding_intpack.h"
 
 NG5_BEGIN_DECL
 
+/** maximum number of objects in a row group of an object array (see <code>column_group_header</code>) */
+#define NG5_ROW_GROUP_SIZE              4096
+
+/** number of Bloom filter bits per distinct string id of a string column in a zone map */
+#define NG5_ZONE_MAP_BLOOM_BITS         10
 
 struct __attribute__((packed)) archive_header {
         char magic[9];
@@ -57,6 +63,10 @@ union __attribute__((packed)) string_tab_flags {
                         : 1;
                 u8 compressed_huffman
                         : 1;
+                u8 compressed_fsst
+                        : 1;
+                u8 compressed_front
+                        : 1;
         } bits;
         u8 value;
 };
@@ -74,12 +84,61 @@ struct __attribute__((packed)) object_array_header {
         u8 num_entries;
 };
 
+/**
+ * Header of an object array written by the streaming converter (marker <code>MARKER_SYMBOL_PROP_OBJECT_ARRAY_STREAM
+ * </code>). The row groups directly follow the header since they are flushed before their total number is known. The
+ * key and offset lists addressing them are written after the last group at <code>directory_off</code>.
+ */
+struct __attribute__((packed)) object_array_stream_header {
+        char marker;
+        u32 num_entries;
+        offset_t directory_off;
+};
+
+/**
+ * Header of a column group. A column group (marker <code>MARKER_SYMBOL_COLUMN_GROUP</code>) is followed by one object
+ * id per object, one offset per column, and the columns. Object arrays with more than <code>NG5_ROW_GROUP_SIZE</code>
+ * objects are split into row groups (marker <code>MARKER_SYMBOL_ROW_GROUP</code>) that share the key of the array and
+ * each hold a contiguous range of its objects. A row group header is followed by the offset of the group's zone map,
+ * and then laid out as a column group; the zone map is written after the last column.
+ */
 struct __attribute__((packed)) column_group_header {
         char marker;
         u32 num_columns;
         u32 num_objects;
 };
 
+/** Header of the zone map of a row group, followed by one <code>zone_map_entry</code> per column of the group. */
+struct __attribute__((packed)) zone_map_header {
+        char marker;
+        u32 num_entries;
+};
+
+/**
+ * Statistics of a single column of a row group. <code>min</code> and <code>max</code> are the order-preserving keys
+ * (see <code>int_zone_key_of</code>) of the smallest and largest non-null value, and are only meaningful if the column
+ * has values of a boolean, number or string id type, and <code>num_nulls</code> is less than <code>num_values</code>.
+ * Null values (the <code>NG5_NULL_*</code> value of the column type, or NaN for numbers) are counted in <code>
+ * num_nulls</code> instead. For a null column, both counts are the number of nulls. A string column entry is followed
+ * by <code>bloom_blocks</code> blocks of a split-block Bloom filter (see <code>std/bloom.h</code>) over its non-null
+ * string ids.
+ */
+struct __attribute__((packed)) zone_map_entry {
+        field_sid_t column_name;
+        char value_type;
+        u32 num_values;
+        u32 num_nulls;
+        u64 min;
+        u64 max;
+        u32 bloom_blocks;
+};
+
+/**
+ * Header of a column in a column group. A column (marker <code>MARKER_SYMBOL_COLUMN</code>) is followed by one offset
+ * per entry, the entry positions, and the entries, each a length and that many values. A packed column (marker <code>
+ * MARKER_SYMBOL_COLUMN_PACKED</code>) holds exactly one integer, boolean or string id per entry; it is followed by the
+ * entry positions, a <code>coding_intpack_header</code> and the packed values.
+ */
 struct __attribute__((packed)) column_header {
         char marker;
         field_sid_t column_name;
@@ -252,6 +311,11 @@ enum marker_type {
         MARKER_TYPE_COLUMN = 31,
         MARKER_TYPE_HUFFMAN_DIC_ENTRY = 32,
         MARKER_TYPE_RECORD_HEADER = 33,
+        MARKER_TYPE_EMBEDDED_STR_TAB = 34,
+        MARKER_TYPE_COLUMN_PACKED = 35,
+        MARKER_TYPE_ROW_GROUP = 36,
+        MARKER_TYPE_ZONE_MAP = 37,
+        MARKER_TYPE_PROP_OBJECT_ARRAY_STREAM = 38,
 };
 
 extern struct archive_header this_file_header;
@@ -269,11 +333,11 @@ struct value_array_marker_mapping_entry {
 extern struct value_array_marker_mapping_entry value_array_marker_mapping[];
 extern struct value_array_marker_mapping_entry valueMarkerMapping[];
 
-struct record_flags {
+union record_flags {
         struct {
                 u8 is_sorted
                         : 1;
-                u8 RESERVED_2
+                u8 has_ordered_string_ids
                         : 1;
                 u8 RESERVED_3
                         : 1;
@@ -295,10 +359,14 @@ struct string_table {
         struct packer compressor;
         offset_t first_entry_off;
         u32 num_embeddded_strings;
+        /** true for an indexed string table, false for a (legacy) linked string table */
+        bool indexed;
+        /** slots of an indexed string table, or NULL */
+        struct memblock *directory;
 };
 
 struct record_table {
-        struct record_flags flags;
+        union record_flags flags;
         struct memblock *recordDataBase;
 };
 
@@ -316,6 +384,18 @@ struct __attribute__((packed)) string_entry_header {
         u32 string_len;
 };
 
+/**
+ * Slot of an indexed string table (marker <code>MARKER_SYMBOL_EMBEDDED_STR_TAB</code>). The table stores one slot per
+ * string sorted by string id, followed by the encoded strings back-to-back in the same order (the string heap).
+ * Linked string tables (marker <code>MARKER_SYMBOL_EMBEDDED_STR_DIC</code>) instead put a <code>string_entry_header
+ * </code> in front of each encoded string.
+ */
+struct __attribute__((packed)) string_table_slot {
+        field_sid_t string_id;
+        offset_t offset;        /* file offset of the encoded string in the heap */
+        u32 string_len;         /* length of the decoded string */
+};
+
 void int_read_prop_offsets(struct archive_prop_offs *prop_offsets, struct memfile *memfile,
         const union object_flags *flags);
 
@@ -329,6 +409,23 @@ void int_embedded_array_props_read(struct array_prop *prop, struct memfile *memf
 
 void int_embedded_table_props_read(struct table_prop *prop, struct memfile *memfile);
 
+const struct string_table_slot *int_string_table_slots(const struct string_table *table);
+
+const struct string_table_slot *int_string_table_find(const struct string_table *table, field_sid_t id);
+
+/** Returns true if columns of <code>type</code> holding a single value per entry are written as packed columns. */
+bool int_is_packable_type(field_e type);
+
+/** Returns the key under which a value of <code>type</code> stored at <code>value</code> is packed. */
+u64 int_packed_key_of(field_e type, const void *value);
+
+/** Stores the value of <code>type</code> packed under <code>key</code> at <code>dst</code>. */
+void int_packed_value_of(void *dst, field_e type, u64 key);
+
+/** Returns an order-preserving key of a boolean, number or string id value of <code>type</code> stored at <code>value
+ * </code>; keys of signed integers are comparable across widths, as are keys of unsigned integers. */
+u64 int_zone_key_of(field_e type, const void *value);
+
 field_e int_get_value_type_of_char(char c);
 
 field_e int_marker_to_field_type(char symbol);
@@ -21,6 +21,7 @@
 #include "shared/common.h"
 #include "shared/error.h"
 #include "archive.h"
+#include "coding/coding_intpack.h"
 
 NG5_BEGIN_DECL
 
@@ -91,17 +92,24 @@ struct collection_iter_state {
                 u32 num_objects;
                 const object_id_t *object_ids;
                 const offset_t *column_offs;
+                offset_t zone_map_off;                  /* zone map of a row group, or 0 for a column group */
                 struct {
                         u32 idx;
                         field_sid_t name;
                         enum field_type type;
                         u32 num_elem;
-                        const offset_t *elem_offsets;
+                        const offset_t *elem_offsets;   /* NULL for a packed column */
                         const u32 *elem_positions;
+                        /* header and values of a packed column (or NULL), decoded window by window */
+                        const struct coding_intpack_header *packed;
+                        const void *packed_values;
+                        struct coding_intpack_cursor packed_cursor;
+                        u64 packed_window[NG5_INTPACK_WINDOW];
                         struct {
                                 u32 idx;
                                 u32 array_length;
                                 const void *array_base;
+                                u64 packed_value;       /* the single value of an entry in a packed column */
                         } current_entry;
                 } current_column;
         } current_column_group;
@@ -180,6 +188,18 @@ struct independent_iter_state {
         struct err err;                                /* error information */
 };
 
+/**
+ * Statistics of the objects in a row group of an object array, i.e., per column, the smallest and largest value, the
+ * number of nulls and, for strings, a Bloom filter over the contained string ids. A query can skip a row group if its
+ * zone map rules out any matching value. Column groups that are not split into row groups have no zone map; then,
+ * every lookup answers that the group may contain a value.
+ */
+struct archive_zone_map {
+        bool exists;                            /* false if the column group has no zone map */
+        u32 num_entries;                        /* number of column statistics */
+        const void *entries;                    /* column statistics in the record table */
+};
+
 typedef struct independent_iter_state archive_collection_iter_t;
 
 typedef struct independent_iter_state archive_column_group_iter_t;
@@ -269,6 +289,31 @@ NG5_EXPORT(const object_id_t *)archive_column_group_get_object_ids(u32 *num_obje
 NG5_EXPORT(bool) archive_column_group_next_column(archive_column_iter_t *column_iter,
         archive_column_group_iter_t *iter);
 
+NG5_EXPORT(bool) archive_column_group_get_zone_map(struct archive_zone_map *zone_map,
+        archive_column_group_iter_t *iter);
+
+/** Returns false only if no integer column named <code>column</code> has a value in <code>[lo, hi]</code>. */
+NG5_EXPORT(bool) archive_zone_map_may_contain_int(const struct archive_zone_map *zone_map, field_sid_t column, i64 lo,
+        i64 hi);
+
+/** Returns false only if no integer column named <code>column</code> has a value in <code>[lo, hi]</code>. */
+NG5_EXPORT(bool) archive_zone_map_may_contain_uint(const struct archive_zone_map *zone_map, field_sid_t column, u64 lo,
+        u64 hi);
+
+/** Returns false only if no number column named <code>column</code> has a value in <code>[lo, hi]</code>. */
+NG5_EXPORT(bool) archive_zone_map_may_contain_number(const struct archive_zone_map *zone_map, field_sid_t column,
+        field_number_t lo, field_number_t hi);
+
+/** Returns false only if no string column named <code>column</code> contains <code>value</code>, which may be the null
+ * string id. */
+NG5_EXPORT(bool) archive_zone_map_may_contain_string(const struct archive_zone_map *zone_map, field_sid_t column,
+        field_sid_t value);
+
+/** Counts the nulls in all columns named <code>column</code>, i.e., the entries of a null column and the null values
+ * of typed columns. Returns false if the column group has no zone map. */
+NG5_EXPORT(bool) archive_zone_map_get_num_nulls(u32 *num_nulls, const struct archive_zone_map *zone_map,
+        field_sid_t column);
+
 NG5_EXPORT(bool) archive_column_get_name(field_sid_t *name, enum field_type *type, archive_column_iter_t *column_iter);
 
 NG5_EXPORT(const u32 *)archive_column_get_entry_positions(u32 *num_entry, archive_column_iter_t *column_iter);
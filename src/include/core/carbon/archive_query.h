@@ -59,6 +59,15 @@ NG5_EXPORT(char **) query_fetch_strings_by_offset(struct archive_query *query, o
 NG5_EXPORT(field_sid_t *)query_find_ids(size_t *num_found, struct archive_query *query,
         const struct string_pred_t *pred, void *capture, i64 limit);
 
+/**
+ * Returns the ids of the objects in object arrays whose string property <code>column</code> contains any of the
+ * <code>num_values</code> string ids in <code>values</code>, e.g., ids found by <code>query_find_ids</code>. Row groups
+ * whose zone map rules out all of <code>values</code> are skipped without being read. The result is allocated on the
+ * heap and must be freed by the caller; it is NULL if no object matches or the scan failed.
+ */
+NG5_EXPORT(object_id_t *)query_find_object_ids(size_t *num_found, struct archive_query *query, field_sid_t column,
+        const field_sid_t *values, size_t num_values);
+
 NG5_END_DECL
 
 #endif
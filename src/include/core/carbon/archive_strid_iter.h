@@ -30,15 +30,40 @@ struct strid_info {
         offset_t offset;
 };
 
+/** number of string entries handed out per call to <code>strid_iter_next</code> by default */
+#define NG5_STRID_ITER_BATCH_SIZE        16384
+
+/** size of the blocks in which a linked string table is read from disk by default */
+#define NG5_STRID_ITER_BLOCK_SIZE        (1024 * 1024)
+
 struct strid_iter {
         FILE *disk_file;
         bool is_open;
         offset_t disk_offset;
-        struct strid_info vector[100000];
+        /** slot directory of an indexed string table, or NULL for a linked string table */
+        const struct string_table_slot *slots;
+        size_t num_slots;
+        size_t slot_pos;
+        /** block buffer to parse entry headers of a linked string table from */
+        char *block;
+        size_t block_size;
+        offset_t block_off;
+        size_t block_len;
+        struct strid_info *vector;
+        size_t batch_size;
 };
 
 NG5_EXPORT(bool) strid_iter_open(struct strid_iter *it, struct err *err, struct archive *archive);
 
+/**
+ * Opens a string id iterator that returns up to <code>batch_size</code> entries per call to <code>strid_iter_next
+ * </code>. The entries of a linked string table are parsed out of <code>block_size</code> large blocks, each read
+ * with a single <code>pread</code> (the default sizes are <code>NG5_STRID_ITER_BATCH_SIZE</code> and
+ * <code>NG5_STRID_ITER_BLOCK_SIZE</code>).
+ */
+NG5_EXPORT(bool) strid_iter_open_with(struct strid_iter *it, struct err *err, struct archive *archive,
+        size_t batch_size, size_t block_size);
+
 NG5_EXPORT(bool) strid_iter_next(bool *success, struct strid_info **info, struct err *err, size_t *info_length,
         struct strid_iter *it);
 
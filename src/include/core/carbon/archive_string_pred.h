@@ -25,9 +25,23 @@ NG5_BEGIN_DECL
 typedef bool
 (*string_pred_func_t)(size_t *idxs_matching, size_t *num_matching, char **strings, size_t num_strings, void *capture);
 
+/**
+ * What a predicate tests for. Predicates other than <code>STRING_PRED_GENERIC</code> are answered by a binary search
+ * over string tables that are stored in lexicographic order; <code>func</code> must implement the same test.
+ */
+enum string_pred_kind {
+        /** any test; evaluated on all strings */
+        STRING_PRED_GENERIC = 0,
+        /** strings equal to the capture */
+        STRING_PRED_EQUALS,
+        /** strings starting with the capture */
+        STRING_PRED_PREFIX
+};
+
 struct string_pred_t {
         string_pred_func_t func;
         i64 limit;
+        enum string_pred_kind kind;
 };
 
 NG5_BUILT_IN(static bool) string_pred_validate(struct err *err, const struct string_pred_t *pred)
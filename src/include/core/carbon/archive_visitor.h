@@ -128,6 +128,11 @@ struct archive_visitor {
         enum visit_policy (*before_visit_object_array)(struct archive *archive, path_stack_t path,
                 object_id_t parent_id, field_sid_t key, void *capture);
 
+        /** called for each row group of a large object array before its objects are visited; row groups are skipped
+         * if <code>VISIT_EXCLUDE</code> is returned, e.g., because their zone map rules out values of interest */
+        enum visit_policy (*before_visit_row_group)(struct archive *archive, path_stack_t path, object_id_t parent_id,
+                field_sid_t key, const struct archive_zone_map *zone_map, void *capture);
+
         void (*before_visit_object_array_objects)(bool *skip_group_object_ids, struct archive *archive,
                 path_stack_t path, object_id_t parent_id, field_sid_t key, const object_id_t *group_object_ids,
                 u32 num_group_object_ids, void *capture);
@@ -0,0 +1,40 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NG5_STRDIC_CONCURRENT_H
+#define NG5_STRDIC_CONCURRENT_H
+
+#include "stdx/strdic.h"
+
+NG5_BEGIN_DECL
+
+/**
+ * Creates a string dictionary that can be used by any number of threads at the same time without partitioning
+ * strings among threads. Strings are interned into an open addressing table whose slots are claimed by CAS, and are
+ * copied into an append-only arena that is shared among threads. String ids are dense and sequential (starting at 1,
+ * since 0 encodes <code>null</code>), and ids of removed strings are not re-used.
+ *
+ * @param dic non-null pointer to the dictionary to be created
+ * @param capacity expected number of distinct strings (the dictionary grows beyond that if required)
+ * @param alloc allocator to be used, or <code>NULL</code> for the standard allocator
+ * @return <code>true</code> in case of success, otherwise a value indicating the error.
+ */
+NG5_EXPORT (int) encode_concurrent_create(struct strdic *dic, size_t capacity, const struct allocator *alloc);
+
+NG5_END_DECL
+
+#endif
@@ -25,10 +25,36 @@ NG5_BEGIN_DECL
 
 struct memblock;
 
+/** Expected access pattern to a memory block, see <code>memblock_advise</code> */
+enum memblock_advice {
+        MEMBLOCK_ADVICE_NORMAL,         /** no particular pattern */
+        MEMBLOCK_ADVICE_SEQUENTIAL,     /** front-to-back scan; read ahead aggressively, drop pages behind */
+        MEMBLOCK_ADVICE_RANDOM,         /** point lookups; do not read ahead */
+        MEMBLOCK_ADVICE_WILLNEED        /** the whole block is needed soon; start paging it in */
+};
+
 NG5_EXPORT(bool) memblock_create(struct memblock **block, size_t size);
 
 NG5_EXPORT(bool) memblock_from_file(struct memblock **block, FILE *file, size_t nbytes);
 
+/**
+ * Creates a read-only memory block over the next <code>nbytes</code> of <code>file</code> (starting at its current
+ * position) by mapping the file into memory rather than reading it. Pages are loaded on first access. As for
+ * <code>memblock_from_file</code>, the file position is advanced by <code>nbytes</code>.
+ *
+ * The block must not be resized or written, and the file must not be truncated while the block is alive.
+ * <code>memblock_drop</code> unmaps it.
+ */
+NG5_EXPORT(bool) memblock_map_file(struct memblock **block, FILE *file, size_t nbytes);
+
+/**
+ * Hints the expected access pattern of <code>block</code> to the operating system. Has an effect on mapped blocks
+ * only (see <code>memblock_map_file</code>); for heap blocks this is a no-op.
+ */
+NG5_EXPORT(bool) memblock_advise(struct memblock *block, enum memblock_advice advice);
+
+NG5_EXPORT(bool) memblock_is_mapped(const struct memblock *block);
+
 NG5_EXPORT(bool) memblock_drop(struct memblock *block);
 
 NG5_EXPORT(bool) memblock_get_error(struct err *out, struct memblock *block);
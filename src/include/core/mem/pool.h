@@ -107,7 +107,11 @@ struct pool_counters
         u32 num_bytes_free_blocked;     /* portion (in bytes) of num_bytes_free_cache that cannot be used */
 };
 
+/* the position of a pointer in 'in_use' is stored in the 16 data bits of a 'data_ptr_t' */
+#define POOL_MAX_MANAGED_PTRS (UINT16_MAX - 1)
+
 struct pool; /* forwarded */
+struct pool_slot_registry; /* forwarded; opaque, see 'pool.c' */
 
 struct pool_strategy
 {
@@ -137,8 +141,7 @@ struct pool_ptr_info {
 struct pool
 {
         struct err                          err;
-        struct vector ofType(pool_ptr_info) in_use;
-        struct vector ofType(u16)           in_use_pos_freelist;
+        struct pool_slot_registry          *in_use;
         struct spinlock                     lock;
         struct pool_strategy                strategy;
 };
@@ -164,6 +167,9 @@ NG5_EXPORT(bool) pool_internal_register(data_ptr_t *dst, struct pool *pool, cons
 
 NG5_EXPORT(void) pool_internal_unregister(struct pool *pool, data_ptr_t ptr);
 
+/** Returns the registry entry of the pointer registered at <code>pos</code> in <code>pool</code> */
+NG5_EXPORT(struct pool_ptr_info *) pool_internal_slot(struct pool *pool, u16 pos);
+
 #define pool_internal_new(pool_strategy, c_ptr, c_ptr_length)                                                          \
 ({                                                                                                                     \
         data_ptr_t result;                                                                                             \
@@ -182,8 +188,7 @@ NG5_EXPORT(void) pool_internal_unregister(struct pool *pool, data_ptr_t ptr);
         u16 pos;                                                                                                       \
         struct pool_ptr_info *info;                                                                                    \
         data_ptr_get_data(&pos, data_ptr);                                                                             \
-        assert(pos < pool_strategy->context->in_use.num_elems);                                                        \
-        info = vec_get(&pool_strategy->context->in_use, pos, struct pool_ptr_info);                                    \
+        info = pool_internal_slot(pool_strategy->context, pos);                                                        \
         assert(!info->is_free);                                                                                        \
         assert(data_ptr_get_pointer(data_ptr) == data_ptr_get_pointer(info->ptr));                                     \
         info;                                                                                                          \
@@ -20,6 +20,8 @@
 
 #include "core/pack/pack_none.h"
 #include "core/pack/huffman.h"
+#include "core/pack/pack_fsst.h"
+#include "core/pack/pack_front.h"
 #include "coding/coding_huffman.h"
 #include "shared/common.h"
 #include "shared/types.h"
@@ -31,7 +33,7 @@ NG5_BEGIN_DECL
  * string table.
  */
 enum packer_type {
-        PACK_NONE, PACK_HUFFMAN
+        PACK_NONE, PACK_HUFFMAN, PACK_FSST, PACK_FRONT
 };
 
 /**
@@ -184,6 +186,10 @@ NG5_EXPORT(void) pack_none_create(struct packer *strategy);
 
 NG5_EXPORT(void) pack_huffman_create(struct packer *strategy);
 
+NG5_EXPORT(void) pack_fsst_create(struct packer *strategy);
+
+NG5_EXPORT(void) pack_front_create(struct packer *strategy);
+
 extern struct compressor_strategy_entry {
         enum packer_type type;
 
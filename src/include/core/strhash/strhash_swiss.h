@@ -0,0 +1,43 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NG5_STRHASH_SWISS_H
+#define NG5_STRHASH_SWISS_H
+
+#include "shared/common.h"
+#include "core/alloc/alloc.h"
+#include "stdx/strhash.h"
+
+NG5_BEGIN_DECL
+
+/**
+ * Creates a string hash table that uses open addressing over flat slot arrays. Each slot has one control byte that
+ * is either empty, deleted, or holds 7 bits of the key hash. Control bytes are grouped by 16 and a lookup probes an
+ * entire group at once (using SSE2 if available), such that keys are only compared for slots whose 7 hash bits match.
+ * Slots store the full hash, the key pointer and the key length. Keys are not copied, i.e., keys must outlive the
+ * table (as for <code>strhash_create_inmemory</code>).
+ *
+ * @param map non-null pointer to the table to be created
+ * @param alloc allocator to be used, or <code>NULL</code> for the standard allocator
+ * @param capacity expected number of keys (the table grows beyond that if required)
+ * @return <code>true</code> in case of success, otherwise a value indicating the error.
+ */
+NG5_EXPORT (bool) strhash_create_swiss(struct strhash *map, const struct allocator *alloc, size_t capacity);
+
+NG5_END_DECL
+
+#endif
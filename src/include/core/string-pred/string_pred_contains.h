@@ -47,6 +47,7 @@ string_pred_contains_init(struct string_pred_t *pred)
         error_if_null(pred);
         pred->limit = NG5_QUERY_LIMIT_NONE;
         pred->func = __string_pred_contains_func;
+        pred->kind = STRING_PRED_GENERIC;
         return true;
 }
 
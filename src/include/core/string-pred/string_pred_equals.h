@@ -30,7 +30,7 @@ NG5_BUILT_IN(static bool) __string_pred_equals_func(size_t *idxs_matching, size_
         const char *needle = (const char *) capture;
 
         for (size_t i = 0; i < num_strings; i++) {
-                if (strstr(strings[i], needle) != NULL) {
+                if (strcmp(strings[i], needle) == 0) {
                         idxs_matching[result_size++] = i;
                 }
         }
@@ -46,6 +46,7 @@ string_pred_equals_init(struct string_pred_t *pred)
         error_if_null(pred);
         pred->limit = NG5_QUERY_LIMIT_1;
         pred->func = __string_pred_equals_func;
+        pred->kind = STRING_PRED_EQUALS;
         return true;
 }
 
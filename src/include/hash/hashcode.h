@@ -0,0 +1,95 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NG5_HASHCODE_H
+#define NG5_HASHCODE_H
+
+#include <string.h>
+
+#include "hash.h"
+#include "bern.h"
+#include "fnv.h"
+#include "wy.h"
+
+NG5_BEGIN_DECL
+
+/**
+ * Default 32bit hash code of a key for in-memory hash tables (string hashes, dictionaries, hash tables and sets).
+ *
+ * Selected at compile time: define 'NG5_CONFIG_HASHCODE_BERNSTEIN' or 'NG5_CONFIG_HASHCODE_FNV' to fall back to
+ * one of the classic byte-at-a-time hashes; otherwise the wyhash-style multiply-mix hash is used. Hash codes are
+ * never written to archives, so changing the selection does not affect the file format.
+ *
+ * Unlike the NG5_HASH_* macros, 'key_size' and 'key' are evaluated exactly once, and a key of zero length is allowed.
+ */
+#if defined(NG5_CONFIG_HASHCODE_BERNSTEIN)
+#define NG5_HASHCODE_OF(key_size, key)           hash_code_of_bernstein(key_size, key)
+#define NG5_HASHCODE_NAME                        "bernstein"
+#elif defined(NG5_CONFIG_HASHCODE_FNV)
+#define NG5_HASHCODE_OF(key_size, key)           hash_code_of_fnv(key_size, key)
+#define NG5_HASHCODE_NAME                        "fnv"
+#else
+#define NG5_HASHCODE_OF(key_size, key)           NG5_HASH_WY(key_size, key)
+#define NG5_HASHCODE_NAME                        "wy"
+#endif
+
+static inline hash32_t hash_code_of_bernstein(size_t len, const void *data)
+{
+        return len > 0 ? NG5_HASH_BERNSTEIN(len, data) : 0;
+}
+
+static inline hash32_t hash_code_of_fnv(size_t len, const void *data)
+{
+        return len > 0 ? NG5_HASH_FNV(len, data) : 0;
+}
+
+/**
+ * A string together with its length and its hash code ('NG5_HASHCODE_OF'). Keys are built once by whoever produces
+ * the string (e.g., the document bulk when it copies strings out of the JSON document), and are then passed unchanged
+ * to string dictionaries, string hashes and slice lists, such that none of them has to measure or hash the string
+ * again. The key does not own 'str'. A null string is represented by 'str' being NULL, and has length and hash 0.
+ */
+struct string_key {
+        const char *str;
+        u32 len;
+        hash32_t hash;
+};
+
+static inline struct string_key string_key_of_len(const char *str, u32 len)
+{
+        return (struct string_key) {
+                .str = str,
+                .len = len,
+                .hash = str ? NG5_HASHCODE_OF(len, str) : 0
+        };
+}
+
+static inline struct string_key string_key_of(const char *str)
+{
+        return string_key_of_len(str, str ? strlen(str) : 0);
+}
+
+static inline void string_keys_of(struct string_key *out, char *const *strings, size_t num_strings)
+{
+        for (size_t i = 0; i < num_strings; i++) {
+                out[i] = string_key_of(strings[i]);
+        }
+}
+
+NG5_END_DECL
+
+#endif
@@ -52,27 +52,25 @@ NG5_BEGIN_DECL
         a += (k[0] + ((unsigned)k[1] << 8) + ((unsigned)k[2] << 16) + ((unsigned)k[3] << 24));                         \
         b += (k[4] + ((unsigned)k[5] << 8) + ((unsigned)k[6] << 16) + ((unsigned)k[7] << 24));                         \
         c += (k[8] + ((unsigned)k[9] << 8) + ((unsigned)k[10] << 16) + ((unsigned)k[11] << 24));                       \
-        JENKINS_MIX(a, b, c);                                                                                          \
+        NG5_JENKINS_MIX(a, b, c);                                                                                      \
         k += 12;                                                                                                       \
         key_size -= 12;                                                                                                \
     }                                                                                                                  \
                                                                                                                        \
     c += key_size;                                                                                                     \
                                                                                                                        \
-    switch (key_size) {                                                                                                \
-        case 11: c += ((unsigned)k[10] << 24); break;                                                                  \
-        case 10: c += ((unsigned)k[9] << 16); break;                                                                   \
-        case 9: c += ((unsigned)k[8] << 8); break;                                                                     \
-        case 8: b += ((unsigned)k[7] << 24); break;                                                                    \
-        case 7: b += ((unsigned)k[6] << 16); break;                                                                    \
-        case 6: b += ((unsigned)k[5] << 8); break;                                                                     \
-        case 5: b += k[4]; break;                                                                                      \
-        case 4: a += ((unsigned)k[3] << 24); break;                                                                    \
-        case 3: a += ((unsigned)k[2] << 16); break;                                                                    \
-        case 2: a += ((unsigned)k[1] << 8); break;                                                                     \
-        case 1: a += k[0]; break;                                                                                      \
-    }                                                                                                                  \
-    JENKINS_MIX(a, b, c);                                                                                              \
+    if (key_size >= 11) c += ((unsigned)k[10] << 24);                                                                  \
+    if (key_size >= 10) c += ((unsigned)k[9] << 16);                                                                   \
+    if (key_size >= 9) c += ((unsigned)k[8] << 8);                                                                     \
+    if (key_size >= 8) b += ((unsigned)k[7] << 24);                                                                    \
+    if (key_size >= 7) b += ((unsigned)k[6] << 16);                                                                    \
+    if (key_size >= 6) b += ((unsigned)k[5] << 8);                                                                     \
+    if (key_size >= 5) b += k[4];                                                                                      \
+    if (key_size >= 4) a += ((unsigned)k[3] << 24);                                                                    \
+    if (key_size >= 3) a += ((unsigned)k[2] << 16);                                                                    \
+    if (key_size >= 2) a += ((unsigned)k[1] << 8);                                                                     \
+    if (key_size >= 1) a += k[0];                                                                                      \
+    NG5_JENKINS_MIX(a, b, c);                                                                                          \
     c;                                                                                                                 \
 })
 
@@ -0,0 +1,133 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NG5_WY_H
+#define NG5_WY_H
+
+#include <string.h>
+
+#include "hash.h"
+
+NG5_BEGIN_DECL
+
+/**
+ * Multiply-mix hash in the style of wyhash. Keys up to 16 bytes are read with (at most four) overlapping loads and
+ * finished by a single 64x64->128 bit multiplication; longer keys are consumed 32 bytes per step by two independent
+ * 16-byte lanes, so that both multiplications of a step can be in flight at the same time. Unlike the byte-at-a-time
+ * hashes in this directory, the key length is part of the hash, and all output bits depend on all input bits.
+ *
+ * Loads assume a little-endian host.
+ */
+
+#define NG5_HASH_WY(key_size, key)               ((hash32_t) hash_wy_fold(hash_wy64(key, key_size, 0)))
+#define NG5_HASH64_WY(key_size, key)             ((hash64_t) hash_wy64(key, key_size, 0))
+#define NG5_HASH_WY_SEEDED(key_size, key, seed)  ((hash32_t) hash_wy_fold(hash_wy64(key, key_size, seed)))
+
+#define NG5_WY_SECRET_0                          0xa0761d6478bd642fULL
+#define NG5_WY_SECRET_1                          0xe7037ed1a0b428dbULL
+#define NG5_WY_SECRET_2                          0x8ebc6af09c88c6e3ULL
+
+static inline void hash_wy_mum128(u64 *a, u64 *b)
+{
+        __uint128_t r = (__uint128_t) *a * *b;
+        *a = (u64) r;
+        *b = (u64) (r >> 64);
+}
+
+static inline u64 hash_wy_mum(u64 a, u64 b)
+{
+        hash_wy_mum128(&a, &b);
+        return a ^ b;
+}
+
+static inline u64 hash_wy_read64(const u8 *p)
+{
+        u64 v;
+        memcpy(&v, p, sizeof(u64));
+        return v;
+}
+
+static inline u64 hash_wy_read32(const u8 *p)
+{
+        u32 v;
+        memcpy(&v, p, sizeof(u32));
+        return v;
+}
+
+/** reads keys of 1 to 3 bytes: first, middle and last byte (which may coincide) */
+static inline u64 hash_wy_read_small(const u8 *p, size_t len)
+{
+        return ((u64) p[0] << 16) | ((u64) p[len >> 1] << 8) | p[len - 1];
+}
+
+static inline u32 hash_wy_fold(u64 hash)
+{
+        return (u32) (hash ^ (hash >> 32));
+}
+
+static inline u64 hash_wy64(const void *key, size_t len, u64 seed)
+{
+        const u8 *p = (const u8 *) key;
+        u64 a, b;
+
+        seed ^= hash_wy_mum(seed ^ NG5_WY_SECRET_0, NG5_WY_SECRET_1);
+
+        if (likely(len <= 16)) {
+                if (len >= 4) {
+                        /** two pairs of 4-byte loads that overlap in the middle cover 4 to 16 bytes */
+                        size_t shift = (len >> 3) << 2;
+                        a = (hash_wy_read32(p) << 32) | hash_wy_read32(p + shift);
+                        b = (hash_wy_read32(p + len - 4) << 32) | hash_wy_read32(p + len - 4 - shift);
+                } else if (len > 0) {
+                        a = hash_wy_read_small(p, len);
+                        b = 0;
+                } else {
+                        a = b = 0;
+                }
+        } else {
+                size_t remain = len;
+                if (unlikely(remain > 32)) {
+                        u64 lane = seed;
+                        do {
+                                seed = hash_wy_mum(hash_wy_read64(p) ^ NG5_WY_SECRET_1,
+                                                   hash_wy_read64(p + 8) ^ seed);
+                                lane = hash_wy_mum(hash_wy_read64(p + 16) ^ NG5_WY_SECRET_2,
+                                                   hash_wy_read64(p + 24) ^ lane);
+                                p += 32;
+                                remain -= 32;
+                        } while (remain > 32);
+                        seed ^= lane;
+                }
+                while (remain > 16) {
+                        seed = hash_wy_mum(hash_wy_read64(p) ^ NG5_WY_SECRET_1, hash_wy_read64(p + 8) ^ seed);
+                        p += 16;
+                        remain -= 16;
+                }
+                /** the last 16 bytes of the key; may re-read bytes that were already consumed above */
+                a = hash_wy_read64(p + remain - 16);
+                b = hash_wy_read64(p + remain - 8);
+        }
+
+        a ^= NG5_WY_SECRET_1;
+        b ^= seed;
+        hash_wy_mum128(&a, &b);
+        return hash_wy_mum(a ^ NG5_WY_SECRET_0 ^ len, b ^ NG5_WY_SECRET_1);
+}
+
+NG5_END_DECL
+
+#endif
@@ -225,6 +225,14 @@ struct columndoc {
         struct columndoc_obj columndoc;
         const struct doc_bulk *bulk;
         bool read_optimized;
+        /** if set, the documents of the bulk form an object array even if there is only one document; otherwise, a
+         * single document is imported as nested object */
+        bool root_is_array;
+        /** if set, string ids in this document are ranks of the strings in lexicographic order */
+        bool ordered_string_ids;
+        /** if 'ordered_string_ids' is set, all strings referenced in this document ordered lexicographically such
+         * that the string with id i is stored at position i - 1 */
+        struct vector ofType(const char *) ordered_strings;
         struct err err;
 };
 
@@ -235,6 +243,18 @@ NG5_DEFINE_GET_ERROR_FUNCTION(columndoc, struct columndoc, doc)
 
 NG5_EXPORT(bool) columndoc_free(struct columndoc *doc);
 
+/**
+ * Remaps all string ids in this document such that the order of ids equals the lexicographic order of the strings
+ * they refer to (with ids starting at 1, and <code>NG5_NULL_ENCODED_STRING</code> left untouched). Afterwards,
+ * range, prefix and sort operations on strings can be evaluated on ids alone. The string dictionary itself is not
+ * changed, i.e., ids in this document must not be resolved with the dictionary anymore (use
+ * <code>ordered_strings</code> instead).
+ *
+ * @param doc non-null document
+ * @return <code>true</code> in case of success, otherwise <code>false</code>
+ */
+NG5_EXPORT(bool) columndoc_order_string_ids(struct columndoc *doc);
+
 NG5_EXPORT(bool) columndoc_print(FILE *file, struct columndoc *doc);
 
 NG5_EXPORT(bool) columndoc_drop(struct columndoc *doc);
@@ -38,7 +38,9 @@ struct doc_entries {
 
 struct doc_bulk {
         struct strdic *dic;
-        struct vector ofType(char *) keys, values;
+        /** all key and value strings of the bulk; lengths and hash codes are computed once when a string is copied
+         * into the bulk, and handed to the dictionary as they are */
+        struct vector ofType(struct string_key) keys, values;
         struct vector ofType(struct doc) models;
 };
 
@@ -92,6 +94,11 @@ NG5_EXPORT(struct doc_obj *)doc_entries_get_root(const struct doc_entries *parti
 NG5_EXPORT(struct columndoc *)doc_entries_columndoc(const struct doc_bulk *bulk, const struct doc_entries *partition,
         bool read_optimized);
 
+/** Like <code>doc_entries_columndoc</code>, but the documents always form the object array "/", even if
+ * <code>partition</code> holds a single document */
+NG5_EXPORT(struct columndoc *)doc_entries_columndoc_array(const struct doc_bulk *bulk,
+        const struct doc_entries *partition, bool read_optimized);
+
 NG5_EXPORT(bool) doc_entries_drop(struct doc_entries *partition);
 
 NG5_END_DECL
@@ -216,7 +216,8 @@ ng5_func_unused static const char *basic_type_to_system_type_str(enum field_type
 #endif
 
 #define CARBON_ARCHIVE_MAGIC                "MP/CARBON"
-#define CARBON_ARCHIVE_VERSION               1
+#define CARBON_ARCHIVE_VERSION               5
+#define CARBON_ARCHIVE_VERSION_MIN           1    /** oldest readable version; version 1 links its string table */
 
 #define  MARKER_SYMBOL_OBJECT_BEGIN        '{'
 #define  MARKER_SYMBOL_OBJECT_END          '}'
@@ -246,10 +247,15 @@ ng5_func_unused static const char *basic_type_to_system_type_str(enum field_type
 #define  MARKER_SYMBOL_PROP_REAL_ARRAY     'F'
 #define  MARKER_SYMBOL_PROP_TEXT_ARRAY     'T'
 #define  MARKER_SYMBOL_PROP_OBJECT_ARRAY   'O'
+#define  MARKER_SYMBOL_PROP_OBJECT_ARRAY_STREAM 'W'
 #define  MARKER_SYMBOL_EMBEDDED_STR_DIC    'D'
 #define  MARKER_SYMBOL_EMBEDDED_STR        '-'
+#define  MARKER_SYMBOL_EMBEDDED_STR_TAB    'P'
 #define  MARKER_SYMBOL_COLUMN_GROUP        'X'
 #define  MARKER_SYMBOL_COLUMN              'x'
+#define  MARKER_SYMBOL_COLUMN_PACKED       'y'
+#define  MARKER_SYMBOL_ROW_GROUP           'Z'
+#define  MARKER_SYMBOL_ZONE_MAP            'z'
 #define  MARKER_SYMBOL_HUFFMAN_DIC_ENTRY   'd'
 #define  MARKER_SYMBOL_RECORD_HEADER       'r'
 #define  MARKER_SYMBOL_HASHTABLE_HEADER    '#'
@@ -67,6 +67,12 @@ typedef float field_number_t;
 
 typedef const char *FIELD_STRING_t;
 
+/* a non-owning reference to a string of 'len' bytes, e.g., inside a string dictionary */
+struct string_view {
+        const char *str;
+        u32 len;
+};
+
 #define NG5_NULL_ENCODED_STRING            0
 #define NG5_NULL_BOOLEAN                   INT8_MAX
 #define NG5_NULL_INT8                      INT8_MAX
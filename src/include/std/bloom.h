@@ -18,58 +18,148 @@
 #ifndef NG5_BLOOM_H
 #define NG5_BLOOM_H
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NG5_BLOOM_HAS_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define NG5_BLOOM_HAS_SSE2
+#endif
+
 #include "shared/common.h"
-#include "bitmap.h"
+#include "shared/types.h"
 
 NG5_BEGIN_DECL
 
-typedef struct bitmap bloom_t;
+/** number of 32bit words per block, i.e., 256 bits that are always inside a single cache line */
+#define NG5_BLOOM_BLOCK_WORDS 8
+
+/** number of bits set per key, i.e., one bit in each word of a block */
+#define NG5_BLOOM_NHASHS      NG5_BLOOM_BLOCK_WORDS
+
+/**
+ * A split-block Bloom filter. A single 64bit hash of a key determines one block (by its higher half), and one bit
+ * in each of the words of that block (by its lower half multiplied with per-word odd constants). Hence, setting or
+ * testing a key touches exactly one cache line, and is done by one (or two) vector operations if SIMD is available.
+ */
+typedef struct bloom {
+        u32 *blocks;
+        size_t num_blocks;
+} bloom_t;
+
+static const u32 NG5_BLOOM_SALT[NG5_BLOOM_BLOCK_WORDS] = {
+        0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+/**
+ * 64bit FNV-1a over the key bytes followed by the Murmur3 finalizer such that all output bits depend on all input
+ * bits (block index and in-block bit positions are taken from different parts of the hash)
+ */
+static inline u64 bloom_hash(const void *key, size_t key_size)
+{
+        const unsigned char *bytes = (const unsigned char *) key;
+        u64 hash = 0xcbf29ce484222325ULL;
+        for (size_t k = 0; k < key_size; k++) {
+                hash = (hash ^ bytes[k]) * 0x100000001b3ULL;
+        }
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return hash;
+}
+
+static inline u32 *bloom_block(const bloom_t *filter, u64 hash)
+{
+        /** maps the higher half of the hash to [0, num_blocks) without a division */
+        size_t block_idx = (size_t) (((hash >> 32) * (u64) filter->num_blocks) >> 32);
+        return filter->blocks + block_idx * NG5_BLOOM_BLOCK_WORDS;
+}
+
+#if defined(NG5_BLOOM_HAS_AVX2)
+
+static inline __m256i bloom_mask(u32 hash)
+{
+        const __m256i salt = _mm256_loadu_si256((const __m256i *) NG5_BLOOM_SALT);
+        __m256i positions = _mm256_srli_epi32(_mm256_mullo_epi32(salt, _mm256_set1_epi32(hash)), 27);
+        return _mm256_sllv_epi32(_mm256_set1_epi32(1), positions);
+}
+
+static inline bool bloom_test_hash(const bloom_t *filter, u64 hash)
+{
+        const __m256i *block = (const __m256i *) bloom_block(filter, hash);
+        return _mm256_testc_si256(_mm256_load_si256(block), bloom_mask((u32) hash));
+}
+
+static inline void bloom_set_hash(bloom_t *filter, u64 hash)
+{
+        __m256i *block = (__m256i *) bloom_block(filter, hash);
+        _mm256_store_si256(block, _mm256_or_si256(_mm256_load_si256(block), bloom_mask((u32) hash)));
+}
+
+#else
+
+static inline void bloom_mask(u32 mask[NG5_BLOOM_BLOCK_WORDS], u32 hash)
+{
+        for (u32 k = 0; k < NG5_BLOOM_BLOCK_WORDS; k++) {
+                mask[k] = 1U << ((hash * NG5_BLOOM_SALT[k]) >> 27);
+        }
+}
+
+static inline bool bloom_test_hash(const bloom_t *filter, u64 hash)
+{
+        const u32 *block = bloom_block(filter, hash);
+        u32 mask[NG5_BLOOM_BLOCK_WORDS];
+        bloom_mask(mask, (u32) hash);
+#if defined(NG5_BLOOM_HAS_SSE2)
+        __m128i lo = _mm_andnot_si128(_mm_load_si128((const __m128i *) block),
+                _mm_loadu_si128((const __m128i *) mask));
+        __m128i hi = _mm_andnot_si128(_mm_load_si128((const __m128i *) block + 1),
+                _mm_loadu_si128((const __m128i *) mask + 1));
+        return _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_or_si128(lo, hi), _mm_setzero_si128())) == 0xFFFF;
+#else
+        u32 missing = 0;
+        for (u32 k = 0; k < NG5_BLOOM_BLOCK_WORDS; k++) {
+                missing |= mask[k] & ~block[k];
+        }
+        return missing == 0;
+#endif
+}
+
+static inline void bloom_set_hash(bloom_t *filter, u64 hash)
+{
+        u32 *block = bloom_block(filter, hash);
+        u32 mask[NG5_BLOOM_BLOCK_WORDS];
+        bloom_mask(mask, (u32) hash);
+        for (u32 k = 0; k < NG5_BLOOM_BLOCK_WORDS; k++) {
+                block[k] |= mask[k];
+        }
+}
+
+#endif
+
+static inline bool bloom_test_and_set_hash(bloom_t *filter, u64 hash)
+{
+        bool contained = bloom_test_hash(filter, hash);
+        if (!contained) {
+                bloom_set_hash(filter, hash);
+        }
+        return contained;
+}
 
 #define NG5_BLOOM_SET(filter, key, keySize)                 \
-({                                                          \
-    size_t nbits = bitmap_nbits(filter);                    \
-    size_t b0 = NG5_HASH_ADDITIVE(keySize, key) % nbits;    \
-    size_t b1 = NG5_HASH_XOR(keySize, key) % nbits;         \
-    size_t b2 = NG5_HASH_ROT(keySize, key) % nbits;         \
-    size_t b3 = NG5_HASH_SAX(keySize, key) % nbits;         \
-    bitmap_set(filter, b0, true);                           \
-    bitmap_set(filter, b1, true);                           \
-    bitmap_set(filter, b2, true);                           \
-    bitmap_set(filter, b3, true);                           \
-})
+        bloom_set_hash(filter, bloom_hash(key, keySize))
 
 #define NG5_BLOOM_TEST(filter, key, keySize)                \
-({                                                          \
-    size_t nbits = bitmap_nbits(filter);                    \
-    size_t b0 = NG5_HASH_ADDITIVE(keySize, key) % nbits;    \
-    size_t b1 = NG5_HASH_XOR(keySize, key) % nbits;         \
-    size_t b2 = NG5_HASH_ROT(keySize, key) % nbits;         \
-    size_t b3 = NG5_HASH_SAX(keySize, key) % nbits;         \
-    bool b0set = bitmap_get(filter, b0);                    \
-    bool b1set = bitmap_get(filter, b1);                    \
-    bool b2set = bitmap_get(filter, b2);                    \
-    bool b3set = bitmap_get(filter, b3);                    \
-    (b0set && b1set && b2set && b3set);                     \
-})
+        bloom_test_hash(filter, bloom_hash(key, keySize))
 
 #define NG5_BLOOM_TEST_AND_SET(filter, key, keySize)        \
-({                                                          \
-    size_t nbits = bitmap_nbits(filter);                    \
-    size_t b0 = NG5_HASH_ADDITIVE(keySize, key) % nbits;    \
-    size_t b1 = NG5_HASH_XOR(keySize, key) % nbits;         \
-    size_t b2 = NG5_HASH_ROT(keySize, key) % nbits;         \
-    size_t b3 = NG5_HASH_SAX(keySize, key) % nbits;         \
-    bool b0set = bitmap_get(filter, b0);                    \
-    bool b1set = bitmap_get(filter, b1);                    \
-    bool b2set = bitmap_get(filter, b2);                    \
-    bool b3set = bitmap_get(filter, b3);                    \
-    bitmap_set(filter, b0, true);                           \
-    bitmap_set(filter, b1, true);                           \
-    bitmap_set(filter, b2, true);                           \
-    bitmap_set(filter, b3, true);                           \
-    (b0set && b1set && b2set && b3set);                     \
-})
+        bloom_test_and_set_hash(filter, bloom_hash(key, keySize))
 
+/**
+ * Constructs a filter with at least 'size' bits (rounded up to whole blocks).
+ */
 NG5_EXPORT(bool) bloom_create(bloom_t *filter, size_t size);
 
 NG5_EXPORT(bool) bloom_drop(bloom_t *filter);
@@ -80,6 +170,13 @@ NG5_EXPORT(size_t) bloom_nbits(bloom_t *filter);
 
 NG5_EXPORT(unsigned) bloom_nhashs();
 
+/**
+ * Returns the expected false-positive probability of a filter with 'num_bits' bits after inserting 'num_keys'
+ * keys. Since keys of a block compete for its bits, the estimate is averaged over the Poisson-distributed number of
+ * keys per block rather than using the formula for non-blocked filters.
+ */
+NG5_EXPORT(double) bloom_fpr(size_t num_bits, size_t num_keys);
+
 NG5_END_DECL
 
-#endif
\ No newline at end of file
+#endif
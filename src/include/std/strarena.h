@@ -0,0 +1,124 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NG5_STRARENA_H
+#define NG5_STRARENA_H
+
+#include <assert.h>
+
+#include "shared/common.h"
+#include "shared/types.h"
+#include "core/alloc/alloc.h"
+
+NG5_BEGIN_DECL
+
+#define STRARENA_MAX_BLOCKS 32
+
+/**
+ * 32bit position of a string inside a string arena
+ */
+typedef u32 strarena_off_t;
+
+/**
+ * An append-only arena for strings. Strings are stored back-to-back as a 32bit length prefix followed by the string
+ * bytes (including a terminating '\0'), and are addressed by the 32bit byte offset of their prefix. The arena grows by
+ * blocks of doubling size that are never moved, i.e., pointers to strings remain valid until the arena is dropped.
+ * Space of strings is not reclaimed before that.
+ */
+struct strarena {
+        /**
+         * Memory allocator that is used to get memory for blocks
+         */
+        struct allocator alloc;
+
+        /**
+         * Block 'k' stores bytes from offset <code>((1 << k) - 1) << first_bits</code> on, and has a size of
+         * <code>1 << (first_bits + k)</code> bytes
+         */
+        char *blocks[STRARENA_MAX_BLOCKS];
+
+        /**
+         * Log2 of the size of the first block
+         */
+        u32 first_bits;
+
+        /**
+         * Offset at which the next string is appended
+         */
+        u64 cursor;
+
+        /**
+         *  Error information
+         */
+        struct err err;
+};
+
+/**
+ * Constructs a new arena with an initial block of at least 'capacity' bytes.
+ *
+ * @param arena non-null arena that should be constructed
+ * @param capacity number of bytes for which memory should be reserved
+ * @param alloc allocator to be used, or <code>NULL</code> for the standard allocator
+ * @return <code>true</code> in case of success, otherwise <code>false</code>
+ */
+NG5_EXPORT(bool) strarena_create(struct strarena *arena, size_t capacity, const struct allocator *alloc);
+
+NG5_EXPORT(bool) strarena_drop(struct strarena *arena);
+
+/**
+ * Copies the first 'len' bytes of 'str' into the arena. The copy is terminated by '\0'.
+ *
+ * @param out non-null pointer to the offset under which the copy is stored
+ * @param arena non-null arena
+ * @param str string to be copied (it may contain '\0')
+ * @param len number of bytes of 'str' to be copied
+ * @return <code>true</code> in case of success, and <code>false</code> if the arena cannot grow any further
+ */
+NG5_EXPORT(bool) strarena_append(strarena_off_t *out, struct strarena *arena, const char *str, u32 len);
+
+/**
+ * Returns the number of bytes occupied by strings in this arena (including prefixes and padding).
+ */
+NG5_EXPORT(size_t) strarena_size(const struct strarena *arena);
+
+static inline const char *strarena_prefix(const struct strarena *arena, strarena_off_t off)
+{
+        u32 block_idx = 63 - __builtin_clzll(((u64) off >> arena->first_bits) + 1);
+        u64 block_begin = (((u64) 1 << block_idx) - 1) << arena->first_bits;
+        assert(block_idx < STRARENA_MAX_BLOCKS && arena->blocks[block_idx]);
+        return arena->blocks[block_idx] + (off - block_begin);
+}
+
+/**
+ * Returns the '\0'-terminated string stored at 'off'.
+ */
+static inline const char *strarena_str(const struct strarena *arena, strarena_off_t off)
+{
+        return strarena_prefix(arena, off) + sizeof(u32);
+}
+
+/**
+ * Returns the length in bytes of the string stored at 'off' (excluding the terminating '\0').
+ */
+static inline u32 strarena_len(const struct strarena *arena, strarena_off_t off)
+{
+        return *(const u32 *) strarena_prefix(arena, off);
+}
+
+NG5_END_DECL
+
+#endif
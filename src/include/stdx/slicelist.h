@@ -23,7 +23,7 @@
 #include "std/bitmap.h"
 #include "core/async/spin.h"
 #include "std/bloom.h"
-#include "hash/hash.h"
+#include "hash/hashcode.h"
 #include "shared/types.h"
 
 NG5_BEGIN_DECL
@@ -44,6 +44,10 @@ NG5_FORWARD_STRUCT_DECL(Slice)
 #define NG5_SLICE_LIST_TARGET_MEMORY_SIZE_IN_BYTE (32768/10)
 #endif
 
+#ifndef NG5_SLICE_LIST_REORGANIZE_INTERVAL
+#define NG5_SLICE_LIST_REORGANIZE_INTERVAL 1024 /** number of lookups after which slices are re-ordered by hits */
+#endif
+
 #define SLICE_DATA_SIZE (NG5_SLICE_LIST_TARGET_MEMORY_SIZE_IN_BYTE - sizeof(slice_lookup_strat_e) - sizeof(u32))
 
 #define SLICE_KEY_COLUMN_MAX_ELEMS (SLICE_DATA_SIZE / 8 / 3) /** one array with elements of 64 bits each, 3 of them */
@@ -101,6 +105,13 @@ typedef struct NG5_slice_list_t {
         struct vector ofType(NG5_bloomfilter_t) filters;
         struct vector ofType(NG5_hash_bounds_t) bounds;
 
+        /** Permutation of slice indices in which slices are probed during lookup, ordered by descending number of
+         * hits (see 'SliceDescriptor') as of the last reorganization */
+        struct vector ofType(u32) order;
+
+        /** Number of lookups since the last reorganization of 'order' */
+        u32 num_lookups;
+
         u32 appender_idx;
 
         struct err err;
@@ -119,10 +130,17 @@ NG5_EXPORT(bool) SliceListDrop(slice_list_t *list);
 
 NG5_EXPORT(bool) slice_list_lookup(slice_handle_t *handle, slice_list_t *list, const char *needle);
 
+/** Like 'slice_list_lookup' but for a needle whose hash code is already known */
+NG5_EXPORT(bool) slice_list_lookup_key(slice_handle_t *handle, slice_list_t *list, const struct string_key *needle);
+
 NG5_EXPORT(bool) SliceListIsEmpty(const slice_list_t *list);
 
 NG5_EXPORT(bool) slice_list_insert(slice_list_t *list, char **strings, field_sid_t *ids, size_t npairs);
 
+/** Like 'slice_list_insert' but for keys whose hash codes are already known */
+NG5_EXPORT(bool) slice_list_insert_keys(slice_list_t *list, const struct string_key *keys, const field_sid_t *ids,
+        size_t npairs);
+
 NG5_EXPORT(bool) SliceListRemove(slice_list_t *list, slice_handle_t *handle);
 
 NG5_END_DECL
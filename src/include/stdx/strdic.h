@@ -23,7 +23,7 @@
 #include "shared/common.h"
 #include "core/alloc/alloc.h"
 #include "shared/types.h"
-#include "hash/hash.h"
+#include "hash/hashcode.h"
 #include "std/vec.h"
 
 NG5_BEGIN_DECL
@@ -34,7 +34,7 @@ NG5_FORWARD_STRUCT_DECL(Vector)
 struct strhash_counters;
 
 enum strdic_tag {
-        SYNC, ASYNC
+        SYNC, ASYNC, CONCURRENT
 };
 
 /**
@@ -70,6 +70,16 @@ struct strdic {
         */
         bool (*insert)(struct strdic *self, field_sid_t **out, char *const *strings, size_t nstrings, size_t nthreads);
 
+        /**
+         * Like <code>insert</code> but for strings whose lengths and hash codes are already known (see
+         * <code>struct string_key</code>), e.g., since they were computed once by the producer of the strings.
+         * Keys are neither measured nor hashed again by the dictionary or by its index.
+         *
+         * Note: Implementation must ensure thread-safeness
+         */
+        bool (*insert_keys)(struct strdic *self, field_sid_t **out, const struct string_key *keys, size_t nkeys,
+                size_t nthreads);
+
         /**
          * Removes a particular number of strings from this dictionary by their ids. The caller must ensure that
          * all string identifiers in <code>strings</code> are valid.
@@ -100,6 +110,15 @@ struct strdic {
          */
         char **(*extract)(struct strdic *self, const field_sid_t *ids, size_t num_ids);
 
+        /**
+         * Like <code>extract</code> but returns (pointer, length) views on the strings stored inside the dictionary
+         * rather than plain string pointers. Views remain valid until the dictionary is dropped or the strings are
+         * removed.
+         *
+         * Note: Implementation must ensure thread-safeness
+         */
+        struct string_view *(*extract_views)(struct strdic *self, const field_sid_t *ids, size_t num_ids);
+
         /**
          * Frees up memory allocated inside a function call via the allocator given in the constructor
          *
@@ -151,6 +170,16 @@ static bool strdic_insert(struct strdic *dic, field_sid_t **out, char *const *st
         return dic->insert(dic, out, strings, nstrings, nthreads);
 }
 
+ng5_func_unused
+static bool strdic_insert_keys(struct strdic *dic, field_sid_t **out, const struct string_key *keys, size_t nkeys,
+        size_t nthreads)
+{
+        error_if_null(dic);
+        error_if_null(keys);
+        assert(dic->insert_keys);
+        return dic->insert_keys(dic, out, keys, nkeys, nthreads);
+}
+
 ng5_func_unused
 static bool strdic_reset_counters(struct strdic *dic)
 {
@@ -205,6 +234,12 @@ static char **strdic_extract(struct strdic *dic, const field_sid_t *ids, size_t
         return dic->extract(dic, ids, nids);
 }
 
+ng5_func_unused
+static struct string_view *strdic_extract_views(struct strdic *dic, const field_sid_t *ids, size_t nids)
+{
+        return dic->extract_views(dic, ids, nids);
+}
+
 ng5_func_unused
 static bool strdic_free(struct strdic *dic, void *ptr)
 {
@@ -50,7 +50,7 @@
 #include "core/alloc/alloc.h"
 #include "std/vec.h"
 
-#include "hash/hash.h"
+#include "hash/hashcode.h"
 #include "shared/types.h"
 
 NG5_BEGIN_DECL
@@ -80,10 +80,20 @@ NG5_BEGIN_DECL
 #define NG5_CONFIG_BUCKET_CAPACITY  1024
 #endif
 
+/**
+ * Backend used for indexes of string dictionaries. By default, the open addressing table (see
+ * 'strhash_create_swiss') is used. To use the bucket table based on slice lists (see 'strhash_create_inmemory')
+ * instead, set 'NG5_CONFIG_STRHASH_SLICED' symbol
+ */
+#ifdef NG5_CONFIG_STRHASH_SLICED
+#define NG5_STRHASH_USE_SLICED
+#endif
+
 struct strhash;
 
 enum strhash_tag {
-        MEMORY_RESIDENT
+        MEMORY_RESIDENT,
+        MEMORY_RESIDENT_SWISS
 };
 
 struct strhash_counters {
@@ -157,6 +167,23 @@ struct strhash {
          */
         int (*get_fast)(struct strhash *self, field_sid_t **out, char *const *keys, size_t nkeys);
 
+        /**
+         * Same as 'put_exact_fast' but for a key whose length and hash code are already known
+         */
+        int (*put_exact_fast_key)(struct strhash *self, const struct string_key *key, field_sid_t value);
+
+        /**
+         * Same as 'get_bulk_safe' but for keys whose lengths and hash codes are already known
+         */
+        int (*get_bulk_safe_keys)(struct strhash *self, field_sid_t **out, bool **found_mask, size_t *nnot_found,
+                const struct string_key *keys, size_t nkeys);
+
+        /**
+         * Same as 'get_exact_safe' but for a key whose length and hash code are already known
+         */
+        int (*get_exact_safe_key)(struct strhash *self, field_sid_t *out, bool *found_mask,
+                const struct string_key *key);
+
         /**
          * Updates keys associated with <code>values</code> in this parallel_map_exec. All values <u>must</u> exist, and the
          * mapping between keys and values must be bidirectional.
@@ -297,6 +324,19 @@ inline static int strhash_put_exact_fast(struct strhash *parallel_map_exec, cons
         return parallel_map_exec->put_exact_fast(parallel_map_exec, key, value);
 }
 
+/**
+ * Same as 'strhash_put_exact_fast' but for a key whose length and hash code are already known
+ */
+inline static int strhash_put_exact_fast_key(struct strhash *parallel_map_exec, const struct string_key *key,
+        field_sid_t value)
+{
+        error_if_null(parallel_map_exec);
+        error_if_null(key);
+        assert(parallel_map_exec->put_exact_fast_key);
+
+        return parallel_map_exec->put_exact_fast_key(parallel_map_exec, key, value);
+}
+
 /**
  * Get the values associated with <code>keys</code> in this parallel_map_exec (if any). In case one <code>key</code> does not
  * exists, the function will return this information via the parameters <code>found_mask</code> and
@@ -342,6 +382,37 @@ inline static int strhash_get_bulk_safe(field_sid_t **out, bool **found_mask, si
         return result;
 }
 
+/**
+ * Same as 'strhash_get_bulk_safe' but for keys whose lengths and hash codes are already known
+ */
+inline static int strhash_get_bulk_safe_keys(field_sid_t **out, bool **found_mask, size_t *num_not_found,
+        struct strhash *parallel_map_exec, const struct string_key *keys, size_t nkeys)
+{
+        error_if_null(out);
+        error_if_null(found_mask);
+        error_if_null(num_not_found);
+        error_if_null(parallel_map_exec);
+        error_if_null(keys);
+        assert(parallel_map_exec->get_bulk_safe_keys);
+
+        return parallel_map_exec->get_bulk_safe_keys(parallel_map_exec, out, found_mask, num_not_found, keys, nkeys);
+}
+
+/**
+ * Same as 'strhash_get_bulk_safe_exact' but for a key whose length and hash code are already known
+ */
+inline static int strhash_get_bulk_safe_exact_key(field_sid_t *out, bool *found, struct strhash *parallel_map_exec,
+        const struct string_key *key)
+{
+        error_if_null(out);
+        error_if_null(found);
+        error_if_null(parallel_map_exec);
+        error_if_null(key);
+        assert(parallel_map_exec->get_exact_safe_key);
+
+        return parallel_map_exec->get_exact_safe_key(parallel_map_exec, out, found, key);
+}
+
 inline static int strhash_get_bulk_safe_exact(field_sid_t *out, bool *found, struct strhash *parallel_map_exec,
         const char *key)
 {
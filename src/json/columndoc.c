@@ -28,6 +28,9 @@ static bool object_put(struct columndoc_obj *model, struct err *err, const struc
 
 static bool import_object(struct columndoc_obj *dst, struct err *err, const struct doc_obj *doc, struct strdic *dic);
 
+static bool import_object_array_root(struct columndoc_obj *dst, struct err *err, const struct doc_obj *root,
+        struct strdic *dic);
+
 static bool print_object(FILE *file, struct err *err, const struct columndoc_obj *object, struct strdic *dic);
 
 static const char *get_type_name(struct err *err, field_e type);
@@ -41,6 +44,14 @@ static struct columndoc_column *object_array_key_columns_find_or_new(
 static bool object_array_key_column_push(struct columndoc_column *col, struct err *err, const struct doc_entries *entry,
         u32 array_idx, struct strdic *dic, struct columndoc_obj *model);
 
+struct string_id_remap {
+        field_sid_t old_id;
+        field_sid_t new_id;
+};
+
+static void object_remap_string_ids(struct columndoc_obj *model, const struct string_id_remap *remap,
+        size_t num_remap);
+
 bool columndoc_create(struct columndoc *columndoc, struct err *err, const struct doc *doc, const struct doc_bulk *bulk,
         const struct doc_entries *entries, struct strdic *dic)
 {
@@ -52,6 +63,7 @@ bool columndoc_create(struct columndoc *columndoc, struct err *err, const struct
         columndoc->dic = dic;
         columndoc->doc = doc;
         columndoc->bulk = bulk;
+        columndoc->ordered_string_ids = false;
         error_init(&columndoc->err);
 
         const char *root_string = "/";
@@ -64,7 +76,11 @@ bool columndoc_create(struct columndoc *columndoc, struct err *err, const struct
         strdic_free(dic, rootId);
 
         const struct doc_obj *root = doc_entries_get_root(entries);
-        if (!import_object(&columndoc->columndoc, err, root, dic)) {
+        if (columndoc->root_is_array) {
+                if (!import_object_array_root(&columndoc->columndoc, err, root, dic)) {
+                        return false;
+                }
+        } else if (!import_object(&columndoc->columndoc, err, root, dic)) {
                 return false;
         }
 
@@ -273,6 +289,71 @@ bool columndoc_free(struct columndoc *doc)
 {
         error_if_null(doc);
         object_meta_model_free(&doc->columndoc);
+        if (doc->ordered_string_ids) {
+                vec_drop(&doc->ordered_strings);
+        }
+        return true;
+}
+
+struct string_with_id {
+        const char *str;
+        field_sid_t id;
+};
+
+static int compare_string_with_id(const void *lhs, const void *rhs)
+{
+        return strcmp(((const struct string_with_id *) lhs)->str, ((const struct string_with_id *) rhs)->str);
+}
+
+static int compare_remap_by_old_id(const void *lhs, const void *rhs)
+{
+        field_sid_t a = ((const struct string_id_remap *) lhs)->old_id;
+        field_sid_t b = ((const struct string_id_remap *) rhs)->old_id;
+        return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+bool columndoc_order_string_ids(struct columndoc *doc)
+{
+        error_if_null(doc);
+        if (doc->ordered_string_ids) {
+                return true;
+        }
+
+        struct vector ofType (const char *) *strings;
+        struct vector ofType(field_sid_t) *string_ids;
+        ng5_check_success(doc_bulk_get_dic_contents(&strings, &string_ids, doc->bulk));
+
+        /** sort distinct strings lexicographically; the null string keeps its id */
+        size_t num_strings = 0;
+        struct string_with_id *sorted = malloc(ng5_max(1, strings->num_elems) * sizeof(struct string_with_id));
+        for (size_t i = 0; i < strings->num_elems; i++) {
+                field_sid_t id = *vec_get(string_ids, i, field_sid_t);
+                if (likely(id != NG5_NULL_ENCODED_STRING)) {
+                        sorted[num_strings++] = (struct string_with_id) {
+                                .str = *vec_get(strings, i, const char *), .id = id
+                        };
+                }
+        }
+        qsort(sorted, num_strings, sizeof(struct string_with_id), compare_string_with_id);
+
+        /** the i-th string in that order gets id i + 1, and lookups of old ids are served by binary search */
+        struct string_id_remap *remap = malloc(ng5_max(1, num_strings) * sizeof(struct string_id_remap));
+        vec_create(&doc->ordered_strings, NULL, sizeof(const char *), ng5_max(1, num_strings));
+        for (size_t i = 0; i < num_strings; i++) {
+                vec_push(&doc->ordered_strings, &sorted[i].str, 1);
+                remap[i] = (struct string_id_remap) {.old_id = sorted[i].id, .new_id = i + 1};
+        }
+        qsort(remap, num_strings, sizeof(struct string_id_remap), compare_remap_by_old_id);
+
+        object_remap_string_ids(&doc->columndoc, remap, num_strings);
+        doc->ordered_string_ids = true;
+
+        free(sorted);
+        free(remap);
+        vec_drop(strings);
+        vec_drop(string_ids);
+        free(strings);
+        free(string_ids);
         return true;
 }
 
@@ -1399,4 +1480,115 @@ static bool import_object(struct columndoc_obj *dst, struct err *err, const stru
                 }
         }
         return true;
-}
\ No newline at end of file
+}
+/* other than 'import_object', imports a single document of the root as object array of length one */
+static bool import_object_array_root(struct columndoc_obj *dst, struct err *err, const struct doc_obj *root,
+        struct strdic *dic)
+{
+        const struct vector ofType(struct doc_entries) *objectEntries = doc_get_entries(root);
+        const struct doc_entries *entries = vec_all(objectEntries, struct doc_entries);
+        for (size_t i = 0; i < objectEntries->num_elems; i++) {
+                const struct doc_entries *entry = entries + i;
+                if (entry->type == FIELD_OBJECT && entry->values.num_elems == 1) {
+                        field_sid_t *key_id;
+                        strdic_locate_fast(&key_id, dic, (char *const *) &entry->key, 1);
+                        bool status = object_put_array(dst, err, entry, dic, key_id);
+                        strdic_free(dic, key_id);
+                        if (!status) {
+                                return false;
+                        }
+                } else if (!object_put(dst, err, entry, dic)) {
+                        return false;
+                }
+        }
+        return true;
+}
+
+static field_sid_t remap_string_id(field_sid_t id, const struct string_id_remap *remap, size_t num_remap)
+{
+        if (id == NG5_NULL_ENCODED_STRING) {
+                return id;
+        }
+        struct string_id_remap key = {.old_id = id};
+        const struct string_id_remap *found = bsearch(&key, remap, num_remap, sizeof(struct string_id_remap),
+                compare_remap_by_old_id);
+        assert(found);
+        return found ? found->new_id : NG5_NULL_ENCODED_STRING;
+}
+
+static void remap_string_id_vector(struct vector ofType(field_sid_t) *ids, const struct string_id_remap *remap,
+        size_t num_remap)
+{
+        field_sid_t *data = vec_all(ids, field_sid_t);
+        for (size_t i = 0; i < ids->num_elems; i++) {
+                data[i] = remap_string_id(data[i], remap, num_remap);
+        }
+}
+
+static void object_remap_string_ids(struct columndoc_obj *model, const struct string_id_remap *remap,
+        size_t num_remap)
+{
+        model->parent_key = remap_string_id(model->parent_key, remap, num_remap);
+
+        remap_string_id_vector(&model->bool_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->int8_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->int16_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->int32_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->int64_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->uint8_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->uint16_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->uin32_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->uint64_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->string_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->float_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->null_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->obj_prop_keys, remap, num_remap);
+
+        remap_string_id_vector(&model->bool_array_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->int8_array_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->int16_array_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->int32_array_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->int64_array_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->uint8_array_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->uint16_array_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->uint32_array_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->uint64_array_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->string_array_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->float_array_prop_keys, remap, num_remap);
+        remap_string_id_vector(&model->null_array_prop_keys, remap, num_remap);
+
+        remap_string_id_vector(&model->string_prop_vals, remap, num_remap);
+        for (size_t i = 0; i < model->string_array_prop_vals.num_elems; i++) {
+                struct vector *values = vec_get(&model->string_array_prop_vals, i, struct vector);
+                remap_string_id_vector(values, remap, num_remap);
+        }
+
+        for (size_t i = 0; i < model->obj_prop_vals.num_elems; i++) {
+                struct columndoc_obj *nested = vec_get(&model->obj_prop_vals, i, struct columndoc_obj);
+                object_remap_string_ids(nested, remap, num_remap);
+        }
+
+        for (size_t i = 0; i < model->obj_array_props.num_elems; i++) {
+                struct columndoc_group *group = vec_get(&model->obj_array_props, i, struct columndoc_group);
+                group->key = remap_string_id(group->key, remap, num_remap);
+                for (size_t j = 0; j < group->columns.num_elems; j++) {
+                        struct columndoc_column *column = vec_get(&group->columns, j, struct columndoc_column);
+                        column->key_name = remap_string_id(column->key_name, remap, num_remap);
+                        if (column->type != FIELD_STRING && column->type != FIELD_OBJECT) {
+                                continue;
+                        }
+                        for (size_t k = 0; k < column->values.num_elems; k++) {
+                                struct vector *values = vec_get(&column->values, k, struct vector);
+                                if (column->type == FIELD_STRING) {
+                                        remap_string_id_vector(values, remap, num_remap);
+                                } else {
+                                        for (size_t l = 0; l < values->num_elems; l++) {
+                                                struct columndoc_obj *nested =
+                                                        vec_get(values, l, struct columndoc_obj);
+                                                object_remap_string_ids(nested, remap, num_remap);
+                                        }
+                                }
+                        }
+                }
+        }
+}
@@ -44,8 +44,8 @@ NG5_EXPORT(bool) doc_bulk_create(struct doc_bulk *bulk, struct strdic *dic)
         error_if_null(bulk)
         error_if_null(dic)
         bulk->dic = dic;
-        vec_create(&bulk->keys, NULL, sizeof(char *), 500);
-        vec_create(&bulk->values, NULL, sizeof(char *), 1000);
+        vec_create(&bulk->keys, NULL, sizeof(struct string_key), 500);
+        vec_create(&bulk->values, NULL, sizeof(struct string_key), 1000);
         vec_create(&bulk->models, NULL, sizeof(struct doc), 50);
         return true;
 }
@@ -103,12 +103,12 @@ NG5_EXPORT(bool) doc_bulk_Drop(struct doc_bulk *bulk)
 {
         error_if_null(bulk)
         for (size_t i = 0; i < bulk->keys.num_elems; i++) {
-                char *string = *vec_get(&bulk->keys, i, char *);
-                free(string);
+                struct string_key *key = vec_get(&bulk->keys, i, struct string_key);
+                free((char *) key->str);
         }
         for (size_t i = 0; i < bulk->values.num_elems; i++) {
-                char *string = *vec_get(&bulk->values, i, char *);
-                free(string);
+                struct string_key *value = vec_get(&bulk->values, i, struct string_key);
+                free((char *) value->str);
         }
         for (size_t i = 0; i < bulk->models.num_elems; i++) {
                 struct doc *model = vec_get(&bulk->models, i, struct doc);
@@ -139,17 +139,17 @@ NG5_EXPORT(bool) doc_bulk_print(FILE *file, struct doc_bulk *bulk)
         error_if_null(bulk)
 
         fprintf(file, "{");
-        char **key_strings = vec_all(&bulk->keys, char *);
+        const struct string_key *key_strings = vec_all(&bulk->keys, struct string_key);
         fprintf(file, "\"Key Strings\": [");
         for (size_t i = 0; i < bulk->keys.num_elems; i++) {
-                fprintf(file, "\"%s\"%s", key_strings[i], i + 1 < bulk->keys.num_elems ? ", " : "");
+                fprintf(file, "\"%s\"%s", key_strings[i].str, i + 1 < bulk->keys.num_elems ? ", " : "");
         }
         fprintf(file, "], ");
 
-        char **valueStrings = vec_all(&bulk->values, char *);
+        const struct string_key *valueStrings = vec_all(&bulk->values, struct string_key);
         fprintf(file, "\"Value Strings\": [");
         for (size_t i = 0; i < bulk->values.num_elems; i++) {
-                fprintf(file, "\"%s\"%s", valueStrings[i], i + 1 < bulk->values.num_elems ? ", " : "");
+                fprintf(file, "\"%s\"%s", valueStrings[i].str, i + 1 < bulk->values.num_elems ? ", " : "");
         }
         fprintf(file, "]}");
 
@@ -201,6 +201,21 @@ void doc_drop(struct doc_obj *model)
         vec_drop(&model->entries);
 }
 
+/** copies 'string' (which may be NULL) into the bulk, and registers it along with its length and hash code */
+static char *bulk_push_string(struct vector ofType(struct string_key) *strings, const char *string)
+{
+        char *copy = NULL;
+        u32 len = 0;
+        if (string) {
+                len = strlen(string);
+                copy = malloc(len + 1);
+                memcpy(copy, string, len + 1);
+        }
+        struct string_key key = string_key_of_len(copy, len);
+        vec_push(strings, &key, 1);
+        return copy;
+}
+
 bool doc_obj_add_key(struct doc_entries **out, struct doc_obj *obj, const char *key, field_e type)
 {
         error_if_null(out)
@@ -208,12 +223,11 @@ bool doc_obj_add_key(struct doc_entries **out, struct doc_obj *obj, const char *
         error_if_null(key)
 
         size_t entry_idx;
-        char *key_dup = strdup(key);
+        char *key_dup = bulk_push_string(&obj->doc->context->keys, key);
 
         struct doc_entries entry_model = {.type = type, .key = key_dup, .context = obj};
 
         create_typed_vector(&entry_model);
-        vec_push(&obj->doc->context->keys, &key_dup, 1);
 
         entry_idx = vec_length(&obj->entries);
         vec_push(&obj->entries, &entry_model, 1);
@@ -233,8 +247,7 @@ bool doc_obj_push_primtive(struct doc_entries *entry, const void *value)
                 vec_push(&entry->values, &VALUE_NULL, 1);
                 break;
         case FIELD_STRING: {
-                char *string = value ? strdup((char *) value) : NULL;
-                vec_push(&entry->context->doc->context->values, &string, 1);
+                char *string = bulk_push_string(&entry->context->doc->context->values, (const char *) value);
                 vec_push(&entry->values, &string, 1);
         }
                 break;
@@ -1283,18 +1296,18 @@ static void sort_columndoc_entries(struct columndoc_obj *columndoc)
         }
 }
 
-struct columndoc *doc_entries_columndoc(const struct doc_bulk *bulk, const struct doc_entries *partition,
-        bool read_optimized)
+static struct columndoc *entries_to_columndoc(const struct doc_bulk *bulk, const struct doc_entries *partition,
+        bool read_optimized, bool root_is_array)
 {
         if (!bulk || !partition) {
                 return NULL;
         }
 
-        // Step 1: encode all strings at once in a bulk
-        char *const *key_strings = vec_all(&bulk->keys, char *);
-        char *const *valueStrings = vec_all(&bulk->values, char *);
-        strdic_insert(bulk->dic, NULL, key_strings, vec_length(&bulk->keys), 0);
-        strdic_insert(bulk->dic, NULL, valueStrings, vec_length(&bulk->values), 0);
+        // Step 1: encode all strings at once in a bulk; their hash codes are known since they were added to the bulk
+        const struct string_key *key_strings = vec_all(&bulk->keys, struct string_key);
+        const struct string_key *valueStrings = vec_all(&bulk->values, struct string_key);
+        strdic_insert_keys(bulk->dic, NULL, key_strings, vec_length(&bulk->keys), 0);
+        strdic_insert_keys(bulk->dic, NULL, valueStrings, vec_length(&bulk->values), 0);
 
         // Step 2: for each document doc, create a meta doc, and construct a binary compressed document
         const struct doc *models = vec_all(&bulk->models, struct doc);
@@ -1308,6 +1321,7 @@ struct columndoc *doc_entries_columndoc(const struct doc_bulk *bulk, const struc
 
         struct columndoc *columndoc = malloc(sizeof(struct columndoc));
         columndoc->read_optimized = read_optimized;
+        columndoc->root_is_array = root_is_array;
         struct err err;
         if (!columndoc_create(columndoc, &err, model, bulk, partition, bulk->dic)) {
                 error_print_and_abort(&err);
@@ -1324,6 +1338,18 @@ struct columndoc *doc_entries_columndoc(const struct doc_bulk *bulk, const struc
         return columndoc;
 }
 
+struct columndoc *doc_entries_columndoc(const struct doc_bulk *bulk, const struct doc_entries *partition,
+        bool read_optimized)
+{
+        return entries_to_columndoc(bulk, partition, read_optimized, false);
+}
+
+struct columndoc *doc_entries_columndoc_array(const struct doc_bulk *bulk, const struct doc_entries *partition,
+        bool read_optimized)
+{
+        return entries_to_columndoc(bulk, partition, read_optimized, true);
+}
+
 NG5_EXPORT(bool) doc_entries_drop(struct doc_entries *partition)
 {
         ng5_unused(partition);
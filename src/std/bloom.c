@@ -15,32 +15,62 @@
  * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <math.h>
+
 #include "std/bloom.h"
 
+#define BLOCK_BITS (NG5_BLOOM_BLOCK_WORDS * 32)
+
 NG5_EXPORT(bool) bloom_create(bloom_t *filter, size_t size)
 {
-        return bitmap_create(filter, size);
+        error_if_null(filter);
+        filter->num_blocks = ng5_max(1, (size + BLOCK_BITS - 1) / BLOCK_BITS);
+        /** blocks are aligned to their size, and hence never span two cache lines */
+        filter->blocks = aligned_alloc(BLOCK_BITS / 8, filter->num_blocks * BLOCK_BITS / 8);
+        error_if_null(filter->blocks);
+        return bloom_clear(filter);
 }
 
 NG5_EXPORT(bool) bloom_drop(bloom_t *filter)
 {
-        return bitmap_drop(filter);
+        error_if_null(filter);
+        free(filter->blocks);
+        filter->blocks = NULL;
+        return true;
 }
 
 NG5_EXPORT(bool) bloom_clear(bloom_t *filter)
 {
-        return bitmap_clear(filter);
+        error_if_null(filter);
+        memset(filter->blocks, 0, filter->num_blocks * BLOCK_BITS / 8);
+        return true;
 }
 
 size_t bloom_nbits(bloom_t *filter)
 {
-        return bitmap_nbits(filter);
+        return filter->num_blocks * BLOCK_BITS;
 }
 
 unsigned bloom_nhashs()
 {
-        return 4;
+        return NG5_BLOOM_NHASHS;
 }
 
+double bloom_fpr(size_t num_bits, size_t num_keys)
+{
+        double num_blocks = ng5_max(1, (num_bits + BLOCK_BITS - 1) / BLOCK_BITS);
+        double lambda = num_keys / num_blocks;
+        if (num_keys == 0) {
+                return 0;
+        }
 
-
+        /** sum over the probability of a block holding 'i' keys times the false-positive rate of such a block, where
+         * each key sets one out of 32 bits in each of the words */
+        double spread = 10 * sqrt(lambda) + 10;
+        double fpr = 0;
+        for (double i = floor(ng5_max(0, lambda - spread)); i <= lambda + spread; i++) {
+                double poisson = exp(i * log(lambda) - lambda - lgamma(i + 1));
+                fpr += poisson * pow(1 - pow(1 - 1.0 / 32, i), NG5_BLOOM_NHASHS);
+        }
+        return fpr;
+}
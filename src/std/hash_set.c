@@ -15,10 +15,10 @@
  * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#include "hash/bern.h"
+#include "hash/hashcode.h"
 #include "std/hash_set.h"
 
-#define HASHCODE_OF(size, x) NG5_HASH_BERNSTEIN(size, x)
+#define HASHCODE_OF(size, x) NG5_HASHCODE_OF(size, x)
 #define FIX_MAP_AUTO_REHASH_LOADFACTOR 0.9f
 
 NG5_EXPORT(bool) hashset_create(struct hashset *map, struct err *err, size_t key_size, size_t capacity)
@@ -173,6 +173,50 @@ static inline const void *get_bucket_key(const struct hashset_bucket *bucket, co
         return map->key_data.base + bucket->key_idx * map->key_data.elem_size;
 }
 
+/* probes linearly from the intended bucket of 'key' up to the first free bucket, which ends every probe sequence */
+static bool find_bucket(u32 *bucket_idx, const struct hashset *map, const void *key)
+{
+        u32 idx = HASHCODE_OF(map->key_data.elem_size, key) % map->table.num_elems;
+        for (u32 num_probes = 0; num_probes < map->table.num_elems; num_probes++) {
+                const struct hashset_bucket *bucket = vec_get(&map->table, idx, struct hashset_bucket);
+                if (!bucket->in_use_flag) {
+                        return false;
+                }
+                if (memcmp(get_bucket_key(bucket, map), key, map->key_data.elem_size) == 0) {
+                        *bucket_idx = idx;
+                        return true;
+                }
+                idx = (idx + 1) % map->table.num_elems;
+        }
+        return false;
+}
+
+/* frees the bucket at 'hole' and shifts its successors back, such that no probe sequence is cut by the free bucket */
+static void remove_bucket(struct hashset *map, u32 hole)
+{
+        u32 num_elems = map->table.num_elems;
+        struct hashset_bucket *empty = vec_get(&map->table, hole, struct hashset_bucket);
+        u32 next = (hole + 1) % num_elems;
+        struct hashset_bucket *bucket;
+
+        while ((bucket = vec_get(&map->table, next, struct hashset_bucket))->in_use_flag) {
+                u32 intended = HASHCODE_OF(map->key_data.elem_size, get_bucket_key(bucket, map)) % num_elems;
+                u32 distance = (next + num_elems - intended) % num_elems;
+                u32 distance_to_hole = (hole + num_elems - intended) % num_elems;
+                if (distance_to_hole < distance) {
+                        *empty = *bucket;
+                        empty->displacement = -(i32) distance_to_hole;
+                        empty = bucket;
+                        hole = next;
+                }
+                next = (next + 1) % num_elems;
+        }
+
+        empty->in_use_flag = false;
+        empty->displacement = 0;
+        empty->key_idx = 0;
+}
+
 static void insert(struct hashset_bucket *bucket, struct hashset *map, const void *key, i32 displacement)
 {
         u64 idx = map->key_data.num_elems;
@@ -193,54 +237,22 @@ static inline uint_fast32_t insert_or_update(struct hashset *map, const u32 *buc
 
                 u32 bucket_idx = intended_bucket_idx;
 
+                /* linear probing, wrapping around; the load factor guarantees that a free bucket exists */
                 struct hashset_bucket *bucket = vec_get(&map->table, bucket_idx, struct hashset_bucket);
-                if (bucket->in_use_flag && memcmp(get_bucket_key(bucket, map), key, map->key_data.elem_size) != 0) {
-                        bool fitting_bucket_found = false;
-                        u32 displace_idx;
-                        for (displace_idx = bucket_idx + 1; displace_idx < map->table.num_elems; displace_idx++) {
-                                struct hashset_bucket
-                                        *bucket = vec_get(&map->table, displace_idx, struct hashset_bucket);
-                                fitting_bucket_found = !bucket->in_use_flag || (bucket->in_use_flag
-                                        && memcmp(get_bucket_key(bucket, map), key, map->key_data.elem_size) == 0);
-                                if (fitting_bucket_found) {
-                                        break;
-                                } else {
-                                        i32 displacement = displace_idx - bucket_idx;
-                                        const void *swap_key = get_bucket_key(bucket, map);
-
-                                        if (bucket->displacement < displacement) {
-                                                insert(bucket, map, key, displacement);
-                                                insert_or_update(map, &displace_idx, swap_key, 1);
-                                                goto next_round;
-                                        }
-                                }
-                        }
-                        if (!fitting_bucket_found) {
-                                for (displace_idx = 0; displace_idx < bucket_idx - 1; displace_idx++) {
-                                        const struct hashset_bucket
-                                                *bucket = vec_get(&map->table, displace_idx, struct hashset_bucket);
-                                        fitting_bucket_found = !bucket->in_use_flag || (bucket->in_use_flag
-                                                && memcmp(get_bucket_key(bucket, map), key, map->key_data.elem_size)
-                                                        == 0);
-                                        if (fitting_bucket_found) {
-                                                break;
-                                        }
-                                }
-                        }
-
-                        assert(fitting_bucket_found == true);
-                        bucket_idx = displace_idx;
+                while (bucket->in_use_flag && memcmp(get_bucket_key(bucket, map), key, map->key_data.elem_size) != 0) {
+                        bucket_idx = (bucket_idx + 1) % map->table.num_elems;
+                        assert(bucket_idx != intended_bucket_idx);
                         bucket = vec_get(&map->table, bucket_idx, struct hashset_bucket);
                 }
 
                 bool is_update =
                         bucket->in_use_flag && memcmp(get_bucket_key(bucket, map), key, map->key_data.elem_size) == 0;
                 if (!is_update) {
-                        i32 displacement = intended_bucket_idx - bucket_idx;
+                        u32 distance = (bucket_idx + map->table.num_elems - intended_bucket_idx) % map->table.num_elems;
+                        i32 displacement = -(i32) distance;
                         insert(bucket, map, key, displacement);
                 }
 
-                next_round:
                 if (map->size >= FIX_MAP_AUTO_REHASH_LOADFACTOR * map->table.cap_elems) {
                         return i + 1; /* tell the caller that pair i was inserted, but it successors not */
                 }
@@ -300,46 +312,14 @@ NG5_EXPORT(bool) hashset_remove_if_contained(struct hashset *map, const void *ke
 
         hashset_lock(map);
 
-        u32 *bucket_idxs = malloc(num_pairs * sizeof(u32));
-        if (!bucket_idxs) {
-                error(&map->err, NG5_ERR_MALLOCERR);
-                hashset_unlock(map);
-                return false;
-        }
-
         for (uint_fast32_t i = 0; i < num_pairs; i++) {
                 const void *key = keys + i * map->key_data.elem_size;
-                bucket_idxs[i] = HASHCODE_OF(map->key_data.elem_size, key) % map->table.num_elems;
-        }
-
-        for (uint_fast32_t i = 0; i < num_pairs; i++) {
-                const void *key = keys + i * map->key_data.elem_size;
-                u32 bucket_idx = bucket_idxs[i];
-                u32 actual_idx = bucket_idx;
-                bool bucket_found = false;
-
-                for (u32 k = bucket_idx; !bucket_found && k < map->table.num_elems; k++) {
-                        const struct hashset_bucket *bucket = vec_get(&map->table, k, struct hashset_bucket);
-                        bucket_found = bucket->in_use_flag
-                                && memcmp(get_bucket_key(bucket, map), key, map->key_data.elem_size) == 0;
-                        actual_idx = k;
-                }
-                for (u32 k = 0; !bucket_found && k < bucket_idx; k++) {
-                        const struct hashset_bucket *bucket = vec_get(&map->table, k, struct hashset_bucket);
-                        bucket_found = bucket->in_use_flag
-                                && memcmp(get_bucket_key(bucket, map), key, map->key_data.elem_size) == 0;
-                        actual_idx = k;
-                }
-
-                if (bucket_found) {
-                        struct hashset_bucket *bucket = vec_get(&map->table, actual_idx, struct hashset_bucket);
-                        bucket->in_use_flag = false;
-                        bucket->key_idx = 0;
+                u32 bucket_idx;
+                if (find_bucket(&bucket_idx, map, key)) {
+                        remove_bucket(map, bucket_idx);
                 }
         }
 
-        free(bucket_idxs);
-
         hashset_unlock(map);
 
         return true;
@@ -354,19 +334,8 @@ NG5_EXPORT(bool) hashset_contains_key(struct hashset *map, const void *key)
 
         hashset_lock(map);
 
-        u32 bucket_idx = HASHCODE_OF(map->key_data.elem_size, key) % map->table.num_elems;
-        bool bucket_found = false;
-
-        for (u32 k = bucket_idx; !bucket_found && k < map->table.num_elems; k++) {
-                const struct hashset_bucket *bucket = vec_get(&map->table, k, struct hashset_bucket);
-                bucket_found =
-                        bucket->in_use_flag && memcmp(get_bucket_key(bucket, map), key, map->key_data.elem_size) == 0;
-        }
-        for (u32 k = 0; !bucket_found && k < bucket_idx; k++) {
-                const struct hashset_bucket *bucket = vec_get(&map->table, k, struct hashset_bucket);
-                bucket_found =
-                        bucket->in_use_flag && memcmp(get_bucket_key(bucket, map), key, map->key_data.elem_size) == 0;
-        }
+        u32 bucket_idx;
+        bool bucket_found = find_bucket(&bucket_idx, map, key);
 
         result = bucket_found;
         hashset_unlock(map);
@@ -0,0 +1,94 @@
+/**
+ * Copyright 2018 Marcus Pinnecke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "std/strarena.h"
+
+/** length prefixes are aligned to their size */
+#define PREFIX_ALIGN(x)         (((x) + sizeof(u32) - 1) & ~((u64) sizeof(u32) - 1))
+#define BLOCK_BEGIN(arena, k)   ((((u64) 1 << (k)) - 1) << (arena)->first_bits)
+#define BLOCK_SIZE(arena, k)    ((u64) 1 << ((arena)->first_bits + (k)))
+
+NG5_EXPORT(bool) strarena_create(struct strarena *arena, size_t capacity, const struct allocator *alloc)
+{
+        error_if_null(arena)
+        ng5_check_success(alloc_this_or_std(&arena->alloc, alloc));
+        error_init(&arena->err);
+
+        arena->first_bits = 12;
+        while (arena->first_bits < 24 && ((size_t) 1 << arena->first_bits) < capacity) {
+                arena->first_bits++;
+        }
+        arena->cursor = 0;
+        for (u32 i = 0; i < STRARENA_MAX_BLOCKS; i++) {
+                arena->blocks[i] = NULL;
+        }
+        arena->blocks[0] = alloc_malloc(&arena->alloc, BLOCK_SIZE(arena, 0));
+        error_if_null(arena->blocks[0])
+        return true;
+}
+
+NG5_EXPORT(bool) strarena_drop(struct strarena *arena)
+{
+        error_if_null(arena)
+        for (u32 i = 0; i < STRARENA_MAX_BLOCKS; i++) {
+                if (arena->blocks[i]) {
+                        alloc_free(&arena->alloc, arena->blocks[i]);
+                        arena->blocks[i] = NULL;
+                }
+        }
+        return true;
+}
+
+NG5_EXPORT(bool) strarena_append(strarena_off_t *out, struct strarena *arena, const char *str, u32 len)
+{
+        error_if_null(out)
+        error_if_null(arena)
+        error_if_null(str)
+
+        u64 need = sizeof(u32) + (u64) len + 1;
+        u64 begin = PREFIX_ALIGN(arena->cursor);
+        u32 block_idx = 63 - __builtin_clzll((begin >> arena->first_bits) + 1);
+
+        /** a string never spans two blocks; skip the remainder of blocks too small to hold it */
+        while (begin + need > BLOCK_BEGIN(arena, block_idx) + BLOCK_SIZE(arena, block_idx)) {
+                block_idx++;
+                begin = BLOCK_BEGIN(arena, block_idx);
+        }
+        if (unlikely(block_idx >= STRARENA_MAX_BLOCKS || begin > UINT32_MAX)) {
+                error(&arena->err, NG5_ERR_MALLOCERR)
+                return false;
+        }
+        if (arena->blocks[block_idx] == NULL) {
+                arena->blocks[block_idx] = alloc_malloc(&arena->alloc, BLOCK_SIZE(arena, block_idx));
+                error_if_null(arena->blocks[block_idx])
+        }
+
+        char *prefix = arena->blocks[block_idx] + (begin - BLOCK_BEGIN(arena, block_idx));
+        *(u32 *) prefix = len;
+        memcpy(prefix + sizeof(u32), str, len);
+        prefix[sizeof(u32) + len] = '\0';
+
+        arena->cursor = begin + need;
+        *out = (strarena_off_t) begin;
+        return true;
+}
+
+NG5_EXPORT(size_t) strarena_size(const struct strarena *arena)
+{
+        assert(arena);
+        return arena->cursor;
+}
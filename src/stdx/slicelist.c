@@ -18,15 +18,23 @@
 #include <assert.h>
 #include <math.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define SLICE_LIST_HAS_SSE2
+#endif
+
 #include "stdx/slicelist.h"
 #include "hash/add.h"
 #include "hash/xor.h"
 #include "hash/rot.h"
 #include "hash/sax.h"
+#include "hash/fnv.h"
+#include "hash/hashcode.h"
 
 #define NG5_SLICE_LIST_TAG "slice-list"
 
-#define get_hashcode(key)    NG5_HASH_ADDITIVE(strlen(key), key)
+/** number of hashes that remain for a vectorized scan after the binary search in a sealed slice */
+#define SLICE_BESEARCH_WINDOW 8
 
 /** OPTIMIZATION: we have only one item to find. Use branch-less scan instead of branching scan */
 /** OPTIMIZATION: find function as macro */
@@ -57,11 +65,16 @@
 
 #define SLICE_BESEARCH(slice, needle_hash, needle_str)                                                                 \
 ({                                                                                                                     \
-    0; \
+    ng5_trace(NG5_SLICE_LIST_TAG, "SLICE_BESEARCH for '%s' started", needle_str);                                \
+    assert(slice);                                                                                                     \
+    assert(needle_str);                                                                                                \
+    slice_besearch(slice, needle_hash, needle_str);                                                                    \
 })
 
 static void appenderNew(slice_list_t *list);
 static void appenderSeal(Slice *slice);
+static void reorganize(slice_list_t *list);
+static inline u32 slice_besearch(Slice *slice, hash32_t needle_hash, const char *needle_str);
 
 static void lock(slice_list_t *list);
 static void unlock(slice_list_t *list);
@@ -79,6 +92,8 @@ NG5_EXPORT(bool) slice_list_create(slice_list_t *list, const struct allocator *a
         vec_create(&list->descriptors, &list->alloc, sizeof(SliceDescriptor), sliceCapacity);
         vec_create(&list->filters, &list->alloc, sizeof(bloom_t), sliceCapacity);
         vec_create(&list->bounds, &list->alloc, sizeof(HashBounds), sliceCapacity);
+        vec_create(&list->order, &list->alloc, sizeof(u32), sliceCapacity);
+        list->num_lookups = 0;
 
         ng5_zero_memory(vec_data(&list->slices), sliceCapacity * sizeof(Slice));
         ng5_zero_memory(vec_data(&list->descriptors), sliceCapacity * sizeof(SliceDescriptor));
@@ -98,6 +113,7 @@ NG5_EXPORT(bool) SliceListDrop(slice_list_t *list)
         vec_drop(&list->slices);
         vec_drop(&list->descriptors);
         vec_drop(&list->bounds);
+        vec_drop(&list->order);
         for (size_t i = 0; i < list->filters.num_elems; i++) {
                 bloom_t *filter = vec_get(&list->filters, i, bloom_t);
                 bloom_drop(filter);
@@ -112,20 +128,32 @@ NG5_EXPORT(bool) SliceListIsEmpty(const slice_list_t *list)
 }
 
 NG5_EXPORT(bool) slice_list_insert(slice_list_t *list, char **strings, field_sid_t *ids, size_t num_pairs)
+{
+        for (size_t i = 0; i < num_pairs; i++) {
+                struct string_key key = string_key_of(strings[i]);
+                ng5_check_success(slice_list_insert_keys(list, &key, ids + i, 1));
+        }
+        return true;
+}
+
+NG5_EXPORT(bool) slice_list_insert_keys(slice_list_t *list, const struct string_key *keys, const field_sid_t *ids,
+        size_t num_pairs)
 {
         lock(list);
 
         while (num_pairs--) {
-                const char *key = *strings++;
+                const struct string_key *needle = keys++;
+                const char *key = needle->str;
                 field_sid_t value = *ids++;
-                hash32_t keyHash = get_hashcode(key);
+                hash32_t keyHash = needle->hash;
                 slice_handle_t handle;
                 int status;
 
                 assert (key);
 
-                /** check whether the keys-values pair is already contained in one slice */
-                status = slice_list_lookup(&handle, list, key);
+                /** check whether the keys-values pair is already contained in one slice; the hash computed by the
+                 * producer of the key is used for both the lookup and the appended entry */
+                status = slice_list_lookup_key(&handle, list, needle);
 
                 if (status == true) {
                         /** pair was found, do not insert it twice */
@@ -169,20 +197,29 @@ NG5_EXPORT(bool) slice_list_insert(slice_list_t *list, char **strings, field_sid
 
 NG5_EXPORT(bool) slice_list_lookup(slice_handle_t *handle, slice_list_t *list, const char *needle)
 {
-        ng5_unused(list);
-        ng5_unused(handle);
-        ng5_unused(needle);
+        struct string_key key = string_key_of(needle);
+        return slice_list_lookup_key(handle, list, &key);
+}
 
-        hash32_t keyHash = get_hashcode(needle);
+NG5_EXPORT(bool) slice_list_lookup_key(slice_handle_t *handle, slice_list_t *list, const struct string_key *needle_key)
+{
+        const char *needle = needle_key->str;
+        hash32_t keyHash = needle_key->hash;
         u32 numSlices = vec_length(&list->slices);
 
+        if (unlikely(++list->num_lookups == NG5_SLICE_LIST_REORGANIZE_INTERVAL)) {
+                reorganize(list);
+        }
+
         /** check whether the keys-values pair is already contained in one slice */
         HashBounds *restrict bounds = vec_all(&list->bounds, HashBounds);
         bloom_t *restrict filters = vec_all(&list->filters, bloom_t);
         Slice *restrict slices = vec_all(&list->slices, Slice);
         SliceDescriptor *restrict descs = vec_all(&list->descriptors, SliceDescriptor);
+        const u32 *restrict order = vec_all(&list->order, u32);
 
-        for (register u32 i = 0; i < numSlices; i++) {
+        for (register u32 k = 0; k < numSlices; k++) {
+                u32 i = order[k];
                 SliceDescriptor *restrict desc = descs + i;
                 HashBounds *restrict bound = bounds + i;
                 Slice *restrict slice = slices + i;
@@ -218,7 +255,6 @@ NG5_EXPORT(bool) slice_list_lookup(slice_handle_t *handle, slice_list_t *list, c
                                                 i);
                                         if (pairPosition < slice->num_elems) {
                                                 /** pair is contained */
-                                                desc->numReadsHit++;
                                                 handle->is_contained = true;
                                                 handle->value = slice->string_id_tColumn[pairPosition];
                                                 handle->key = needle;
@@ -267,13 +303,16 @@ static void appenderNew(slice_list_t *list)
 
         vec_push(&list->descriptors, &desc, 1);
 
+        /** new slices are probed last until they gained hits */
+        vec_push(&list->order, &numSlices, 1);
+
         /** the lookup guards */
         assert(sizeof(bloom_t) <= NG5_SLICE_LIST_BLOOMFILTER_TARGET_MEMORY_SIZE_IN_BYTE);
         bloom_t filter;
 
         /** NOTE: the size of each bloom_t lead to a false positive probability of 100%, i.e., number of items in the
          * slice is around 32644 depending on the CPU cache size, the number of actual bits in the filter (Cache line size
-         * in bits minus the header for the bloom_t) along with the number of used hash functions (4), lead to that
+         * in bits minus the header for the bloom_t) along with the number of bits set per key (8), lead to that
          * probability. However, the reason a bloom_t is used is to skip slices whch definitively do NOT contain the
          * keys-values pair - and that still works ;) */
         bloom_create(&filter, (NG5_SLICE_LIST_BLOOMFILTER_TARGET_MEMORY_SIZE_IN_BYTE - sizeof(bloom_t)) * 8);
@@ -298,27 +337,114 @@ static void appenderNew(slice_list_t *list)
                 (size_t) NG5_SLICE_LIST_BLOOMFILTER_TARGET_MEMORY_SIZE_IN_BYTE,
                 NG5_SLICE_LIST_BLOOMFILTER_TARGET_MEMORY_NAME,
                 (size_t) SLICE_KEY_COLUMN_MAX_ELEMS,
-                bitmap_nbits(&filter),
-                (pow(1 - exp(-(double) bloom_nhashs()
-                                / ((double) bitmap_nbits(&filter) / (double) SLICE_KEY_COLUMN_MAX_ELEMS)),
-                        bitmap_nbits(&filter))),
+                bloom_nbits(&filter),
+                bloom_fpr(bloom_nbits(&filter), SLICE_KEY_COLUMN_MAX_ELEMS),
                 sizeof(Slice),
                 (sizeof(slice_list_t) + list->slices.num_elems
                         * (sizeof(Slice) + sizeof(SliceDescriptor) + (sizeof(u32) * list->descriptors.num_elems)
-                                + sizeof(bloom_t) + bitmap_nbits(&filter) / 8 + sizeof(HashBounds))) / 1024.0 / 1024.0);
+                                + sizeof(bloom_t) + bloom_nbits(&filter) / 8 + sizeof(HashBounds))) / 1024.0 / 1024.0);
 
         /** register new slice as the current appender */
         list->appender_idx = numSlices;
 }
 
+struct slice_entry {
+        hash32_t hash;
+        const char *key;
+        field_sid_t value;
+};
+
+static int compare_slice_entries(const void *lhs, const void *rhs)
+{
+        hash32_t a = ((const struct slice_entry *) lhs)->hash;
+        hash32_t b = ((const struct slice_entry *) rhs)->hash;
+        return a < b ? -1 : (a > b ? 1 : 0);
+}
+
 static void appenderSeal(Slice *slice)
 {
-        ng5_unused(slice);
-        //  slice->cacheIdx = 0;
-        //  slice_sort(slice);
-        //  slice->strat = SLICE_LOOKUP_BESEARCH;
+        /** a full slice does not change anymore; sort it by hash such that lookups can use binary search */
+        struct slice_entry entries[SLICE_KEY_COLUMN_MAX_ELEMS];
+        for (u32 i = 0; i < slice->num_elems; i++) {
+                entries[i] = (struct slice_entry) {
+                        .hash = slice->keyHashColumn[i], .key = slice->key_column[i], .value = slice->string_id_tColumn[i]
+                };
+        }
+        qsort(entries, slice->num_elems, sizeof(struct slice_entry), compare_slice_entries);
+        for (u32 i = 0; i < slice->num_elems; i++) {
+                slice->keyHashColumn[i] = entries[i].hash;
+                slice->key_column[i] = entries[i].key;
+                slice->string_id_tColumn[i] = entries[i].value;
+        }
+        slice->cacheIdx = (u32) -1;
+        slice->strat = SLICE_LOOKUP_BESEARCH;
+}
+
+static inline u32 slice_besearch(Slice *slice, hash32_t needle_hash, const char *needle_str)
+{
+        const hash32_t *hashes = slice->keyHashColumn;
+        u32 num_elems = slice->num_elems;
+
+        if (slice->cacheIdx != (u32) -1 && hashes[slice->cacheIdx] == needle_hash &&
+                strcmp(slice->key_column[slice->cacheIdx], needle_str) == 0) {
+                return slice->cacheIdx;
+        }
+
+        /** branch-free narrowing of the range that contains the first hash not less than the needle hash */
+        u32 begin = 0, len = num_elems;
+        while (len > SLICE_BESEARCH_WINDOW) {
+                u32 half = len / 2;
+                begin = hashes[begin + half - 1] < needle_hash ? begin + half : begin;
+                len -= half;
+        }
+
+        /** scan for equal hashes (which might continue past the window in case of hash collisions) */
+        u32 i = begin;
+#if defined(SLICE_LIST_HAS_SSE2)
+        __m128i needle = _mm_set1_epi32((int) needle_hash);
+        for (; i + 4 <= num_elems && hashes[i] <= needle_hash; i += 4) {
+                __m128i candidates = _mm_loadu_si128((const __m128i *) (hashes + i));
+                int matches = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(candidates, needle)));
+                while (matches) {
+                        u32 pos = i + __builtin_ctz(matches);
+                        if (strcmp(slice->key_column[pos], needle_str) == 0) {
+                                slice->cacheIdx = pos;
+                                return pos;
+                        }
+                        matches &= matches - 1;
+                }
+        }
+#endif
+        for (; i < num_elems && hashes[i] <= needle_hash; i++) {
+                if (hashes[i] == needle_hash && strcmp(slice->key_column[i], needle_str) == 0) {
+                        slice->cacheIdx = i;
+                        return i;
+                }
+        }
+        return num_elems;
+}
 
-        // TODO: sealing means sort and then replace 'find' with bsearch or something. Not yet implemented: sealed slices are also search in a linear fashion
+static void reorganize(slice_list_t *list)
+{
+        /** the order changes only slightly between two reorganizations, hence insertion sort on the permutation */
+        u32 *order = vec_all(&list->order, u32);
+        SliceDescriptor *descs = vec_all(&list->descriptors, SliceDescriptor);
+        for (u32 i = 1; i < list->order.num_elems; i++) {
+                u32 slice_idx = order[i];
+                size_t hits = descs[slice_idx].numReadsHit;
+                u32 j = i;
+                for (; j > 0 && descs[order[j - 1]].numReadsHit < hits; j--) {
+                        order[j] = order[j - 1];
+                }
+                order[j] = slice_idx;
+        }
+
+        /** age the counters such that the order follows changes in the access pattern */
+        for (u32 i = 0; i < list->descriptors.num_elems; i++) {
+                descs[i].numReadsHit /= 2;
+                descs[i].numReadsAll /= 2;
+        }
+        list->num_lookups = 0;
 }
 
 static void lock(slice_list_t *list)
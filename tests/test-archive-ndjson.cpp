@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include "test-utils.h"
+
+static std::string
+ndjson_to_json(const std::string &ndjson, u32 batch_docs, size_t batch_bytes)
+{
+    struct archive archive;
+    struct err err;
+
+    FILE *file = fmemopen((void *) ndjson.c_str(), ndjson.length(), "r");
+    bool status = archive_from_ndjson(&archive, TEST_ARCHIVE_PATH, &err, file, PACK_NONE, SYNC, 0,
+                                      batch_docs, batch_bytes, false, NULL);
+    fclose(file);
+    EXPECT_TRUE(status);
+    if (!status) {
+        return "";
+    }
+    std::string result = to_json(&archive);
+    archive_close(&archive);
+    return result;
+}
+
+/* one document per line, with objects of different shape */
+static const char *ndjson_docs =
+    "{\"name\": \"a\", \"n\": 1, \"ok\": true}\n"
+    "{\"name\": \"b\", \"n\": 2, \"ok\": false}\n"
+    "{\"name\": \"c\", \"n\": -3, \"tags\": [\"x\", \"y\"]}\n"
+    "{\"name\": \"d\", \"n\": 4, \"nested\": {\"v\": 5.5}}\n"
+    "{\"name\": \"e\", \"n\": null}\n";
+
+static const char *json_docs =
+    "[{\"name\": \"a\", \"n\": 1, \"ok\": true}, "
+    "{\"name\": \"b\", \"n\": 2, \"ok\": false}, "
+    "{\"name\": \"c\", \"n\": -3, \"tags\": [\"x\", \"y\"]}, "
+    "{\"name\": \"d\", \"n\": 4, \"nested\": {\"v\": 5.5}}, "
+    "{\"name\": \"e\", \"n\": null}]";
+
+TEST(ArchiveNdjsonTest, SingleBatch)
+{
+    std::string expected = json_to_json(json_docs);
+    ASSERT_EQ(ndjson_to_json(ndjson_docs, NG5_NDJSON_BATCH_DOCS, NG5_NDJSON_BATCH_BYTES), expected);
+}
+
+TEST(ArchiveNdjsonTest, SingleDocumentBatches)
+{
+    std::string expected = json_to_json(json_docs);
+    ASSERT_EQ(ndjson_to_json(ndjson_docs, 1, NG5_NDJSON_BATCH_BYTES), expected);
+    ASSERT_EQ(ndjson_to_json(ndjson_docs, 2, NG5_NDJSON_BATCH_BYTES), expected);
+}
+
+TEST(ArchiveNdjsonTest, SingleDocument)
+{
+    /* other than archive_from_json, a single document is still stored in the object array "/", which is printed
+     * without brackets when it holds only one object */
+    ASSERT_EQ(ndjson_to_json("{\"name\": \"a\", \"n\": 1}\n", 1, NG5_NDJSON_BATCH_BYTES),
+              "{\n   \"/\": \n      {\n         \"name\": \"a\", \n         \"n\": 1\n      }\n   \n}");
+}
+
+TEST(ArchiveNdjsonTest, SkipBlankLines)
+{
+    std::string ndjson = std::string("\n") + ndjson_docs;
+    ndjson.insert(ndjson.find("\n{\"name\": \"c\"") + 1, "\n   \n\n");
+    ndjson += "\n\n";
+
+    std::string expected = json_to_json(json_docs);
+    ASSERT_EQ(ndjson_to_json(ndjson, NG5_NDJSON_BATCH_DOCS, NG5_NDJSON_BATCH_BYTES), expected);
+    ASSERT_EQ(ndjson_to_json(ndjson, 2, NG5_NDJSON_BATCH_BYTES), expected);
+}
+
+TEST(ArchiveNdjsonTest, ByteLimitedBatches)
+{
+    std::string expected = json_to_json(json_docs);
+
+    /* flushes after each line */
+    ASSERT_EQ(ndjson_to_json(ndjson_docs, NG5_NDJSON_BATCH_DOCS, 1), expected);
+    /* flushes after about two lines */
+    ASSERT_EQ(ndjson_to_json(ndjson_docs, NG5_NDJSON_BATCH_DOCS, 70), expected);
+}
+
+TEST(ArchiveNdjsonTest, EmptyObjectBatch)
+{
+    /* archive_from_json drops objects without any property from object arrays, or refuses the input if there is no
+     * property at all; the NDJSON import keeps every line as object, hence the literal expectations */
+    ASSERT_EQ(ndjson_to_json("{}\n{}\n{}\n", NG5_NDJSON_BATCH_DOCS, NG5_NDJSON_BATCH_BYTES),
+              "{\n   \"/\": [\n      {\n      },\n      {\n      },\n      {\n      }\n   ]\n}");
+
+    /* the second batch holds empty objects only */
+    ASSERT_EQ(ndjson_to_json("{\"n\": 1}\n{\"n\": 2}\n{}\n{}\n", 2, NG5_NDJSON_BATCH_BYTES),
+              "{\n   \"/\": [\n      {\n         \"n\": 1\n      },\n      {\n         \"n\": 2\n      },\n"
+              "      {\n      },\n      {\n      }\n   ]\n}");
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+
+#include "test-utils.h"
+#include "coding/coding_front.h"
+
+#define NUM_ITEMS 200
+
+static std::string
+item_name(u32 i)
+{
+    char name[16];
+    snprintf(name, sizeof(name), "item-%03u", i);
+    return name;
+}
+
+/* one object per item, whose names are stored in reverse order to not hand over sorted input */
+static test_object_t
+named_object(u32 i)
+{
+    return { { "name", json_string(item_name(NUM_ITEMS - 1 - i)) }, { "kind", json_string(i % 2 ? "odd" : "even") } };
+}
+
+static std::vector<std::string>
+find_strings(struct archive_query *query, struct string_pred_t *pred, const char *capture)
+{
+    size_t num_found = 0;
+    std::vector<std::string> result;
+
+    field_sid_t *ids = query_find_ids(&num_found, query, pred, (void *) capture, NG5_QUERY_LIMIT_NONE);
+    for (size_t i = 0; ids && i < num_found; i++) {
+        char *string = query_fetch_string_by_id(query, ids[i]);
+        EXPECT_TRUE(string != NULL);
+        result.push_back(string ? string : "");
+        free(string);
+    }
+    free(ids);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+TEST(FrontCodingTest, EncodeDecodeRoundTrip)
+{
+    const u32 block_size = 4;
+    std::vector<std::string> strings = { "", "a", "ab", "abc", "abc", "abd", "b", "ba", "bab", "babylon", "c",
+                                         "common-prefix-1", "common-prefix-12", "common-prefix-2", "d" };
+    for (u32 i = 0; i < 300; i++) {
+        strings.push_back("long-" + std::string(i, 'x'));
+    }
+
+    struct memblock *block;
+    struct memfile file;
+    struct coding_front coder;
+    std::vector<offset_t> offsets;
+
+    memblock_create(&block, 1024 * 1024);
+    memfile_open(&file, block, READ_WRITE);
+    ASSERT_TRUE(coding_front_create(&coder, block_size));
+    for (const std::string &string : strings) {
+        offsets.push_back(memfile_tell(&file));
+        ASSERT_TRUE(coding_front_encode(&file, &coder, string.c_str()));
+    }
+    size_t nbytes = memfile_tell(&file);
+    coding_front_drop(&coder);
+
+    /* each string is decoded from its block alone */
+    const char *data = memblock_raw_data(block);
+    for (size_t i = 0; i < strings.size(); i++) {
+        offset_t block_begin = offsets[i - i % block_size];
+        std::string decoded(strings[i].length(), '\0');
+        ASSERT_TRUE(coding_front_decode(&decoded[0], decoded.length(), data + block_begin, nbytes - block_begin,
+                                        offsets[i] - block_begin));
+        ASSERT_EQ(decoded, strings[i]);
+    }
+
+    /* the first entry of a block is stored in full, the others share a prefix with their predecessor */
+    u64 back, shared, suffix_len;
+    ASSERT_GT(coding_front_read_header(&back, &shared, &suffix_len, data + offsets[4], nbytes - offsets[4]), 0u);
+    ASSERT_EQ(back, 0u);
+    ASSERT_EQ(shared, 0u);
+    ASSERT_EQ(suffix_len, 3u);
+    ASSERT_GT(coding_front_read_header(&back, &shared, &suffix_len, data + offsets[5], nbytes - offsets[5]), 0u);
+    ASSERT_EQ(back, offsets[5] - offsets[4]);
+    ASSERT_EQ(shared, 2u);
+    ASSERT_EQ(suffix_len, 1u);
+
+    /* a string of the wrong length or an offset inside an entry is rejected */
+    std::string decoded(16, '\0');
+    ASSERT_FALSE(coding_front_decode(&decoded[0], 2, data + offsets[4], nbytes - offsets[4],
+                                     offsets[5] - offsets[4]));
+    ASSERT_FALSE(coding_front_decode(&decoded[0], 3, data + offsets[4], nbytes - offsets[4], 1));
+
+    memblock_drop(block);
+}
+
+TEST(FrontCodingTest, ConvertAndRoundTrip)
+{
+    /* read-optimized archives order properties by key, hence both are compared to their uncompressed counterpart */
+    std::string json = make_object_array_json(NUM_ITEMS, named_object);
+    ASSERT_EQ(json_to_json(json, PACK_FRONT, false), json_to_json(json, PACK_NONE, false));
+    ASSERT_EQ(json_to_json(json, PACK_FRONT, true), json_to_json(json, PACK_NONE, true));
+}
+
+TEST(FrontCodingTest, FindIdsBySearch)
+{
+    struct archive archive;
+    struct archive_query query;
+    struct string_pred_t equals, prefix;
+
+    /* read-optimized archives order string ids lexicographically, hence predicates are answered by search */
+    bool status = test_archive_from_json(&archive, make_object_array_json(NUM_ITEMS, named_object), PACK_FRONT,
+                                         true);
+    ASSERT_TRUE(status);
+    ASSERT_TRUE(archive.string_table.indexed);
+    ASSERT_TRUE(archive.record_table.flags.bits.has_ordered_string_ids);
+    status = archive_query(&query, &archive);
+    ASSERT_TRUE(status);
+
+    string_pred_equals_init(&equals);
+    string_pred_prefix_init(&prefix);
+
+    /* equality, for the first, the last and some string in between */
+    for (const char *needle : { "even", "item-000", "item-042", "item-199", "kind", "name", "odd" }) {
+        ASSERT_EQ(find_strings(&query, &equals, needle), std::vector<std::string>({ needle }));
+    }
+    ASSERT_TRUE(find_strings(&query, &equals, "item-").empty());
+    ASSERT_TRUE(find_strings(&query, &equals, "item-200").empty());
+    ASSERT_TRUE(find_strings(&query, &equals, "a").empty());
+    ASSERT_TRUE(find_strings(&query, &equals, "zzz").empty());
+
+    /* prefixes spanning several blocks of the front packer */
+    std::vector<std::string> expected;
+    for (u32 i = 0; i < NUM_ITEMS; i++) {
+        expected.push_back(item_name(i));
+    }
+    ASSERT_EQ(find_strings(&query, &prefix, "item-"), expected);
+    ASSERT_EQ(find_strings(&query, &prefix, "item-1"),
+              std::vector<std::string>(expected.begin() + 100, expected.begin() + 200));
+    ASSERT_EQ(find_strings(&query, &prefix, "item-04"),
+              std::vector<std::string>(expected.begin() + 40, expected.begin() + 50));
+    ASSERT_EQ(find_strings(&query, &prefix, "o"), std::vector<std::string>({ "odd" }));
+    ASSERT_TRUE(find_strings(&query, &prefix, "item-2").empty());
+    ASSERT_TRUE(find_strings(&query, &prefix, "zzz").empty());
+
+    /* the limit ends the scan early */
+    size_t num_found = 0;
+    field_sid_t *ids = query_find_ids(&num_found, &query, &prefix, (void *) "item-", 5);
+    ASSERT_TRUE(ids != NULL);
+    ASSERT_EQ(num_found, 5u);
+    free(ids);
+
+    archive_close(&archive);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
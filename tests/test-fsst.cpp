@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string>
+
+#include "core/carbon.h"
+#include "coding/coding_fsst.h"
+
+static const char *sample_strings[] = {
+    "http://www.example.com/index.html", "http://www.example.com/about.html", "http://www.example.org/",
+    "https://www.example.com/contact", "The quick brown fox jumps over the lazy dog", "the lazy dog sleeps",
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", "0123456789", "example", "www"
+};
+
+#define NUM_SAMPLE_STRINGS (sizeof(sample_strings) / sizeof(sample_strings[0]))
+
+static void
+build_dictionary(struct coding_fsst *dic)
+{
+    string_vector_t strings;
+
+    vec_create(&strings, NULL, sizeof(const char *), NUM_SAMPLE_STRINGS);
+    for (size_t i = 0; i < NUM_SAMPLE_STRINGS; i++) {
+        vec_push(&strings, &sample_strings[i], 1);
+    }
+    coding_fsst_create(dic);
+    EXPECT_TRUE(coding_fsst_build(dic, &strings));
+    vec_drop(&strings);
+}
+
+/* the symbol table as it is read back from its serialized form */
+static void
+serialize_and_read(struct coding_fsst *dst, const struct coding_fsst *src)
+{
+    struct memblock *block;
+    struct memfile file;
+
+    memblock_create(&block, 16 * 1024);
+    memfile_open(&file, block, READ_WRITE);
+    EXPECT_TRUE(coding_fsst_serialize(&file, src));
+    memfile_seek(&file, 0);
+    EXPECT_TRUE(coding_fsst_read(dst, &file));
+    memblock_drop(block);
+}
+
+static std::string
+encode(struct coding_fsst *dic, const char *string)
+{
+    struct memblock *block;
+    struct memfile file;
+
+    memblock_create(&block, 1024 + 2 * strlen(string));
+    memfile_open(&file, block, READ_WRITE);
+    EXPECT_TRUE(coding_fsst_encode(&file, dic, string));
+    std::string result(memblock_raw_data(block), memfile_tell(&file));
+    memblock_drop(block);
+    return result;
+}
+
+static std::string
+decode(const struct coding_fsst *dic, const std::string &encoded, size_t strlen)
+{
+    size_t nbytes_read = 0;
+    std::string result(strlen, '\0');
+    EXPECT_TRUE(coding_fsst_decode(&result[0], strlen, &nbytes_read, dic, encoded.data(), encoded.length()));
+    EXPECT_EQ(nbytes_read, encoded.length());
+    return result;
+}
+
+TEST(FsstTest, EncodeDecodeRoundTrip)
+{
+    struct coding_fsst encoder, decoder;
+
+    build_dictionary(&encoder);
+    ASSERT_GT(encoder.num_symbols, 0u);
+    serialize_and_read(&decoder, &encoder);
+    ASSERT_EQ(decoder.num_symbols, encoder.num_symbols);
+
+    const char *strings[] = { "http://www.example.com/index.html", "the quick brown dog", "a", "ww", "example.org",
+                              "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+                              "ZZZ unseen \x01\x7f\x80\xfe\xff bytes" };
+    for (size_t i = 0; i < sizeof(strings) / sizeof(strings[0]); i++) {
+        std::string encoded = encode(&encoder, strings[i]);
+        ASSERT_LE(encoded.length(), 2 * strlen(strings[i]));
+        ASSERT_EQ(decode(&decoder, encoded, strlen(strings[i])), strings[i]);
+    }
+
+    /* frequent strings are shorter after encoding */
+    ASSERT_LT(encode(&encoder, sample_strings[0]).length(), strlen(sample_strings[0]));
+
+    coding_fsst_drop(&encoder);
+    coding_fsst_drop(&decoder);
+}
+
+TEST(FsstTest, EncodeDecodeEmptyString)
+{
+    struct coding_fsst dic;
+
+    build_dictionary(&dic);
+    std::string encoded = encode(&dic, "");
+    ASSERT_EQ(encoded.length(), 0u);
+    ASSERT_EQ(decode(&dic, encoded, 0), "");
+    coding_fsst_drop(&dic);
+}
+
+TEST(FsstTest, EncodeDecodeEscapedBytes)
+{
+    struct coding_fsst empty, dic;
+
+    /* without any symbol, each byte is escaped */
+    coding_fsst_create(&empty);
+    const char *string = "escape every byte, even \xff";
+    std::string encoded = encode(&empty, string);
+    ASSERT_EQ(encoded.length(), 2 * strlen(string));
+    for (size_t i = 0; i < encoded.length(); i += 2) {
+        ASSERT_EQ((unsigned char) encoded[i], NG5_FSST_ESCAPE);
+        ASSERT_EQ(encoded[i + 1], string[i / 2]);
+    }
+    ASSERT_EQ(decode(&empty, encoded, strlen(string)), string);
+
+    /* none of these bytes is part of the sample */
+    build_dictionary(&dic);
+    string = "\x01\x02\x03\xf0\xf1\xf2\xf3\xf4\xf5\xf6\xf7";
+    encoded = encode(&dic, string);
+    ASSERT_EQ(encoded.length(), 2 * strlen(string));
+    ASSERT_EQ(decode(&dic, encoded, strlen(string)), string);
+
+    /* an escape code without its literal is rejected */
+    char decoded[16];
+    size_t nbytes_read;
+    ASSERT_FALSE(coding_fsst_decode(decoded, strlen(string), &nbytes_read, &dic, encoded.data(),
+                                    encoded.length() - 1));
+
+    coding_fsst_drop(&empty);
+    coding_fsst_drop(&dic);
+}
+
+TEST(FsstTest, DecodeConsecutiveStrings)
+{
+    struct coding_fsst dic;
+
+    /* strings are stored back to back, each decoded on its own given its length */
+    build_dictionary(&dic);
+    std::string encoded;
+    for (size_t i = 0; i < NUM_SAMPLE_STRINGS; i++) {
+        encoded += encode(&dic, sample_strings[i]);
+    }
+
+    size_t offset = 0;
+    for (size_t i = 0; i < NUM_SAMPLE_STRINGS; i++) {
+        size_t len = strlen(sample_strings[i]), nbytes_read = 0;
+        std::string decoded(len, '\0');
+        ASSERT_TRUE(coding_fsst_decode(&decoded[0], len, &nbytes_read, &dic, encoded.data() + offset,
+                                       encoded.length() - offset));
+        ASSERT_EQ(decoded, sample_strings[i]);
+        offset += nbytes_read;
+    }
+    ASSERT_EQ(offset, encoded.length());
+
+    coding_fsst_drop(&dic);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
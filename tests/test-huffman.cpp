@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string>
+
+#include "core/carbon.h"
+
+#define DIC_MARKER 'd'
+
+static struct coding_huffman *
+huffman_create()
+{
+    struct coding_huffman *dic = (struct coding_huffman *) malloc(sizeof(struct coding_huffman));
+    coding_huffman_create(dic);
+    return dic;
+}
+
+/* writes a dictionary entry the way 'coding_huffman_serialize' does */
+static void
+write_entry(struct memfile *file, unsigned char letter, u8 nbits)
+{
+    char marker = DIC_MARKER;
+    memfile_write(file, &marker, sizeof(char));
+    memfile_write(file, &letter, sizeof(unsigned char));
+    memfile_write(file, &nbits, sizeof(u8));
+}
+
+/* memory blocks are not zeroed, hence the dictionary must be followed by something other than an entry marker */
+static void
+end_dictionary(struct memfile *file)
+{
+    char end = '\0';
+    memfile_write(file, &end, sizeof(char));
+}
+
+static struct coding_huffman *
+read_dictionary(struct memblock *block)
+{
+    struct memfile file;
+    struct coding_huffman *dic = huffman_create();
+    memfile_open(&file, block, READ_ONLY);
+    EXPECT_TRUE(coding_huffman_read_dictionary(dic, &file, DIC_MARKER));
+    return dic;
+}
+
+/* encodes and decodes 'string', where 'decoder' was read back from the serialized code of 'encoder' */
+static std::string
+encode_decode(struct coding_huffman *encoder, struct coding_huffman *decoder, const char *string)
+{
+    struct memblock *block;
+    struct memfile file;
+    struct pack_huffman_str_info info;
+
+    memblock_create(&block, 1024 + 16 * strlen(string));
+    memset((void *) memblock_raw_data(block), 0, 1024 + 16 * strlen(string));
+    memfile_open(&file, block, READ_WRITE);
+    EXPECT_TRUE(coding_huffman_encode(&file, encoder, string));
+
+    memfile_seek(&file, 0);
+    coding_huffman_read_string(&info, &file);
+    std::string result(strlen(string), '\0');
+    EXPECT_TRUE(coding_huffman_decode(&result[0], strlen(string), decoder, info.encoded_bytes, info.nbytes_encoded));
+
+    memblock_drop(block);
+    return result;
+}
+
+TEST(HuffmanTest, DecodeCanonicalTable)
+{
+    struct memblock *block;
+    struct memfile file;
+
+    /* canonical codes: a = 0, b = 10, c = 110, d = 111 */
+    memblock_create(&block, 1024);
+    memfile_open(&file, block, READ_WRITE);
+    write_entry(&file, 'd', 3);
+    write_entry(&file, 'a', 1);
+    write_entry(&file, 'c', 3);
+    write_entry(&file, 'b', 2);
+    end_dictionary(&file);
+    struct coding_huffman *dic = read_dictionary(block);
+    memblock_drop(block);
+
+    /* "abcdda": 0 10 110 111 111 0, stored least-significant bit first */
+    const char encoded[16] = { (char) 0xDA, (char) 0x0F };
+    char decoded[7] = { 0 };
+    ASSERT_TRUE(coding_huffman_decode(decoded, 6, dic, encoded, 2));
+    ASSERT_STREQ(decoded, "abcdda");
+
+    coding_huffman_drop(dic);
+}
+
+TEST(HuffmanTest, DecodeCodesLongerThanTable)
+{
+    struct memblock *block;
+    struct memfile file;
+
+    /* code lengths 1, 2, ..., 13, 13 exceed the width of the decoding table */
+    memblock_create(&block, 1024);
+    memfile_open(&file, block, READ_WRITE);
+    for (u8 i = 0; i < 13; i++) {
+        write_entry(&file, 'a' + i, i + 1);
+    }
+    write_entry(&file, 'n', 13);
+    end_dictionary(&file);
+    struct coding_huffman *dic = read_dictionary(block);
+    memblock_drop(block);
+
+    ASSERT_EQ(encode_decode(dic, dic, "nmlkjihgfedcba"), "nmlkjihgfedcba");
+    ASSERT_EQ(encode_decode(dic, dic, "aaaaaaaaaaaaaaaaaaaanaaaaaaaaaaaaaaaaaaaaaa"),
+              "aaaaaaaaaaaaaaaaaaaanaaaaaaaaaaaaaaaaaaaaaa");
+    ASSERT_EQ(encode_decode(dic, dic, "nnnnnnnnnnnnnnnnnnnnmmmmmmmmmmmmmm"), "nnnnnnnnnnnnnnnnnnnnmmmmmmmmmmmmmm");
+
+    coding_huffman_drop(dic);
+}
+
+TEST(HuffmanTest, EncodeDecodeRoundTrip)
+{
+    const char *strings[] = { "", "a", "hello world", "The quick brown fox jumps over the lazy dog",
+                              "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab",
+                              "zyx ~!@#$%^&*()_+ 0123456789 \x01\x7f\x80\xff" };
+    const size_t num_strings = sizeof(strings) / sizeof(strings[0]);
+    string_vector_t string_vector;
+    struct memblock *block;
+    struct memfile file;
+
+    vec_create(&string_vector, NULL, sizeof(const char *), num_strings);
+    for (size_t i = 0; i < num_strings; i++) {
+        vec_push(&string_vector, &strings[i], 1);
+    }
+
+    struct coding_huffman *encoder = huffman_create();
+    ASSERT_TRUE(coding_huffman_build(encoder, &string_vector));
+    vec_drop(&string_vector);
+
+    memblock_create(&block, 4096);
+    memfile_open(&file, block, READ_WRITE);
+    ASSERT_TRUE(coding_huffman_serialize(&file, encoder, DIC_MARKER));
+    end_dictionary(&file);
+    struct coding_huffman *decoder = read_dictionary(block);
+    memblock_drop(block);
+
+    for (size_t i = 0; i < num_strings; i++) {
+        ASSERT_EQ(encode_decode(encoder, decoder, strings[i]), strings[i]);
+    }
+
+    /* letters without a code cannot be encoded */
+    struct memblock *out;
+    memblock_create(&out, 1024);
+    memfile_open(&file, out, READ_WRITE);
+    ASSERT_FALSE(coding_huffman_encode(&file, encoder, "\x02"));
+    memblock_drop(out);
+
+    coding_huffman_drop(encoder);
+    coding_huffman_drop(decoder);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+
+#include "test-utils.h"
+#include "coding/coding_intpack.h"
+
+#define NUM_VALUES 200
+
+static u64
+next_random(u64 *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static std::vector<unsigned char>
+encode(const struct coding_intpack_header *header, const std::vector<u64> &values)
+{
+    std::vector<unsigned char> payload(coding_intpack_payload_size(header) + 1);
+    EXPECT_TRUE(coding_intpack_encode(payload.data(), header, values.data()));
+    payload.pop_back();
+    return payload;
+}
+
+/* decodes all values by a cursor, in windows of 'window' values */
+static std::vector<u64>
+decode(const struct coding_intpack_header *header, const std::vector<unsigned char> &payload, u32 window)
+{
+    struct coding_intpack_cursor cursor;
+    std::vector<u64> result, buffer(window);
+    u32 num_decoded;
+
+    coding_intpack_cursor_init(&cursor, header);
+    while ((num_decoded = coding_intpack_decode(buffer.data(), window, &cursor, header, payload.data()))) {
+        EXPECT_LE(num_decoded, window);
+        result.insert(result.end(), buffer.begin(), buffer.begin() + num_decoded);
+    }
+    return result;
+}
+
+static void
+expect_round_trip(const std::vector<u64> &values, enum coding_intpack_scheme scheme)
+{
+    struct coding_intpack_header header;
+
+    ASSERT_TRUE(coding_intpack_plan(&header, values.data(), values.size()));
+    ASSERT_EQ(header.scheme, scheme);
+    ASSERT_EQ(header.num_values, values.size());
+
+    std::vector<unsigned char> payload = encode(&header, values);
+    for (u32 window : { 1u, 3u, 7u, (u32) NG5_INTPACK_WINDOW, 1000u }) {
+        ASSERT_EQ(decode(&header, payload, window), values);
+    }
+}
+
+TEST(IntpackTest, FrameOfReference)
+{
+    std::vector<u64> values;
+    u64 state = 42;
+    for (u32 i = 0; i < NUM_VALUES; i++) {
+        values.push_back(1000000 + next_random(&state) % 1000);
+    }
+    expect_round_trip(values, INTPACK_FOR);
+
+    /* all values equal, which takes no bits per value */
+    expect_round_trip(std::vector<u64>(NUM_VALUES, 7), INTPACK_FOR);
+    expect_round_trip(std::vector<u64>(1, UINT64_MAX), INTPACK_FOR);
+
+    /* signed values, mapped to keys that keep their order */
+    values.clear();
+    for (i64 i = 0; i < NUM_VALUES; i++) {
+        values.push_back(coding_intpack_key_from_signed((i % 2 ? -1 : 1) * (i % 50)));
+    }
+    expect_round_trip(values, INTPACK_FOR);
+    ASSERT_LT(coding_intpack_key_from_signed(-1), coding_intpack_key_from_signed(0));
+    ASSERT_LT(coding_intpack_key_from_signed(INT64_MIN), coding_intpack_key_from_signed(INT64_MAX));
+    ASSERT_EQ(coding_intpack_signed_from_key(coding_intpack_key_from_signed(-49)), -49);
+}
+
+TEST(IntpackTest, Delta)
+{
+    std::vector<u64> values;
+    u64 state = 7, value = UINT64_MAX / 2;
+    for (u32 i = 0; i < NUM_VALUES; i++) {
+        /* small steps, up and down, over a range wider than the steps */
+        value += next_random(&state) % 64 + (i % 3 == 0 ? -100 : 1000);
+        values.push_back(value);
+    }
+    expect_round_trip(values, INTPACK_DELTA);
+
+    /* a step that wraps around */
+    values.clear();
+    for (u32 i = 0; i < NUM_VALUES; i++) {
+        values.push_back(UINT64_MAX - NUM_VALUES / 2 + i * 1000);
+    }
+    struct coding_intpack_header header;
+    coding_intpack_plan(&header, values.data(), values.size());
+    ASSERT_EQ(decode(&header, encode(&header, values), NG5_INTPACK_WINDOW), values);
+}
+
+TEST(IntpackTest, RunLength)
+{
+    std::vector<u64> values;
+    u64 state = 3;
+    for (u32 run = 0; values.size() < NUM_VALUES; run++) {
+        u64 value = next_random(&state);
+        /* runs that end within and across decoding windows */
+        for (u32 i = 0; i < 1 + (run * 17) % 45; i++) {
+            values.push_back(value);
+        }
+    }
+    expect_round_trip(values, INTPACK_RLE);
+
+    /* one long run between two single values */
+    values.assign(NUM_VALUES, 0);
+    values[0] = UINT64_MAX;
+    values.back() = UINT64_MAX;
+    expect_round_trip(values, INTPACK_RLE);
+}
+
+TEST(IntpackTest, UnpackAllWidths)
+{
+    /* windows of fewer than four values take the scalar path; longer windows use the AVX2 kernel if the CPU has it,
+     * up to where fewer than eight bytes are left and up to 56 bits per value */
+    for (u8 width = 0; width <= 64; width++) {
+        struct coding_intpack_header header = { };
+        std::vector<u64> values;
+        u64 state = 1 + width, mask = width == 64 ? UINT64_MAX : (1ULL << width) - 1;
+        for (u32 i = 0; i < NUM_VALUES; i++) {
+            values.push_back(next_random(&state) & mask);
+        }
+        header.scheme = INTPACK_FOR;
+        header.width = width;
+        header.num_values = NUM_VALUES;
+        header.reference = 0;
+        std::vector<unsigned char> payload = encode(&header, values);
+
+        const u64 reference = 12345;
+        for (size_t n : { 1, 2, 3, 4, 5, 31, 32, 33 }) {
+            for (u64 first : { 0, 1, 7, 8, 100, NUM_VALUES - 33, NUM_VALUES - 5 }) {
+                size_t count = std::min(n, (size_t) (NUM_VALUES - first));
+                std::vector<u64> dst(count);
+                coding_intpack_unpack(dst.data(), payload.data(), payload.size(), width, first, count, reference);
+                for (size_t i = 0; i < count; i++) {
+                    ASSERT_EQ(dst[i], reference + values[first + i]) << "width " << (int) width << ", first "
+                                                                     << first << ", i " << i;
+                }
+            }
+        }
+
+        std::vector<u64> dst(NUM_VALUES);
+        coding_intpack_unpack(dst.data(), payload.data(), payload.size(), width, 0, NUM_VALUES, 0);
+        ASSERT_EQ(dst, values) << "width " << (int) width;
+    }
+}
+
+/* properties of the same type in each object, such that each is stored in one column */
+#define NUM_OBJECTS 100
+
+static test_object_t
+packed_object(u32 i)
+{
+    return { { "id", std::to_string(1000 + i * 300) }, { "n", std::to_string(i % 7) }, { "g", std::to_string(i / 25) },
+             { "neg", std::to_string(-(int) (i % 5) * 20) }, { "ok", i % 3 == 0 ? "true" : "false" },
+             { "tag", json_string(i < NUM_OBJECTS / 2 ? "low" : "high") } };
+}
+
+TEST(IntpackTest, PackedColumnsRoundTrip)
+{
+    struct memblock *stream;
+    struct err err;
+    char *buffer = NULL;
+    size_t buffer_len = 0;
+
+    std::string json = make_object_array_json(NUM_OBJECTS, packed_object);
+
+    /* ids are packed by delta, groups and tags by run length, the others by frame of reference */
+    bool status = archive_stream_from_json(&stream, &err, json.c_str(), PACK_NONE, SYNC, 0, false, false, NULL);
+    ASSERT_TRUE(status);
+    FILE *file = open_memstream(&buffer, &buffer_len);
+    ASSERT_TRUE(archive_print(file, &err, stream));
+    fclose(file);
+    std::string view(buffer, buffer_len);
+    free(buffer);
+    memblock_drop(stream);
+    ASSERT_NE(view.find("[scheme: for]"), std::string::npos);
+    ASSERT_NE(view.find("[scheme: delta]"), std::string::npos);
+    ASSERT_NE(view.find("[scheme: rle]"), std::string::npos);
+
+    ASSERT_EQ(json_to_json(json), make_expected_object_array_json(NUM_OBJECTS, packed_object));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
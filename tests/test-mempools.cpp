@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 #include <printf.h>
 #include <cinttypes>
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
 #include "shared/common.h"
 #include "shared/types.h"
 #include "core/mem/pool.h"
@@ -130,7 +134,211 @@
 //        }
 //}
 
-// TODO: add pool tests again
+#define NUM_THREADS 8
+#define NUM_ROUNDS 200
+#define NUM_PTRS_PER_ROUND 64
+
+/* the addresses registered in tests; the registry never dereferences them */
+static char dummy_memory[POOL_MAX_MANAGED_PTRS];
+
+/* the thread (+1) that currently holds a position, or 0 if the position is not handed out */
+static std::atomic<u32> owners[POOL_MAX_MANAGED_PTRS];
+
+static u16
+position_of(data_ptr_t ptr)
+{
+    u16 pos;
+    data_ptr_get_data(&pos, ptr);
+    return pos;
+}
+
+/* moves the position of 'ptr' from owner 'from' to owner 'to', which fails if the registry handed out a position
+ * that is still held, or released a position that was not held */
+static bool
+hand_over(data_ptr_t ptr, u32 from, u32 to)
+{
+    return owners[position_of(ptr)].compare_exchange_strong(from, to);
+}
+
+static bool
+create_pool(struct pool *pool)
+{
+    for (std::atomic<u32> &owner : owners) {
+        owner = 0;
+    }
+    return pool_create_by_name(pool, POOL_STRATEGY_NONE_NAME);
+}
+
+/* registers and unregisters batches of pointers without taking the pool lock; every other batch is released in
+ * reverse order, such that the freelist is not handed back in the order it was built */
+static void
+register_and_unregister(struct pool *pool, u32 t, u32 *num_errors)
+{
+    std::vector<data_ptr_t> ptrs;
+
+    *num_errors = 0;
+    for (u32 round = 0; round < NUM_ROUNDS; round++) {
+        for (u32 i = 0; i < NUM_PTRS_PER_ROUND; i++) {
+            data_ptr_t ptr;
+            const char *adr = dummy_memory + t * NUM_PTRS_PER_ROUND + i;
+            if (!pool_internal_register(&ptr, pool, adr, 1, 1)) {
+                (*num_errors)++;
+                continue;
+            }
+            *num_errors += !hand_over(ptr, 0, t + 1);
+            *num_errors += data_ptr_get(const char, ptr) != adr;
+            ptrs.push_back(ptr);
+        }
+        for (size_t k = 0; k < ptrs.size(); k++) {
+            data_ptr_t ptr = ptrs[round % 2 ? ptrs.size() - 1 - k : k];
+            *num_errors += !hand_over(ptr, t + 1, 0);
+            pool_internal_unregister(pool, ptr);
+        }
+        ptrs.clear();
+    }
+}
+
+/* registers pointers until the registry refuses to hand out another position */
+static void
+register_until_full(struct pool *pool, std::vector<data_ptr_t> *ptrs)
+{
+    data_ptr_t ptr;
+    while (pool_internal_register(&ptr, pool, dummy_memory + ptrs->size(), 1, 1)) {
+        ptrs->push_back(ptr);
+    }
+}
+
+/* allocates, reallocates and frees through the public entry points, checking each block keeps its content */
+static void
+alloc_realloc_free(struct pool *pool, u8 tag)
+{
+    std::vector<data_ptr_t> ptrs;
+
+    for (u32 round = 0; round < NUM_ROUNDS / 10; round++) {
+        for (u32 i = 1; i <= NUM_PTRS_PER_ROUND; i++) {
+            data_ptr_t ptr = pool_alloc(pool, i);
+            *data_ptr_get(u8, ptr) = tag;
+            ptrs.push_back(ptr);
+        }
+        for (u32 i = 0; i < ptrs.size(); i += 2) {
+            ptrs[i] = pool_realloc(pool, ptrs[i], 2 * NUM_PTRS_PER_ROUND);
+        }
+        for (data_ptr_t ptr : ptrs) {
+            EXPECT_EQ(*data_ptr_get(u8, ptr), tag);
+            pool_free(pool, ptr);
+        }
+        ptrs.clear();
+    }
+}
+
+TEST(MemPoolTest, RegistryConcurrentRegisterUnregister)
+{
+    struct pool pool;
+    std::vector<std::thread> threads;
+    u32 num_errors[NUM_THREADS];
+
+    ASSERT_TRUE(create_pool(&pool));
+    for (u32 t = 0; t < NUM_THREADS; t++) {
+        threads.emplace_back(register_and_unregister, &pool, t, &num_errors[t]);
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    for (u32 t = 0; t < NUM_THREADS; t++) {
+        ASSERT_EQ(num_errors[t], 0u) << "thread " << t;
+    }
+
+    /* no more positions were handed out than were held at once; as every position was released exactly once, the
+     * freelist holds each of them once, and re-registering as many pointers yields exactly these positions */
+    const u32 num_ptrs = NUM_THREADS * NUM_PTRS_PER_ROUND;
+    std::vector<data_ptr_t> ptrs;
+    std::set<u16> positions;
+    for (u32 i = 0; i < num_ptrs; i++) {
+        data_ptr_t ptr;
+        ASSERT_TRUE(pool_internal_register(&ptr, &pool, dummy_memory + i, 1, 1));
+        ASSERT_TRUE(hand_over(ptr, 0, 1));
+        ASSERT_FALSE(pool_internal_slot(&pool, position_of(ptr))->is_free);
+        positions.insert(position_of(ptr));
+        ptrs.push_back(ptr);
+    }
+    ASSERT_EQ(positions.size(), (size_t) num_ptrs);
+    ASSERT_EQ(*positions.rbegin(), num_ptrs - 1);
+
+    for (data_ptr_t ptr : ptrs) {
+        pool_internal_unregister(&pool, ptr);
+        ASSERT_TRUE(pool_internal_slot(&pool, position_of(ptr))->is_free);
+    }
+    ASSERT_TRUE(pool_drop(&pool));
+}
+
+TEST(MemPoolTest, RegistryBoundedAcrossThreads)
+{
+    struct pool pool;
+    std::vector<std::thread> threads;
+    std::vector<std::vector<data_ptr_t>> ptrs(NUM_THREADS);
+
+    /* the threads race for the last fresh positions; none is handed out twice, and none beyond the limit */
+    ASSERT_TRUE(create_pool(&pool));
+    for (u32 t = 0; t < NUM_THREADS; t++) {
+        threads.emplace_back(register_until_full, &pool, &ptrs[t]);
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    size_t num_registered = 0;
+    for (u32 t = 0; t < NUM_THREADS; t++) {
+        for (data_ptr_t ptr : ptrs[t]) {
+            ASSERT_LT(position_of(ptr), POOL_MAX_MANAGED_PTRS);
+            ASSERT_TRUE(hand_over(ptr, 0, t + 1));
+        }
+        num_registered += ptrs[t].size();
+    }
+    ASSERT_EQ(num_registered, (size_t) POOL_MAX_MANAGED_PTRS);
+    ASSERT_EQ(pool.err.code, NG5_ERR_MEMPOOL_LIMIT);
+
+    /* a full registry hands out a released position again, but no other */
+    u32 t = 0;
+    while (ptrs[t].empty()) {
+        t++;
+    }
+    data_ptr_t ptr, released = ptrs[t].back();
+    pool_internal_unregister(&pool, released);
+    ASSERT_TRUE(pool_internal_register(&ptr, &pool, dummy_memory, 1, 1));
+    ASSERT_EQ(position_of(ptr), position_of(released));
+    ASSERT_FALSE(pool_internal_register(&ptr, &pool, dummy_memory, 1, 1));
+    ptrs[t].back() = ptr;
+
+    for (std::vector<data_ptr_t> &thread_ptrs : ptrs) {
+        for (data_ptr_t ptr : thread_ptrs) {
+            pool_internal_unregister(&pool, ptr);
+        }
+    }
+    ASSERT_TRUE(pool_drop(&pool));
+}
+
+TEST(MemPoolTest, AllocFreeAcrossThreads)
+{
+    struct pool pool;
+    struct pool_counters counters;
+    std::vector<std::thread> threads;
+
+    /* the public entry points, which serialize the strategy but share the registry with the tests above */
+    ASSERT_TRUE(create_pool(&pool));
+    for (u32 t = 0; t < NUM_THREADS; t++) {
+        threads.emplace_back(alloc_realloc_free, &pool, (u8) t);
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    const u32 num_calls = NUM_THREADS * NUM_ROUNDS / 10 * NUM_PTRS_PER_ROUND;
+    ASSERT_TRUE(pool_get_counters(&counters, &pool));
+    ASSERT_EQ(counters.num_alloc_calls, num_calls);
+    ASSERT_EQ(counters.num_realloc_calls, num_calls / 2);
+    ASSERT_EQ(counters.num_free_calls, num_calls);
+    ASSERT_TRUE(pool_drop(&pool));
+}
 
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
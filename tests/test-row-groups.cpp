@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+
+#include "test-utils.h"
+
+/* one row group full of "early" objects, followed by a second one that only holds "late" objects */
+#define NUM_EARLY_OBJECTS NG5_ROW_GROUP_SIZE
+#define NUM_LATE_OBJECTS  100
+#define NUM_OBJECTS       (NUM_EARLY_OBJECTS + NUM_LATE_OBJECTS)
+
+static test_object_t
+tagged_object(u32 i)
+{
+    return { { "tag", json_string(i < NUM_EARLY_OBJECTS ? "early" : "late") }, { "n", std::to_string(i) } };
+}
+
+static field_sid_t
+find_string_id(struct archive_query *query, const char *string)
+{
+    size_t num_match;
+    struct string_pred_t pred;
+
+    string_pred_equals_init(&pred);
+    field_sid_t *result = query_find_ids(&num_match, query, &pred, (void *) string, NG5_QUERY_LIMIT_NONE);
+    EXPECT_TRUE(result != NULL);
+    EXPECT_EQ(num_match, 1u);
+    field_sid_t id = result ? result[0] : NG5_NULL_ENCODED_STRING;
+    free(result);
+    return id;
+}
+
+struct row_group_capture {
+    field_sid_t tag;
+    field_sid_t needle;
+    u32 num_row_groups;
+    u32 num_row_groups_excluded;
+    u32 num_tags_visited;
+    u32 num_needles_visited;
+};
+
+static enum visit_policy
+before_visit_row_group(struct archive *archive, path_stack_t path, object_id_t parent_id, field_sid_t key,
+                       const struct archive_zone_map *zone_map, void *capture)
+{
+    ng5_unused(archive);
+    ng5_unused(path);
+    ng5_unused(parent_id);
+    ng5_unused(key);
+
+    struct row_group_capture *state = (struct row_group_capture *) capture;
+    state->num_row_groups++;
+    if (archive_zone_map_may_contain_string(zone_map, state->tag, state->needle)) {
+        return VISIT_INCLUDE;
+    } else {
+        state->num_row_groups_excluded++;
+        return VISIT_EXCLUDE;
+    }
+}
+
+static void
+visit_object_array_object_property_strings(struct archive *archive, path_stack_t path, object_id_t parent_id,
+                                           field_sid_t key, object_id_t nested_object_id, field_sid_t nested_key,
+                                           const field_sid_t *nested_values, u32 num_nested_values, void *capture)
+{
+    ng5_unused(archive);
+    ng5_unused(path);
+    ng5_unused(parent_id);
+    ng5_unused(key);
+    ng5_unused(nested_object_id);
+
+    struct row_group_capture *state = (struct row_group_capture *) capture;
+    if (nested_key == state->tag) {
+        for (u32 i = 0; i < num_nested_values; i++) {
+            state->num_tags_visited++;
+            state->num_needles_visited += nested_values[i] == state->needle;
+        }
+    }
+}
+
+TEST(RowGroupsTest, ConvertAndRoundTrip)
+{
+    ASSERT_EQ(json_to_json(make_object_array_json(NUM_OBJECTS, tagged_object)),
+              make_expected_object_array_json(NUM_OBJECTS, tagged_object));
+}
+
+TEST(RowGroupsTest, ExcludeRowGroupsByZoneMap)
+{
+    struct archive archive;
+    struct archive_query query;
+
+    bool status = test_archive_from_json(&archive, make_object_array_json(NUM_OBJECTS, tagged_object));
+    ASSERT_TRUE(status);
+    status = archive_query(&query, &archive);
+    ASSERT_TRUE(status);
+
+    struct row_group_capture capture = { };
+    capture.tag = find_string_id(&query, "tag");
+    capture.needle = find_string_id(&query, "late");
+
+    struct archive_visitor visitor = { };
+    struct archive_visitor_desc desc = { .visit_mask = NG5_ARCHIVE_ITER_MASK_ANY };
+    visitor.before_visit_row_group = before_visit_row_group;
+    visitor.visit_object_array_object_property_strings = visit_object_array_object_property_strings;
+
+    status = archive_visit_archive(&archive, &desc, &visitor, &capture);
+    ASSERT_TRUE(status);
+
+    /* only the row group of "late" objects is visited */
+    ASSERT_EQ(capture.num_row_groups, 2u);
+    ASSERT_EQ(capture.num_row_groups_excluded, 1u);
+    ASSERT_EQ(capture.num_tags_visited, (u32) NUM_LATE_OBJECTS);
+    ASSERT_EQ(capture.num_needles_visited, (u32) NUM_LATE_OBJECTS);
+
+    archive_close(&archive);
+}
+
+TEST(RowGroupsTest, FindObjectIdsByStringId)
+{
+    struct archive archive;
+    struct archive_query query;
+    size_t num_found;
+
+    bool status = test_archive_from_json(&archive, make_object_array_json(NUM_OBJECTS, tagged_object));
+    ASSERT_TRUE(status);
+    status = archive_query(&query, &archive);
+    ASSERT_TRUE(status);
+
+    field_sid_t tag = find_string_id(&query, "tag");
+    field_sid_t early = find_string_id(&query, "early");
+    field_sid_t late = find_string_id(&query, "late");
+
+    object_id_t *ids = query_find_object_ids(&num_found, &query, tag, &late, 1);
+    ASSERT_TRUE(ids != NULL);
+    ASSERT_EQ(num_found, (size_t) NUM_LATE_OBJECTS);
+    free(ids);
+
+    field_sid_t both[] = { early, late };
+    ids = query_find_object_ids(&num_found, &query, tag, both, 2);
+    ASSERT_TRUE(ids != NULL);
+    ASSERT_EQ(num_found, (size_t) NUM_OBJECTS);
+    free(ids);
+
+    /* no object has a property "early" */
+    ids = query_find_object_ids(&num_found, &query, early, &late, 1);
+    ASSERT_TRUE(ids == NULL);
+    ASSERT_EQ(num_found, 0u);
+
+    archive_close(&archive);
+}
+
+static test_object_t
+nullable_object(u32 i)
+{
+    return { { "v", "[" + std::to_string(i % 100) + ", null]" } };
+}
+
+struct zone_map_capture {
+    field_sid_t column;
+    u32 num_row_groups;
+    u32 num_nulls;
+    bool may_contain_values;
+    bool may_contain_sentinel_range;
+};
+
+static enum visit_policy
+inspect_row_group(struct archive *archive, path_stack_t path, object_id_t parent_id, field_sid_t key,
+                  const struct archive_zone_map *zone_map, void *capture)
+{
+    ng5_unused(archive);
+    ng5_unused(path);
+    ng5_unused(parent_id);
+    ng5_unused(key);
+
+    struct zone_map_capture *state = (struct zone_map_capture *) capture;
+    u32 num_nulls;
+    state->num_row_groups++;
+    EXPECT_TRUE(archive_zone_map_get_num_nulls(&num_nulls, zone_map, state->column));
+    state->num_nulls += num_nulls;
+    state->may_contain_values &= archive_zone_map_may_contain_int(zone_map, state->column, 0, 99);
+    state->may_contain_sentinel_range |= archive_zone_map_may_contain_int(zone_map, state->column, 100, INT64_MAX);
+    return VISIT_EXCLUDE;
+}
+
+TEST(RowGroupsTest, ZoneMapsSkipNullValues)
+{
+    struct archive archive;
+    struct archive_query query;
+
+    bool status = test_archive_from_json(&archive, make_object_array_json(NUM_OBJECTS, nullable_object));
+    ASSERT_TRUE(status);
+    status = archive_query(&query, &archive);
+    ASSERT_TRUE(status);
+
+    struct zone_map_capture capture = { };
+    capture.column = find_string_id(&query, "v");
+    capture.may_contain_values = true;
+
+    struct archive_visitor visitor = { };
+    struct archive_visitor_desc desc = { .visit_mask = NG5_ARCHIVE_ITER_MASK_ANY };
+    visitor.before_visit_row_group = inspect_row_group;
+
+    status = archive_visit_archive(&archive, &desc, &visitor, &capture);
+    ASSERT_TRUE(status);
+
+    /* the null in each array is counted, but does not widen the value range to the null sentinel */
+    ASSERT_EQ(capture.num_row_groups, 2u);
+    ASSERT_EQ(capture.num_nulls, (u32) NUM_OBJECTS);
+    ASSERT_TRUE(capture.may_contain_values);
+    ASSERT_FALSE(capture.may_contain_sentinel_range);
+
+    archive_close(&archive);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "core/carbon.h"
+#include "stdx/slicelist.h"
+
+#define NUM_SLICES 6
+
+static std::vector<std::string>
+make_keys(u32 num_keys)
+{
+    std::vector<std::string> keys;
+    for (u32 i = 0; i < num_keys; i++) {
+        keys.push_back("key-" + std::to_string(i));
+    }
+    return keys;
+}
+
+static void
+insert_keys(slice_list_t *list, std::vector<std::string> &keys, u32 begin, u32 end)
+{
+    for (u32 i = begin; i < end; i++) {
+        char *key = &keys[i][0];
+        field_sid_t value = 1000 + i;
+        ASSERT_TRUE(slice_list_insert(list, &key, &value, 1));
+    }
+}
+
+/* the value of 'key', or -1 if the list does not contain it */
+static field_sid_t
+lookup(slice_list_t *list, const std::string &key)
+{
+    slice_handle_t handle;
+    bool found = slice_list_lookup(&handle, list, key.c_str());
+    EXPECT_EQ(found, handle.is_contained);
+    return found ? handle.value : (field_sid_t) -1;
+}
+
+static void
+expect_all_keys(slice_list_t *list, const std::vector<std::string> &keys, u32 num_inserted)
+{
+    for (u32 i = 0; i < keys.size(); i++) {
+        ASSERT_EQ(lookup(list, keys[i]), i < num_inserted ? 1000 + i : (field_sid_t) -1) << keys[i];
+    }
+}
+
+static Slice *
+slice_at(slice_list_t *list, u32 pos)
+{
+    return vec_get(&list->slices, pos, Slice);
+}
+
+static u32
+first_in_order(slice_list_t *list)
+{
+    return *vec_get(&list->order, 0, u32);
+}
+
+TEST(SliceListTest, LookupAcrossSlices)
+{
+    slice_list_t list;
+    const u32 num_keys = NUM_SLICES * SLICE_KEY_COLUMN_MAX_ELEMS + SLICE_KEY_COLUMN_MAX_ELEMS / 3;
+    std::vector<std::string> keys = make_keys(num_keys + 100);
+
+    /* full slices are sealed, i.e., sorted by hash and searched by binary search, the last one is scanned */
+    ASSERT_TRUE(slice_list_create(&list, NULL, 2));
+    insert_keys(&list, keys, 0, num_keys);
+    ASSERT_EQ(vec_length(&list.slices), (size_t) NUM_SLICES + 1);
+    for (u32 i = 0; i < NUM_SLICES; i++) {
+        Slice *slice = slice_at(&list, i);
+        ASSERT_EQ(slice->strat, SLICE_LOOKUP_BESEARCH);
+        ASSERT_EQ(slice->num_elems, (u32) SLICE_KEY_COLUMN_MAX_ELEMS);
+        for (u32 k = 1; k < slice->num_elems; k++) {
+            ASSERT_LE(slice->keyHashColumn[k - 1], slice->keyHashColumn[k]);
+        }
+    }
+    ASSERT_EQ(slice_at(&list, NUM_SLICES)->strat, SLICE_LOOKUP_SCAN);
+
+    /* twice, the second time hitting the per-slice cache of the last found position */
+    expect_all_keys(&list, keys, num_keys);
+    expect_all_keys(&list, keys, num_keys);
+
+    /* inserting a key that is contained already keeps it once */
+    insert_keys(&list, keys, 0, 10);
+    ASSERT_EQ(slice_at(&list, NUM_SLICES)->num_elems, num_keys % SLICE_KEY_COLUMN_MAX_ELEMS);
+
+    SliceListDrop(&list);
+}
+
+TEST(SliceListTest, HotAndColdKeysAcrossReorders)
+{
+    slice_list_t list;
+    const u32 num_keys = NUM_SLICES * SLICE_KEY_COLUMN_MAX_ELEMS + 10;
+    std::vector<std::string> keys = make_keys(num_keys + SLICE_KEY_COLUMN_MAX_ELEMS);
+
+    ASSERT_TRUE(slice_list_create(&list, NULL, NUM_SLICES + 2));
+    insert_keys(&list, keys, 0, num_keys);
+    expect_all_keys(&list, keys, num_keys);
+
+    /* keys in the last sealed slice are hot: after some reorganizations, that slice is probed first */
+    const u32 hot_slice = NUM_SLICES - 1;
+    for (u32 round = 0; round < 4 * NG5_SLICE_LIST_REORGANIZE_INTERVAL / SLICE_KEY_COLUMN_MAX_ELEMS; round++) {
+        for (u32 i = hot_slice * SLICE_KEY_COLUMN_MAX_ELEMS; i < (hot_slice + 1) * SLICE_KEY_COLUMN_MAX_ELEMS; i++) {
+            ASSERT_EQ(lookup(&list, keys[i]), 1000 + i) << keys[i];
+        }
+    }
+    ASSERT_EQ(first_in_order(&list), hot_slice);
+
+    /* cold keys, in slices probed after the hot one, and keys in the appender are still found */
+    expect_all_keys(&list, keys, num_keys);
+
+    /* then the keys in the appender become hot, and the appender is sealed once full */
+    const u32 appender = NUM_SLICES;
+    for (u32 round = 0; round < 4 * NG5_SLICE_LIST_REORGANIZE_INTERVAL / 10; round++) {
+        for (u32 i = appender * SLICE_KEY_COLUMN_MAX_ELEMS; i < num_keys; i++) {
+            ASSERT_EQ(lookup(&list, keys[i]), 1000 + i) << keys[i];
+        }
+    }
+    ASSERT_EQ(first_in_order(&list), appender);
+    ASSERT_EQ(slice_at(&list, appender)->strat, SLICE_LOOKUP_SCAN);
+
+    insert_keys(&list, keys, num_keys, keys.size());
+    ASSERT_EQ(slice_at(&list, appender)->strat, SLICE_LOOKUP_BESEARCH);
+    ASSERT_EQ(vec_length(&list.slices), (size_t) NUM_SLICES + 2);
+    expect_all_keys(&list, keys, keys.size());
+
+    SliceListDrop(&list);
+}
+
+TEST(SliceListTest, HashCollisionsInSealedSlices)
+{
+    slice_list_t list;
+    const u32 num_keys = 2 * SLICE_KEY_COLUMN_MAX_ELEMS + 1;
+    std::vector<std::string> keys = make_keys(num_keys);
+    std::vector<struct string_key> string_keys;
+    std::vector<field_sid_t> values;
+
+    /* runs of keys sharing a hash, some of which are longer than the window the binary search narrows down to and
+     * span several vectors of the vectorized scan */
+    for (u32 i = 0; i < num_keys; i++) {
+        struct string_key key = string_key_of(keys[i].c_str());
+        key.hash = i < SLICE_KEY_COLUMN_MAX_ELEMS / 2 ? 7 * (i / 3) : 7 * (i / 13) + 1;
+        string_keys.push_back(key);
+        values.push_back(1000 + i);
+    }
+
+    ASSERT_TRUE(slice_list_create(&list, NULL, 4));
+    ASSERT_TRUE(slice_list_insert_keys(&list, string_keys.data(), values.data(), num_keys));
+    ASSERT_EQ(vec_length(&list.slices), 3u);
+
+    for (u32 round = 0; round < 2; round++) {
+        for (u32 i = 0; i < num_keys; i++) {
+            slice_handle_t handle;
+            ASSERT_TRUE(slice_list_lookup_key(&handle, &list, &string_keys[i])) << keys[i];
+            ASSERT_EQ(handle.value, 1000 + i) << keys[i];
+        }
+    }
+
+    /* a key whose hash is contained, but the key itself is not */
+    struct string_key unknown = string_key_of("unknown");
+    unknown.hash = string_keys[SLICE_KEY_COLUMN_MAX_ELEMS].hash;
+    slice_handle_t handle;
+    ASSERT_FALSE(slice_list_lookup_key(&handle, &list, &unknown));
+    ASSERT_FALSE(handle.is_contained);
+
+    SliceListDrop(&list);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/carbon.h"
+#include "core/encode/encode_concurrent.h"
+
+#define NUM_THREADS 8
+#define NUM_KEYS_PER_THREAD 4000
+#define KEY_STRIDE 1000
+#define BATCH_SIZE 97
+
+/* the i-th key, which is inserted by up to NUM_KEYS_PER_THREAD / KEY_STRIDE threads */
+static std::string
+key_name(u32 i)
+{
+    return "key-" + std::to_string(i);
+}
+
+/* inserts the keys of thread 't' in small batches, and locates each batch right after it was inserted */
+static void
+insert_keys(struct strdic *dic, u32 t, std::vector<field_sid_t> *ids, bool *success)
+{
+    std::vector<std::string> keys;
+    for (u32 i = 0; i < NUM_KEYS_PER_THREAD; i++) {
+        keys.push_back(key_name(t * KEY_STRIDE + i));
+    }
+
+    *success = true;
+    for (size_t begin = 0; begin < keys.size(); begin += BATCH_SIZE) {
+        size_t end = std::min(keys.size(), begin + BATCH_SIZE);
+        std::vector<char *> batch;
+        for (size_t i = begin; i < end; i++) {
+            batch.push_back(&keys[i][0]);
+        }
+
+        field_sid_t *inserted, *located;
+        if (!strdic_insert(dic, &inserted, batch.data(), batch.size(), 1)) {
+            *success = false;
+            return;
+        }
+        if (!strdic_locate_fast(&located, dic, batch.data(), batch.size())) {
+            strdic_free(dic, inserted);
+            *success = false;
+            return;
+        }
+        for (size_t i = 0; i < batch.size(); i++) {
+            ids->push_back(inserted[i]);
+            *success &= located[i] == inserted[i];
+        }
+        strdic_free(dic, inserted);
+        strdic_free(dic, located);
+    }
+}
+
+TEST(StrdicConcurrentTest, OverlappingInserts)
+{
+    struct strdic dic;
+    std::vector<std::thread> threads;
+    std::vector<std::vector<field_sid_t>> ids(NUM_THREADS);
+    bool success[NUM_THREADS];
+
+    /* a small capacity, such that the index is grown while other threads insert */
+    ASSERT_TRUE(encode_concurrent_create(&dic, 16, NULL));
+    for (u32 t = 0; t < NUM_THREADS; t++) {
+        threads.emplace_back(insert_keys, &dic, t, &ids[t], &success[t]);
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    /* each thread got the same id for the same key, and distinct ids for distinct keys */
+    std::map<std::string, field_sid_t> key_ids;
+    std::map<field_sid_t, std::string> id_keys;
+    for (u32 t = 0; t < NUM_THREADS; t++) {
+        ASSERT_TRUE(success[t]) << "thread " << t;
+        ASSERT_EQ(ids[t].size(), (size_t) NUM_KEYS_PER_THREAD);
+        for (u32 i = 0; i < NUM_KEYS_PER_THREAD; i++) {
+            std::string key = key_name(t * KEY_STRIDE + i);
+            field_sid_t id = ids[t][i];
+            ASSERT_NE(id, NG5_NULL_ENCODED_STRING);
+            ASSERT_EQ(key_ids.emplace(key, id).first->second, id) << key;
+            ASSERT_EQ(id_keys.emplace(id, key).first->second, key) << id;
+        }
+    }
+
+    /* ids are dense */
+    const size_t num_keys = (NUM_THREADS - 1) * KEY_STRIDE + NUM_KEYS_PER_THREAD;
+    ASSERT_EQ(key_ids.size(), num_keys);
+    ASSERT_EQ(id_keys.size(), num_keys);
+    ASSERT_EQ(id_keys.begin()->first, NG5_NULL_ENCODED_STRING + 1);
+    ASSERT_EQ(id_keys.rbegin()->first, NG5_NULL_ENCODED_STRING + num_keys);
+
+    size_t num_distinct;
+    ASSERT_TRUE(strdic_num_distinct(&num_distinct, &dic));
+    ASSERT_EQ(num_distinct, num_keys);
+
+    /* all keys are located by, and extracted as, the id they were inserted with */
+    std::vector<std::string> keys;
+    std::vector<char *> key_ptrs;
+    std::vector<field_sid_t> expected;
+    for (auto &entry : key_ids) {
+        keys.push_back(entry.first);
+        expected.push_back(entry.second);
+    }
+    for (std::string &key : keys) {
+        key_ptrs.push_back(&key[0]);
+    }
+
+    field_sid_t *located;
+    bool *found_mask;
+    size_t num_not_found;
+    ASSERT_TRUE(strdic_locate_safe(&located, &found_mask, &num_not_found, &dic, key_ptrs.data(), key_ptrs.size()));
+    ASSERT_EQ(num_not_found, 0u);
+    ASSERT_EQ(std::vector<field_sid_t>(located, located + keys.size()), expected);
+    strdic_free(&dic, located);
+    strdic_free(&dic, found_mask);
+
+    char **extracted = strdic_extract(&dic, expected.data(), expected.size());
+    ASSERT_TRUE(extracted != NULL);
+    for (size_t i = 0; i < keys.size(); i++) {
+        ASSERT_STREQ(extracted[i], keys[i].c_str());
+    }
+    strdic_free(&dic, extracted);
+
+    /* a key never inserted is not found */
+    char unknown[] = "key-unknown";
+    char *unknown_ptr = unknown;
+    ASSERT_TRUE(strdic_locate_safe(&located, &found_mask, &num_not_found, &dic, &unknown_ptr, 1));
+    ASSERT_EQ(num_not_found, 1u);
+    ASSERT_FALSE(found_mask[0]);
+    strdic_free(&dic, located);
+    strdic_free(&dic, found_mask);
+
+    strdic_drop(&dic);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,279 @@
+#include <gtest/gtest.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "core/carbon.h"
+#include "core/strhash/strhash_swiss.h"
+
+/* counts live blocks, records the sizes of all requested allocations, and fails the n-th allocation if asked to */
+struct counting_allocator_state {
+    size_t num_live;
+    u32 fail_countdown;                 /* the allocation that fails, counted from 1, or 0 to never fail */
+    std::vector<size_t> sizes;
+};
+
+static void *
+counting_malloc(struct allocator *self, size_t size)
+{
+    counting_allocator_state *state = (counting_allocator_state *) self->extra;
+    state->sizes.push_back(size);
+    if (state->fail_countdown && --state->fail_countdown == 0) {
+        return NULL;
+    }
+    state->num_live++;
+    return malloc(size);
+}
+
+static void *
+counting_realloc(struct allocator *self, void *ptr, size_t size)
+{
+    ng5_unused(self);
+    return realloc(ptr, size);
+}
+
+static void
+counting_free(struct allocator *self, void *ptr)
+{
+    ((counting_allocator_state *) self->extra)->num_live--;
+    free(ptr);
+}
+
+static void
+counting_clone(struct allocator *dst, const struct allocator *self)
+{
+    *dst = *self;
+}
+
+static void
+counting_allocator_create(struct allocator *alloc, counting_allocator_state *state)
+{
+    *state = counting_allocator_state();
+    alloc->extra = state;
+    error_init(&alloc->err);
+    alloc->malloc = counting_malloc;
+    alloc->realloc = counting_realloc;
+    alloc->free = counting_free;
+    alloc->clone = counting_clone;
+}
+
+static std::vector<std::string>
+make_keys(u32 first, u32 num_keys)
+{
+    std::vector<std::string> keys;
+    for (u32 i = first; i < first + num_keys; i++) {
+        keys.push_back("key-" + std::to_string(i));
+    }
+    return keys;
+}
+
+static std::vector<char *>
+key_ptrs(std::vector<std::string> &keys)
+{
+    std::vector<char *> ptrs;
+    for (std::string &key : keys) {
+        ptrs.push_back(&key[0]);
+    }
+    return ptrs;
+}
+
+/* the value of 'key', or -1 if the table does not contain it */
+static field_sid_t
+get(struct strhash *map, const std::string &key)
+{
+    field_sid_t value;
+    bool found;
+    EXPECT_TRUE(strhash_get_bulk_safe_exact(&value, &found, map, key.c_str()));
+    return found ? value : (field_sid_t) -1;
+}
+
+TEST(StrhashSwissTest, PutGetRemove)
+{
+    struct strhash map;
+    std::vector<std::string> keys = make_keys(0, 1000);
+    std::vector<char *> ptrs = key_ptrs(keys);
+    std::vector<field_sid_t> values;
+    for (u32 i = 0; i < keys.size(); i++) {
+        values.push_back(10 * i);
+    }
+
+    ASSERT_TRUE(strhash_create_swiss(&map, NULL, keys.size()));
+    ASSERT_TRUE(strhash_put_safe(&map, ptrs.data(), values.data(), keys.size()));
+
+    field_sid_t *out;
+    bool *found_mask;
+    size_t num_not_found;
+    ASSERT_TRUE(strhash_get_bulk_safe(&out, &found_mask, &num_not_found, &map, ptrs.data(), keys.size()));
+    ASSERT_EQ(num_not_found, 0u);
+    ASSERT_EQ(std::vector<field_sid_t>(out, out + keys.size()), values);
+    strhash_free(out, &map);
+    strhash_free(found_mask, &map);
+
+    /* a safe put replaces the value of a key that exists already */
+    ASSERT_TRUE(strhash_put_exact(&map, keys[7].c_str(), 7));
+    ASSERT_EQ(get(&map, keys[7]), 7u);
+    values[7] = 7;
+    ASSERT_EQ(get(&map, "key-unknown"), (field_sid_t) -1);
+
+    /* every other key is removed, and then the removed keys are put back with other values */
+    std::vector<char *> removed;
+    for (u32 i = 0; i < keys.size(); i += 2) {
+        removed.push_back(ptrs[i]);
+    }
+    ASSERT_TRUE(strhash_remove(&map, removed.data(), removed.size()));
+    for (u32 i = 0; i < keys.size(); i++) {
+        ASSERT_EQ(get(&map, keys[i]), i % 2 ? values[i] : (field_sid_t) -1) << keys[i];
+    }
+    for (u32 i = 0; i < keys.size(); i += 2) {
+        ASSERT_TRUE(strhash_put_exact_fast(&map, keys[i].c_str(), i + 1));
+    }
+    for (u32 i = 0; i < keys.size(); i++) {
+        ASSERT_EQ(get(&map, keys[i]), i % 2 ? values[i] : i + 1) << keys[i];
+    }
+
+    strhash_drop(&map);
+}
+
+TEST(StrhashSwissTest, GrowthKeepsAllKeys)
+{
+    struct strhash map;
+    struct allocator alloc;
+    counting_allocator_state state;
+    std::vector<std::string> keys = make_keys(0, 20000);
+
+    /* from a single group, the table doubles while keys are put one by one */
+    counting_allocator_create(&alloc, &state);
+    ASSERT_TRUE(strhash_create_swiss(&map, &alloc, 1));
+    std::vector<size_t> table_sizes = { state.sizes.back() };
+    for (u32 i = 0; i < keys.size(); i++) {
+        size_t num_allocs = state.sizes.size();
+        ASSERT_TRUE(strhash_put_exact_fast(&map, keys[i].c_str(), i));
+        if (state.sizes.size() > num_allocs) {
+            /* control bytes first, then slots */
+            ASSERT_EQ(state.sizes.size(), num_allocs + 2);
+            table_sizes.push_back(state.sizes.back());
+        }
+    }
+    ASSERT_GT(table_sizes.size(), 8u);
+    for (size_t i = 1; i < table_sizes.size(); i++) {
+        ASSERT_EQ(table_sizes[i], 2 * table_sizes[i - 1]);
+    }
+
+    for (u32 i = 0; i < keys.size(); i++) {
+        ASSERT_EQ(get(&map, keys[i]), i) << keys[i];
+    }
+    ASSERT_EQ(get(&map, "key-20000"), (field_sid_t) -1);
+
+    strhash_drop(&map);
+    ASSERT_EQ(state.num_live, 0u);
+}
+
+/* puts keys until the next put would grow the table; returns the number of keys put */
+static u32
+fill_to_limit(struct strhash *map, counting_allocator_state *state, std::vector<std::string> &keys)
+{
+    u32 num_keys = 0;
+
+    /* only a growing put allocates, which then fails and leaves the table as is */
+    state->fail_countdown = 1;
+    while (strhash_put_exact_fast(map, keys[num_keys].c_str(), num_keys)) {
+        num_keys++;
+    }
+    EXPECT_EQ(state->fail_countdown, 0u);
+    return num_keys;
+}
+
+TEST(StrhashSwissTest, TombstonesRehashInPlace)
+{
+    struct strhash map;
+    struct allocator alloc;
+    counting_allocator_state state;
+    std::vector<std::string> keys = make_keys(0, 20000);
+    std::deque<u32> live;
+    std::vector<bool> removed(keys.size());
+
+    counting_allocator_create(&alloc, &state);
+    ASSERT_TRUE(strhash_create_swiss(&map, &alloc, 100));
+    /* the slots are allocated last, also if allocating the control bytes before them fails */
+    size_t slots_size = state.sizes.back();
+    u32 num_keys = fill_to_limit(&map, &state, keys);
+    for (u32 i = 0; i < num_keys; i++) {
+        live.push_back(i);
+    }
+
+    /* a table at its load limit has full groups, in which removed slots become tombstones. For each key removed, a
+     * new one is put unless the table would have to grow, which is refused. The table stays at its limit while
+     * tombstones take the place of more and more keys, until a growing put finds less than half of the load to be
+     * keys, and rehashes the table in place rather than doubling it */
+    while (true) {
+        ASSERT_LT(num_keys, keys.size());
+        char *key = &keys[live.front()][0];
+        removed[live.front()] = true;
+        live.pop_front();
+        ASSERT_TRUE(strhash_remove(&map, &key, 1));
+
+        state.fail_countdown = 1;
+        if (strhash_put_exact_fast(&map, keys[num_keys].c_str(), num_keys)) {
+            live.push_back(num_keys++);
+        } else if (state.sizes.back() == slots_size) {
+            break;
+        } else {
+            ASSERT_EQ(state.sizes.back(), 2 * slots_size);
+        }
+    }
+
+    /* the rehash takes place once allocations succeed again */
+    size_t num_allocs = state.sizes.size();
+    ASSERT_TRUE(strhash_put_exact_fast(&map, keys[num_keys].c_str(), num_keys));
+    live.push_back(num_keys++);
+    ASSERT_EQ(state.sizes.size(), num_allocs + 2);
+    ASSERT_EQ(state.sizes.back(), slots_size);
+
+    for (u32 i = 0; i < num_keys; i++) {
+        ASSERT_EQ(get(&map, keys[i]), removed[i] ? (field_sid_t) -1 : i) << keys[i];
+    }
+
+    strhash_drop(&map);
+    ASSERT_EQ(state.num_live, 0u);
+}
+
+TEST(StrhashSwissTest, FailedGrowthKeepsTable)
+{
+    struct strhash map;
+    struct allocator alloc;
+    counting_allocator_state state;
+    std::vector<std::string> keys = make_keys(0, 1000);
+
+    counting_allocator_create(&alloc, &state);
+    ASSERT_TRUE(strhash_create_swiss(&map, &alloc, 100));
+    u32 num_keys = fill_to_limit(&map, &state, keys);
+
+    /* either of the two allocations of the new table fails, without losing keys or leaking the other block */
+    size_t num_live = state.num_live;
+    for (u32 fail : { 1, 2 }) {
+        state.fail_countdown = fail;
+        ASSERT_FALSE(strhash_put_exact_fast(&map, keys[num_keys].c_str(), num_keys)) << "allocation " << fail;
+        ASSERT_EQ(state.num_live, num_live);
+        for (u32 i = 0; i < num_keys; i++) {
+            ASSERT_EQ(get(&map, keys[i]), i) << keys[i];
+        }
+        ASSERT_EQ(get(&map, keys[num_keys]), (field_sid_t) -1);
+    }
+
+    /* the table grows once allocations succeed again */
+    state.fail_countdown = 0;
+    for (u32 i = num_keys; i < keys.size(); i++) {
+        ASSERT_TRUE(strhash_put_exact_fast(&map, keys[i].c_str(), i));
+    }
+    for (u32 i = 0; i < keys.size(); i++) {
+        ASSERT_EQ(get(&map, keys[i]), i) << keys[i];
+    }
+
+    strhash_drop(&map);
+    ASSERT_EQ(state.num_live, 0u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
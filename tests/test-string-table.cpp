@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <set>
+#include <algorithm>
+
+#include "test-utils.h"
+
+#define NUM_OBJECTS 300
+
+static const enum packer_type packers[] = { PACK_NONE, PACK_HUFFMAN, PACK_FSST, PACK_FRONT };
+
+static test_object_t
+valued_object(u32 i)
+{
+    return { { "name", json_string("value-" + std::to_string(i * 7919 % 1000)) },
+             { "kind", json_string(i % 2 ? "odd" : "even") } };
+}
+
+static std::set<std::string>
+make_expected_strings()
+{
+    std::set<std::string> strings = { "/", "name", "kind", "odd", "even" };
+    for (u32 i = 0; i < NUM_OBJECTS; i++) {
+        strings.insert("value-" + std::to_string(i * 7919 % 1000));
+    }
+    return strings;
+}
+
+/* scans the slot directory in small batches, and fetches each string by its id */
+static void
+expect_string_table(struct archive *archive, const std::set<std::string> &expected)
+{
+    struct archive_query query;
+    struct strid_iter it;
+    struct strid_info *info;
+    struct err err;
+    size_t info_len;
+    bool success;
+    std::vector<field_sid_t> ids;
+    std::set<std::string> strings;
+
+    ASSERT_TRUE(archive->string_table.indexed);
+    ASSERT_TRUE(archive_query(&query, archive));
+
+    ASSERT_TRUE(strid_iter_open_with(&it, &err, archive, 7, NG5_STRID_ITER_BLOCK_SIZE));
+    while (strid_iter_next(&success, &info, &err, &info_len, &it)) {
+        ASSERT_TRUE(success);
+        for (size_t i = 0; i < info_len; i++) {
+            ids.push_back(info[i].id);
+        }
+    }
+    strid_iter_close(&it);
+
+    /* slots are sorted by id */
+    ASSERT_EQ(ids.size(), expected.size());
+    ASSERT_TRUE(std::is_sorted(ids.begin(), ids.end()));
+    ASSERT_TRUE(std::adjacent_find(ids.begin(), ids.end()) == ids.end());
+
+    for (field_sid_t id : ids) {
+        char *string = query_fetch_string_by_id(&query, id);
+        ASSERT_TRUE(string != NULL);
+        char *uncached = query_fetch_string_by_id_nocache(&query, id);
+        ASSERT_TRUE(uncached != NULL);
+        ASSERT_STREQ(string, uncached);
+        strings.insert(string);
+        free(string);
+        free(uncached);
+    }
+    ASSERT_EQ(strings, expected);
+
+    /* ids between and beyond the slots are not found */
+    ASSERT_TRUE(query_fetch_string_by_id_nocache(&query, ids.back() + 1) == NULL);
+    for (size_t i = 0; i + 1 < ids.size(); i++) {
+        if (ids[i] + 1 < ids[i + 1]) {
+            ASSERT_TRUE(query_fetch_string_by_id_nocache(&query, ids[i] + 1) == NULL);
+            break;
+        }
+    }
+}
+
+TEST(StringTableTest, ConvertAndRoundTrip)
+{
+    std::string json = make_object_array_json(NUM_OBJECTS, valued_object);
+
+    for (bool read_optimized : { false, true }) {
+        std::string expected;
+        for (enum packer_type packer : packers) {
+            struct archive archive;
+
+            bool status = test_archive_from_json(&archive, json, packer, read_optimized);
+            ASSERT_TRUE(status) << "packer " << packer;
+            ASSERT_TRUE(archive.string_table.indexed);
+            std::string result = to_json(&archive);
+            archive_close(&archive);
+
+            /* the packer does not change the output */
+            expected = expected.empty() ? result : expected;
+            ASSERT_EQ(result, expected) << "packer " << packer << ", read-optimized " << read_optimized;
+        }
+    }
+}
+
+TEST(StringTableTest, FetchStringsById)
+{
+    std::string json = make_object_array_json(NUM_OBJECTS, valued_object);
+    std::set<std::string> expected = make_expected_strings();
+
+    /* ids are dense in read-optimized archives, hence looked up directly, and otherwise by binary search */
+    for (bool read_optimized : { false, true }) {
+        for (enum packer_type packer : packers) {
+            struct archive archive;
+
+            SCOPED_TRACE("packer " + std::to_string(packer) + ", read-optimized " + std::to_string(read_optimized));
+            bool status = test_archive_from_json(&archive, json, packer, read_optimized);
+            ASSERT_TRUE(status);
+            expect_string_table(&archive, expected);
+            archive_close(&archive);
+        }
+    }
+}
+
+TEST(StringTableTest, ReopenMappedAndBuffered)
+{
+    struct archive archive;
+
+    bool status = test_archive_from_json(&archive, make_object_array_json(NUM_OBJECTS, valued_object), PACK_HUFFMAN);
+    ASSERT_TRUE(status);
+    std::string expected = to_json(&archive);
+    archive_close(&archive);
+
+    for (enum archive_open_mode mode : { ARCHIVE_OPEN_MAPPED, ARCHIVE_OPEN_BUFFERED }) {
+        SCOPED_TRACE("mode " + std::to_string(mode));
+        ASSERT_TRUE(archive_open_with_mode(&archive, TEST_ARCHIVE_PATH, mode));
+        expect_string_table(&archive, make_expected_strings());
+        ASSERT_EQ(to_json(&archive), expected);
+        archive_close(&archive);
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,102 @@
+#ifndef NG5_TEST_UTILS_H
+#define NG5_TEST_UTILS_H
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/carbon.h"
+
+/* archives created by tests are written to (and replaced at) this path, relative to the working directory */
+#define TEST_ARCHIVE_PATH "tmp-test-archive.carbon"
+
+/* properties of an object as key and JSON value, in order */
+typedef std::vector<std::pair<std::string, std::string>> test_object_t;
+
+static inline bool
+test_archive_from_json(struct archive *archive, const std::string &json, enum packer_type compressor = PACK_NONE,
+                       bool read_optimized = false)
+{
+    struct err err;
+    return archive_from_json(archive, TEST_ARCHIVE_PATH, &err, json.c_str(), compressor, SYNC, 0, read_optimized,
+                             false, NULL);
+}
+
+/* prints 'archive' as JSON, in the same way as 'carbon-tool to_json' */
+static inline std::string
+to_json(struct archive *archive)
+{
+    char *buffer = NULL;
+    size_t buffer_len = 0;
+    struct encoded_doc_list collection;
+
+    FILE *file = open_memstream(&buffer, &buffer_len);
+    archive_converter(&collection, archive);
+    encoded_doc_collection_print(file, &collection);
+    encoded_doc_collection_drop(&collection);
+    fclose(file);
+
+    std::string result(buffer, buffer_len);
+    free(buffer);
+    return result;
+}
+
+/* converts 'json' into an archive, and prints that archive as JSON */
+static inline std::string
+json_to_json(const std::string &json, enum packer_type compressor = PACK_NONE, bool read_optimized = false)
+{
+    struct archive archive;
+
+    bool status = test_archive_from_json(&archive, json, compressor, read_optimized);
+    EXPECT_TRUE(status);
+    if (!status) {
+        return "";
+    }
+    std::string result = to_json(&archive);
+    archive_close(&archive);
+    return result;
+}
+
+/* the JSON array of 'num_objects' objects, the i-th of which holds the properties 'object(i)' */
+static inline std::string
+make_object_array_json(u32 num_objects, test_object_t (*object)(u32))
+{
+    std::string json = "[";
+    for (u32 i = 0; i < num_objects; i++) {
+        test_object_t properties = object(i);
+        json += i > 0 ? ", {" : "{";
+        for (size_t k = 0; k < properties.size(); k++) {
+            json += (k > 0 ? ", \"" : "\"") + properties[k].first + "\": " + properties[k].second;
+        }
+        json += "}";
+    }
+    return json + "]";
+}
+
+/* the output of 'to_json' for an archive of 'make_object_array_json(num_objects, object)' */
+static inline std::string
+make_expected_object_array_json(u32 num_objects, test_object_t (*object)(u32))
+{
+    std::string json = "{\n   \"/\": [\n";
+    for (u32 i = 0; i < num_objects; i++) {
+        test_object_t properties = object(i);
+        json += i > 0 ? ",\n      {\n" : "      {\n";
+        for (size_t k = 0; k < properties.size(); k++) {
+            json += "         \"" + properties[k].first + "\": " + properties[k].second
+                + (k + 1 < properties.size() ? ", \n" : "\n");
+        }
+        json += "      }";
+    }
+    return json + "\n   ]\n}";
+}
+
+/* a JSON string value */
+static inline std::string
+json_string(const std::string &value)
+{
+    return "\"" + value + "\"";
+}
+
+#endif
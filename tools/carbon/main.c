@@ -20,21 +20,35 @@
                           "   --no-string-id-index       Turn-off pre-computation of string id to offset\n" \
                           "                              index\n" \
                           "   --read-optimized           Sort keys and values during pre-processing for\n" \
-                          "                              efficient reads (experimental)\n" \
+                          "                              efficient reads, and assign string ids in\n" \
+                          "                              lexicographic order of strings (experimental)\n" \
                           "   --force-overwrite          Overwrite the output file if this file already\n" \
                           "                              exists\n" \
                           "   --silent                   Suppress all outputs to stdout\n" \
                           "   --dic-type <type>          Use <type> as string dictionary implementation to\n" \
-                          "                              be used. Types are 'sync' (single-threaded), and\n" \
-                          "                              'async' (multi-threaded). Default type is 'async'.\n" \
+                          "                              be used. Types are 'sync' (single-threaded),\n" \
+                          "                              'async' (multi-threaded, partitioned by string), and\n" \
+                          "                              'concurrent' (shared by all threads). Default type\n" \
+                          "                              is 'async'.\n" \
                           "                              If 'async', see `--dic-nthreads` for options\n" \
                           "   --dic-nthreads <num>       Use number <num> of threads being spawn for\n" \
                           "                              string dictionary encoding. Ignored unless\n" \
                           "                              parameter `--dic-type` is set to `async`.\n" \
                           "                              By default, 8 threads are spawned\n" \
+                          "   --trace-alloc <file>       Record all allocations made through the library's\n" \
+                          "                              default allocator into the binary allocation trace\n" \
+                          "                              <file>, e.g., to replay it with `bench-mem-replay`\n" \
+                          "   --ndjson                   Read <input> as newline-delimited JSON, one object per\n" \
+                          "                              line, and convert it in batches with bounded memory.\n" \
+                          "                              The documents are stored in the object array \"/\"\n" \
+                          "   --batch-docs <num>         Flush a batch of newline-delimited JSON after <num>\n" \
+                          "                              documents. By default, 4096 documents\n" \
+                          "   --batch-bytes <num>        Flush a batch of newline-delimited JSON after about\n" \
+                          "                              <num> bytes of input. By default, 16 MiB\n" \
                           "\nEXAMPLE\n" \
                           "   $ carbon-tool convert out.carbon in.json\n" \
-                          "   $ carbon-tool convert --size-optimized --read-optimized out.carbon in.json" \
+                          "   $ carbon-tool convert --size-optimized --read-optimized out.carbon in.json\n" \
+                          "   $ carbon-tool convert --ndjson out.carbon in.ndjson" \
 
 #define DESC_CAB2JS_INFO  "Convert single CARBON file into JSON and print it to stdout"
 #define DESC_CAB2JS_USAGE "The parameter <args> is a path to a CARBON file that is converted JSON and printed on stdout.\n" \
@@ -171,6 +171,10 @@ bool moduleCheckJsInvoke(int argc, char **argv, FILE *file, struct cmdopt_mgr *m
 #define JS_2_CAB_OPTION_DIC_NTHREADS "--dic-nthreads"
 #define JS_2_CAB_OPTION_NO_STRING_ID_INDEX "--no-string-id-index"
 #define JS_2_CAB_OPTION_USE_COMPRESSOR "--compressor"
+#define JS_2_CAB_OPTION_TRACE_ALLOC "--trace-alloc"
+#define JS_2_CAB_OPTION_NDJSON "--ndjson"
+#define JS_2_CAB_OPTION_NDJSON_BATCH_DOCS "--batch-docs"
+#define JS_2_CAB_OPTION_NDJSON_BATCH_BYTES "--batch-bytes"
 #define JS_2_CAB_OPTION_USE_COMPRESSOR_HUFFMAN "huffman"
 
 static void tracker_begin_create_from_model()
@@ -326,6 +330,10 @@ bool moduleJs2CabInvoke(int argc, char **argv, FILE *file, struct cmdopt_mgr *ma
         enum packer_type compressor = PACK_NONE;
         enum strdic_tag dic_type = ASYNC;
         int string_dic_async_nthreads = 8;
+        const char *pathAllocTrace = NULL;
+        bool flagNdjson = false;
+        u32 ndjsonBatchDocs = NG5_NDJSON_BATCH_DOCS;
+        size_t ndjsonBatchBytes = NG5_NDJSON_BATCH_BYTES;
 
         int outputIdx = 0, inputIdx = 1;
         int i;
@@ -359,6 +367,8 @@ bool moduleJs2CabInvoke(int argc, char **argv, FILE *file, struct cmdopt_mgr *ma
                         dic_type = ASYNC;
                     } else if (strcmp(dic_type_name, "sync") == 0) {
                         dic_type = SYNC;
+                    } else if (strcmp(dic_type_name, "concurrent") == 0) {
+                        dic_type = CONCURRENT;
                     } else {
                         NG5_CONSOLE_WRITE(file, "unsupported dictionary type requested: '%s'",
                                              dic_type_name);
@@ -378,6 +388,24 @@ bool moduleJs2CabInvoke(int argc, char **argv, FILE *file, struct cmdopt_mgr *ma
                         NG5_CONSOLE_WRITELN(file, "** ERROR ** thread setting cannot be applied: %s", opt);
                         return false;
                     }
+                } else if (strcmp(opt, JS_2_CAB_OPTION_TRACE_ALLOC) == 0 && i++ < argc) {
+                    pathAllocTrace = argv[i];
+                } else if (strcmp(opt, JS_2_CAB_OPTION_NDJSON) == 0) {
+                    flagNdjson = true;
+                } else if ((strcmp(opt, JS_2_CAB_OPTION_NDJSON_BATCH_DOCS) == 0 ||
+                            strcmp(opt, JS_2_CAB_OPTION_NDJSON_BATCH_BYTES) == 0) && i++ < argc) {
+                    const char *batch_str = argv[i];
+                    long long batch_atoll = atoll(batch_str);
+                    if (batch_atoll <= 0) {
+                        NG5_CONSOLE_WRITE(file, "not a number or zero batch size assigned: '%s'", batch_str);
+                        NG5_CONSOLE_WRITE_CONT(file, "[%s]\n", "ERROR");
+                        NG5_CONSOLE_WRITELN(file, "** ERROR ** batch setting cannot be applied: %s", opt);
+                        return false;
+                    } else if (strcmp(opt, JS_2_CAB_OPTION_NDJSON_BATCH_DOCS) == 0) {
+                        ndjsonBatchDocs = batch_atoll > UINT32_MAX ? UINT32_MAX : (u32) batch_atoll;
+                    } else {
+                        ndjsonBatchBytes = batch_atoll;
+                    }
                 } else {
                     NG5_CONSOLE_WRITELN(file, "** ERROR ** unrecognized option '%s'", opt);
                     return false;
@@ -392,6 +420,12 @@ bool moduleJs2CabInvoke(int argc, char **argv, FILE *file, struct cmdopt_mgr *ma
                 "optimization is turned off. Use '--size-optimized' such that a pack has any effect%s", "");
         }
 
+        if (flagNdjson && flagReadOptimized) {
+            NG5_CONSOLE_WRITELN(file, "** ERROR ** '%s' cannot be combined with '%s' since sorting requires the "
+                "entire input", JS_2_CAB_OPTION_NDJSON, JS_2_CAB_OPTION_READ_OPTIMIZED);
+            return false;
+        }
+
         if (i + 1 >= argc) {
             NG5_CONSOLE_WRITELN(file, "** ERROR ** require <output> and <input> parameter: %d remain", argc);
             return false;
@@ -415,17 +449,29 @@ bool moduleJs2CabInvoke(int argc, char **argv, FILE *file, struct cmdopt_mgr *ma
             return false;
         }
 
-        NG5_CONSOLE_WRITELN(file, "  - Read contents into memory%s", "");
+        if (pathAllocTrace) {
+            struct allocator recorder;
+            if (!trace_alloc_create_recording(&recorder, pathAllocTrace)) {
+                NG5_CONSOLE_WRITELN(file, "** ERROR ** unable to open allocation trace file '%s'", pathAllocTrace);
+                return false;
+            }
+            alloc_override_std(&recorder);
+        }
 
+        char *jsonContent = NULL;
         FILE *f = fopen(pathJsonFileIn, "rb");
-        fseek(f, 0, SEEK_END);
-        long fsize = ftell(f);
-        fseek(f, 0, SEEK_SET);
-        char *jsonContent = malloc(fsize + 1);
-        size_t nread = fread(jsonContent, fsize, 1, f);
-        ng5_unused(nread);
-        fclose(f);
-        jsonContent[fsize] = 0;
+        if (!flagNdjson) {
+            NG5_CONSOLE_WRITELN(file, "  - Read contents into memory%s", "");
+
+            fseek(f, 0, SEEK_END);
+            long fsize = ftell(f);
+            fseek(f, 0, SEEK_SET);
+            jsonContent = malloc(fsize + 1);
+            size_t nread = fread(jsonContent, fsize, 1, f);
+            ng5_unused(nread);
+            fclose(f);
+            jsonContent[fsize] = 0;
+        }
 
         struct archive archive;
         struct err err;
@@ -459,7 +505,16 @@ bool moduleJs2CabInvoke(int argc, char **argv, FILE *file, struct cmdopt_mgr *ma
         progress_tracker.begin_string_id_index_baking = tracker_begin_string_id_index_baking;
         progress_tracker.end_string_id_index_baking = tracker_end_string_id_index_baking;
 
-        if (!archive_from_json(&archive, pathCarbonFileOut, &err, jsonContent,
+        if (flagNdjson) {
+            if (!archive_from_ndjson(&archive, pathCarbonFileOut, &err, f, compressor, dic_type,
+                                     string_dic_async_nthreads, ndjsonBatchDocs, ndjsonBatchBytes,
+                                     flagBakeStringIdIndex, &progress_tracker)) {
+                error_print_and_abort(&err);
+            } else {
+                archive_close(&archive);
+            }
+            fclose(f);
+        } else if (!archive_from_json(&archive, pathCarbonFileOut, &err, jsonContent,
                                       compressor, dic_type, string_dic_async_nthreads, flagReadOptimized,
                                       flagBakeStringIdIndex, &progress_tracker)) {
             error_print_and_abort(&err);
@@ -470,6 +525,11 @@ bool moduleJs2CabInvoke(int argc, char **argv, FILE *file, struct cmdopt_mgr *ma
 
         free(jsonContent);
 
+        if (pathAllocTrace) {
+            alloc_override_std(NULL);
+            trace_alloc_close_recording();
+        }
+
 //        struct memblock *carbonFile;
 //        NG5_CONSOLE_WRITE(file, "  - Convert partition into in-memory CARBON file%s", "");
 //        struct err err;